@@ -5,6 +5,7 @@
  *      Author: vince
  */
 #include <stdbool.h>
+#include <stdint.h>
 #ifndef INCLUDE_IOT_IOT_COMMUNICATION_H_
 #define INCLUDE_IOT_IOT_COMMUNICATION_H_
 
@@ -74,6 +75,11 @@ void init_GPIOs_IOT();
  *   3 = Category 3 (binary: 01) - Low/Warning/Below threshold
  *   4 = Category 4 (binary: 00) - Unknown/No reading
  * 
+ * The pin values of every (code, active, value) combination come from a table
+ * built at compile time; each port is changed with a single write, so the
+ * receiver never sees a port half updated, and the pins are not configured
+ * again after the message.
+ * 
  * INTEGRATION WITH GREENHOUSE SYSTEMS:
  * This function is called by various sensor modules:
  * - Temperature monitoring
@@ -83,4 +89,49 @@ void init_GPIOs_IOT();
  */
 void send_data(int,bool,int);
 
+/**
+ * @brief Transmits a sensor status together with the measured value
+ *
+ * Same as send_data, plus the reading the category was computed from.
+ * With the v1 link only the category is sent. When the firmware is built with
+ * IOT_LINK_V2 the lines carry nibble frames (see iot_frame.h) holding the
+ * reading and a timestamp, clocked by a STROBE/ACK handshake:
+ * - P2.3, P6.7, P3.5, P3.0: data nibble
+ * - P3.7: FRAME, LOW during a frame
+ * - P3.6: STROBE, toggled for every nibble
+ * - P5.7: ACK input, the receiver copies STROBE once it has read the nibble
+ *
+ * @param code Sensor type identifier (1-7), as in send_data
+ * @param active Sensor operational status, as in send_data
+ * @param value Measurement category (1-4), as in send_data
+ * @param reading The measured value (lux, celsius, ppm, adc counts, pump state)
+ */
+void send_reading(int code, bool active, int value, int32_t reading);
+
+#if defined(IOT_CYCLE_BENCHMARK) && !defined(IOT_LINK_V2)
+/**
+ * @brief Result of iot_benchmark, in MCLK cycles per send_data call
+ */
+typedef struct {
+    uint32_t legacy_cycles;  // one read-modify-write per pin plus init_GPIOs_IOT
+    uint32_t table_cycles;   // precomputed pin states, one write per port
+} IotBenchmark;
+
+/**
+ * @brief Times send_data against the previous per-pin implementation
+ *
+ * Uses Timer32 (module 1). The IoT lines toggle during the measurement, the
+ * receiver should be disconnected.
+ */
+void iot_benchmark(IotBenchmark * result);
+#endif
+
+#ifdef IOT_LINK_V2
+/**
+ * @brief Returns the number of frames aborted because the receiver did not
+ * acknowledge a nibble in time
+ */
+uint32_t iot_get_failed_frames();
+#endif
+
 #endif /* INCLUDE_IOT_IOT_COMMUNICATION_H_ */
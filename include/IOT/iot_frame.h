@@ -0,0 +1,108 @@
+/*
+ * iot_frame.h
+ *
+ * IOT LINK V2 FRAMES
+ * Byte format of the messages sent on the IoT GPIO lines when the firmware is
+ * built with IOT_LINK_V2. A frame carries the same sensor code, status and
+ * category of the v1 link, plus the real reading and the time it was taken:
+ *
+ *     header   1 byte   bits 0-2 sensor code, bit 3 active, bits 4-5 category - 1,
+ *                       bit 6 set if the reading takes 4 bytes instead of 2
+ *     reading  2/4 bytes little endian, signed
+ *     time     4 bytes  little endian, milliseconds since boot
+ *     crc      1 byte   CRC-8 (polynomial 0x07) of all the previous bytes
+ *
+ * Every byte goes out as two nibbles, high nibble first (see IOT_communication.h
+ * for the handshake). The decoder is the receiving side of the link and is used
+ * by the tests in place of the real IoT board.
+ * This module does not touch the hardware.
+ */
+
+#ifndef INCLUDE_IOT_IOT_FRAME_H_
+#define INCLUDE_IOT_IOT_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// longest encoded frame, in bytes
+#define IOT_FRAME_MAX_LEN 10
+
+/*
+    content of a frame
+    fields:
+    - code: sensor code (1-7, same as send_data)
+    - active: sensor status
+    - category: measurement category (1-4, same as send_data)
+    - reading: the measured value
+    - timestamp: milliseconds since boot when the value was read
+*/
+typedef struct {
+    uint8_t code;
+    bool active;
+    uint8_t category;
+    int32_t reading;
+    uint32_t timestamp;
+} IotFrame;
+
+/*
+    receiving side of the link
+    fields:
+    - buf: bytes received so far
+    - len: number of complete bytes in buf
+    - high: true when the high nibble of the next byte has been received
+    - overflow: more nibbles than the longest frame were received
+*/
+typedef struct {
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    uint8_t len;
+    bool high;
+    bool overflow;
+} IotDecoder;
+
+/*
+    CRC-8 with polynomial 0x07 and initial value 0
+*/
+uint8_t iot_frame_crc8(const uint8_t * data, uint8_t len);
+
+/*
+    encodes a frame
+    arguments:
+    - frame: the frame, the code is masked to 3 bits and a category out of
+      range becomes 4
+    - buf: destination, at least IOT_FRAME_MAX_LEN bytes
+    returns:
+    - the number of bytes written (8 or 10)
+*/
+uint8_t iot_frame_encode(const IotFrame * frame, uint8_t * buf);
+
+/*
+    decodes a complete frame
+    arguments:
+    - buf, len: the received bytes
+    - frame: filled with the content of the frame
+    returns:
+    - true if the frame is valid (length matching the header and correct crc)
+*/
+bool iot_frame_decode(const uint8_t * buf, uint8_t len, IotFrame * frame);
+
+/*
+    forgets the nibbles received so far, called when a frame starts
+*/
+void iot_decoder_reset(IotDecoder * decoder);
+
+/*
+    stores a nibble received from the data lines
+*/
+void iot_decoder_push(IotDecoder * decoder, uint8_t nibble);
+
+/*
+    called when the frame line goes back high
+    arguments:
+    - decoder: the decoder
+    - frame: filled with the content of the frame
+    returns:
+    - true if a valid frame was received
+*/
+bool iot_decoder_end(IotDecoder * decoder, IotFrame * frame);
+
+#endif /* INCLUDE_IOT_IOT_FRAME_H_ */
@@ -0,0 +1,134 @@
+/*
+ * iot_publish.h
+ *
+ * IOT PUBLICATION
+ * Filters the messages of the sensor modules before they reach the IoT link.
+ * The last state (active flag and category) sent for every sensor code is
+ * cached and a message goes out only when:
+ * - it is the first one for the code
+ * - the state differs from the cached one and the rate limit of the code has
+ *   expired since the last message (otherwise it stays pending and the
+ *   publication task sends the latest state as soon as the limit expires)
+ * - the heartbeat interval elapsed since the last message of the code, so the
+ *   receiver knows the board is alive
+ * The reading is carried along but does not count as a change: a sensor whose
+ * category is stable does not flood the link.
+ */
+
+#ifndef INCLUDE_IOT_IOT_PUBLISH_H_
+#define INCLUDE_IOT_IOT_PUBLISH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// sensor codes go from 1 to 7, index 0 is unused
+#define IOT_PUBLISH_CODES 8
+
+// default interval between two messages of an unchanged code in milliseconds, 0 disables it
+#define IOT_PUBLISH_HEARTBEAT_DEFAULT 30000
+// period of the publication task in milliseconds
+#define IOT_PUBLISH_TASK_PERIOD 500
+
+/*
+    cached state of a sensor code
+    fields:
+    - has_sent: false until the first message of the code goes out
+    - pending: the latest state differs from the sent one and waits for the rate limit
+    - sent_active, sent_value: state carried by the last message
+    - active, value, reading: latest state given by the sensor module
+    - last_sent: uptime of the last message in milliseconds
+    - rate_limit: minimum time between two messages of the code in milliseconds
+*/
+typedef struct {
+    bool has_sent;
+    bool pending;
+    bool sent_active;
+    uint8_t sent_value;
+    bool active;
+    uint8_t value;
+    int32_t reading;
+    uint32_t last_sent;
+    uint32_t rate_limit;
+} IotPublishEntry;
+
+/*
+    struct holding the state of the publication layer
+    fields:
+    - codes: one entry per sensor code
+    - heartbeat: interval of the heartbeat messages in milliseconds, 0 to disable them
+    - sent, suppressed: counters for debugging
+*/
+typedef struct {
+    IotPublishEntry codes[IOT_PUBLISH_CODES];
+    uint32_t heartbeat;
+    uint32_t sent;
+    uint32_t suppressed;
+} IotPublishState;
+
+/*
+    resets the cache and sets the default heartbeat and rate limits
+*/
+void iot_publish_state_init(IotPublishState * state);
+
+/*
+    changes the minimum time between two messages of a code
+*/
+void iot_publish_set_rate_limit(IotPublishState * state, uint8_t code, uint32_t rate_limit);
+
+/*
+    records the latest state of a sensor and decides whether it has to be sent now
+    arguments:
+    - state: the publication state
+    - code, active, value, reading: same as send_reading
+    - now: uptime in milliseconds
+    returns:
+    - true if the message has to be sent (then call iot_publish_mark_sent)
+    - false if the code is out of range, the state is unchanged or rate limited
+*/
+bool iot_publish_update(IotPublishState * state, uint8_t code, bool active, uint8_t value, int32_t reading, uint32_t now);
+
+/*
+    records that the latest state of code was sent at time now
+*/
+void iot_publish_mark_sent(IotPublishState * state, uint8_t code, uint32_t now);
+
+/*
+    finds a code whose pending change can go out or whose heartbeat is due
+    arguments:
+    - state: the publication state
+    - now: uptime in milliseconds
+    returns:
+    - the code, its latest state is in state->codes[code]
+    - 0 if nothing has to be sent
+*/
+uint8_t iot_publish_next_due(const IotPublishState * state, uint32_t now);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    initializes the publication state and pushes the publication task on the scheduler
+*/
+void iot_publish_init();
+
+/*
+    replaces send_reading in the sensor modules: the message is queued (see
+    iot_tx_queue.h) only if needed, the function never waits for the IoT pins
+*/
+void iot_publish(int code, bool active, int value, int32_t reading);
+
+/*
+    periodic task: sends the pending changes and the heartbeats
+*/
+void iot_publish_task();
+
+/*
+    changes the heartbeat interval, used by the option menu
+*/
+void update_iot_heartbeat(int32_t new_timer);
+
+/*
+    adds the heartbeat interval to the option menu
+*/
+void add_iot_publish_options();
+#endif
+
+#endif /* INCLUDE_IOT_IOT_PUBLISH_H_ */
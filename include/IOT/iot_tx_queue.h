@@ -0,0 +1,135 @@
+/*
+ * iot_tx_queue.h
+ *
+ * IOT TX QUEUE
+ * Messages waiting to be sent on the IoT pins. The sensor modules only push
+ * messages (through iot_publish) and return immediately; a periodic task sends
+ * a few of them per run, so a slow receiver never delays the sensor readings.
+ * A message for a sensor code that is already waiting replaces it in place,
+ * only the latest state of a sensor matters to the receiver.
+ * The queue keeps statistics on the time messages wait and on the messages
+ * refused because it was full.
+ */
+
+#ifndef INCLUDE_IOT_IOT_TX_QUEUE_H_
+#define INCLUDE_IOT_IOT_TX_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// number of messages that can wait, one per sensor code is enough in normal operation
+#define IOT_TX_QUEUE_LEN 8
+// messages sent by a single run of the task
+#define IOT_TX_BURST 2
+// period of the task in milliseconds
+#define IOT_TX_TASK_PERIOD 100
+
+/*
+    struct representing a waiting message
+    fields:
+    - code, active, value, reading: arguments of send_reading
+    - enqueued_at: uptime in milliseconds when the message was pushed
+*/
+typedef struct {
+    uint8_t code;
+    bool active;
+    uint8_t value;
+    int32_t reading;
+    uint32_t enqueued_at;
+} IotTxMessage;
+
+/*
+    statistics of the queue
+    fields:
+    - enqueued: messages accepted
+    - coalesced: messages that replaced a waiting one with the same code
+    - overflows: messages refused because the queue was full
+    - sent: messages handed to the IoT pins
+    - max_pending: highest number of messages waiting at the same time
+    - max_latency: longest wait between push and send in milliseconds
+    - total_latency: sum of the waits of the sent messages, for the average
+*/
+typedef struct {
+    uint32_t enqueued;
+    uint32_t coalesced;
+    uint32_t overflows;
+    uint32_t sent;
+    uint8_t max_pending;
+    uint32_t max_latency;
+    uint32_t total_latency;
+} IotTxStats;
+
+/*
+    circular buffer of waiting messages
+    fields:
+    - msgs: the messages
+    - head: index of the oldest message
+    - count: number of waiting messages
+    - stats: the statistics
+*/
+typedef struct {
+    IotTxMessage msgs[IOT_TX_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+    IotTxStats stats;
+} IotTxQueue;
+
+void iot_tx_queue_init(IotTxQueue * queue);
+
+/*
+    adds a message, or updates the waiting message with the same code
+    arguments:
+    - queue: the queue
+    - code, active, value, reading: the message
+    - now: uptime in milliseconds
+    returns:
+    - false if the queue is full
+*/
+bool iot_tx_queue_push(IotTxQueue * queue, uint8_t code, bool active, uint8_t value, int32_t reading, uint32_t now);
+
+/*
+    removes the oldest message
+    arguments:
+    - queue: the queue
+    - msg: filled with the message
+    returns:
+    - false if the queue is empty
+*/
+bool iot_tx_queue_pop(IotTxQueue * queue, IotTxMessage * msg);
+
+/*
+    records that a popped message was sent at time now
+*/
+void iot_tx_queue_mark_sent(IotTxQueue * queue, const IotTxMessage * msg, uint32_t now);
+
+/*
+    returns the average wait of the sent messages in milliseconds
+*/
+uint32_t iot_tx_queue_average_latency(const IotTxQueue * queue);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    initializes the queue and pushes the sending task on the scheduler,
+    must be called before the first iot_tx_send
+*/
+void iot_tx_init();
+
+/*
+    queues a message for the IoT pins, can be called from interrupt context
+    returns:
+    - false if the queue is full
+*/
+bool iot_tx_send(uint8_t code, bool active, uint8_t value, int32_t reading);
+
+/*
+    periodic task: sends up to IOT_TX_BURST messages
+*/
+void iot_tx_task();
+
+/*
+    returns the statistics of the queue
+*/
+const IotTxStats * iot_tx_get_stats();
+#endif
+
+#endif /* INCLUDE_IOT_IOT_TX_QUEUE_H_ */
@@ -40,6 +40,10 @@
 #include "Crystalfontz128x128_ST7735.h"
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#include "lcd_dirty_region.h"
+#include "lcd_scene.h"
+#include "lcd_glyph_cache.h"
+#include "clock/clock_profile.h"
 #include <stdint.h>
 
 uint8_t Lcd_Orientation;
@@ -47,6 +51,105 @@ uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
 uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
 uint16_t Lcd_TouchTrim;
 
+//
+// Retained copy of the screen as palette-indexed spans (see lcd_scene.h). The
+// drawing functions only write in Lcd_Scene and mark the area they touched;
+// Crystalfontz128x128_Flush compares the touched rows with Lcd_Shown, the
+// content of the panel, and sends only the pixels that differ.
+//
+static LcdScene Lcd_Scene, Lcd_Shown;
+static const LcdScene * const Lcd_Scenes[2] = { &Lcd_Scene, &Lcd_Shown };
+static LcdPalette Lcd_Palette;
+static LcdDirtyRegion Lcd_Dirty;
+// set when the panel content is unknown (orientation change): every touched row is sent whole
+static bool Lcd_ResendAll;
+
+//
+// Pixel rows being sent by the DMA, two so the next row can be prepared
+// while the previous one is still going out.
+//
+static uint16_t Lcd_Line[2][LCD_HORIZONTAL_MAX];
+static uint8_t Lcd_LineSel;
+
+//
+// Bounding box of the pixels changed by the current drawing call.
+//
+static int16_t Lcd_ChgX0, Lcd_ChgY0, Lcd_ChgX1, Lcd_ChgY1;
+
+//
+// Run of same colored pixels not yet written in the scene: consecutive pixels
+// of a drawing call become a single span.
+//
+static int16_t Lcd_RunX0, Lcd_RunX1 = -1, Lcd_RunY;
+static uint16_t Lcd_RunColor;
+
+static void Crystalfontz128x128_ChangeBegin(void)
+{
+    Lcd_ChgX0 = LCD_HORIZONTAL_MAX;
+    Lcd_ChgY0 = LCD_VERTICAL_MAX;
+    Lcd_ChgX1 = -1;
+    Lcd_ChgY1 = -1;
+}
+
+static void Crystalfontz128x128_RunEnd(void)
+{
+    if (Lcd_RunX1 < 0)
+    {
+        return;
+    }
+    uint8_t color = lcd_palette_index(&Lcd_Palette, Lcd_RunColor, Lcd_Scenes, 2);
+    lcd_scene_fill(&Lcd_Scene, Lcd_RunY, Lcd_RunX0, Lcd_RunX1, color);
+
+    if (Lcd_RunX0 < Lcd_ChgX0) Lcd_ChgX0 = Lcd_RunX0;
+    if (Lcd_RunX1 > Lcd_ChgX1) Lcd_ChgX1 = Lcd_RunX1;
+    if (Lcd_RunY < Lcd_ChgY0) Lcd_ChgY0 = Lcd_RunY;
+    if (Lcd_RunY > Lcd_ChgY1) Lcd_ChgY1 = Lcd_RunY;
+    Lcd_RunX1 = -1;
+}
+
+static void Crystalfontz128x128_SetRun(int16_t lX0, int16_t lX1, int16_t lY, uint16_t ulValue)
+{
+    Crystalfontz128x128_RunEnd();
+    Lcd_RunX0 = lX0;
+    Lcd_RunX1 = lX1;
+    Lcd_RunY = lY;
+    Lcd_RunColor = ulValue;
+}
+
+static inline void Crystalfontz128x128_SetPixel(int16_t lX, int16_t lY, uint16_t ulValue)
+{
+    if (Lcd_RunX1 >= 0 && lY == Lcd_RunY && lX == Lcd_RunX1 + 1 &&
+        ulValue == Lcd_RunColor)
+    {
+        Lcd_RunX1++;
+        return;
+    }
+    Crystalfontz128x128_SetRun(lX, lX, lY, ulValue);
+}
+
+static void Crystalfontz128x128_ChangeEnd(void)
+{
+    Crystalfontz128x128_RunEnd();
+    if (Lcd_ChgX1 >= 0)
+    {
+        lcd_dirty_add(&Lcd_Dirty, Lcd_ChgX0, Lcd_ChgY0, Lcd_ChgX1, Lcd_ChgY1);
+    }
+}
+
+//
+// Keeps the SPI clock right across clock profile switches: the transfer in
+// progress is finished at the old speed, then the divider is recomputed.
+//
+static void Crystalfontz128x128_ClockChanged(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz)
+{
+    if (change == CLOCK_CHANGE_BEFORE)
+    {
+        HAL_LCD_waitIdle();
+        return;
+    }
+    HAL_LCD_SpiInit();
+}
+
 //*****************************************************************************
 //
 //! Initializes the display driver.
@@ -61,6 +164,8 @@ void Crystalfontz128x128_Init(void)
 {
     HAL_LCD_PortInit();
     HAL_LCD_SpiInit();
+    HAL_LCD_DmaInit();
+    clock_profile_register(Crystalfontz128x128_ClockChanged);
 
     GPIO_setOutputLowOnPin(LCD_RST_PORT, LCD_RST_PIN);
     HAL_LCD_delay(50);
@@ -99,12 +204,15 @@ void Crystalfontz128x128_Init(void)
 
     Crystalfontz128x128_SetDrawFrame(0, 0, 127, 127);
     HAL_LCD_writeCommand(CM_RAMWR);
-    int i;
-    for (i = 0; i < 16384; i++)
-    {
-        HAL_LCD_writeData(0xFF);
-        HAL_LCD_writeData(0xFF);
-    }
+    HAL_LCD_fillPixelsDma(0xFFFF, 16384);
+
+    // the scenes start equal to the panel, filled while the DMA runs
+    lcd_palette_init(&Lcd_Palette);
+    uint8_t white = lcd_palette_index(&Lcd_Palette, 0xFFFF, Lcd_Scenes, 2);
+    lcd_scene_init(&Lcd_Scene, white);
+    lcd_scene_init(&Lcd_Shown, white);
+    lcd_dirty_init(&Lcd_Dirty, LCD_HORIZONTAL_MAX, LCD_VERTICAL_MAX);
+    Lcd_ResendAll = false;
 
     HAL_LCD_delay(10);
     HAL_LCD_writeCommand(CM_DISPON);
@@ -189,6 +297,120 @@ void Crystalfontz128x128_SetOrientation(uint8_t orientation)
             HAL_LCD_writeData(CM_MADCTL_MX | CM_MADCTL_MV | CM_MADCTL_BGR);
             break;
     }
+
+    //
+    // The panel memory is now read in a different order, resend everything.
+    //
+    Lcd_ResendAll = true;
+    lcd_dirty_add(&Lcd_Dirty, 0, 0, LCD_HORIZONTAL_MAX - 1, LCD_VERTICAL_MAX - 1);
+}
+
+
+//*****************************************************************************
+//
+//! Draws a string with opaque background using the glyph cache.
+//!
+//! \param context is the graphics context, giving font, colors and clipping.
+//! \param string is the string to draw.
+//! \param length is the number of characters to draw, or -1 to draw up to the
+//! terminating NUL.
+//! \param x is the X coordinate of the left edge of the string.
+//! \param y is the Y coordinate of the top of the string.
+//!
+//! Equivalent to Graphics_drawString with OPAQUE_TEXT, but the glyphs are
+//! copied already rasterised in the scene (their 1 bit masks are expanded to
+//! the foreground and background colors of the context), one row of the whole line at a time
+//! so the background between the characters becomes a single span; the line
+//! is sent on the next flush with one address window per changed pixel row.
+//! Fonts not supported by the cache are drawn through grlib.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_DrawString(const Graphics_Context *context,
+                                    const int8_t *string, int32_t length,
+                                    int32_t x, int32_t y)
+{
+    const Graphics_Rectangle *pClip = &context->clipRegion;
+    int32_t lX, lY, row, col, i, count;
+
+    if (!lcd_glyph_font_supported(context->font))
+    {
+        Graphics_drawString((Graphics_Context *)context, (int8_t *)string,
+                            length, x, y, OPAQUE_TEXT);
+        return;
+    }
+    if (y > pClip->sYMax || y + LCD_GLYPH_HEIGHT <= pClip->sYMin)
+    {
+        return;
+    }
+
+    count = 0;
+    while (count != length && string[count])
+    {
+        count++;
+    }
+
+    Crystalfontz128x128_ChangeBegin();
+    for (row = 0; row < LCD_GLYPH_HEIGHT; row++)
+    {
+        lY = y + row;
+        if (lY < pClip->sYMin || lY > pClip->sYMax)
+        {
+            continue;
+        }
+        for (i = 0, lX = x; i < count && lX <= pClip->sXMax; i++, lX += LCD_GLYPH_WIDTH)
+        {
+            if (lX + LCD_GLYPH_WIDTH <= pClip->sXMin)
+            {
+                continue;
+            }
+            uint8_t mask = lcd_glyph_get(context, (uint8_t)string[i])[row];
+            for (col = 0; col < LCD_GLYPH_WIDTH; col++)
+            {
+                if (lX + col >= pClip->sXMin && lX + col <= pClip->sXMax)
+                {
+                    Crystalfontz128x128_SetPixel(lX + col, lY,
+                                                 (mask & LCD_GLYPH_BIT(col)) ?
+                                                 context->foreground :
+                                                 context->background);
+                }
+            }
+        }
+    }
+    Crystalfontz128x128_ChangeEnd();
+}
+
+
+//*****************************************************************************
+//
+//! Draws a string centered on a point using the glyph cache.
+//!
+//! Same arguments and placement as Graphics_drawStringCentered with
+//! OPAQUE_TEXT, see Crystalfontz128x128_DrawString.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_DrawStringCentered(const Graphics_Context *context,
+                                            const int8_t *string, int32_t length,
+                                            int32_t x, int32_t y)
+{
+    if (!lcd_glyph_font_supported(context->font))
+    {
+        Graphics_drawStringCentered((Graphics_Context *)context, (int8_t *)string,
+                                    length, x, y, OPAQUE_TEXT);
+        return;
+    }
+
+    int32_t count = 0;
+    while (count != length && string[count])
+    {
+        count++;
+    }
+    Crystalfontz128x128_DrawString(context, string, count,
+                                   x - (count * LCD_GLYPH_WIDTH) / 2,
+                                   y - context->font->baseline / 2);
 }
 
 
@@ -213,15 +435,12 @@ static void Crystalfontz128x128_PixelDraw(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
-
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX,lY);
-
     //
-    // Write the pixel value.
+    // Only the scene is written, the pixel is sent on the next flush.
     //
-    HAL_LCD_writeCommand(CM_RAMWR);
-    HAL_LCD_writeData(ulValue>>8);
-    HAL_LCD_writeData(ulValue);
+    Crystalfontz128x128_ChangeBegin();
+    Crystalfontz128x128_SetRun(lX, lX, lY, ulValue);
+    Crystalfontz128x128_ChangeEnd();
 }
 
 
@@ -261,11 +480,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
 {
     uint16_t Data;
 
-    //
-    // Set the cursor increment to left to right, followed by top to bottom.
-    //
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX+lCount,127);
-    HAL_LCD_writeCommand(CM_RAMWR);
+    Crystalfontz128x128_ChangeBegin();
 
     //
     // Determine how to interpret the pixel data based on the number of bits
@@ -286,10 +501,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 for(; (lX0 < 8) && lCount; lX0++, lCount--)
                 {
                     // Draw this pixel in the appropriate color
-                    HAL_LCD_writeData((((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1])>>8);
-                    HAL_LCD_writeData(((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1]);
+                    Crystalfontz128x128_SetPixel(lX++, lY,
+                        ((uint32_t *)pucPalette)[(Data >> (7 - lX0)) & 1]);
                 }
 
                 // Start at the beginning of the next byte of image data
@@ -320,9 +533,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                         // and extract the corresponding entry from the palette
                         Data = (*pucData >> 4);
                         Data = (*(uint16_t *)(pucPalette + Data));
-                        // Write to LCD screen
-                        HAL_LCD_writeData(Data>>8);
-                        HAL_LCD_writeData(Data);
+                        Crystalfontz128x128_SetPixel(lX++, lY, Data);
 
                         // Decrement the count of pixels to draw
                         lCount--;
@@ -336,9 +547,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                             // the palette
                             Data = (*pucData++ & 15);
                             Data = (*(uint16_t *)(pucPalette + Data));
-                            // Write to LCD screen
-                            HAL_LCD_writeData(Data>>8);
-                            HAL_LCD_writeData(Data);
+                            Crystalfontz128x128_SetPixel(lX++, lY, Data);
 
                             // Decrement the count of pixels to draw
                             lCount--;
@@ -360,9 +569,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 // corresponding entry from the palette
                 Data = *pucData++;
                 Data = (*(uint16_t *)(pucPalette + Data));
-                // Write to LCD screen
-                HAL_LCD_writeData(Data>>8);
-                HAL_LCD_writeData(Data);
+                Crystalfontz128x128_SetPixel(lX++, lY, Data);
             }
             // The image data has been drawn
             break;
@@ -387,12 +594,12 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 usData = *((uint16_t *)pucData);
                 pucData += 2;
 
-                // Translate this palette entry and write it to the screen
-                HAL_LCD_writeData(usData>>8);
-                HAL_LCD_writeData(usData);
+                Crystalfontz128x128_SetPixel(lX++, lY, usData);
             }
         }
     }
+
+    Crystalfontz128x128_ChangeEnd();
 }
 
 
@@ -419,20 +626,12 @@ static void Crystalfontz128x128_LineDrawH(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
-
-
-    Crystalfontz128x128_SetDrawFrame(lX1, lY, lX2, lY);
-
     //
     // Write the pixel value.
     //
-    int16_t i;
-    HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = lX1; i <= lX2; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    Crystalfontz128x128_ChangeBegin();
+    Crystalfontz128x128_SetRun(lX1, lX2, lY, ulValue);
+    Crystalfontz128x128_ChangeEnd();
 }
 
 
@@ -459,18 +658,16 @@ static void Crystalfontz128x128_LineDrawV(const Graphics_Display *pDisplay,
                                           int16_t lY2,
                                           uint16_t ulValue)
 {
-    Crystalfontz128x128_SetDrawFrame(lX, lY1, lX, lY2);
-
     //
     // Write the pixel value.
     //
     int16_t i;
-    HAL_LCD_writeCommand(CM_RAMWR);
+    Crystalfontz128x128_ChangeBegin();
     for (i = lY1; i <= lY2; i++)
     {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
+        Crystalfontz128x128_SetPixel(lX, i, ulValue);
     }
+    Crystalfontz128x128_ChangeEnd();
 }
 
 
@@ -500,19 +697,16 @@ static void Crystalfontz128x128_RectFill(const Graphics_Display *pDisplay,
     int16_t y0 = pRect->sYMin;
     int16_t y1 = pRect->sYMax;
 
-    Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
-
     //
     // Write the pixel value.
     //
-    int16_t i;
-    int16_t pixels = (x1 - x0 + 1) * (y1 - y0 + 1);
-    HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = 0; i <= pixels; i++)
+    int16_t y;
+    Crystalfontz128x128_ChangeBegin();
+    for (y = y0; y <= y1; y++)
     {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
+        Crystalfontz128x128_SetRun(x0, x1, y, ulValue);
     }
+    Crystalfontz128x128_ChangeEnd();
 }
 
 //*****************************************************************************
@@ -551,10 +745,14 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 //! \param pDisplay is a pointer to the driver-specific data for this
 //! display driver.
 //!
-//! This functions flushes any cached drawing operations to the display.  This
-//! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! This functions flushes any cached drawing operations to the display.  Every
+//! pixel row touched since the last flush is compared with the content of the
+//! panel and only the range of pixels that differs is sent, with one address
+//! window and one DMA transfer (a constant fill when the range has a single
+//! color).  Must be called (through Graphics_flushBuffer) after drawing for
+//! the changes to become visible.
+//!
+//! The function returns while the last row is still being sent.
 //!
 //! \return None.
 //
@@ -562,9 +760,72 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 static void
 Crystalfontz128x128_Flush(const Graphics_Display *pDisplay)
 {
+    uint32_t rowMask[LCD_VERTICAL_MAX / 32] = { 0 };
+    uint8_t indices[LCD_HORIZONTAL_MAX];
+    uint8_t i, first, last, x;
+    uint16_t y;
+
     //
-    // There is nothing to be done.
+    // Rows covered by at least one dirty rectangle.
     //
+    for (i = 0; i < Lcd_Dirty.count; i++)
+    {
+        for (y = Lcd_Dirty.rects[i].y0; y <= Lcd_Dirty.rects[i].y1; y++)
+        {
+            rowMask[y / 32] |= 1UL << (y % 32);
+        }
+    }
+
+    for (y = 0; y < LCD_VERTICAL_MAX; y++)
+    {
+        if (!(rowMask[y / 32] & (1UL << (y % 32))))
+        {
+            continue;
+        }
+        if (Lcd_ResendAll)
+        {
+            first = 0;
+            last = LCD_HORIZONTAL_MAX - 1;
+        }
+        else if (!lcd_scene_row_diff(&Lcd_Scene, &Lcd_Shown, y, &first, &last))
+        {
+            continue;
+        }
+
+        lcd_scene_row_indices(&Lcd_Scene, y, indices);
+        for (x = first; x < last && indices[x] == indices[last]; x++)
+        {
+        }
+
+        if (x == last)
+        {
+            Crystalfontz128x128_SetDrawFrame(first, y, last, y);
+            HAL_LCD_writeCommand(CM_RAMWR);
+            HAL_LCD_fillPixelsDma(Lcd_Palette.colors[indices[first]], last - first + 1);
+        }
+        else
+        {
+            //
+            // The row is converted while the DMA is still sending the
+            // previous one from the other line buffer.
+            //
+            uint16_t *pLine = Lcd_Line[Lcd_LineSel];
+            Lcd_LineSel ^= 1;
+            for (x = first; x <= last; x++)
+            {
+                pLine[x] = LCD_PANEL_ORDER(Lcd_Palette.colors[indices[x]]);
+            }
+            // waits for the previous row before moving the address window
+            Crystalfontz128x128_SetDrawFrame(first, y, last, y);
+            HAL_LCD_writeCommand(CM_RAMWR);
+            HAL_LCD_writePixelsDma((const uint8_t *)&pLine[first],
+                                   (last - first + 1) * 2, 0, 1);
+        }
+        lcd_scene_copy_row(&Lcd_Shown, &Lcd_Scene, y);
+    }
+
+    Lcd_ResendAll = false;
+    lcd_dirty_clear(&Lcd_Dirty);
 }
 
 
@@ -48,6 +48,9 @@
 #define LCD_VERTICAL_MAX                   128
 #define LCD_HORIZONTAL_MAX                 128
 
+// Swaps a 5-6-5 color to the byte order the panel expects (MSB first)
+#define LCD_PANEL_ORDER(c)    ((uint16_t)(((c) >> 8) | ((c) << 8)))
+
 #define LCD_ORIENTATION_UP    0
 #define LCD_ORIENTATION_LEFT  1
 #define LCD_ORIENTATION_DOWN  2
@@ -107,6 +110,14 @@ extern void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t
 
 extern void Crystalfontz128x128_SetOrientation(uint8_t orientation);
 
+extern void Crystalfontz128x128_DrawString(const Graphics_Context *context,
+                                           const int8_t *string, int32_t length,
+                                           int32_t x, int32_t y);
+
+extern void Crystalfontz128x128_DrawStringCentered(const Graphics_Context *context,
+                                                   const int8_t *string, int32_t length,
+                                                   int32_t x, int32_t y);
+
 
 
 #endif /* __CRYSTALFONTZLCD_H__ */
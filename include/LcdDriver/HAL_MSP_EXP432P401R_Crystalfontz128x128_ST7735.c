@@ -61,7 +61,7 @@ void HAL_LCD_SpiInit(void)
     eUSCI_SPI_MasterConfig config =
         {
             EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
-            LCD_SYSTEM_CLOCK_SPEED,
+            CS_getSMCLK(),
             LCD_SPI_CLOCK_SPEED,
             EUSCI_B_SPI_MSB_FIRST,
             EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT,
@@ -77,6 +77,127 @@ void HAL_LCD_SpiInit(void)
 }
 
 
+//
+// DMA control table, the controller requires it to be aligned to its size.
+//
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(Lcd_DmaControlTable, 1024)
+static DMA_ControlTable Lcd_DmaControlTable[32];
+#elif defined(__IAR_SYSTEMS_ICC__)
+#pragma data_alignment=1024
+static DMA_ControlTable Lcd_DmaControlTable[32];
+#else
+static DMA_ControlTable Lcd_DmaControlTable[32] __attribute__((aligned(1024)));
+#endif
+
+//
+// State of the transfer in progress. A transfer is a number of rows of
+// rowBytes bytes, stride bytes apart in memory; every row is sent in chunks of
+// at most LCD_DMA_MAX_CHUNK bytes, the next chunk is started from the DMA
+// interrupt. Fills send the same bytes over and over instead.
+//
+static struct
+{
+    const uint8_t *row;
+    const uint8_t *src;
+    uint32_t left;
+    uint16_t rowBytes;
+    uint16_t stride;
+    uint16_t rowsLeft;
+    bool fill;
+    bool constant;
+    volatile bool busy;
+} Lcd_Dma;
+
+static uint8_t Lcd_DmaPattern[LCD_DMA_PATTERN_SIZE];
+
+void HAL_LCD_DmaInit(void)
+{
+    DMA_enableModule();
+    DMA_setControlBase(Lcd_DmaControlTable);
+    DMA_assignChannel(LCD_DMA_CHANNEL);
+    DMA_disableChannelAttribute(LCD_DMA_CHANNEL,
+                                UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST |
+                                UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+
+    DMA_assignInterrupt(LCD_DMA_INT, LCD_DMA_CHANNEL_NUM);
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL_NUM);
+    Interrupt_enableInterrupt(LCD_DMA_INT_NUM);
+
+    Lcd_Dma.busy = false;
+}
+
+//
+// Starts the next chunk of the current transfer. The eUSCI requests a byte as
+// long as its transmit buffer is empty, so the chunk starts as soon as the
+// channel is enabled.
+//
+static void HAL_LCD_dmaStartChunk(void)
+{
+    uint32_t len = Lcd_Dma.left;
+    uint32_t max = LCD_DMA_MAX_CHUNK;
+    uint32_t srcInc = UDMA_SRC_INC_8;
+
+    if (Lcd_Dma.fill && Lcd_Dma.constant)
+    {
+        srcInc = UDMA_SRC_INC_NONE;
+    }
+    else if (Lcd_Dma.fill)
+    {
+        max = LCD_DMA_PATTERN_SIZE;
+    }
+    if (len > max)
+    {
+        len = max;
+    }
+
+    DMA_setChannelControl(UDMA_PRI_SELECT | LCD_DMA_CHANNEL,
+                          UDMA_SIZE_8 | srcInc | UDMA_DST_INC_NONE | UDMA_ARB_1);
+    DMA_setChannelTransfer(UDMA_PRI_SELECT | LCD_DMA_CHANNEL, UDMA_MODE_BASIC,
+                           (void *)Lcd_Dma.src,
+                           (void *)SPI_getTransmitBufferAddressForDMA(LCD_EUSCI_BASE),
+                           len);
+    if (!Lcd_Dma.fill)
+    {
+        Lcd_Dma.src += len;
+    }
+    Lcd_Dma.left -= len;
+    DMA_enableChannel(LCD_DMA_CHANNEL_NUM);
+}
+
+//
+// Continues the current transfer once the last chunk is done. Called from the
+// DMA interrupt and, with interrupts masked, from HAL_LCD_waitIdle.
+//
+static void HAL_LCD_dmaNext(void)
+{
+    if (!Lcd_Dma.busy || DMA_isChannelEnabled(LCD_DMA_CHANNEL_NUM))
+    {
+        return;
+    }
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL_NUM);
+
+    if (Lcd_Dma.left == 0)
+    {
+        if (Lcd_Dma.rowsLeft == 0)
+        {
+            Lcd_Dma.busy = false;
+            return;
+        }
+        Lcd_Dma.rowsLeft--;
+        Lcd_Dma.row += Lcd_Dma.stride;
+        Lcd_Dma.src = Lcd_Dma.row;
+        Lcd_Dma.left = Lcd_Dma.rowBytes;
+    }
+    HAL_LCD_dmaStartChunk();
+}
+
+void DMA_INT1_IRQHandler(void)
+{
+    HAL_LCD_dmaNext();
+}
+
+
 //*****************************************************************************
 //
 // Writes a command to the CFAF128128B-0145T.  This function implements the basic SPI
@@ -85,6 +206,9 @@ void HAL_LCD_SpiInit(void)
 //*****************************************************************************
 void HAL_LCD_writeCommand(uint8_t command)
 {
+    // Pixel data still going out must not be sent as a command
+    HAL_LCD_waitIdle();
+
     // Set to command mode
     GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
 
@@ -111,7 +235,7 @@ void HAL_LCD_writeCommand(uint8_t command)
 void HAL_LCD_writeData(uint8_t data)
 {
     // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
+    HAL_LCD_waitIdle();
 
     // Transmit data
     UCB0TXBUF = data;
@@ -120,6 +244,117 @@ void HAL_LCD_writeData(uint8_t data)
     while (UCB0STATW & UCBUSY);
 }
 
+
+//*****************************************************************************
+//
+// Sends a block of pixel data to the CFAF128128B-0145T through the DMA
+// controller and returns immediately.  The data is made of rows of rowBytes
+// bytes, stride bytes apart, already in panel byte order (MSB of each pixel
+// first).  It must stay untouched until HAL_LCD_isBusy returns false; any
+// other write to the LCD waits for the transfer to finish.
+//
+//*****************************************************************************
+void HAL_LCD_writePixelsDma(const uint8_t *data, uint16_t rowBytes,
+                            uint16_t stride, uint16_t rows)
+{
+    if (rowBytes == 0 || rows == 0)
+    {
+        return;
+    }
+    HAL_LCD_waitIdle();
+
+    Lcd_Dma.row = data;
+    Lcd_Dma.src = data;
+    Lcd_Dma.left = rowBytes;
+    Lcd_Dma.rowBytes = rowBytes;
+    Lcd_Dma.stride = stride;
+    Lcd_Dma.rowsLeft = rows - 1;
+    Lcd_Dma.fill = false;
+    Lcd_Dma.busy = true;
+    HAL_LCD_dmaStartChunk();
+}
+
+
+//*****************************************************************************
+//
+// Sends count pixels of the same color to the CFAF128128B-0145T through the
+// DMA controller and returns immediately.  When both bytes of the color are
+// equal (black, white) the DMA reads a single byte over and over, otherwise it
+// repeats a small buffer filled with the color.
+//
+//*****************************************************************************
+void HAL_LCD_fillPixelsDma(uint16_t color, uint32_t count)
+{
+    uint8_t high = color >> 8;
+    uint8_t low = color;
+    uint16_t i;
+
+    if (count == 0)
+    {
+        return;
+    }
+    HAL_LCD_waitIdle();
+
+    Lcd_Dma.constant = (high == low);
+    if (Lcd_Dma.constant)
+    {
+        Lcd_DmaPattern[0] = high;
+    }
+    else
+    {
+        for (i = 0; i < LCD_DMA_PATTERN_SIZE; i += 2)
+        {
+            Lcd_DmaPattern[i] = high;
+            Lcd_DmaPattern[i + 1] = low;
+        }
+    }
+
+    Lcd_Dma.src = Lcd_DmaPattern;
+    Lcd_Dma.left = count * 2;
+    Lcd_Dma.rowsLeft = 0;
+    Lcd_Dma.fill = true;
+    Lcd_Dma.busy = true;
+    HAL_LCD_dmaStartChunk();
+}
+
+
+//*****************************************************************************
+//
+// Returns true while a DMA transfer to the CFAF128128B-0145T is in progress.
+//
+//*****************************************************************************
+bool HAL_LCD_isBusy(void)
+{
+    return Lcd_Dma.busy;
+}
+
+
+//*****************************************************************************
+//
+// Waits until the DMA transfer in progress is over and the last byte written
+// to the CFAF128128B-0145T has left the shift register.
+//
+//*****************************************************************************
+void HAL_LCD_waitIdle(void)
+{
+    while (Lcd_Dma.busy)
+    {
+        //
+        // Keeps the transfer going if it is called with interrupts masked,
+        // otherwise the DMA interrupt does it.
+        //
+        bool was_disabled = Interrupt_disableMaster();
+        HAL_LCD_dmaNext();
+        if (!was_disabled)
+        {
+            Interrupt_enableMaster();
+        }
+    }
+
+    // USCI_B0 Busy? //
+    while (UCB0STATW & UCBUSY);
+}
+
 //*****************************************************************************
 //
 //! Provides a small delay.
@@ -42,6 +42,7 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 //*****************************************************************************
 //
@@ -49,10 +50,9 @@
 //
 //*****************************************************************************
 
-// System clock speed (in Hz)
-#define LCD_SYSTEM_CLOCK_SPEED                 48000000
-// SPI clock speed (in Hz)
-#define LCD_SPI_CLOCK_SPEED                    16000000
+// SPI clock speed (in Hz), the eUSCI divides the current SMCLK down to it
+// (the ST7735 accepts up to 15 MHz)
+#define LCD_SPI_CLOCK_SPEED                    12000000
 
 // Ports from MSP432 connected to LCD
 #define LCD_SCK_PORT          GPIO_PORT_P1
@@ -73,6 +73,17 @@
 // Definition of USCI base address to be used for SPI communication
 #define LCD_EUSCI_BASE        EUSCI_B0_BASE
 
+// DMA channel triggered by the transmit buffer of LCD_EUSCI_BASE
+#define LCD_DMA_CHANNEL       DMA_CH0_EUSCIB0TX0
+#define LCD_DMA_CHANNEL_NUM   0
+// DMA interrupt line used to chain the chunks of a transfer
+#define LCD_DMA_INT           DMA_INT1
+#define LCD_DMA_INT_NUM       INT_DMA_INT1
+// Largest number of bytes moved by a single DMA transfer (hardware limit)
+#define LCD_DMA_MAX_CHUNK     1024
+// Size in bytes of the repeated color used by fills of a two-byte color
+#define LCD_DMA_PATTERN_SIZE  256
+
 //*****************************************************************************
 //
 // Prototypes for the globals exported by this driver.
@@ -80,8 +91,14 @@
 //*****************************************************************************
 extern void HAL_LCD_writeCommand(uint8_t command);
 extern void HAL_LCD_writeData(uint8_t data);
+extern void HAL_LCD_writePixelsDma(const uint8_t *data, uint16_t rowBytes,
+                                   uint16_t stride, uint16_t rows);
+extern void HAL_LCD_fillPixelsDma(uint16_t color, uint32_t count);
+extern bool HAL_LCD_isBusy(void);
+extern void HAL_LCD_waitIdle(void);
 extern void HAL_LCD_PortInit(void);
 extern void HAL_LCD_SpiInit(void);
+extern void HAL_LCD_DmaInit(void);
 
 // Custom __delay_cycles() for non CCS Compiler
 #if !defined( __TI_ARM__ )
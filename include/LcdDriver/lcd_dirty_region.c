@@ -0,0 +1,131 @@
+/*
+ * lcd_dirty_region.c
+ *
+ * Tracking and merging of the changed screen areas.
+ */
+
+#include "lcd_dirty_region.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+void lcd_dirty_init(LcdDirtyRegion * region, int16_t width, int16_t height){
+    region->count = 0;
+    region->width = width;
+    region->height = height;
+}
+
+void lcd_dirty_clear(LcdDirtyRegion * region){
+    region->count = 0;
+}
+
+uint32_t lcd_rect_area(const LcdRect * rect){
+    return (uint32_t)(rect->x1 - rect->x0 + 1) * (uint32_t)(rect->y1 - rect->y0 + 1);
+}
+
+uint32_t lcd_dirty_area(const LcdDirtyRegion * region){
+    uint32_t area = 0;
+    uint8_t i;
+    for(i = 0; i < region->count; i++){
+        area += lcd_rect_area(&region->rects[i]);
+    }
+    return area;
+}
+
+static LcdRect rect_union(const LcdRect * a, const LcdRect * b){
+    LcdRect ret = {
+        MIN(a->x0, b->x0),
+        MIN(a->y0, b->y0),
+        MAX(a->x1, b->x1),
+        MAX(a->y1, b->y1)
+    };
+    return ret;
+}
+
+static bool rect_contains(const LcdRect * outer, const LcdRect * inner){
+    return outer->x0 <= inner->x0 && outer->y0 <= inner->y0 &&
+           outer->x1 >= inner->x1 && outer->y1 >= inner->y1;
+}
+
+// pixels shared by the two rectangles
+static uint32_t rect_overlap(const LcdRect * a, const LcdRect * b){
+    int16_t x0 = MAX(a->x0, b->x0);
+    int16_t y0 = MAX(a->y0, b->y0);
+    int16_t x1 = MIN(a->x1, b->x1);
+    int16_t y1 = MIN(a->y1, b->y1);
+    if(x0 > x1 || y0 > y1){
+        return 0;
+    }
+    return (uint32_t)(x1 - x0 + 1) * (uint32_t)(y1 - y0 + 1);
+}
+
+/*
+    pixels that would be sent without having changed if the two rectangles were merged,
+    minus the window setup that the merge saves.
+    a value <= 0 means merging is not worse than keeping them apart
+*/
+static int32_t merge_cost(const LcdRect * a, const LcdRect * b){
+    LcdRect u = rect_union(a, b);
+    int32_t wasted = (int32_t)lcd_rect_area(&u)
+                   - (int32_t)(lcd_rect_area(a) + lcd_rect_area(b) - rect_overlap(a, b));
+    return wasted - LCD_DIRTY_WINDOW_COST;
+}
+
+static void remove_at(LcdDirtyRegion * region, uint8_t index){
+    region->rects[index] = region->rects[region->count - 1];
+    region->count--;
+}
+
+void lcd_dirty_add(LcdDirtyRegion * region, int16_t x0, int16_t y0, int16_t x1, int16_t y1){
+    // normalize and clip
+    LcdRect rect = {MIN(x0, x1), MIN(y0, y1), MAX(x0, x1), MAX(y0, y1)};
+    if(rect.x1 < 0 || rect.y1 < 0 || rect.x0 >= region->width || rect.y0 >= region->height){
+        return;
+    }
+    rect.x0 = MAX(rect.x0, 0);
+    rect.y0 = MAX(rect.y0, 0);
+    rect.x1 = MIN(rect.x1, region->width - 1);
+    rect.y1 = MIN(rect.y1, region->height - 1);
+
+    uint8_t i;
+    // most pixel writes fall inside an area already marked
+    for(i = 0; i < region->count; i++){
+        if(rect_contains(&region->rects[i], &rect)){
+            return;
+        }
+    }
+
+    // absorb every rectangle it overlaps or is cheap to merge with, the grown rectangle may reach new ones
+    bool merged = true;
+    while(merged){
+        merged = false;
+        for(i = 0; i < region->count; i++){
+            if(rect_overlap(&rect, &region->rects[i]) > 0 || merge_cost(&rect, &region->rects[i]) <= 0){
+                rect = rect_union(&rect, &region->rects[i]);
+                remove_at(region, i);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if(region->count == LCD_DIRTY_MAX_RECTS){
+        // no room left: merge with the rectangle that wastes the fewest pixels
+        uint8_t best = 0;
+        int32_t best_cost = merge_cost(&rect, &region->rects[0]);
+        for(i = 1; i < region->count; i++){
+            int32_t cost = merge_cost(&rect, &region->rects[i]);
+            if(cost < best_cost){
+                best_cost = cost;
+                best = i;
+            }
+        }
+        rect = rect_union(&rect, &region->rects[best]);
+        remove_at(region, best);
+        // the bigger rectangle might now overlap others
+        lcd_dirty_add(region, rect.x0, rect.y0, rect.x1, rect.y1);
+        return;
+    }
+
+    region->rects[region->count++] = rect;
+}
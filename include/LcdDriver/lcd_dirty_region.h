@@ -0,0 +1,67 @@
+/*
+ * lcd_dirty_region.h
+ *
+ * DIRTY REGION TRACKER
+ * Keeps the list of the screen areas that changed since the last flush.
+ * Rectangles that overlap, touch, or are close enough that sending them together
+ * costs less than opening a second address window are merged, so a flush sends
+ * few large bursts instead of many small ones.
+ * This module does not touch the hardware, the LCD driver owns one tracker.
+ */
+
+#ifndef INCLUDE_LCDDRIVER_LCD_DIRTY_REGION_H_
+#define INCLUDE_LCDDRIVER_LCD_DIRTY_REGION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of separate rectangles kept before they are forced together
+#define LCD_DIRTY_MAX_RECTS 6
+// cost of opening an address window (CASET + RASET + RAMWR), in pixels worth of SPI bytes
+#define LCD_DIRTY_WINDOW_COST 6
+
+/*
+    inclusive rectangle, same convention as Graphics_Rectangle
+*/
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+} LcdRect;
+
+/*
+    struct representing the tracker
+    fields:
+    - rects: the dirty rectangles, never overlapping each other
+    - count: number of valid rectangles
+    - width, height: size of the screen, used for clipping
+*/
+typedef struct {
+    LcdRect rects[LCD_DIRTY_MAX_RECTS];
+    uint8_t count;
+    int16_t width;
+    int16_t height;
+} LcdDirtyRegion;
+
+// initializes an empty tracker for a screen of the given size
+void lcd_dirty_init(LcdDirtyRegion * region, int16_t width, int16_t height);
+
+/*
+    marks an area as changed, merging it with the tracked ones when convenient
+    arguments:
+    - region: the tracker
+    - x0, y0, x1, y1: inclusive corners, clipped to the screen
+*/
+void lcd_dirty_add(LcdDirtyRegion * region, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+// forgets every rectangle, to be called after a flush
+void lcd_dirty_clear(LcdDirtyRegion * region);
+
+// number of pixels covered by the tracked rectangles
+uint32_t lcd_dirty_area(const LcdDirtyRegion * region);
+
+// area of an inclusive rectangle
+uint32_t lcd_rect_area(const LcdRect * rect);
+
+#endif /* INCLUDE_LCDDRIVER_LCD_DIRTY_REGION_H_ */
@@ -0,0 +1,209 @@
+/*
+ * lcd_glyph_cache.c
+ *
+ * Glyph cache for the fixed 6x8 font, see lcd_glyph_cache.h
+ */
+
+#include "lcd_glyph_cache.h"
+#include "Crystalfontz128x128_ST7735.h"
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/grlib/grlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// one mask per glyph row, see LCD_GLYPH_BIT
+static uint8_t glyph_rows[LCD_GLYPH_COUNT][LCD_GLYPH_HEIGHT];
+// one bit per cached character
+static uint32_t glyph_valid[(LCD_GLYPH_COUNT + 31) / 32];
+// font the cached glyphs were rasterised with
+static const Graphics_Font * glyph_font;
+
+/*
+    capture display: grlib draws the glyph on a display as big as a cell, with
+    the foreground set to 1 and the background to 0, the callbacks below store
+    the pixels as bits in capture_cell
+*/
+static uint8_t * capture_cell;
+
+static void capture_put(int16_t x, int16_t y, uint16_t value){
+    if(x >= 0 && x < LCD_GLYPH_WIDTH && y >= 0 && y < LCD_GLYPH_HEIGHT){
+        if(value){
+            capture_cell[y] |= LCD_GLYPH_BIT(x);
+        }else{
+            capture_cell[y] &= ~LCD_GLYPH_BIT(x);
+        }
+    }
+}
+
+static void capture_pixel_draw(const Graphics_Display * display, int16_t x, int16_t y, uint16_t value){
+    capture_put(x, y, value);
+}
+
+// text is drawn with 1 bit per pixel data and a palette made of the context colours
+static void capture_pixel_draw_multiple(const Graphics_Display * display, int16_t x, int16_t y,
+                                        int16_t x0, int16_t count, int16_t bpp,
+                                        const uint8_t * data, const uint32_t * palette){
+    if(bpp != 1){
+        return;
+    }
+    while(count--){
+        capture_put(x++, y, palette[(*data >> (7 - x0)) & 1]);
+        if(++x0 == 8){
+            x0 = 0;
+            data++;
+        }
+    }
+}
+
+static void capture_line_draw_h(const Graphics_Display * display, int16_t x1, int16_t x2, int16_t y, uint16_t value){
+    while(x1 <= x2){
+        capture_put(x1++, y, value);
+    }
+}
+
+static void capture_line_draw_v(const Graphics_Display * display, int16_t x, int16_t y1, int16_t y2, uint16_t value){
+    while(y1 <= y2){
+        capture_put(x, y1++, value);
+    }
+}
+
+static void capture_rect_fill(const Graphics_Display * display, const Graphics_Rectangle * rect, uint16_t value){
+    int16_t y;
+    for(y = rect->sYMin; y <= rect->sYMax; y++){
+        capture_line_draw_h(display, rect->sXMin, rect->sXMax, y, value);
+    }
+}
+
+static uint32_t capture_color_translate(const Graphics_Display * display, uint32_t value){
+    return g_sCrystalfontz128x128_funcs.pfnColorTranslate(display, value);
+}
+
+static void capture_flush(const Graphics_Display * display){
+}
+
+static void capture_clear(const Graphics_Display * display, uint16_t value){
+    Graphics_Rectangle rect = {0, 0, LCD_GLYPH_WIDTH - 1, LCD_GLYPH_HEIGHT - 1};
+    capture_rect_fill(display, &rect, value);
+}
+
+static Graphics_Display capture_display = {
+    sizeof(Graphics_Display),
+    0,
+    LCD_GLYPH_WIDTH,
+    LCD_GLYPH_HEIGHT,
+};
+
+static const Graphics_Display_Functions capture_funcs = {
+    capture_pixel_draw,
+    capture_pixel_draw_multiple,
+    capture_line_draw_h,
+    capture_line_draw_v,
+    capture_rect_fill,
+    capture_color_translate,
+    capture_flush,
+    capture_clear
+};
+
+static Graphics_Context capture_context;
+
+static void glyph_rasterise(const Graphics_Context * context, uint8_t index){
+    int8_t ch = LCD_GLYPH_FIRST + index;
+
+    Graphics_initContext(&capture_context, &capture_display, &capture_funcs);
+    GrContextFontSet(&capture_context, context->font);
+    // the colours are only told apart, they are applied when the glyph is copied
+    capture_context.foreground = 1;
+    capture_context.background = 0;
+
+    capture_cell = glyph_rows[index];
+    capture_clear(&capture_display, 0);
+    Graphics_drawString(&capture_context, &ch, 1, 0, 0, OPAQUE_TEXT);
+}
+
+bool lcd_glyph_font_supported(const Graphics_Font * font){
+    return font == &g_sFontFixed6x8;
+}
+
+void lcd_glyph_invalidate(void){
+    uint8_t i;
+    for(i = 0; i < sizeof(glyph_valid) / sizeof(glyph_valid[0]); i++){
+        glyph_valid[i] = 0;
+    }
+}
+
+const uint8_t * lcd_glyph_get(const Graphics_Context * context, uint8_t ch){
+    if(!lcd_glyph_font_supported(context->font)){
+        return NULL;
+    }
+    if(context->font != glyph_font){
+        lcd_glyph_invalidate();
+        glyph_font = context->font;
+    }
+
+    if(ch < LCD_GLYPH_FIRST || ch >= LCD_GLYPH_FIRST + LCD_GLYPH_COUNT){
+        ch = ' ';
+    }
+    uint8_t index = ch - LCD_GLYPH_FIRST;
+    if(!(glyph_valid[index / 32] & (1UL << (index % 32)))){
+        glyph_rasterise(context, index);
+        glyph_valid[index / 32] |= 1UL << (index % 32);
+    }
+    return glyph_rows[index];
+}
+
+#ifdef LCD_GLYPH_BENCHMARK
+#define BENCHMARK_ROUNDS 8
+#define BENCHMARK_LINE_LEN 21
+
+static const int8_t * const benchmark_lines[2] = {
+    (const int8_t *)"ABCDEFGHIJKLMNOPQRSTU",
+    (const int8_t *)"vwxyz0123456789<>=+-*"
+};
+
+// draws BENCHMARK_ROUNDS screens of text and returns the elapsed Timer32 ticks
+static uint32_t benchmark_run(Graphics_Context * context, bool use_cache){
+    uint8_t round, line;
+
+    Graphics_clearDisplay(context);
+    Graphics_flushBuffer(context);
+
+    Timer32_setCount(TIMER32_1_BASE, UINT32_MAX);
+    uint32_t start = Timer32_getValue(TIMER32_1_BASE);
+    for(round = 0; round < BENCHMARK_ROUNDS; round++){
+        for(line = 0; line < LCD_VERTICAL_MAX / LCD_GLYPH_HEIGHT; line++){
+            int8_t * text = (int8_t *)benchmark_lines[(round + line) & 1];
+            if(use_cache){
+                Crystalfontz128x128_DrawString(context, text, BENCHMARK_LINE_LEN, 0, line * LCD_GLYPH_HEIGHT);
+            }else{
+                Graphics_drawString(context, text, BENCHMARK_LINE_LEN, 0, line * LCD_GLYPH_HEIGHT, OPAQUE_TEXT);
+            }
+        }
+        Graphics_flushBuffer(context);
+    }
+    // the timer counts down
+    return start - Timer32_getValue(TIMER32_1_BASE);
+}
+
+void lcd_glyph_benchmark(Graphics_Context * context, LcdGlyphBenchmark * result){
+    uint8_t i;
+
+    Timer32_initModule(TIMER32_1_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT, TIMER32_FREE_RUN_MODE);
+    Timer32_startTimer(TIMER32_1_BASE, false);
+
+    // rasterise the glyphs before timing, only the steady state is measured
+    for(i = 0; i < 2; i++){
+        Crystalfontz128x128_DrawString(context, (int8_t *)benchmark_lines[i], BENCHMARK_LINE_LEN, 0, 0);
+    }
+
+    uint64_t clock = CS_getMCLK();
+    result->chars = (uint32_t)BENCHMARK_ROUNDS * (LCD_VERTICAL_MAX / LCD_GLYPH_HEIGHT) * BENCHMARK_LINE_LEN;
+    uint32_t grlib_ticks = benchmark_run(context, false);
+    uint32_t cache_ticks = benchmark_run(context, true);
+    result->grlib_cps = grlib_ticks ? (uint32_t)(result->chars * clock / grlib_ticks) : 0;
+    result->cache_cps = cache_ticks ? (uint32_t)(result->chars * clock / cache_ticks) : 0;
+
+    Timer32_haltTimer(TIMER32_1_BASE);
+    Graphics_clearDisplay(context);
+    Graphics_flushBuffer(context);
+}
+#endif
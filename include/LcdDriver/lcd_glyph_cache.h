@@ -0,0 +1,76 @@
+/*
+ * lcd_glyph_cache.h
+ *
+ * GLYPH CACHE
+ * Keeps the characters of the fixed 6x8 font already rasterised as 1 bit per
+ * pixel masks (768 bytes for the whole font), so text can be copied in the
+ * scene row by row instead of going through grlib one pixel at a time; the
+ * masks are expanded to the colours of the context while copying them.
+ * Glyphs are rasterised by grlib itself the first time they are used (drawing
+ * them on a small capture display), the cache is emptied when the font of the
+ * context changes.
+ */
+
+#ifndef INCLUDE_LCDDRIVER_LCD_GLYPH_CACHE_H_
+#define INCLUDE_LCDDRIVER_LCD_GLYPH_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/grlib/grlib.h>
+
+// size of a cached glyph, the cell of g_sFontFixed6x8
+#define LCD_GLYPH_WIDTH 6
+#define LCD_GLYPH_HEIGHT 8
+// characters covered by grlib fonts (' ' to 0x7F)
+#define LCD_GLYPH_FIRST ' '
+#define LCD_GLYPH_COUNT 96
+// bit of a glyph row mask giving the pixel in column x, set for the foreground
+#define LCD_GLYPH_BIT(x) (1U << (LCD_GLYPH_WIDTH - 1 - (x)))
+
+/*
+    returns true if the font can be drawn through the cache
+    (only the fixed width 6x8 font is supported)
+*/
+bool lcd_glyph_font_supported(const Graphics_Font * font);
+
+/*
+    returns the glyph of a character, rasterising it if needed
+    arguments:
+    - context: graphics context giving the font
+    - ch: the character, characters out of the font are drawn as spaces
+    returns:
+    - LCD_GLYPH_HEIGHT row masks, see LCD_GLYPH_BIT
+    - NULL if the font of the context is not supported
+*/
+const uint8_t * lcd_glyph_get(const Graphics_Context * context, uint8_t ch);
+
+/*
+    empties the cache
+*/
+void lcd_glyph_invalidate(void);
+
+#ifdef LCD_GLYPH_BENCHMARK
+/*
+    struct with the result of lcd_glyph_benchmark
+    fields:
+    - chars: number of characters drawn by each path
+    - grlib_cps: characters per second drawing through Graphics_drawString
+    - cache_cps: characters per second drawing through the glyph cache
+*/
+typedef struct {
+    uint32_t chars;
+    uint32_t grlib_cps;
+    uint32_t cache_cps;
+} LcdGlyphBenchmark;
+
+/*
+    draws the same lines of text through grlib and through the cache, timing
+    both with Timer32 (module 1), and leaves the screen cleared
+    arguments:
+    - context: graphics context of the LCD, with g_sFontFixed6x8 selected
+    - result: where the measured rates are written
+*/
+void lcd_glyph_benchmark(Graphics_Context * context, LcdGlyphBenchmark * result);
+#endif
+
+#endif /* INCLUDE_LCDDRIVER_LCD_GLYPH_CACHE_H_ */
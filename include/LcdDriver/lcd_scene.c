@@ -0,0 +1,260 @@
+/*
+ * lcd_scene.c
+ *
+ * Run-length scene buffer for the 128x128 panel, see lcd_scene.h
+ */
+
+#include "lcd_scene.h"
+#include <string.h>
+
+static uint8_t packed_get(const LcdSceneRow * row, uint8_t x){
+    uint8_t byte = row->data.pixels[x >> 1];
+    return (x & 1) ? (byte >> 4) : (byte & 0x0F);
+}
+
+static void packed_set(LcdSceneRow * row, uint8_t x, uint8_t color){
+    uint8_t * byte = &row->data.pixels[x >> 1];
+    if(x & 1){
+        *byte = (*byte & 0x0F) | (color << 4);
+    }else{
+        *byte = (*byte & 0xF0) | (color & 0x0F);
+    }
+}
+
+static void row_indices(const LcdSceneRow * row, uint8_t * out){
+    uint16_t x = 0;
+    uint8_t i;
+    if(row->packed){
+        for(x = 0; x < LCD_SCENE_WIDTH; x++){
+            out[x] = packed_get(row, x);
+        }
+        return;
+    }
+    for(i = 0; i < row->count; i++){
+        while(x <= row->data.spans[i].end){
+            out[x++] = row->data.spans[i].color;
+        }
+    }
+}
+
+static void row_set_uniform(LcdSceneRow * row, uint8_t color){
+    row->packed = false;
+    row->count = 1;
+    row->data.spans[0].end = LCD_SCENE_WIDTH - 1;
+    row->data.spans[0].color = color;
+}
+
+// appends a span, extending the previous one if it has the same color
+static void spans_append(LcdSpan * spans, uint8_t * count, uint8_t end, uint8_t color){
+    if(*count > 0 && spans[*count - 1].color == color){
+        spans[*count - 1].end = end;
+        return;
+    }
+    spans[*count].end = end;
+    spans[*count].color = color;
+    (*count)++;
+}
+
+void lcd_scene_init(LcdScene * scene, uint8_t color){
+    uint16_t y;
+    for(y = 0; y < LCD_SCENE_HEIGHT; y++){
+        row_set_uniform(&scene->rows[y], color);
+    }
+}
+
+void lcd_scene_fill(LcdScene * scene, uint8_t y, uint8_t x0, uint8_t x1, uint8_t color){
+    LcdSceneRow * row = &scene->rows[y];
+    uint16_t x;
+
+    if(x0 == 0 && x1 == LCD_SCENE_WIDTH - 1){
+        row_set_uniform(row, color);
+        return;
+    }
+    if(row->packed){
+        for(x = x0; x <= x1; x++){
+            packed_set(row, x, color);
+        }
+        return;
+    }
+
+    // rebuild the span list: what is left of the old spans before x0, the new span, what is left after x1
+    LcdSpan spans[LCD_SCENE_ROW_SPANS + 2];
+    uint8_t count = 0;
+    uint8_t start = 0;
+    uint8_t i;
+    for(i = 0; i < row->count; i++){
+        const LcdSpan * span = &row->data.spans[i];
+        if(span->end < x0){
+            spans_append(spans, &count, span->end, span->color);
+        }else if(start < x0){
+            spans_append(spans, &count, x0 - 1, span->color);
+        }
+        if(span->end >= x0){
+            break;
+        }
+        start = span->end + 1;
+    }
+    spans_append(spans, &count, x1, color);
+    for(; i < row->count; i++){
+        if(row->data.spans[i].end > x1){
+            spans_append(spans, &count, row->data.spans[i].end, row->data.spans[i].color);
+        }
+    }
+
+    if(count <= LCD_SCENE_ROW_SPANS){
+        memcpy(row->data.spans, spans, count * sizeof(LcdSpan));
+        row->count = count;
+        return;
+    }
+
+    // too many color changes for the spans: switch the row to 4 bit indices
+    uint8_t indices[LCD_SCENE_WIDTH];
+    row_indices(row, indices);
+    row->packed = true;
+    row->count = 0;
+    for(x = 0; x < LCD_SCENE_WIDTH; x++){
+        packed_set(row, x, (x >= x0 && x <= x1) ? color : indices[x]);
+    }
+}
+
+uint8_t lcd_scene_get(const LcdScene * scene, uint8_t y, uint8_t x){
+    const LcdSceneRow * row = &scene->rows[y];
+    uint8_t i;
+    if(row->packed){
+        return packed_get(row, x);
+    }
+    for(i = 0; i < row->count - 1; i++){
+        if(row->data.spans[i].end >= x){
+            break;
+        }
+    }
+    return row->data.spans[i].color;
+}
+
+void lcd_scene_row_indices(const LcdScene * scene, uint8_t y, uint8_t * out){
+    row_indices(&scene->rows[y], out);
+}
+
+bool lcd_scene_row_diff(const LcdScene * a, const LcdScene * b, uint8_t y, uint8_t * first, uint8_t * last){
+    const LcdSceneRow * row_a = &a->rows[y];
+    const LcdSceneRow * row_b = &b->rows[y];
+
+    // same spans: nothing to decode
+    if(!row_a->packed && !row_b->packed && row_a->count == row_b->count &&
+       memcmp(row_a->data.spans, row_b->data.spans, row_a->count * sizeof(LcdSpan)) == 0){
+        return false;
+    }
+
+    uint8_t pixels_a[LCD_SCENE_WIDTH];
+    uint8_t pixels_b[LCD_SCENE_WIDTH];
+    row_indices(row_a, pixels_a);
+    row_indices(row_b, pixels_b);
+
+    int16_t lo = 0;
+    int16_t hi = LCD_SCENE_WIDTH - 1;
+    while(lo <= hi && pixels_a[lo] == pixels_b[lo]){
+        lo++;
+    }
+    if(lo > hi){
+        return false;
+    }
+    while(pixels_a[hi] == pixels_b[hi]){
+        hi--;
+    }
+    *first = lo;
+    *last = hi;
+    return true;
+}
+
+void lcd_scene_copy_row(LcdScene * dst, const LcdScene * src, uint8_t y){
+    const LcdSceneRow * from = &src->rows[y];
+    LcdSceneRow * to = &dst->rows[y];
+    to->packed = from->packed;
+    to->count = from->count;
+    if(from->packed){
+        memcpy(to->data.pixels, from->data.pixels, LCD_SCENE_ROW_BYTES);
+    }else{
+        memcpy(to->data.spans, from->data.spans, from->count * sizeof(LcdSpan));
+    }
+}
+
+uint8_t lcd_scene_row_spans(const LcdScene * scene, uint8_t y){
+    const LcdSceneRow * row = &scene->rows[y];
+    return row->packed ? 0 : row->count;
+}
+
+void lcd_palette_init(LcdPalette * palette){
+    palette->count = 0;
+    palette->last = 0;
+}
+
+static uint16_t used_indices(const LcdScene * const * scenes, uint8_t scene_count){
+    uint16_t used = 0;
+    uint8_t s, i;
+    uint16_t y, x;
+    for(s = 0; s < scene_count; s++){
+        for(y = 0; y < LCD_SCENE_HEIGHT; y++){
+            const LcdSceneRow * row = &scenes[s]->rows[y];
+            if(row->packed){
+                for(x = 0; x < LCD_SCENE_WIDTH; x++){
+                    used |= 1 << packed_get(row, x);
+                }
+            }else{
+                for(i = 0; i < row->count; i++){
+                    used |= 1 << row->data.spans[i].color;
+                }
+            }
+        }
+    }
+    return used;
+}
+
+// squared distance between two RGB565 colors
+static uint32_t color_distance(uint16_t a, uint16_t b){
+    int32_t dr = (int32_t)(a >> 11) - (b >> 11);
+    int32_t dg = (int32_t)((a >> 5) & 0x3F) - ((b >> 5) & 0x3F);
+    int32_t db = (int32_t)(a & 0x1F) - (b & 0x1F);
+    // green has one bit more than red and blue
+    return 4 * dr * dr + dg * dg + 4 * db * db;
+}
+
+uint8_t lcd_palette_index(LcdPalette * palette, uint16_t color,
+                          const LcdScene * const * scenes, uint8_t scene_count){
+    uint8_t i;
+    if(palette->count > 0 && palette->colors[palette->last] == color){
+        return palette->last;
+    }
+    for(i = 0; i < palette->count; i++){
+        if(palette->colors[i] == color){
+            palette->last = i;
+            return i;
+        }
+    }
+    if(palette->count < LCD_SCENE_PALETTE_SIZE){
+        palette->colors[palette->count] = color;
+        palette->last = palette->count;
+        return palette->count++;
+    }
+
+    // palette full: reuse an index no scene refers to anymore
+    uint16_t used = used_indices(scenes, scene_count);
+    for(i = 0; i < LCD_SCENE_PALETTE_SIZE; i++){
+        if(!(used & (1 << i))){
+            palette->colors[i] = color;
+            palette->last = i;
+            return i;
+        }
+    }
+
+    // every color is on the screen: use the closest one
+    uint8_t best = 0;
+    uint32_t best_distance = UINT32_MAX;
+    for(i = 0; i < LCD_SCENE_PALETTE_SIZE; i++){
+        uint32_t distance = color_distance(palette->colors[i], color);
+        if(distance < best_distance){
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,133 @@
+/*
+ * lcd_scene.h
+ *
+ * SCENE BUFFER
+ * Compact copy of the screen content: every row is a list of run-length spans
+ * of palette indices (a uniform row costs 2 bytes). Rows with too many color
+ * changes to fit in LCD_SCENE_ROW_SPANS spans (lines of text, bitmaps) switch
+ * to 4 bit palette indices, so a row never takes more than LCD_SCENE_ROW_BYTES
+ * bytes and a whole screen fits in about 8 KB instead of the 32 KB of an RGB565
+ * frame buffer.
+ * The LCD driver keeps two scenes, the one being drawn and the one shown by the
+ * panel, and only sends the pixels of the rows that differ between them.
+ * This module does not touch the hardware.
+ */
+
+#ifndef INCLUDE_LCDDRIVER_LCD_SCENE_H_
+#define INCLUDE_LCDDRIVER_LCD_SCENE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LCD_SCENE_WIDTH 128
+#define LCD_SCENE_HEIGHT 128
+// 4 bit palette indices
+#define LCD_SCENE_PALETTE_SIZE 16
+// storage of a row: LCD_SCENE_WIDTH pixels of 4 bits, or LCD_SCENE_ROW_SPANS spans
+#define LCD_SCENE_ROW_BYTES (LCD_SCENE_WIDTH / 2)
+#define LCD_SCENE_ROW_SPANS (LCD_SCENE_ROW_BYTES / 2)
+
+/*
+    run of pixels of the same color
+    fields:
+    - end: x of the last pixel of the run, the run starts after the previous one
+    - color: palette index
+*/
+typedef struct {
+    uint8_t end;
+    uint8_t color;
+} LcdSpan;
+
+/*
+    struct representing a row
+    fields:
+    - packed: true if the row is stored as 4 bit indices (even x in the low nibble)
+    - count: number of spans when not packed
+    - spans / pixels: the content
+*/
+typedef struct {
+    bool packed;
+    uint8_t count;
+    union {
+        LcdSpan spans[LCD_SCENE_ROW_SPANS];
+        uint8_t pixels[LCD_SCENE_ROW_BYTES];
+    } data;
+} LcdSceneRow;
+
+typedef struct {
+    LcdSceneRow rows[LCD_SCENE_HEIGHT];
+} LcdScene;
+
+/*
+    RGB565 colors referenced by the indices of the scenes
+    fields:
+    - colors: the colors, only the first count are valid
+    - count: number of colors
+    - last: index returned by the last lookup, checked first
+*/
+typedef struct {
+    uint16_t colors[LCD_SCENE_PALETTE_SIZE];
+    uint8_t count;
+    uint8_t last;
+} LcdPalette;
+
+/*
+    fills the whole scene with one palette index
+*/
+void lcd_scene_init(LcdScene * scene, uint8_t color);
+
+/*
+    sets the pixels x0..x1 (inclusive, already clipped) of row y to a palette index
+*/
+void lcd_scene_fill(LcdScene * scene, uint8_t y, uint8_t x0, uint8_t x1, uint8_t color);
+
+/*
+    returns the palette index of a pixel
+*/
+uint8_t lcd_scene_get(const LcdScene * scene, uint8_t y, uint8_t x);
+
+/*
+    writes the palette index of every pixel of row y in out (LCD_SCENE_WIDTH bytes)
+*/
+void lcd_scene_row_indices(const LcdScene * scene, uint8_t y, uint8_t * out);
+
+/*
+    compares row y of two scenes
+    arguments:
+    - a, b: the scenes
+    - y: the row
+    - first, last: set to the first and last x that differ
+    returns:
+    - true if the rows differ
+*/
+bool lcd_scene_row_diff(const LcdScene * a, const LcdScene * b, uint8_t y, uint8_t * first, uint8_t * last);
+
+/*
+    copies row y of src in dst
+*/
+void lcd_scene_copy_row(LcdScene * dst, const LcdScene * src, uint8_t y);
+
+/*
+    returns the number of spans of row y, or 0 if the row is packed
+*/
+uint8_t lcd_scene_row_spans(const LcdScene * scene, uint8_t y);
+
+/*
+    empties the palette
+*/
+void lcd_palette_init(LcdPalette * palette);
+
+/*
+    returns the palette index of a color, adding it if needed
+    arguments:
+    - palette: the palette
+    - color: RGB565 color
+    - scenes, scene_count: every scene using the palette; when the palette is
+      full the indices none of them uses anymore are given to new colors
+    returns:
+    - the index of the color, or of the closest color if the palette is full
+*/
+uint8_t lcd_palette_index(LcdPalette * palette, uint16_t color,
+                          const LcdScene * const * scenes, uint8_t scene_count);
+
+#endif /* INCLUDE_LCDDRIVER_LCD_SCENE_H_ */
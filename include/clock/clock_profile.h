@@ -0,0 +1,147 @@
+/*
+ * clock_profile.h
+ *
+ * CLOCK PROFILES
+ * The board runs in one of three clock profiles:
+ *
+ *     profile       MCLK     SMCLK    VCORE   flash wait states
+ *     LOW_POWER     3 MHz    3 MHz    0       0
+ *     NOMINAL       12 MHz   12 MHz   0       0
+ *     PERFORMANCE   48 MHz   24 MHz   1       1
+ *
+ * (SMCLK cannot go above 24 MHz, so it is MCLK / 2 in the performance profile.)
+ * The board boots in LOW_POWER and can switch profile at any time, for example
+ * to burst at 48 MHz for display or calibration work and go back to idling at
+ * 3 MHz. The core voltage and the flash wait states are raised before the
+ * clocks when the frequency goes up and lowered after them when it goes down.
+ *
+ * Every peripheral driver whose dividers depend on SMCLK registers a listener;
+ * listeners are called with interrupts disabled twice per switch: before it,
+ * to let the last byte out of their shift registers, and after it, to
+ * recompute their dividers from the new clocks.
+ */
+
+#ifndef INCLUDE_CLOCK_CLOCK_PROFILE_H_
+#define INCLUDE_CLOCK_CLOCK_PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of registered listeners
+#define CLOCK_PROFILE_MAX_LISTENERS 8
+// Timer_A PWM modules divide SMCLK down to this tick, so their periods do not depend on the profile
+#define CLOCK_PROFILE_TIMER_TICK_HZ 3000000
+// maximum number of steps of a profile switch
+#define CLOCK_PROFILE_MAX_STEPS 3
+
+typedef enum {
+    CLOCK_PROFILE_LOW_POWER,
+    CLOCK_PROFILE_NOMINAL,
+    CLOCK_PROFILE_PERFORMANCE,
+    CLOCK_PROFILE_COUNT
+} ClockProfile;
+
+/*
+    struct describing a profile
+    fields:
+    - name: printable name
+    - mclk_hz: CPU clock (DCO)
+    - smclk_hz: peripheral clock
+    - smclk_divider: SMCLK = MCLK / smclk_divider
+    - vcore: core voltage level (0 or 1)
+    - wait_states: flash wait states of both banks
+*/
+typedef struct {
+    const char * name;
+    uint32_t mclk_hz;
+    uint32_t smclk_hz;
+    uint8_t smclk_divider;
+    uint8_t vcore;
+    uint8_t wait_states;
+} ClockProfileDesc;
+
+/*
+    steps of a profile switch, see clock_profile_plan
+*/
+typedef enum {
+    CLOCK_STEP_VCORE,
+    CLOCK_STEP_WAIT_STATES,
+    CLOCK_STEP_CLOCKS
+} ClockStep;
+
+typedef enum {
+    CLOCK_CHANGE_BEFORE,
+    CLOCK_CHANGE_AFTER
+} ClockChange;
+
+/*
+    listener of the profile switches
+    arguments:
+    - change: CLOCK_CHANGE_BEFORE (clocks not changed yet) or CLOCK_CHANGE_AFTER
+    - mclk_hz, smclk_hz: the clocks of the new profile
+*/
+typedef void (*ClockListener)(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz);
+
+/*
+    returns the description of a profile, NULL if it does not exist
+*/
+const ClockProfileDesc * clock_profile_desc(ClockProfile profile);
+
+/*
+    computes the order in which a switch must change the hardware
+    arguments:
+    - from, to: the current and the new profile
+    - steps: filled with the steps, at least CLOCK_PROFILE_MAX_STEPS elements
+    returns:
+    - the number of steps, 0 if nothing changes
+*/
+uint8_t clock_profile_plan(ClockProfile from, ClockProfile to, ClockStep * steps);
+
+/*
+    returns the Timer_A input divider (1, 2, 4 or 8) bringing smclk_hz to
+    CLOCK_PROFILE_TIMER_TICK_HZ, or as close as possible without going below it
+*/
+uint8_t clock_profile_timer_divider(uint32_t smclk_hz);
+
+/*
+    forgets every listener and marks LOW_POWER as the current profile
+    (the hardware is only configured by clock_profile_init)
+*/
+void clock_profile_state_init();
+
+/*
+    registers a listener
+    returns:
+    - false if CLOCK_PROFILE_MAX_LISTENERS listeners are already registered
+*/
+bool clock_profile_register(ClockListener listener);
+
+/*
+    returns the current profile
+*/
+ClockProfile clock_profile_get();
+
+/*
+    switches to a profile and notifies the listeners, does nothing if it is already the current one
+    returns:
+    - the previous profile, so a burst can restore it
+*/
+ClockProfile clock_profile_set(ClockProfile profile);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    forgets every listener and configures the core voltage, the flash and the clocks
+    for the LOW_POWER profile, must be called before any peripheral is initialized
+*/
+void clock_profile_init();
+
+/*
+    sets the input divider of a Timer_A module running from SMCLK to clock_profile_timer_divider(smclk_hz)
+    arguments:
+    - timer: base address of the module (TIMER_A1_BASE...)
+    - smclk_hz: current SMCLK
+*/
+void clock_profile_retime_timer_a(uint32_t timer, uint32_t smclk_hz);
+#endif
+
+#endif /* INCLUDE_CLOCK_CLOCK_PROFILE_H_ */
@@ -0,0 +1,86 @@
+/*
+ * dashboard.h
+ *
+ * SENSOR DASHBOARD
+ * Shows the live greenhouse values on the LCD, one widget per line:
+ *
+ *     Light  : <lux> lx
+ *     Lamp   : ON/OFF
+ *     Temp   : <celsius> C
+ *     Air    : <ppm> ppm
+ *     Tank   : <adc>
+ *     Reserv.: <adc>
+ *     Pump 1 : ON/OFF
+ *     Pump 2 : ON/OFF
+ *     Buzzer : ON/OFF
+ *
+ * The labels are drawn once; the dashboard registers an observer callback and
+ * only the value field of a widget whose value changed is redrawn by the
+ * refresh task, so the SPI traffic is limited to the changed characters.
+ * Enabled with the SCREEN_DASHBOARD build flag (the option menu then stays on UART).
+ */
+
+#ifndef INCLUDE_DASHBOARD_DASHBOARD_H_
+#define INCLUDE_DASHBOARD_DASHBOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "observer/observer.h"
+
+// first text row of the widgets (rows are 8 pixels high)
+#define DASHBOARD_FIRST_ROW 2
+// column where the value fields start and their length, in characters
+#define DASHBOARD_FIELD_COL 9
+#define DASHBOARD_FIELD_LEN 12
+// default period of the refresh task in milliseconds
+#define DASHBOARD_REFRESH_DEFAULT 250
+
+/*
+    resets the pending widgets, must be called before registering dashboard_on_change
+*/
+void dashboard_state_init();
+
+/*
+    observer callback: marks the widget of id as needing a redraw
+*/
+void dashboard_on_change(ObservedValue id, int32_t value, uint64_t time);
+
+/*
+    returns the bitmask of the widgets to redraw (bit i is ObservedValue i) and clears it
+*/
+uint32_t dashboard_take_pending();
+
+/*
+    returns the label of the widget of id, already padded to DASHBOARD_FIELD_COL characters
+*/
+const char * dashboard_label(ObservedValue id);
+
+/*
+    writes the value field of a widget, padded with spaces to DASHBOARD_FIELD_LEN characters
+    arguments:
+    - id: the widget
+    - value: the value to show
+    - buf: destination, must hold at least DASHBOARD_FIELD_LEN + 1 characters
+    - buf_len: size of buf
+    returns:
+    - the number of characters written (without the terminator), 0 if buf is too small
+*/
+uint16_t dashboard_format_value(ObservedValue id, int32_t value, char * buf, uint16_t buf_len);
+
+#if !defined(SOFTWARE_DEBUG) && defined(SCREEN_DASHBOARD)
+#include <ti/grlib/grlib.h>
+
+/*
+    draws the labels, registers the observer callback and the refresh task
+    arguments:
+    - context: graphics context of the LCD (already initialized)
+*/
+void dashboard_init(Graphics_Context * context);
+
+/*
+    refresh task: redraws the value fields of the changed widgets and flushes the display
+*/
+void dashboard_task();
+#endif
+
+#endif /* INCLUDE_DASHBOARD_DASHBOARD_H_ */
@@ -0,0 +1,257 @@
+/*
+ * datalog.h
+ *
+ * LONG TERM DATA LOG
+ * The history (history/history.h) only keeps the last hours in RAM and is
+ * lost on reset. The data log appends the same changes of the observed
+ * values to spare flash, in blocks the host downloads when it is connected:
+ * days of data survive resets and connectivity gaps.
+ *
+ * The flash region is a ring of DATALOG_BLOCK_SIZE blocks. A block is
+ *
+ *     seal word   CRC, value mask, length, record count, first time, last time
+ *     open word   magic, sequence number, boot number, start time
+ *     payload     records, as in the history (id | delta, varints), padded with 0xFF
+ *
+ * The open word is programmed when the block is opened. The payload is
+ * programmed a flash word (16 bytes) at a time, the bytes of the last
+ * unfinished word are kept in RAM. The seal word is programmed last, when
+ * the block is full or has been open for DATALOG_BLOCK_SPAN_MS: only sealed
+ * blocks are downloaded. The CRC (CRC-16/CCITT-FALSE, see settings_log_crc16)
+ * covers the rest of the seal word, the open word and the payload.
+ *
+ * Every block decodes on its own: the times are relative to the start time
+ * of the block and the first record of each value holds its full value. The
+ * times are the scheduler uptimes of the boot the block belongs to, the boot
+ * number is incremented every time the log is mounted.
+ *
+ * The changes are queued by the observer callback and moved to flash by a
+ * task every DATALOG_TASK_PERIOD, or as soon as the queue is half full.
+ *
+ * At boot the block with the highest sequence number is the newest; if it
+ * was left open by a reset it is sealed with the records programmed so far
+ * (the records still in RAM are lost). When the ring is full the sector
+ * holding the oldest blocks is erased.
+ *
+ * The host downloads the blocks it lacks by sequence number:
+ *
+ *     LOGINFO:$       replies LOG:<first sequence>,<last sequence>,<boot>,<dropped>$ (sealed
+ *                     blocks, 0,0 if there is none yet; dropped: changes lost since the boot
+ *                     because the queue to the log was full, the log has a gap then)
+ *     LOGGET:<seq>$   replies LOGB:<seq>,<bytes>$, then LOGD:<seq>,<offset>,<hex bytes>$ lines
+ *                     holding the header and the payload, or LOG:ERR,<seq>$ if the block is not
+ *                     in flash (the transfer also stops with LOG:ERR if the block is erased meanwhile)
+ *
+ * tools/datalog_reader.c downloads the missing blocks into a directory and
+ * decodes them.
+ */
+
+#ifndef INCLUDE_DATALOG_DATALOG_H_
+#define INCLUDE_DATALOG_DATALOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DATALOG_BLOCK_SIZE 1024
+#define DATALOG_HEADER_SIZE 32
+#define DATALOG_PAYLOAD_SIZE (DATALOG_BLOCK_SIZE - DATALOG_HEADER_SIZE)
+// programming unit, a flash word of the MSP432
+#define DATALOG_WORD_SIZE 16
+#define DATALOG_MAGIC 0xDA7A1065UL
+// a block is sealed after this time even if it is not full
+#define DATALOG_BLOCK_SPAN_MS 3600000UL
+// ids of the records, as in the history; 15 would be a padding byte
+#define DATALOG_MAX_IDS 15
+// longest record, as in the history
+#define DATALOG_MAX_RECORD_LEN 11
+// bytes of a block sent in a LOGD line
+#define DATALOG_LINE_BYTES 48
+
+/*
+    programs bytes into erased flash
+    arguments:
+    - address: the first byte, aligned on DATALOG_WORD_SIZE
+    - data, len: the bytes, a multiple of DATALOG_WORD_SIZE
+    returns:
+    - false if the flash controller reported an error
+*/
+typedef bool (*DatalogProgramFP)(uint8_t * address, const void * data, uint16_t len);
+/*
+    erases the sector starting at address
+    returns:
+    - false if the flash controller reported an error
+*/
+typedef bool (*DatalogEraseFP)(uint8_t * sector);
+// called for every record of a block, time is the scheduler uptime
+typedef void (*DatalogSampleFP)(void * context, uint8_t id, uint32_t time, int32_t value);
+
+/*
+    struct representing the header of a block, as it is in flash
+    fields:
+    - crc: CRC of the header after it and of the payload
+    - mask: bit i set if the block has records of value i
+    - length: bytes of payload
+    - count: number of records
+    - first_time, last_time: times of the first and the last record
+    - magic, sequence, boot, start_time: the open word, start_time is the base of the record times
+    the seal word is erased (all bits set) while the block is open
+*/
+typedef struct {
+    uint16_t crc;
+    uint16_t mask;
+    uint16_t length;
+    uint16_t count;
+    uint32_t first_time;
+    uint32_t last_time;
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t boot;
+    uint16_t reserved;
+    uint32_t start_time;
+} DatalogHeader;
+
+/*
+    struct representing the log
+    fields:
+    - base, block_count, blocks_per_sector: the flash region
+    - program, erase: the flash routines
+    - boot: boot number of this boot
+    - oldest: index of the oldest block, newest: of the newest one (-1 if there is none)
+    - open: true if the newest block is open
+    - header: header of the open block, the seal word is filled as records are appended
+    - written: payload bytes of the open block programmed
+    - stage, stage_len: bytes of the open block not programmed yet
+    - time, values: time of the last record and value of each id in the open block
+*/
+typedef struct {
+    uint8_t * base;
+    uint16_t block_count;
+    uint8_t blocks_per_sector;
+    DatalogProgramFP program;
+    DatalogEraseFP erase;
+    uint16_t boot;
+    int16_t oldest;
+    int16_t newest;
+    bool open;
+    DatalogHeader header;
+    uint16_t written;
+    uint32_t stage[DATALOG_WORD_SIZE / 4];
+    uint8_t stage_len;
+    uint32_t time;
+    int32_t values[DATALOG_MAX_IDS];
+} Datalog;
+
+/*
+    sets the flash region and routines, datalog_mount must be called before using the log
+    arguments:
+    - base, size: the flash region, sectors of sector_size bytes
+    - sector_size: a multiple of DATALOG_BLOCK_SIZE
+    - program, erase: the flash routines
+*/
+void datalog_state_init(Datalog * log, uint8_t * base, uint32_t size, uint32_t sector_size,
+                        DatalogProgramFP program, DatalogEraseFP erase);
+
+/*
+    finds the oldest and the newest block, seals the newest if it was left open and starts a new boot
+    returns:
+    - false if the open block could not be sealed
+*/
+bool datalog_mount(Datalog * log);
+
+/*
+    appends a record, opening a new block (and erasing the oldest sector) when needed
+    arguments:
+    - id: the value, less than DATALOG_MAX_IDS
+    - time: the scheduler uptime, not earlier than the previous record
+    - value: the value
+    returns:
+    - false if the id is not valid or the flash reported an error
+*/
+bool datalog_append(Datalog * log, uint8_t id, uint32_t time, int32_t value);
+
+/*
+    seals the open block, if any
+    returns:
+    - false if the flash reported an error
+*/
+bool datalog_seal(Datalog * log);
+
+/*
+    finds the sequence numbers of the sealed blocks
+    arguments:
+    - first, last: set to the sequence numbers of the oldest and the newest sealed block
+    returns:
+    - false if there is no sealed block
+*/
+bool datalog_range(const Datalog * log, uint32_t * first, uint32_t * last);
+
+/*
+    finds a sealed block
+    returns:
+    - the block in flash, NULL if it is not there or not sealed
+*/
+const uint8_t * datalog_find(const Datalog * log, uint32_t sequence);
+
+/*
+    bytes of a sealed block worth sending: header and payload
+*/
+uint16_t datalog_block_bytes(const uint8_t * block);
+
+/*
+    checks a sealed block, in flash or downloaded
+    arguments:
+    - block: the block
+    - len: bytes available, at least datalog_block_bytes
+    returns:
+    - false if it is not sealed, the length is not valid or the CRC does not match
+*/
+bool datalog_block_check(const uint8_t * block, uint16_t len);
+
+/*
+    calls fn for every record of a checked block, oldest first
+    returns:
+    - the number of records
+*/
+uint16_t datalog_block_decode(const uint8_t * block, DatalogSampleFP fn, void * context);
+
+#ifndef SOFTWARE_DEBUG
+// the data log region, 14 sectors of bank 1 below the settings log (reserved in msp432p401r.cmd)
+#define DATALOG_FLASH_START 0x00030000UL
+#define DATALOG_FLASH_SIZE 0x0000E000UL
+#define DATALOG_FLASH_SECTOR_SIZE 0x1000UL
+// period of the task moving the queued changes to flash
+#define DATALOG_TASK_PERIOD 10000
+
+/*
+    mounts the log and starts recording the observed values, to be called right after observer_init
+*/
+void datalog_init();
+
+/*
+    handlers of the LOGINFO and LOGGET messages, called by the UART parser with the text after the colon
+*/
+void datalog_info(const char * str);
+void datalog_get(const char * str);
+
+#ifdef DATALOG_BENCHMARK
+/*
+    struct representing the result of datalog_benchmark, in MCLK cycles
+    fields:
+    - append_cycles: average cost of an append
+    - worst_cycles: most expensive append (a word programmed, or a block sealed and opened)
+*/
+typedef struct {
+    uint32_t append_cycles;
+    uint32_t worst_cycles;
+} DatalogBenchmark;
+
+/*
+    appends records to a log simulated in RAM and measures them with Timer32 (module 1):
+    the encoding, staging and CRC costs, without the flash programming time;
+    the log in flash is not touched
+*/
+void datalog_benchmark(DatalogBenchmark * result);
+#endif
+#endif
+
+#endif /* INCLUDE_DATALOG_DATALOG_H_ */
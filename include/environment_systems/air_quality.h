@@ -14,6 +14,7 @@
 // M and B are calibration constants specific to the gas being measured
 #define M -1.30f // slope of the linear regression line for the MQ135 sensor
 #define B 2.604f // y-intercept of the linear regression line for the MQ135 sensor
+#define DEFAULT_AIR_THRESHOLD 500 // Default air quality threshold (ppm)
 
 
 
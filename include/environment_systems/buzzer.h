@@ -3,19 +3,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#ifndef SOFTWARE_DEBUG
-/***********************
- * pins for the buzzer *
- ***********************/
-#define BUZZER_PORT GPIO_PORT_P8
-#define BUZZER_PIN  GPIO_PIN2
-
-/*************************************
- * defining variables for the timers *
- *************************************/
-#define BUZZER_TIMER TIMER_A3_BASE
-#define BUZZER_CCR   TIMER_A_CAPTURECOMPARE_REGISTER_2
-#endif
+/*******************************************************
+ * period of the tone, in counts of the 3 MHz PWM timer *
+ *******************************************************/
+#define BUZZER_PERIOD 3000
 
 /**********************************
  * buzzer state tracking variables *
@@ -33,11 +24,9 @@ static bool buzzer_manual_mode;
  * and initializes the buzzer to a known off state.
  * 
  * INITIALIZATION SEQUENCE:
- * 1. Configure GPIO pin for timer output
- * 2. Set up timer for PWM generation
- * 3. Configure PWM compare settings
- * 4. Initialize buzzer to off state
- * 5. Set default mode to automatic
+ * 1. Set up the PWM channel (timer and pin), stopped
+ * 2. Set a 50% duty cycle
+ * 3. Initialize buzzer to off state and default mode to automatic
  */
 void init_buzzer();
 
@@ -49,8 +38,8 @@ void init_buzzer();
  * debug feedback when the buzzer activates.
  * 
  * HOW PWM AUDIO GENERATION WORKS:
- * 1. Timer A3 counts from 0 to 3000 repeatedly (1 kHz frequency)
- * 2. When count reaches 1500 (compare value), output pin toggles
+ * 1. The PWM timer counts from 0 to 3000 repeatedly (1 kHz frequency)
+ * 2. When count reaches 1500 (compare value), output pin is reset, at 3000 it is set
  * 3. This creates a square wave: high for 1500 counts, low for 1500 counts
  * 4. Square wave drives the buzzer, creating audible 1 kHz tone
  * 5. Tone continues until timer is stopped
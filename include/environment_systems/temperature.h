@@ -173,10 +173,8 @@ void temp_set_current_temperature(uint8_t);
  * - TOO HOT ie. +1 (> higher_threshold): Cooling needed, plants may wilt or burn
  * - JUST RIGHT ie. 0 (within range): Perfect growing conditions maintained
  * 
- * AUTOMATED RESPONSES:
- * Each condition triggers different system actions:
- * 1. Buzzer alerts for out-of-range conditions
- * 2. IoT data transmission with status codes
+ * The function has no side effects (no logging, no IoT message): the buzzer
+ * alerts and the IoT status are handled by update_temperature.
  * 
  * @return Temperature evaluation result.
  */
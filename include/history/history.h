@@ -0,0 +1,214 @@
+/*
+ * history.h
+ *
+ * SENSOR HISTORY
+ * The modules only keep their latest value. The history records every change
+ * of the observed values (see observer/observer.h) with its time in a ring
+ * buffer in SRAM, so the host can ask for charts of the last hours instead of
+ * polling the board continuously.
+ *
+ * Each change is one variable length record:
+ *
+ *     byte 0   value id (bits 7-4) | zigzag delta (bits 3-0)
+ *     varint   zigzag delta, only if bits 3-0 are HISTORY_DELTA_ESCAPE
+ *     varint   milliseconds since the previous record
+ *
+ * The delta is the difference from the previous value of the same id (from 0
+ * for its first record), zigzag encoded so small negative deltas stay small.
+ * Varints hold 7 bits per byte, least significant first, with bit 7 set on
+ * every byte but the last. A temperature change of one degree ten seconds
+ * after the previous record takes 3 bytes.
+ *
+ * When the ring is full the oldest records are dropped. They are folded into
+ * the base, the time and the value of every id just before the oldest record
+ * still in the ring, from which the records are decoded.
+ *
+ * The values are step functions: a value holds from its record until the
+ * next record of the same id. The aggregates of a window are computed on it,
+ * so the average is weighted by time and a window without records still has
+ * the value held through it. UART query:
+ *
+ *     HIST:<id>,<from ms>,<to ms>,<window ms>$
+ *
+ * replies HIST:<id>,<from ms>,<window ms>,<count>$ and then, one line per
+ * window from the oldest, HST:<index>,<min>,<max>,<avg>,<records>$ (the value
+ * fields are empty if the value was not known during the window). The times
+ * are scheduler uptimes, at most HISTORY_MAX_WINDOWS windows are sent. A
+ * query that cannot be parsed replies HIST:ERR$.
+ */
+
+#ifndef INCLUDE_HISTORY_HISTORY_H_
+#define INCLUDE_HISTORY_HISTORY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "observer/observer.h"
+
+// size of the ring of the firmware
+#define HISTORY_BUF_LEN 4096
+// number of values that can be recorded (4 bits in a record)
+#define HISTORY_MAX_IDS 16
+// longest record: header, delta and time varints of 5 bytes
+#define HISTORY_MAX_RECORD_LEN 11
+#define HISTORY_DELTA_ESCAPE 0x0F
+// maximum number of windows of a query
+#define HISTORY_MAX_WINDOWS 48
+
+/*
+    struct representing the state of the values at a point of the ring
+    fields:
+    - time: time of the last record decoded
+    - values: value of each id
+    - known: bit i set once id i has a value
+*/
+typedef struct {
+    uint32_t time;
+    int32_t values[HISTORY_MAX_IDS];
+    uint16_t known;
+} HistoryState;
+
+/*
+    struct representing the ring
+    fields:
+    - buf, size: the bytes of the ring
+    - head: where the next record is written
+    - tail: the oldest record
+    - used: bytes in use
+    - records: number of records in the ring
+    - base: state before the oldest record
+    - last: state after the newest record
+    - dropped: records dropped to make room since the init
+*/
+typedef struct {
+    uint8_t * buf;
+    uint16_t size;
+    uint16_t head;
+    uint16_t tail;
+    uint16_t used;
+    uint16_t records;
+    HistoryState base;
+    HistoryState last;
+    uint32_t dropped;
+} History;
+
+/*
+    struct representing the aggregates of a value over a window
+    fields:
+    - min, max, avg: of the value held during the window, avg weighted by time
+    - covered: milliseconds of the window during which the value was known
+    - records: records of the value in the window
+    - sum: value times milliseconds over the window, from which avg is computed
+    the value was not known during the window if covered and records are 0, min, max and avg are 0 then
+*/
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t avg;
+    uint32_t covered;
+    uint16_t records;
+    int64_t sum;
+} HistoryAggregate;
+
+/*
+    struct representing a query
+    fields:
+    - id: the value
+    - from, to: time range
+    - window: length of a window
+*/
+typedef struct {
+    uint8_t id;
+    uint32_t from;
+    uint32_t to;
+    uint32_t window;
+} HistoryQuery;
+
+/*
+    empties a ring
+    arguments:
+    - buf, size: the bytes of the ring, at least HISTORY_MAX_RECORD_LEN
+    - now: time of the init, the base time
+*/
+void history_state_init(History * history, uint8_t * buf, uint16_t size, uint32_t now);
+
+/*
+    records a value, dropping the oldest records if there is no room;
+    the time must not be earlier than the one of the previous record
+    arguments:
+    - id: the value, less than HISTORY_MAX_IDS
+    - time: time of the sample
+    - value: the value
+    returns:
+    - false if the id is not valid
+*/
+bool history_record(History * history, uint8_t id, uint32_t time, int32_t value);
+
+/*
+    computes the aggregates of a value over consecutive windows
+    arguments:
+    - id: the value
+    - from: start of the first window
+    - window: length of a window, not 0
+    - count: number of windows
+    - now: the current time, the last value is held up to it
+    - out: filled with the aggregates, count elements
+*/
+void history_aggregate(const History * history, uint8_t id, uint32_t from, uint32_t window,
+                       uint8_t count, uint32_t now, HistoryAggregate * out);
+
+/*
+    encodes a record
+    arguments:
+    - out: at least HISTORY_MAX_RECORD_LEN bytes
+    - id: the value
+    - delta: change since the previous record of the value
+    - elapsed: milliseconds since the previous record
+    returns:
+    - the length of the record
+*/
+uint8_t history_encode_record(uint8_t * out, uint8_t id, int32_t delta, uint32_t elapsed);
+
+/*
+    decodes a record
+    arguments:
+    - in, len: the bytes available
+    - id, delta, elapsed: set to the fields of the record
+    returns:
+    - the length of the record
+    - 0 if it does not end within len bytes
+*/
+uint8_t history_decode_record(const uint8_t * in, uint16_t len, uint8_t * id, int32_t * delta, uint32_t * elapsed);
+
+/*
+    number of windows of a query, at most HISTORY_MAX_WINDOWS
+*/
+uint8_t history_query_windows(const HistoryQuery * query);
+
+/*
+    parses the value of a HIST message, "<id>,<from>,<to>,<window>"
+    returns:
+    - false if the format is not valid, the id is unknown, the range is empty or the window is 0
+*/
+bool history_parse_query(const char * str, HistoryQuery * query);
+
+/*
+    formats the HST line of a window, with its terminator
+    returns:
+    - the length of the line, without the terminator
+    - 0 if it does not fit in len
+*/
+uint16_t history_format_window(char * buf, uint16_t len, uint8_t index, const HistoryAggregate * aggregate);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    starts recording the observed values, to be called right after observer_init
+*/
+void history_init();
+
+/*
+    handler of the HIST messages, called by the UART parser with the text after the colon
+*/
+void history_query(const char * str);
+#endif
+
+#endif /* INCLUDE_HISTORY_HISTORY_H_ */
@@ -7,14 +7,11 @@
 #ifndef SOFTWARE_DEBUG
 #include "scheduling/scheduler.h"
 
-// GPIO pin for the LED light
+// GPIO pin for the LED showing whether the lights are on
+// (the lights themselves are on the PWM_GROW_LIGHT channel, see pwm/pwm.h)
 #define LED_PORT GPIO_PORT_P1
 #define LED_PIN GPIO_PIN0
 
-// GPIO pin for the PWM output (CCR1)
-#define CCR1_PORT GPIO_PORT_P7
-#define CCR1_PIN GPIO_PIN7
-
 // address of the OPT3001 light sensor
 #define OPT3001_SLAVE_ADDRESS 0x44
 
@@ -42,12 +39,25 @@
 // How often our light update task runs (in milliseconds)
 #define TASK_INTERVAL_MS 10500         // 10.5 seconds
 
+// Photoperiod: the automatic mode keeps the lights off at night (16 hours on, 8 off)
+#define PHOTOPERIOD_START_HOUR 6       // Lights allowed from 06:00...
+#define PHOTOPERIOD_END_HOUR 22        // ...to 22:00, wall clock from the RTC (see scheduling/calendar.h)
+
 /***************************************************************************
  *  PWM (Pulse Width Modulation) settings for controlling light brightness *
  ***************************************************************************/
 #define PWM_FREQUENCY_HZ 1200          // How fast PWM pulses (1200 times per second)
-#define SMCLK_FREQUENCY_MHZ 3000000    // Microcontroller clock speed (3 MHz)
+#define SMCLK_FREQUENCY_MHZ 3000000    // PWM timer clock (SMCLK divided down to 3 MHz in every clock profile)
 #define PWM_PERIOD (SMCLK_FREQUENCY_MHZ / PWM_FREQUENCY_HZ)  // Calculate PWM period
+#define GROW_LIGHT_FADE_STEP 2         // PWM counts changed each PWM period while fading (full range in ~1 s)
+
+/*************************************************************************
+ *  Closed loop control: PID gains in Q15 (32768 = 1.0), brightness per  *
+ *  lux of error, tuned with the plant model in test/light_pid_test.c    *
+ *************************************************************************/
+#define LIGHT_PID_KP 24576             // 0.75
+#define LIGHT_PID_KI 32768             // 1.0
+#define LIGHT_PID_KD 0                 // the sensor reading is too noisy to differentiate
 
 /*****************************************
  *  Bit masks for processing sensor data *
@@ -86,12 +96,19 @@
 ///
 /// - on: A flag indicating whether the grow light is currently turned on or off.
 ///
+/// - last_lux: The last light level read from the sensor, after scaling.
+///
+/// - closed_loop: A flag indicating whether the automatic mode uses the PID controller, which keeps
+///   the measured light level at the threshold, instead of the proportional law.
+///
 /// - stack_pos: position in the stack of the scheduler
 typedef struct GrowLight{
     uint32_t current_brightness;
     uint32_t threshold;
     bool manual_mode;
     bool on;
+    uint32_t last_lux;
+    bool closed_loop;
 #ifndef SOFTWARE_DEBUG
     task_list_index stack_pos;
 #endif
@@ -132,6 +149,17 @@ static uint32_t process_sensor_data(uint32_t);
  */
 static uint32_t calculate_brightness(uint32_t sensor_val);
 
+/**
+ * @brief Calculates the brightness with the PID controller (closed loop mode)
+ * 
+ * The sensor also sees our own lights, so the controller adjusts the brightness
+ * until the measured light level equals the threshold.
+ * 
+ * @param sensor_val Current light level reading from the sensor
+ * @return Calculated brightness value [0 to MAX_BRIGHTNESS]
+ */
+static uint32_t calculate_pid_brightness(uint32_t sensor_val);
+
 /**
  * @brief Sends light level information to IoT (Internet of Things) systems
  * 
@@ -187,6 +215,18 @@ bool is_grow_light_on();
  */
 bool grow_light_get_mode();
 
+/**
+ * @brief Checks which law the automatic mode uses
+ * @return true if the PID controller is used, false for the proportional law
+ */
+bool grow_light_get_closed_loop();
+
+/**
+ * @brief Gets the last light level measured by the sensor
+ * @return Scaled sensor value from the last automatic update (0 if none happened yet)
+ */
+uint32_t grow_light_get_lux();
+
 /**
  * @brief Sets the brightness level of our grow lights
  * 
@@ -217,6 +257,17 @@ void grow_light_set_threshold(uint32_t);
  */
 void grow_light_set_mode(int32_t);
 
+/**
+ * @brief Switches the automatic mode between the proportional law and the PID controller
+ * 
+ * Proportional: the darker it is below the threshold, the brighter the lights
+ * Closed loop: the PID controller keeps the measured light level at the threshold,
+ * starting from the current brightness so the lights do not jump
+ * 
+ * @param closed_loop 0 = proportional, any other value = PID controller
+ */
+void grow_light_set_closed_loop(int32_t);
+
 /**
  * @brief Sets the brightness level of our grow lights
  * 
@@ -304,18 +355,6 @@ void update_light_hal(uint32_t);
 
 #ifndef SOFTWARE_DEBUG
 
-/**
- * @brief Interrupt handler for Timer_A1 (handles PWM timing)
- * 
- * This function is called automatically by the microcontroller hardware
- * when timer events occur. It's responsible for creating the PWM signal
- * that controls LED brightness by switching the lights on and off rapidly.
- * 
- * Interrupts are like "emergency phone calls" - the processor stops what
- * it's doing to handle them immediately, then returns to normal operation.
- */
-void TA1_N_IRQHandler(void);
-
 /**
  * @brief Updates how often the automatic light control runs
  * 
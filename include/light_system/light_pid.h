@@ -0,0 +1,70 @@
+/*
+ * light_pid.h
+ *
+ * CLOSED LOOP BRIGHTNESS CONTROL
+ * A PID controller in fixed point: the gains are Q15 numbers (32768 = 1.0,
+ * larger values allowed), the error is in lux and the output is a brightness
+ * level. The derivative is taken on the measurement, so a setpoint change
+ * does not kick the output, and the integral is clamped to the output range,
+ * so it does not wind up while the lights are saturated.
+ *
+ * The controller is called once per sensor reading, the gains are tuned for
+ * that sample time with the plant model in test/light_pid_test.c.
+ */
+
+#ifndef INCLUDE_LIGHT_SYSTEM_LIGHT_PID_H_
+#define INCLUDE_LIGHT_SYSTEM_LIGHT_PID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// number of fractional bits of the gains
+#define LIGHT_PID_Q 15
+// a gain of 1.0
+#define LIGHT_PID_ONE (1L << LIGHT_PID_Q)
+
+/*
+    struct representing the controller
+    fields:
+    - kp, ki, kd: proportional, integral and derivative gains (Q15)
+    - out_min, out_max: range of the output
+    - integral: integral term, in Q15 output units
+    - last_measurement: measurement of the previous update
+    - primed: false until the first update, when there is no previous measurement
+*/
+typedef struct {
+    int32_t kp;
+    int32_t ki;
+    int32_t kd;
+    int32_t out_min;
+    int32_t out_max;
+    int64_t integral;
+    int32_t last_measurement;
+    bool primed;
+} LightPid;
+
+/*
+    sets the gains and the output range, and resets the state with the output at out_min
+*/
+void light_pid_init(LightPid * pid, int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max);
+
+/*
+    resets the state so the next output continues from a given one (bumpless transfer)
+    arguments:
+    - pid: the controller
+    - output: the output currently applied, clamped to the output range
+*/
+void light_pid_reset(LightPid * pid, int32_t output);
+
+/*
+    computes the next output
+    arguments:
+    - pid: the controller
+    - setpoint: the wanted light level
+    - measurement: the light level read from the sensor
+    returns:
+    - the output, between out_min and out_max
+*/
+int32_t light_pid_update(LightPid * pid, int32_t setpoint, int32_t measurement);
+
+#endif /* INCLUDE_LIGHT_SYSTEM_LIGHT_PID_H_ */
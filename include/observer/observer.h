@@ -0,0 +1,79 @@
+/*
+ * observer.h
+ *
+ * VALUE OBSERVER
+ * The modules call observer_notify from their setters every time one of the
+ * values below is updated; the registered callbacks are only called when the
+ * value is actually different from the last one notified, so a consumer (the
+ * dashboard) can react to changes without polling every getter.
+ * Callbacks may be called from interrupt context, they should only store the
+ * value and leave the real work to a task.
+ * Every notification is a sample: it is dated with uptime_now_ms (see
+ * scheduling/uptime.h) even if the value did not change, so a consumer can
+ * tell a stale value from a steady one with observer_get_time.
+ */
+
+#ifndef INCLUDE_OBSERVER_OBSERVER_H_
+#define INCLUDE_OBSERVER_OBSERVER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of registered callbacks
+#define OBSERVER_MAX_CALLBACKS 4
+
+/*
+    values that can be observed
+*/
+typedef enum {
+    OBSERVED_LIGHT_LUX,
+    OBSERVED_LIGHT_ON,
+    OBSERVED_TEMPERATURE,
+    OBSERVED_AIR_LEVEL,
+    OBSERVED_TANK_LEVEL,
+    OBSERVED_RESERVOIR_LEVEL,
+    OBSERVED_PUMP1,
+    OBSERVED_PUMP2,
+    OBSERVED_BUZZER,
+    OBSERVED_VALUE_COUNT
+} ObservedValue;
+
+// time: of the sample, milliseconds from uptime_now_ms
+typedef void (*ObserverCallback)(ObservedValue id, int32_t value, uint64_t time);
+
+/*
+    forgets every callback and every value notified so far
+*/
+void observer_init();
+
+/*
+    registers a callback called on every change
+    returns:
+    - true if the callback was registered
+    - false if there are already OBSERVER_MAX_CALLBACKS callbacks
+*/
+bool observer_register(ObserverCallback callback);
+
+/*
+    notifies the new value of id and dates it, the callbacks are called only if it changed
+    (the first notification of a value always counts as a change)
+*/
+void observer_notify(ObservedValue id, int32_t value);
+
+/*
+    returns the last value notified for id (0 if it was never notified)
+*/
+int32_t observer_get(ObservedValue id);
+
+/*
+    returns true if id has been notified at least once
+*/
+bool observer_has_value(ObservedValue id);
+
+/*
+    returns the time of the last notification of id, changed or not, in milliseconds from uptime_now_ms
+    (0 if it was never notified)
+*/
+uint64_t observer_get_time(ObservedValue id);
+
+#endif /* INCLUDE_OBSERVER_OBSERVER_H_ */
@@ -0,0 +1,57 @@
+/*
+ * option_ids.h
+ *
+ * STABLE OPTION IDS
+ * Every option has a numeric id, used by the UART commands (see
+ * option_menu/option_remote.h) and as the key of its value in the settings
+ * log. The ids must never change nor be reused for another option, even when
+ * an option is removed, renamed or moved in the menu: a host script or a
+ * value stored in flash would silently address a different option.
+ * Each module has its own range, new options take the next free id of it.
+ */
+
+#ifndef INCLUDE_OPTION_MENU_OPTION_IDS_H_
+#define INCLUDE_OPTION_MENU_OPTION_IDS_H_
+
+typedef enum {
+    // lights, temperature, air quality and buzzer (main.c)
+    OPTION_ID_POWER_LEDS = 1,
+    OPTION_ID_LIGHT_MODE = 2,
+    OPTION_ID_LIGHT_CLOSED_LOOP = 3,
+    OPTION_ID_LIGHT_TIMER = 4,
+    OPTION_ID_LIGHT_THRESHOLD = 5,
+    OPTION_ID_TEMP_TIMER = 6,
+    OPTION_ID_TEMP_HIGHER_THRESHOLD = 7,
+    OPTION_ID_TEMP_LOWER_THRESHOLD = 8,
+    OPTION_ID_AIR_TIMER = 9,
+    OPTION_ID_AIR_THRESHOLD = 10,
+    OPTION_ID_POWER_BUZZER = 11,
+    OPTION_ID_BUZZER_MODE = 12,
+
+    // water reading
+    OPTION_ID_RESERVOIRE_EMPTY_THRESHOLD = 20,
+    OPTION_ID_RESERVOIRE_LOW_THRESHOLD = 21,
+    OPTION_ID_RESERVOIRE_MODERATE_THRESHOLD = 22,
+    OPTION_ID_TANK_EMPTY_THRESHOLD = 23,
+    OPTION_ID_TANK_READING_TIME = 24,
+    OPTION_ID_RESERVOIRE_READING_TIME = 25,
+
+    // pump management
+    OPTION_ID_PUMPS_MANUAL_MODE = 30,
+    OPTION_ID_PUMP1_STATUS = 31,
+    OPTION_ID_PUMP2_STATUS = 32,
+    OPTION_ID_PUMP1_ENABLE_TIME = 33,
+    OPTION_ID_PUMP2_ENABLE_TIME = 34,
+    OPTION_ID_PUMP1_DISABLE_TIME = 35,
+    OPTION_ID_PUMP2_DISABLE_TIME = 36,
+
+    // telemetry and IoT
+    OPTION_ID_TELEMETRY_TIMER = 40,
+    OPTION_ID_IOT_HEARTBEAT = 41,
+
+    // test options (option_menu_test.c)
+    OPTION_ID_TEST_BLINK_A = 250,
+    OPTION_ID_TEST_BLINK_B = 251,
+} OptionId;
+
+#endif /* INCLUDE_OPTION_MENU_OPTION_IDS_H_ */
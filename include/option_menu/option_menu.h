@@ -40,15 +40,23 @@ OptionList option_list;
  */
 void option_menu_init_option_list();
 /*
-    pushes an option in the list
+    pushes an option in the list, with the default value of its descriptor
     arguments:
-    - option: the option to be pushed
+    - desc: the descriptor of the option, in a const table
     returns:
     - position of the option if it has been succesfully pushed
-    - -1 if the list is full
+    - -1 if the list is full or an option with the same id is already in it
 
  */
-int32_t option_menu_push_option(Option option);
+int32_t option_menu_push_option(const OptionDesc * desc);
+/*
+    pushes every option of a descriptor table
+    arguments:
+    - table, count: the descriptors
+    returns:
+    - the number of options pushed, less than count if the list is full or an id is repeated
+ */
+int32_t option_menu_push_options(const OptionDesc * table, int32_t count);
 /*
 
     pops an option from the list
@@ -92,4 +100,33 @@ int option_menu_nav_prev_option();
 void option_menu_toggle();
 
 void option_menu_init(Graphics_Context * graphics_context);
+
+/*
+    forces the current option to be drawn and sent again on the next draw task,
+    to be called when an option value is changed from outside the menu
+*/
+void option_menu_mark_dirty();
+
+/*
+    changes the value of an option from outside the menu, it is applied by the next option_change_confirm
+    arguments:
+    - index: position of the option in the list
+    - value: in the form returned by option_get_value
+    returns:
+    - 1 if the value has been set
+    - -1 if the index or the value is not valid
+*/
+int32_t option_menu_set_value(int32_t index, int32_t value);
+/*
+    runs the actions of the options changed since the last confirm, from the menu or
+    option_menu_set_value, with the scheduler tick masked, then stores their values in flash
+*/
+void option_change_confirm();
+/*
+    applies the option values stored in flash (see settings/settings_log.h) and runs
+    the actions of the restored options; the options whose value is confirmed are stored again
+    and the settings of no option are dropped when the log is compacted.
+    to be called in main, after settings_init and once every option and module is initialized
+*/
+void option_menu_load_settings();
 #endif /* OPTION_MENU_OPTION_MENU_H_ */
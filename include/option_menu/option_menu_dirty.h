@@ -0,0 +1,67 @@
+/*
+ * option_menu_dirty.h
+ *
+ * OPTION MENU CHANGE TRACKING
+ * The menu only redraws (and sends through UART) the current option when it
+ * is dirty: the list changed, the current option moved or its value changed.
+ * The redraw flag is cleared only once the line has been drawn or queued, so
+ * a full tx queue is retried by the next draw task.
+ * The options whose value changed are also marked one bit each, until
+ * option_change_confirm runs their actions and saves them.
+ * This module does not touch the hardware, the menu owns one tracker.
+ */
+
+#ifndef INCLUDE_OPTION_MENU_OPTION_MENU_DIRTY_H_
+#define INCLUDE_OPTION_MENU_OPTION_MENU_DIRTY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// options that can be tracked, at least MAX_OPTIONS
+#define OPTION_DIRTY_MAX_OPTIONS 64
+#define OPTION_DIRTY_WORDS ((OPTION_DIRTY_MAX_OPTIONS + 31) / 32)
+
+/*
+    struct representing the tracker
+    fields:
+    - redraw: the current option must be drawn again
+    - changed: bit i set when the value of option i changed and has not been confirmed yet
+*/
+typedef struct {
+    bool redraw;
+    uint32_t changed[OPTION_DIRTY_WORDS];
+} OptionMenuDirty;
+
+// initializes a tracker with nothing changed, the first draw is always done
+void option_dirty_init(OptionMenuDirty * dirty);
+
+// the current option must be drawn again (list changed, moved to another option)
+void option_dirty_mark_redraw(OptionMenuDirty * dirty);
+
+// returns true if the current option must be drawn again
+bool option_dirty_needs_redraw(const OptionMenuDirty * dirty);
+
+// the current option has been drawn or queued, clears the redraw flag
+void option_dirty_drawn(OptionMenuDirty * dirty);
+
+/*
+    the value of an option changed: marks it for the confirm and the current option for a redraw
+    arguments:
+    - index: the option, out of range indexes are ignored
+*/
+void option_dirty_mark_changed(OptionMenuDirty * dirty, int32_t index);
+
+// forgets the change of an option, for a removed option
+void option_dirty_forget(OptionMenuDirty * dirty, int32_t index);
+
+// returns true if the value of the option changed and has not been confirmed yet
+bool option_dirty_is_changed(const OptionMenuDirty * dirty, int32_t index);
+
+/*
+    takes the changed options for a confirm, clearing them
+    arguments:
+    - pending: filled with the changed bits, OPTION_DIRTY_WORDS words
+*/
+void option_dirty_take_changed(OptionMenuDirty * dirty, uint32_t * pending);
+
+#endif /* INCLUDE_OPTION_MENU_OPTION_MENU_DIRTY_H_ */
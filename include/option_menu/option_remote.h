@@ -0,0 +1,107 @@
+/*
+ * option_remote.h
+ *
+ * REMOTE OPTION COMMANDS
+ * The options can be read and changed through UART by their stable id (see
+ * option_menu/option_ids.h), without emulating the joystick:
+ *
+ *     GET:<id>$                              replies VAL:<id>,<value>$ or GET:ERR,<id>$
+ *     SET:<id>=<value>[,<id>=<value>...]$    replies SET:OK,<count>$ or SET:ERR,<id>$
+ *     LIST:$                                 replies LIST:<count>$ and then, one line per option,
+ *     OPT:<id>,<type>,<value>,<min>,<max>,<step>,<name>$
+ *
+ * The values are in the form returned by option_get_value: threshold value,
+ * timer amount in milliseconds, switch state (0 or 1). <type> is 0 for a
+ * threshold, 1 for a timer and 2 for a switch; the range of a timer is the
+ * one of the timer array, with a step of 0 (only the amounts of the array
+ * are valid).
+ *
+ * A SET is all or nothing: every value is checked with option_check_value
+ * before any is changed, SET:ERR names the first id that is unknown or whose
+ * value is not valid (0 if the frame cannot be parsed). The new values are
+ * then confirmed like in the menu: the actions run together with the
+ * scheduler tick masked, and the values are stored in flash. A board is
+ * provisioned with a single SET frame, of at most OPTION_REMOTE_MAX_ASSIGNMENTS
+ * values and OPTION_REMOTE_FRAME_LEN characters.
+ *
+ * The OPT lines are sent one at a time, each one queued when the previous one
+ * has gone out, so a LIST never fills the reply queue.
+ */
+
+#ifndef INCLUDE_OPTION_MENU_OPTION_REMOTE_H_
+#define INCLUDE_OPTION_MENU_OPTION_REMOTE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "option_menu/options.h"
+
+// maximum number of values in a SET frame
+#define OPTION_REMOTE_MAX_ASSIGNMENTS 32
+// longest frame received, separator included (the UART receive ring holds UART_BUF_LEN - 1 bytes)
+#define OPTION_REMOTE_FRAME_LEN 255
+// longest reply line, terminator included
+#define OPTION_REMOTE_LINE_LEN 96
+
+/*
+    struct representing one <id>=<value> of a SET frame
+*/
+typedef struct {
+    uint8_t id;
+    int32_t value;
+} OptionAssignment;
+
+/*
+    parses the id of a GET frame
+    arguments:
+    - str: the text after the colon, "<id>"
+    - id: set to the id
+    returns:
+    - false if it is not a number from 0 to 255
+*/
+bool option_remote_parse_id(const char * str, uint8_t * id);
+
+/*
+    parses the assignments of a SET frame
+    arguments:
+    - str: the text after the colon, "<id>=<value>[,<id>=<value>...]"
+    - assignments: filled with the parsed assignments, in order
+    - max: size of assignments
+    returns:
+    - the number of assignments
+    - -1 if the format is not valid, a number overflows or there are more than max assignments
+*/
+int8_t option_remote_parse_assignments(const char * str, OptionAssignment * assignments, uint8_t max);
+
+/*
+    checks every assignment of a SET frame against the options
+    arguments:
+    - options, count: the options
+    - assignments, assignment_count: the parsed assignments
+    - indexes: set to the index of the option of each assignment
+    returns:
+    - -1 if every assignment is valid
+    - the position of the first assignment whose id is unknown or whose value is not valid
+*/
+int8_t option_remote_check(const Option * options, int32_t count,
+                           const OptionAssignment * assignments, uint8_t assignment_count,
+                           int32_t * indexes);
+
+/*
+    formats the OPT line of an option, with its terminator
+    returns:
+    - the length of the line, without the terminator
+    - 0 if it does not fit in len
+*/
+uint16_t option_remote_format_option(char * buf, size_t len, Option * option);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    handlers of the GET, SET and LIST frames, called by the UART parser with the text after the colon
+*/
+void option_remote_get(const char * str);
+void option_remote_set(const char * str);
+void option_remote_list(const char * str);
+#endif
+
+#endif /* INCLUDE_OPTION_MENU_OPTION_REMOTE_H_ */
@@ -6,6 +6,7 @@
 #include "stdbool.h"
 #include "stdint.h"
 #include "string.h"
+#include "option_menu/option_ids.h"
 
 
 
@@ -18,26 +19,6 @@
     - SWITCH: ON/OFF
  */
 typedef enum { THRESHOLD, TIMER, SWITCH } OptionType;
-/*
- * ------------------------------------------------------------
- *                      THRESHOLD Option
- * ------------------------------------------------------------
- */
-/*
-    struct representing a threshold option
-    fields:
-    - value: the value of the threshold
-    - min_value: the minimum value the threshold can be
-    - max_value: the maximum value the threshold can be
-    - increments: how much the value shall increment or decrement every change
-*/
-typedef struct {
-  int32_t value;
-  int32_t min_value;
-  int32_t max_value;
-  int32_t increments;
-} OptionTU;
-
 /*
  * ------------------------------------------------------------
  *                      TIMER OPTION
@@ -62,7 +43,7 @@ typedef struct {
 
 
 // array with the timer options. accessed through an index
-extern TimerAmount timer_option_arr[TIMER_OPTION_ARR_LEN];
+extern const TimerAmount timer_option_arr[TIMER_OPTION_ARR_LEN];
 
 //index for timer arr
 typedef  int32_t t_arr_index;
@@ -76,7 +57,7 @@ typedef  int32_t t_arr_index;
     - -1 if it's not an entry
 
  */
-int32_t timer_option_get_index(char * str);
+int32_t timer_option_get_index(const char * str);
 /*
     get value in milliseconds using index
     arguments:
@@ -94,64 +75,19 @@ int32_t timer_option_get_value(t_arr_index index);
     - pointer to the string
     - -1 otherwise
  */
-char * timer_option_get_name(t_arr_index index);
-
-char * timer_option_get_name_by_value(int32_t val);
-/*
- * ------------------------------------------------------------
- *                      OPTION UNION
- * ------------------------------------------------------------
- */
+const char * timer_option_get_name(t_arr_index index);
 
+const char * timer_option_get_name_by_value(int32_t val);
 /*
-
-    union representing the three different option types
-    possible values:
-    - threshold: in case it's a threshold, using a threshold option struct
-    - timer: in case it's a timer, using a index to the threshold array
-    - sswitch: in case it's a switch, using a bool
- */
-typedef union {
-  OptionTU threshold;
-  t_arr_index timer;
-  bool sswitch;
-} OptionUnion;
-/*
-    function to create a new option union with a threshold
-    arguments:
-    - value, min_value,max_value,increments: same fields as in OptionTU
-    - error: pointer to an int changed in case of error, for instance min_value bigger than max_value
+    get the index using the value in milliseconds
     returns:
-    new option union with the specified values
-
-
- */
-OptionUnion option_u_new_threshold(int32_t value, int32_t min_value,
-                                   int32_t max_value, int32_t increments,
-                                   int *error);
-/*
-    function to create a new option union with a timer
-    arguments:
-    - str: the string representing the time amount
-    - error: pointer to an int changed in case of error
-    returns:
-    new option union with the specified values
-*/
-
-OptionUnion option_u_new_timer( char *str,
-                               int *error);
-/*
-    function to create a new option union with a switch
-    arguments:
-    - sswitch: the switch value
+    - the index if the value is in the array
+    - -1 otherwise
  */
-
-OptionUnion option_u_new_switch(bool sswitch);
-
-
+t_arr_index timer_option_get_index_by_value(int32_t value);
 /*
  * ------------------------------------------------------------
- *                      OPTION UNION
+ *                      OPTION DESCRIPTOR
  * ------------------------------------------------------------
  */
 
@@ -171,31 +107,100 @@ typedef void (*FmtStringFP)(char *,int32_t,size_t);
 */
 typedef void (*OnChangeFP)(int32_t);
 
+// longest name drawn on the screen
 #define OPTION_NAME_MAX_LENGTH 50
 
 /*
-    struct representing an option in the menu
+    struct describing an option. The descriptors are declared const, in tables
+    kept in flash by each module: only the value of an option is in RAM
     fields:
+    - id: the stable id of the option, see option_menu/option_ids.h
     - name: the name of the option
     - type: the option type
-    - value: the value union
+    - default_value: the value at boot, in the form returned by option_get_value
+      (threshold value, timer amount in milliseconds, switch state)
+    - min_value, max_value, increments: range and step of a threshold, unused by the other types
     - on_change_action: function called when the value is changed(in order to update fields etc)
     - to_string: function called when we want the stringified version of the option's value
  */
-
 typedef struct {
-  char name[OPTION_NAME_MAX_LENGTH + 1];
+  uint8_t id;
+  const char * name;
   OptionType type;
-  OptionUnion value;
+  int32_t default_value;
+  int32_t min_value;
+  int32_t max_value;
+  int32_t increments;
   OnChangeFP on_change_action;
   FmtStringFP to_string;
-  bool changed;
+} OptionDesc;
+
+/*
+    initializers of the descriptors of each type
+ */
+#define OPTION_THRESHOLD(id, name, value, min_value, max_value, increments, action, to_string) \
+    {id, name, THRESHOLD, value, min_value, max_value, increments, action, to_string}
+#define OPTION_TIMER(id, name, millis, action, to_string) \
+    {id, name, TIMER, millis, 0, 0, 0, action, to_string}
+#define OPTION_SWITCH(id, name, on, action, to_string) \
+    {id, name, SWITCH, on, 0, 0, 0, action, to_string}
+
+/*
+    struct representing an option in the menu
+    fields:
+    - desc: the descriptor
+    - value: the threshold value, the index in timer_option_arr of a timer, the switch state
+    the options changed and not confirmed yet are tracked by the option menu
+ */
+typedef struct {
+  const OptionDesc * desc;
+  int32_t value;
 } Option;
 
+/*
+    creates an option with the default value of its descriptor
+    arguments:
+    - desc: the descriptor, it must stay valid (a const table)
+    returns:
+    the option, its value is -1 for a timer whose default is not in the timer array
+*/
+Option option_from_desc(const OptionDesc * desc);
+
 int32_t option_get_value(Option * option);
 
-Option option_new(char *name, OptionType type, OptionUnion value,
-                  OnChangeFP action,FmtStringFP to_string);
+/*
+    sets the value of an option, in the form returned by option_get_value
+    arguments:
+    - option: the option
+    - value: the threshold value, the timer amount in milliseconds or the switch state
+    returns:
+    - 1 if the value has been set
+    - -1 if the threshold is out of range or the timer amount is not in the timer array
+*/
+int32_t option_set_value(Option * option, int32_t value);
+
+/*
+    tells whether a value can be set on an option from outside the menu (see option_remote.h):
+    stricter than option_set_value, it must be a value the menu could show
+    arguments:
+    - desc: the descriptor of the option
+    - value: in the form returned by option_get_value
+    returns:
+    - true for a threshold in range and on a step from the minimum (or the maximum itself),
+      a timer amount of the timer array, a switch state of 0 or 1
+*/
+bool option_check_value(const OptionDesc * desc, int32_t value);
+
+/*
+    finds an option by its stable id
+    arguments:
+    - options, count: the options to search
+    - id: the id, see option_menu/option_ids.h
+    returns:
+    - the index of the option
+    - -1 if no option has this id
+*/
+int32_t option_find_by_id(const Option * options, int32_t count, uint8_t id);
 
 
 /*
@@ -0,0 +1,146 @@
+/*
+ * idle.h
+ *
+ * IDLE MANAGER
+ * When the scheduler has nothing to run the main loop calls idle_sleep, which
+ * puts the CPU to sleep (WFI) in the deepest state that is safe for the
+ * peripherals currently in use:
+ *
+ * - LPM0: the CPU stops, every clock keeps running. The scheduler timer wakes
+ *   it up at the next tick. Always safe.
+ * - LPM3: every high frequency clock stops and only the 32 kHz BCLK keeps
+ *   running, so the scheduler timer (SMCLK) freezes. The watchdog, in interval
+ *   mode, wakes the CPU up before the next task is due; the time actually
+ *   slept is measured with the RTC prescaler and credited to the scheduler.
+ *   Only used when none of the IDLE_BUSY_* peripherals is active and the next
+ *   task is at least IDLE_LPM3_MIN_MS away.
+ *
+ * The eUSCI cannot receive in LPM3: the UART counts as busy for
+ * IDLE_UART_HOLD_MS after the last received byte, so a connected host is
+ * never ignored, but the first byte sent after a longer silence can be lost.
+ *
+ * The time spent in each state is counted and reported through UART every
+ * IDLE_REPORT_INTERVAL milliseconds:
+ *     IDLE:<lpm0 permille>,<lpm3 permille>,<lpm0 entries>,<lpm3 entries>$
+ */
+
+#ifndef INCLUDE_POWER_IDLE_H_
+#define INCLUDE_POWER_IDLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// frequency of the BCLK used to measure the sleep time
+#define IDLE_TICKS_PER_SECOND 32768
+// watchdog intervals (in BCLK ticks) that end a LPM3 sleep: 250 ms and ~15.6 ms
+#define IDLE_WAKE_LONG_TICKS 8192
+#define IDLE_WAKE_SHORT_TICKS 512
+// shortest time to the next task for which LPM3 is worth it
+#define IDLE_LPM3_MIN_MS 16
+// the UART counts as busy for this long after the last received byte
+#define IDLE_UART_HOLD_MS 30000
+// period of the residency report in milliseconds
+#define IDLE_REPORT_INTERVAL 60000
+// key of the report in the UART telemetry class
+#define IDLE_REPORT_KEY 1
+
+typedef enum {
+    IDLE_LPM0,
+    IDLE_LPM3,
+    IDLE_STATE_COUNT
+} IdleState;
+
+/*
+    peripherals that keep the board out of LPM3, as bit numbers
+*/
+typedef enum {
+    IDLE_BUSY_UART,
+    IDLE_BUSY_I2C,
+    IDLE_BUSY_BUZZER,
+    IDLE_BUSY_GROW_LIGHT,
+    IDLE_BUSY_ADC,
+    IDLE_BUSY_LCD,
+    IDLE_BUSY_COUNT
+} IdleBusy;
+
+/*
+    struct representing the residency counters
+    fields:
+    - entries: number of sleeps in each state
+    - ticks: BCLK ticks spent in each state
+    - blocked: number of sleeps in which each IdleBusy peripheral prevented LPM3
+    - credit_carry: fraction of millisecond (in ticks) not credited to the scheduler yet
+*/
+typedef struct {
+    uint32_t entries[IDLE_STATE_COUNT];
+    uint64_t ticks[IDLE_STATE_COUNT];
+    uint32_t blocked[IDLE_BUSY_COUNT];
+    uint32_t credit_carry;
+} IdleStats;
+
+/*
+    resets the counters
+*/
+void idle_stats_init(IdleStats * stats);
+
+/*
+    chooses the sleep state
+    arguments:
+    - busy: bitmask of the active peripherals, bit i is IdleBusy i
+    - ms_to_next: milliseconds before the next task is due
+    returns:
+    - IDLE_LPM3 if no peripheral is busy and the next task is far enough, IDLE_LPM0 otherwise
+*/
+IdleState idle_choose_state(uint32_t busy, int32_t ms_to_next);
+
+/*
+    returns the watchdog interval (IDLE_WAKE_LONG_TICKS or IDLE_WAKE_SHORT_TICKS)
+    ending a LPM3 sleep before the next task is due
+*/
+uint16_t idle_wake_ticks(int32_t ms_to_next);
+
+/*
+    records a sleep
+    arguments:
+    - stats: the counters
+    - state: the state the CPU slept in
+    - busy: the busy bitmask that was used to choose it
+    - ticks: BCLK ticks slept
+*/
+void idle_stats_record(IdleStats * stats, IdleState state, uint32_t busy, uint32_t ticks);
+
+/*
+    converts slept ticks to whole milliseconds, keeping the remainder for the next call
+    returns:
+    - the milliseconds to credit to the scheduler
+*/
+uint32_t idle_credit_ms(IdleStats * stats, uint32_t ticks);
+
+/*
+    returns the time spent in a state, in thousandths of uptime_ms
+*/
+uint16_t idle_residency_permille(const IdleStats * stats, IdleState state, uint32_t uptime_ms);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    starts the 32 kHz clock and the RTC used to measure the sleeps, and the report task
+*/
+void idle_init();
+
+/*
+    sleeps until the next interrupt if the scheduler has nothing to run
+*/
+void idle_sleep();
+
+/*
+    copies the residency counters
+*/
+void idle_get_stats(IdleStats * stats);
+
+/*
+    task sending the residency report
+*/
+void idle_report_task();
+#endif
+
+#endif /* INCLUDE_POWER_IDLE_H_ */
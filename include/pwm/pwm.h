@@ -0,0 +1,117 @@
+/*
+ * pwm.h
+ *
+ * HARDWARE PWM CHANNELS
+ * The grow light and the buzzer are driven by a Timer_A output unit in
+ * reset/set mode: the timer sets the pin at the end of every period (CCR0)
+ * and resets it when it reaches the channel compare register, so the
+ * waveform is produced without any interrupt. Only the table in pwm.c knows
+ * which timer output and which pin carry a channel:
+ *
+ *     channel          timer output   pin
+ *     PWM_GROW_LIGHT   TA1.1          P7.7
+ *     PWM_BUZZER       TA3.2          P8.2
+ *
+ * Timer_A compare registers are not buffered, and moving one below the
+ * counter in the middle of a period skips the reset and leaves the pin high
+ * for a whole period. pwm_set only stores the new duty: the CCR0 interrupt is
+ * enabled for the one period boundary at which it is copied into the compare
+ * register, then disabled again. A channel with a steady duty costs no CPU time.
+ *
+ * pwm_fade moves the duty towards a target by a fixed step at every period
+ * boundary, from the same interrupt, which stays enabled until the target is
+ * reached.
+ *
+ * The timers are divided down to CLOCK_PROFILE_TIMER_TICK_HZ, the periods do
+ * not change with the clock profile.
+ */
+
+#ifndef INCLUDE_PWM_PWM_H_
+#define INCLUDE_PWM_PWM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    PWM_GROW_LIGHT,
+    PWM_BUZZER,
+    PWM_CHANNEL_COUNT
+} PwmChannel;
+
+/*
+    converts a level to timer counts
+    arguments:
+    - value: the level, from 0 to max (clamped)
+    - max: the level giving a 100% duty
+    - period: the period of the channel in timer counts
+    returns:
+    - the duty in timer counts, from 0 to period
+*/
+uint16_t pwm_duty_counts(uint32_t value, uint32_t max, uint16_t period);
+
+/*
+    returns the compare register value producing a duty in reset/set mode:
+    counts for a partial duty, period + 1 (never reached, so the pin stays high)
+    for a full one, 0 for none (the pin is then driven low instead)
+*/
+uint16_t pwm_compare_value(uint16_t counts, uint16_t period);
+
+/*
+    returns the duty of the period after current in a fade
+    arguments:
+    - current: the duty of this period
+    - target: the duty at the end of the fade
+    - step: the largest change per period, 0 to jump to the target
+*/
+uint16_t pwm_fade_step(uint16_t current, uint16_t target, uint16_t step);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    configures the timer and the pin of a channel, stopped with the pin low
+    arguments:
+    - channel: the channel
+    - period: the period in timer counts (CLOCK_PROFILE_TIMER_TICK_HZ / frequency)
+*/
+void pwm_init(PwmChannel channel, uint16_t period);
+
+/*
+    changes the duty of a channel, at the next period boundary if it is running,
+    at the next pwm_start otherwise
+    arguments:
+    - channel: the channel
+    - counts: the time the pin is high in each period, from 0 to the period
+*/
+void pwm_set(PwmChannel channel, uint16_t counts);
+
+/*
+    fades the duty of a running channel to a target, a stopped channel gets it at once
+    arguments:
+    - channel: the channel
+    - counts: the target duty, from 0 to the period
+    - step: counts added or removed at each period boundary
+*/
+void pwm_fade(PwmChannel channel, uint16_t counts, uint16_t step);
+
+/*
+    starts the waveform, the first period begins low
+*/
+void pwm_start(PwmChannel channel);
+
+/*
+    stops the timer and drives the pin low
+*/
+void pwm_stop(PwmChannel channel);
+
+/*
+    returns true if the timer of a channel is counting
+*/
+bool pwm_is_running(PwmChannel channel);
+
+/*
+    period boundary interrupts, only enabled while a duty change or a fade is pending
+*/
+void TA1_0_IRQHandler(void);
+void TA3_0_IRQHandler(void);
+#endif
+
+#endif /* INCLUDE_PWM_PWM_H_ */
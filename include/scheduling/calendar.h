@@ -0,0 +1,183 @@
+/*
+ * calendar.h
+ *
+ * CALENDAR SCHEDULING
+ * The periodic tasks of the scheduler only know relative time. Calendar rules
+ * run a routine at a time of day, every day or on some days of the week
+ * (lights on at 06:00, pump at 07:00 on mondays...).
+ *
+ * The wall clock is kept by RTC_C, which keeps counting in LPM3. Only one RTC
+ * alarm is programmed at a time, for the next rule that is due: when it fires
+ * the RTC interrupt queues calendar_task on the scheduler, which runs every
+ * rule due since the last run and programs the alarm for the next one. The
+ * CPU is never woken up to check the time.
+ *
+ * Times are handled as minutes of the week, from 0 (sunday 00:00) to
+ * CALENDAR_MINUTES_PER_WEEK - 1. The clock is set through UART with
+ *     TIME:<day of week, 0 = sunday>,<hour>,<minute>,<second>$
+ * The RTC starts at sunday 00:00 on every boot; until the clock has been set
+ * no rule is run and calendar_time_valid tells the time-of-day users (the
+ * photoperiod of the grow light) not to trust it.
+ */
+
+#ifndef INCLUDE_SCHEDULING_CALENDAR_H_
+#define INCLUDE_SCHEDULING_CALENDAR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of rules
+#define CALENDAR_MAX_RULES 8
+#define CALENDAR_MINUTES_PER_DAY 1440
+#define CALENDAR_MINUTES_PER_WEEK (7 * CALENDAR_MINUTES_PER_DAY)
+// day masks of the rules, bit d is day of week d (0 = sunday)
+#define CALENDAR_DAY(d) (1U << (d))
+#define CALENDAR_EVERY_DAY 0x7F
+#define CALENDAR_WEEKDAYS 0x3E
+#define CALENDAR_WEEKEND 0x41
+
+// routine run by a rule
+typedef void (*CalendarFP)(void);
+
+/*
+    struct representing a wall clock time
+    fields:
+    - day_of_week: 0 (sunday) to 6 (saturday)
+    - hour, minute, second
+*/
+typedef struct {
+    uint8_t day_of_week;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+} CalendarTime;
+
+/*
+    struct representing a rule
+    fields:
+    - fpointer: the routine
+    - days: days on which it runs (CALENDAR_DAY bits)
+    - minute_of_day: time at which it runs
+*/
+typedef struct {
+    CalendarFP fpointer;
+    uint8_t days;
+    uint16_t minute_of_day;
+} CalendarRule;
+
+/*
+    struct representing the rules and the last minute they have been checked at
+    fields:
+    - rules, count: the rules
+    - last_minute: minute of the week of the last calendar_due
+    - synced: true once calendar_sync has been called, the rules only run after it
+*/
+typedef struct {
+    CalendarRule rules[CALENDAR_MAX_RULES];
+    uint8_t count;
+    uint16_t last_minute;
+    bool synced;
+} Calendar;
+
+/*
+    forgets every rule and marks the time as not set yet
+*/
+void calendar_state_init(Calendar * calendar);
+
+/*
+    adds a rule
+    arguments:
+    - days: CALENDAR_DAY bits, CALENDAR_EVERY_DAY for a daily rule
+    - hour, minute: time of the day
+    - fpointer: the routine to run
+    returns:
+    - the index of the rule
+    - -1 if the arguments are not valid or there is no space
+*/
+int8_t calendar_add_rule(Calendar * calendar, uint8_t days, uint8_t hour, uint8_t minute, CalendarFP fpointer);
+
+/*
+    returns the minute of the week of a time, or CALENDAR_MINUTES_PER_WEEK if it is not valid
+*/
+uint16_t calendar_minute_of_week(const CalendarTime * time);
+
+/*
+    marks every rule before now as already run and the time as set, after the
+    clock has been set (the rules due at now itself are still run by the next calendar_due)
+*/
+void calendar_sync(Calendar * calendar, uint16_t now);
+
+/*
+    collects the rules due since the previous call
+    arguments:
+    - now: the current minute of the week
+    - due: filled with the routines to run, each rule at most once, at least CALENDAR_MAX_RULES elements
+    returns:
+    - the number of routines, always 0 before the first calendar_sync
+*/
+uint8_t calendar_due(Calendar * calendar, uint16_t now, CalendarFP * due);
+
+/*
+    finds the next time a rule is due, strictly after now
+    arguments:
+    - now: the current minute of the week
+    - next: set to the minute of the week of the next rule
+    returns:
+    - false if there is no rule
+*/
+bool calendar_next(const Calendar * calendar, uint16_t now, uint16_t * next);
+
+/*
+    tells whether a minute of the day is in [start, end), the window can wrap around midnight
+*/
+bool calendar_in_window(uint16_t minute_of_day, uint16_t start, uint16_t end);
+
+/*
+    parses the value of a TIME message, "<day of week>,<hour>,<minute>,<second>"
+    returns:
+    - false if the format or a field is not valid
+*/
+bool calendar_parse_time(const char * str, CalendarTime * time);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    starts the RTC at sunday 00:00 and enables its alarm interrupt, the time is
+    only valid after calendar_set_time; must be called after idle_init (which
+    selects the 32 kHz clock) and before any calendar_add
+*/
+void calendar_init();
+
+/*
+    adds a rule, see calendar_add_rule, and reprograms the alarm
+*/
+int8_t calendar_add(uint8_t days, uint8_t hour, uint8_t minute, CalendarFP fpointer);
+
+/*
+    sets the wall clock and marks it as valid; the rules due at the new time are run by the scheduler
+*/
+void calendar_set_time(const CalendarTime * time);
+
+/*
+    tells whether the wall clock has been set since boot
+*/
+bool calendar_time_valid();
+
+/*
+    reads the wall clock
+*/
+void calendar_get_time(CalendarTime * time);
+
+/*
+    tells whether the wall clock is in [start, end) (minutes of the day)
+*/
+bool calendar_now_in_window(uint16_t start, uint16_t end);
+
+/*
+    task run when the alarm fires: runs the due rules and programs the next alarm
+*/
+void calendar_task();
+
+void RTC_C_IRQHandler(void);
+#endif
+
+#endif /* INCLUDE_SCHEDULING_CALENDAR_H_ */
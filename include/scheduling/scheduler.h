@@ -87,6 +87,17 @@ int disable_task_at(uint32_t index);
     - -1 if index out of bounds
 */
 int enable_task_at(uint32_t index);
+/*
+    changes the period of the task at index; a countdown longer than the new period is shortened,
+    so a shorter period takes effect at once
+    arguments:
+    - index: the index of the task
+    - max_time: the new period in milliseconds
+    return:
+    - 0 if the operation has been done succesfully
+    - -1 if index out of bounds
+*/
+int set_task_period(uint32_t index, int32_t max_time);
 
 
 
@@ -141,6 +152,18 @@ void scheduler();
  */
 void timer_interrupt(int elapsed);
 
+/*
+    milliseconds elapsed since uptime_init, the low 32 bits of uptime_now_ms (see scheduling/uptime.h)
+    (wraps around after ~49 days)
+*/
+uint32_t scheduler_get_uptime();
+
+/*
+    milliseconds before the next active task is due, 0 if tasks are already queued
+    and INT32_MAX if no task is active; call it with interrupts disabled
+*/
+int32_t scheduler_ms_to_next_task();
+
 void scheduler_init();
 
 
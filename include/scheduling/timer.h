@@ -20,15 +20,21 @@
 /*
     utility function that computes the countdown value for the timer.
     arguments:
+    - clock: the frequency of the timer's clock source in Hz
     - period: the timer's period in milliseconds
     - divider: the prescaler's division factor
 
  */
-inline int32_t compute_countdown(int32_t period,int32_t divider);
+inline int32_t compute_countdown(int32_t clock,int32_t period,int32_t divider);
 
 
 void timer_init();
 
+/*
+    mask and unmask the scheduler tick interrupt around the code sharing the task list and queue with it.
+    the calls can be nested (also from other interrupts): the tick is unmasked again by the enable
+    matching the outermost disable, so a group of changes is seen by the tick all at once
+*/
 void enable_timer_interrupt();
 void disable_timer_interrupt();
 
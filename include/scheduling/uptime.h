@@ -0,0 +1,76 @@
+/*
+ * uptime.h
+ *
+ * MONOTONIC UPTIME CLOCK
+ * The scheduler tick (TIMER_A0 on SMCLK) stops in LPM3 and is only credited
+ * the time slept afterwards, so it cannot date events. The uptime clock is
+ * the 16 bit prescaler count of RTC_C (RT1PS:RT0PS), which runs on the 32 kHz
+ * BCLK started by the idle manager (see power/idle.h): it is one of the few
+ * counters still running in LPM3 and does not change with the clock profiles.
+ * The count wraps every 2 s, the RT1PS event interrupt extends it to 64 bits
+ * (it ends a LPM3 sleep every 2 s, the idle manager goes back to sleep at once).
+ *
+ * A read masks the interrupts for a few cycles, so the clock can be read from
+ * the tasks and from the interrupts; an overflow not served yet is detected
+ * from the pending flag. The resolution is one BCLK period, ~30.5 us.
+ *
+ * scheduler_get_uptime returns the low 32 bits of uptime_now_ms, and the
+ * observer (see observer/observer.h) dates every sample notified by the
+ * sensor setters with it.
+ */
+
+#ifndef INCLUDE_SCHEDULING_UPTIME_H_
+#define INCLUDE_SCHEDULING_UPTIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// frequency of BCLK, counted by the clock
+#define UPTIME_TICKS_PER_SECOND 32768
+
+/*
+    extends a 16 bit count to 64 bits
+    arguments:
+    - overflows: overflows counted by the interrupt
+    - count: the prescaler count, read after overflows
+    - pending: overflow flag read after count, the interrupt was not served yet
+    returns:
+    - the ticks since the start of the clock
+*/
+uint64_t uptime_extend(uint32_t overflows, uint16_t count, bool pending);
+
+/*
+    converts ticks to milliseconds and microseconds, rounding down
+*/
+uint64_t uptime_ticks_to_ms(uint64_t ticks);
+uint64_t uptime_ticks_to_us(uint64_t ticks);
+
+/*
+    ticks since uptime_init (0 before it), from tasks or interrupts
+*/
+uint64_t uptime_now_ticks();
+
+/*
+    milliseconds and microseconds since uptime_init, from tasks or interrupts
+*/
+uint64_t uptime_now_ms();
+uint64_t uptime_now_us();
+
+#ifdef SOFTWARE_DEBUG
+/*
+    sets the ticks returned by uptime_now_ticks, the tests move the clock by hand
+*/
+void uptime_set_ticks(uint64_t ticks);
+#else
+/*
+    starts the clock, to be called after idle_init (which starts the 32 kHz clock and the RTC)
+*/
+void uptime_init();
+
+/*
+    counts a wrap of the prescalers, called by RTC_C_IRQHandler (see scheduling/calendar.h)
+*/
+void uptime_overflow();
+#endif
+
+#endif /* INCLUDE_SCHEDULING_UPTIME_H_ */
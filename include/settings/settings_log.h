@@ -0,0 +1,194 @@
+/*
+ * settings_log.h
+ *
+ * PERSISTENT SETTINGS
+ * The values set through the option menu are kept in flash as an append only
+ * log: every confirmed change adds one record at the end of the active
+ * sector, nothing is rewritten in place. At boot the records are replayed in
+ * order, the last record of a setting wins.
+ *
+ * A record takes two words:
+ *
+ *     word 0   key (bits 31-16) | CRC-16 of key and value (bits 15-0)
+ *     word 1   value
+ *
+ * The key identifies a setting (the stable id of the option, see
+ * option_menu/option_ids.h, so the records survive options being added,
+ * renamed or reordered). A record whose CRC
+ * does not match, like one cut in half by a reset while it was programmed,
+ * is skipped. The first two words of a sector are its header: a magic number
+ * and a generation, the active sector is the valid one with the highest
+ * generation.
+ *
+ * When the active sector is full its latest records are copied into the next
+ * sector of the ring, which is erased first, and the new header is programmed
+ * last: a reset during the copy leaves the old sector active. Each compaction
+ * erases the sector after the active one, so the erase cycles are spread
+ * evenly over the sectors of the ring, and a value equal to the stored one
+ * is not written again. A compaction also drops the settings rejected by the
+ * filter of the log, like the records of options that no longer exist or the
+ * keys of an older format, so they do not take the place of the others.
+ *
+ * The log only reads the sectors through pointers and changes them through a
+ * program and an erase routine, with the flash semantics (programming only
+ * clears bits, erasing sets the whole sector to 0xFF): the firmware passes
+ * the FlashCtl routines, the tests a simulated flash in RAM.
+ */
+
+#ifndef INCLUDE_SETTINGS_SETTINGS_LOG_H_
+#define INCLUDE_SETTINGS_SETTINGS_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// maximum number of sectors in the ring
+#define SETTINGS_LOG_MAX_SECTORS 4
+// maximum number of different keys kept by a compaction
+#define SETTINGS_LOG_MAX_KEYS 64
+#define SETTINGS_LOG_MAGIC 0x5E771065UL
+// words in a record, and in the header of a sector
+#define SETTINGS_LOG_RECORD_WORDS 2
+#define SETTINGS_LOG_ERASED 0xFFFFFFFFUL
+
+/*
+    programs words into erased flash
+    arguments:
+    - address: the first word
+    - words, count: the words to program
+    returns:
+    - false if the flash controller reported an error
+*/
+typedef bool (*SettingsProgramFP)(volatile uint32_t * address, const uint32_t * words, uint16_t count);
+/*
+    erases a whole sector
+    returns:
+    - false if the flash controller reported an error
+*/
+typedef bool (*SettingsEraseFP)(volatile uint32_t * sector);
+// called for every valid record when the log is replayed
+typedef void (*SettingsApplyFP)(uint16_t key, int32_t value);
+// tells whether a setting is still used, the others are not copied by a compaction
+typedef bool (*SettingsKeepFP)(uint16_t key);
+
+/*
+    struct representing the log
+    fields:
+    - sectors, sector_count: the sectors of the ring
+    - sector_slots: records per sector, the header included
+    - program, erase: the flash routines
+    - keep: the filter of the compactions, NULL keeps every setting
+    - active: the sector the records are appended to
+    - next: the first free slot of the active sector
+    - generation: the generation of the active sector
+*/
+typedef struct {
+    volatile uint32_t * sectors[SETTINGS_LOG_MAX_SECTORS];
+    uint8_t sector_count;
+    uint16_t sector_slots;
+    SettingsProgramFP program;
+    SettingsEraseFP erase;
+    SettingsKeepFP keep;
+    uint8_t active;
+    uint16_t next;
+    uint32_t generation;
+} SettingsLog;
+
+/*
+    sets the sectors and the flash routines, settings_log_mount must be called before using the log
+    arguments:
+    - sectors, sector_count: the sectors of the ring, from 2 to SETTINGS_LOG_MAX_SECTORS
+    - sector_size: the size of a sector in bytes
+    - program, erase: the flash routines
+*/
+void settings_log_state_init(SettingsLog * log, volatile uint32_t * const * sectors, uint8_t sector_count,
+                             uint32_t sector_size, SettingsProgramFP program, SettingsEraseFP erase);
+
+/*
+    sets the filter of the compactions, see SettingsKeepFP
+    arguments:
+    - keep: the filter, NULL keeps every setting
+*/
+void settings_log_set_filter(SettingsLog * log, SettingsKeepFP keep);
+
+/*
+    finds the active sector and its first free slot, the first sector is formatted
+    if none is valid (first boot)
+    returns:
+    - false if the flash could not be formatted
+*/
+bool settings_log_mount(SettingsLog * log);
+
+/*
+    calls apply for every valid record of the active sector, oldest first
+    returns:
+    - the number of records
+*/
+uint16_t settings_log_replay(const SettingsLog * log, SettingsApplyFP apply);
+
+/*
+    finds the latest value of a setting
+    arguments:
+    - key: the setting
+    - value: set to the value if it is found
+    returns:
+    - false if the setting has never been stored
+*/
+bool settings_log_find(const SettingsLog * log, uint16_t key, int32_t * value);
+
+/*
+    stores a value, compacting the log first if the active sector is full;
+    nothing is written if it is already the stored value
+    arguments:
+    - key: the setting, not SETTINGS_LOG_ERASED & 0xFFFF
+    - value: the value
+    returns:
+    - false if the flash reported an error or there are too many settings to fit in a sector
+*/
+bool settings_log_append(SettingsLog * log, uint16_t key, int32_t value);
+
+/*
+    copies the latest record of each setting kept by the filter into the next sector of the ring and makes it the active one
+    returns:
+    - false if the flash reported an error, the old sector is then still the active one
+*/
+bool settings_log_compact(SettingsLog * log);
+
+/*
+    CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of a buffer
+*/
+uint16_t settings_log_crc16(const uint8_t * data, uint16_t len);
+
+/*
+    continues a CRC-16/CCITT-FALSE over more bytes, for buffers in pieces
+    arguments:
+    - crc: the CRC of the previous pieces
+*/
+uint16_t settings_log_crc16_update(uint16_t crc, const uint8_t * data, uint16_t len);
+
+#ifndef SOFTWARE_DEBUG
+// the sectors of the log, the last two sectors of bank 1 (reserved in msp432p401r.cmd)
+#define SETTINGS_FLASH_START 0x0003E000UL
+#define SETTINGS_FLASH_SECTOR_SIZE 0x1000UL
+
+/*
+    mounts the log on its flash sectors, must be called before settings_replay and settings_save
+*/
+void settings_init();
+
+/*
+    calls apply for every stored setting, see settings_log_replay
+*/
+uint16_t settings_replay(SettingsApplyFP apply);
+
+/*
+    stores the value of a setting, see settings_log_append
+*/
+bool settings_save(uint16_t key, int32_t value);
+
+/*
+    sets the filter of the compactions, see settings_log_set_filter
+*/
+void settings_set_filter(SettingsKeepFP keep);
+#endif
+
+#endif /* INCLUDE_SETTINGS_SETTINGS_LOG_H_ */
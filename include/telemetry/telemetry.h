@@ -0,0 +1,141 @@
+/*
+ * telemetry.h
+ *
+ * TELEMETRY
+ * This module periodically packs the state of every subsystem into a single
+ * timestamped frame and sends it through UART, so the host does not need to
+ * scrape the option menu lines to know the sensor values.
+ *
+ * frame format (decimal fields, comma separated):
+ *     TLM:<uptime ms>,<lux>,<brightness>,<temperature>,<air ppm>,<tank adc>,<reservoir adc>,<flags>$
+ * flags is a bitmask of the TELEMETRY_FLAG_* values below.
+ */
+
+#ifndef INCLUDE_TELEMETRY_TELEMETRY_H_
+#define INCLUDE_TELEMETRY_TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TELEMETRY_FRAME_HEADER "TLM:"
+#define TELEMETRY_FRAME_SEP '$'
+// worst case: header + 7 fields of 10 digits + flags + 7 commas + separator + terminator
+#define TELEMETRY_FRAME_LEN 96
+
+// default period of the telemetry task in milliseconds
+#define TELEMETRY_INTERVAL_DEFAULT 5000
+// a frame is sent anyway after this many suppressed intervals, so the host knows the board is alive
+#define TELEMETRY_HEARTBEAT_INTERVALS 12
+
+#define TELEMETRY_FLAG_LIGHT_ON   (1 << 0)
+#define TELEMETRY_FLAG_LIGHT_MAN  (1 << 1)
+#define TELEMETRY_FLAG_PUMP1      (1 << 2)
+#define TELEMETRY_FLAG_PUMP2      (1 << 3)
+#define TELEMETRY_FLAG_PUMPS_BLK  (1 << 4)
+#define TELEMETRY_FLAG_BUZZER     (1 << 5)
+#define TELEMETRY_FLAG_AIR_ALARM  (1 << 6)
+
+/*
+    struct representing a snapshot of the greenhouse state
+    fields:
+    - timestamp: milliseconds since boot when the snapshot was taken
+    - lux: last light sensor reading
+    - brightness: current grow light PWM value
+    - air_ppm: last air quality level
+    - tank_level: raw ADC value of the tank sensor
+    - reservoir_level: raw ADC value of the reservoir sensor
+    - temperature: last temperature reading in celsius
+    - flags: on/off states, see TELEMETRY_FLAG_*
+*/
+typedef struct {
+    uint32_t timestamp;
+    uint32_t lux;
+    uint32_t brightness;
+    uint32_t air_ppm;
+    uint32_t tank_level;
+    uint32_t reservoir_level;
+    uint8_t temperature;
+    uint8_t flags;
+} TelemetrySnapshot;
+
+/*
+    struct holding the state of the delta suppression
+    fields:
+    - last_sent: the last snapshot that was actually transmitted
+    - has_sent: false until the first frame goes out
+    - skipped: consecutive intervals suppressed since the last frame
+    - sent, suppressed, dropped: counters for debugging (dropped = refused by the tx queue)
+*/
+typedef struct {
+    TelemetrySnapshot last_sent;
+    bool has_sent;
+    uint32_t skipped;
+    uint32_t sent;
+    uint32_t suppressed;
+    uint32_t dropped;
+} TelemetryState;
+
+/*
+    checks whether two snapshots carry the same values, the timestamp is ignored
+*/
+bool telemetry_snapshot_equal(const TelemetrySnapshot * a, const TelemetrySnapshot * b);
+
+/*
+    writes the frame for the given snapshot in the buffer
+    arguments:
+    - snapshot: the values to send
+    - buffer: where to write the frame
+    - len: size of the buffer
+    returns:
+    - the length of the frame (without the string terminator)
+    - 0 if the buffer is too small
+*/
+uint16_t telemetry_format_frame(const TelemetrySnapshot * snapshot, char * buffer, uint16_t len);
+
+/*
+    decides whether the snapshot has to be transmitted, updating the suppression counters
+    a frame is sent when it is the first one, when some value changed or when
+    TELEMETRY_HEARTBEAT_INTERVALS intervals have been suppressed in a row
+    arguments:
+    - state: the suppression state
+    - snapshot: the candidate snapshot
+    returns:
+    - true if the frame has to be sent
+*/
+bool telemetry_should_send(TelemetryState * state, const TelemetrySnapshot * snapshot);
+
+/*
+    records that the snapshot was handed to the UART (or that the tx queue refused it)
+*/
+void telemetry_mark_sent(TelemetryState * state, const TelemetrySnapshot * snapshot, bool ok);
+
+void telemetry_state_init(TelemetryState * state);
+
+#ifndef SOFTWARE_DEBUG
+/*
+    initializes the telemetry state and pushes the periodic task on the scheduler
+*/
+void telemetry_init();
+
+/*
+    fills the snapshot reading the getters of every subsystem
+*/
+void telemetry_collect(TelemetrySnapshot * snapshot);
+
+/*
+    periodic task: collects a snapshot and sends it if needed
+*/
+void telemetry_task();
+
+/*
+    changes the period of the telemetry task, used by the option menu
+*/
+void update_telemetry_timer(int32_t new_timer);
+
+/*
+    adds the telemetry timer to the option menu
+*/
+void add_telemetry_options();
+#endif
+
+#endif /* INCLUDE_TELEMETRY_TELEMETRY_H_ */
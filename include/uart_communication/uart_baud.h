@@ -0,0 +1,64 @@
+/*
+ * uart_baud.h
+ *
+ * BAUD RATE CONFIGURATION
+ * This module computes the eUSCI_A divider values (UCBRx, UCBRFx, UCBRSx and UCOS16)
+ * for a given source clock and baud rate, following the algorithm described in the
+ * MSP432P4xx technical reference manual (eUSCI_A UART, "Setting a Baud Rate").
+ * It does not touch any hardware, so it can be used both by uart_init and on the host.
+ */
+
+#ifndef INCLUDE_UART_COMMUNICATION_UART_BAUD_H_
+#define INCLUDE_UART_COMMUNICATION_UART_BAUD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// baud rate used at boot, kept at 9600 for the python uart client
+#define UART_DEFAULT_BAUD 9600
+// baud rate used when the high speed mode is requested
+#define UART_HIGH_SPEED_BAUD 115200
+
+// smallest clock/baud ratio accepted: below this the receiver has too few samples per bit
+#define UART_BAUD_MIN_DIVISOR 4
+// maximum accepted error between the requested and the generated baud rate, in 1/10000
+#define UART_BAUD_MAX_ERROR 200
+
+/*
+    struct representing the divider values for the eUSCI_A module
+    fields:
+    - clock_prescalar: UCBRx, integer part of the divider
+    - first_mod_reg: UCBRFx, first modulation stage (only used when oversampling)
+    - second_mod_reg: UCBRSx, second modulation stage pattern
+    - oversampling: UCOS16, true if the oversampling baud rate generation is used
+    - error: deviation of the generated baud rate from the requested one, in 1/10000
+*/
+typedef struct {
+    uint16_t clock_prescalar;
+    uint8_t first_mod_reg;
+    uint8_t second_mod_reg;
+    bool oversampling;
+    int32_t error;
+} UART_BaudConfig;
+
+/*
+    computes the divider values to obtain the given baud rate from the given clock
+    arguments:
+    - clock_hz: frequency of the clock feeding the eUSCI module (SMCLK)
+    - baud: requested baud rate
+    - config: pointer to the struct where the result is written
+    returns:
+    - true if the baud rate can be generated within UART_BAUD_MAX_ERROR
+    - false otherwise (config is still filled with the best attempt)
+*/
+bool uart_baud_compute(uint32_t clock_hz, uint32_t baud, UART_BaudConfig * config);
+
+/*
+    returns the baud rate actually generated by a configuration
+    arguments:
+    - clock_hz: frequency of the clock feeding the eUSCI module
+    - config: the divider values
+*/
+uint32_t uart_baud_effective(uint32_t clock_hz, const UART_BaudConfig * config);
+
+#endif /* INCLUDE_UART_COMMUNICATION_UART_BAUD_H_ */
@@ -11,17 +11,27 @@
 #include<ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "uart_communication/uart_tx_queue.h"
 #define UART_BUF_LEN 256
-#define READ_BUF_LEN 64
+// longest message handled, separator included: a bulk SET of every option must fit
+// (see OPTION_REMOTE_FRAME_LEN in option_menu/option_remote.h)
+#define READ_BUF_LEN UART_BUF_LEN
 //used by water reading to handle the data
 uint32_t water_arr[2];
 
-//4 types of messages received through UART
+//11 types of messages received through UART
 typedef enum __RxMessageType {
     CONTROLLER,
     WATER1,
     WATER2,
-    AIR
+    AIR,
+    TIME,
+    GET,
+    SET,
+    LIST,
+    HIST,
+    LOGINFO,
+    LOGGET
 }RxMessageType;
 
 void RMT_to_string(uint8_t * buffer, RxMessageType type);
@@ -46,10 +56,11 @@ typedef struct {
 
     UART_Buffer rx_buff;
     volatile bool rx_overflow;
+    bool rx_discarding;              // dropping the tail of a too long message up to its separator
 
     char read_buf[READ_BUF_LEN];
-    fp_tx_callback tx_complete_callback;    // TX complete callback
     fp_rx_callback rx_data_callback; // RX data callback
+    uint32_t baud;                   // baud rate currently configured
 } UART_Context;
 
 UART_Context uart_ctx;
@@ -62,12 +73,56 @@ UART_Context uart_ctx;
  * - joystick and buttons input
  * - water level sensor
  * - air quality
+ * - wall clock time (TIME:<day of week>,<hour>,<minute>,<second>$, see scheduling/calendar.h)
+ * - options read and changed by id (GET:<id>$, SET:<id>=<value>,...$, LIST:$, see option_menu/option_remote.h)
+ * - history of a sensor value (HIST:<id>,<from ms>,<to ms>,<window ms>$, see history/history.h)
+ * - blocks of the data log in flash (LOGINFO:$, LOGGET:<sequence>$, see datalog/datalog.h)
+ * a message longer than READ_BUF_LEN is dropped
  */
 
 
 void  uart_init();
+/*
+    reconfigures the eUSCI_A0 dividers for the given baud rate using the current SMCLK frequency
+    arguments:
+    - baud: requested baud rate (e.g. UART_DEFAULT_BAUD or UART_HIGH_SPEED_BAUD)
+    returns:
+    - true if the baud rate was applied
+    - false if it cannot be generated from the current clock, the previous setting is kept
+*/
+bool uart_set_baud(uint32_t baud);
+/*
+    queues a message to be sent, see uart_tx_queue.h for the priorities and drop policies
+    arguments:
+    - msg_class: class of the message (alert, reply, telemetry, menu)
+    - key: messages of a coalescing class with the same key replace each other
+    - data, length: the bytes to send, at most UART_TX_MSG_LEN
+    - callback: called from the interrupt once the message has been sent, can be NULL
+    returns:
+    - true if the message is queued
+    - false if it has been dropped
+*/
+bool uart_send(UART_TxClass msg_class, uint16_t key, const uint8_t *data, uint16_t length, void (*callback)(void));
+/*
+    queues a message as a command reply (same as uart_send with UART_TX_REPLY and key 0)
+*/
 bool UART_write(const uint8_t *data, uint16_t length, void (*callback)(void));
+/*
+    copies the tx queue statistics of a class
+    returns:
+    - false if the class is not valid
+*/
+bool uart_get_tx_stats(UART_TxClass msg_class, UART_TxStats * stats);
 uint16_t UART_read(uint8_t * buffer, uint16_t max_length);
+/*
+    tells whether the UART is in use
+    arguments:
+    - hold_ms: how long the line counts as in use after the last received byte
+    returns:
+    - true if a message is being sent, received bytes are waiting to be handled
+      or a byte has been received in the last hold_ms milliseconds
+*/
+bool uart_is_active(uint32_t hold_ms);
 
 
 void handle_msg(void);
@@ -0,0 +1,155 @@
+/*
+ * uart_tx_queue.h
+ *
+ * UART TX QUEUE
+ * Messages waiting to be sent through UART, grouped by class.
+ * The class is also the priority: when the line is free the oldest message of the
+ * highest priority class goes out first, so alerts never wait behind telemetry.
+ * Every class has a limit on the number of pending messages and a policy applied
+ * when the limit is reached. When the whole pool is full, a message can take the
+ * slot of the oldest message of a lower priority class.
+ * This module only manages the memory, uart_comm feeds the hardware with it.
+ */
+
+#ifndef INCLUDE_UART_COMMUNICATION_UART_TX_QUEUE_H_
+#define INCLUDE_UART_COMMUNICATION_UART_TX_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// total number of messages that can be pending
+#define UART_TX_QUEUE_SLOTS 12
+// maximum length of a single message
+#define UART_TX_MSG_LEN 128
+
+/*
+    message classes, in decreasing priority
+*/
+typedef enum {
+    UART_TX_ALERT,
+    UART_TX_REPLY,
+    UART_TX_TELEMETRY,
+    UART_TX_MENU,
+    UART_TX_N_CLASSES
+} UART_TxClass;
+
+/*
+    what to do when a class has reached its limit
+    - UART_TX_DROP_OLDEST: the oldest pending message of the class is discarded
+    - UART_TX_DROP_NEWEST: the new message is refused
+    - UART_TX_COALESCE: a pending message with the same key is replaced in place,
+      otherwise it behaves like UART_TX_DROP_OLDEST
+*/
+typedef enum {
+    UART_TX_DROP_OLDEST,
+    UART_TX_DROP_NEWEST,
+    UART_TX_COALESCE
+} UART_TxPolicy;
+
+typedef void(*fp_tx_msg_callback) (void);
+
+/*
+    struct representing a pending message
+    fields:
+    - data, len: the bytes to send
+    - key: identifies messages that can replace each other (UART_TX_COALESCE)
+    - msg_class: the class the message belongs to
+    - callback: called once the last byte has been handed to the hardware, never
+      called if the message is dropped or replaced
+*/
+typedef struct {
+    uint8_t data[UART_TX_MSG_LEN];
+    uint16_t len;
+    uint16_t key;
+    UART_TxClass msg_class;
+    fp_tx_msg_callback callback;
+} UART_TxMessage;
+
+/*
+    statistics of a class
+    fields:
+    - enqueued: messages accepted
+    - sent: messages fully transmitted
+    - dropped: messages refused or discarded before being sent
+    - coalesced: messages that replaced a pending one with the same key
+    - pending: messages currently waiting
+    - max_pending: highest value reached by pending
+*/
+typedef struct {
+    uint32_t enqueued;
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t coalesced;
+    uint16_t pending;
+    uint16_t max_pending;
+} UART_TxStats;
+
+/*
+    the queue: a pool of message slots linked in one list per class plus a free list
+*/
+typedef struct {
+    UART_TxMessage slots[UART_TX_QUEUE_SLOTS];
+    int8_t next[UART_TX_QUEUE_SLOTS];
+    int8_t head[UART_TX_N_CLASSES];
+    int8_t tail[UART_TX_N_CLASSES];
+    int8_t free_head;
+    uint8_t limit[UART_TX_N_CLASSES];
+    UART_TxPolicy policy[UART_TX_N_CLASSES];
+    UART_TxStats stats[UART_TX_N_CLASSES];
+} UART_TxQueue;
+
+/*
+    initializes the queue with the default policies:
+    - alerts: 6 messages, coalesced by key (same alert is sent once with the latest content)
+    - replies: 4 messages, newest refused so the caller knows it has to retry
+    - telemetry: 2 messages, coalesced by key
+    - menu: 1 message, coalesced by key (only the last line matters)
+*/
+void uart_tx_queue_init(UART_TxQueue * queue);
+
+/*
+    changes the policy and limit of a class
+    arguments:
+    - queue: the queue
+    - msg_class: the class to change
+    - policy: the new policy
+    - limit: maximum number of pending messages, between 1 and UART_TX_QUEUE_SLOTS
+*/
+void uart_tx_queue_set_policy(UART_TxQueue * queue, UART_TxClass msg_class, UART_TxPolicy policy, uint8_t limit);
+
+/*
+    adds a message to the queue, copying the data
+    arguments:
+    - queue: the queue
+    - msg_class: the class of the message
+    - key: coalescing key
+    - data, len: the bytes to send (len at most UART_TX_MSG_LEN)
+    - callback: transmission complete callback, can be NULL
+    returns:
+    - true if the message is pending (new or coalesced)
+    - false if it has been dropped
+*/
+bool uart_tx_queue_push(UART_TxQueue * queue, UART_TxClass msg_class, uint16_t key,
+                        const uint8_t * data, uint16_t len, fp_tx_msg_callback callback);
+
+/*
+    takes the next message to send out of its class list, the slot stays reserved
+    until uart_tx_queue_release is called
+    returns:
+    - the slot index of the message
+    - -1 if nothing is pending
+*/
+int8_t uart_tx_queue_pop(UART_TxQueue * queue);
+
+/*
+    gives back the slot of a message returned by uart_tx_queue_pop once it has been sent
+*/
+void uart_tx_queue_release(UART_TxQueue * queue, int8_t slot);
+
+// returns the message stored in a slot
+UART_TxMessage * uart_tx_queue_message(UART_TxQueue * queue, int8_t slot);
+
+// returns the statistics of a class
+const UART_TxStats * uart_tx_queue_stats(const UART_TxQueue * queue, UART_TxClass msg_class);
+
+#endif /* INCLUDE_UART_COMMUNICATION_UART_TX_QUEUE_H_ */
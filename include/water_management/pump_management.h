@@ -16,6 +16,9 @@
 #define PUMP2_ENABLE_TIME_DEFAULT 10000
 #define PUMP1_DISABLE_TIME_DEFAULT 20000
 #define PUMP2_DISABLE_TIME_DEFAULT 20000
+// daily watering run of pump 1, on top of its periodic cycle (see scheduling/calendar.h)
+#define PUMP1_WATERING_HOUR 7
+#define PUMP1_WATERING_MINUTE 0
 
 int activate_pump1_index, activate_pump2_index, deactivate_pump1_index, deactivate_pump2_index;
 bool act_1, act_2;
@@ -23,6 +26,7 @@ bool act_1, act_2;
 
 void pump_init();
 void activate_pump1();
+void water_pump1_daily();
 void activate_pump2();
 void turn_off_pump1();
 void turn_off_pump2();
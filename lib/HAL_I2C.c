@@ -38,18 +38,50 @@
 #include "HAL_I2C.h"
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "clock/clock_profile.h"
 
 
 /* I2C Master Configuration Parameter */
-const eUSCI_I2C_MasterConfig i2cConfig =
+eUSCI_I2C_MasterConfig i2cConfig =
 {
         EUSCI_B_I2C_CLOCKSOURCE_SMCLK,          // SMCLK Clock Source
-        48000000,                               // SMCLK = 48MHz
-        EUSCI_B_I2C_SET_DATA_RATE_400KBPS,      // Desired I2C Clock of 100khz
+        3000000,                                // SMCLK, updated from CS_getSMCLK() on every init
+        EUSCI_B_I2C_SET_DATA_RATE_400KBPS,      // Desired I2C Clock of 400khz
         0,                                      // No byte counter threshold
         EUSCI_B_I2C_NO_AUTO_STOP                // No Autostop
 };
 
+/* Slave address, restored when the module is initialized again */
+static unsigned int i2cSlaveAddress = 0;
+
+static void I2C_configure(void)
+{
+    i2cConfig.i2cClk = CS_getSMCLK();
+
+    /* Initialize USCI_B1 and I2C Master to communicate with slave devices*/
+    I2C_initMaster(EUSCI_B1_BASE, &i2cConfig);
+
+    /* Disable I2C module to make changes */
+    I2C_disableModule(EUSCI_B1_BASE);
+
+    /* Enable I2C Module to start operations */
+    I2C_enableModule(EUSCI_B1_BASE);
+}
+
+/* Recomputes the bit rate divider after an SMCLK change (transfers are blocking, none is in progress) */
+static void I2C_clockChanged(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz)
+{
+    if (change != CLOCK_CHANGE_AFTER)
+    {
+        return;
+    }
+    I2C_configure();
+    if (i2cSlaveAddress != 0)
+    {
+        I2C_setSlaveAddress(EUSCI_B1_BASE, i2cSlaveAddress);
+    }
+}
+
 void Init_I2C_GPIO()
 {
     /* Select I2C function for I2C_SCL(P6.5) & I2C_SDA(P6.4) */
@@ -73,14 +105,8 @@ void Init_I2C_GPIO()
 
 void I2C_init(void)
 {
-        /* Initialize USCI_B0 and I2C Master to communicate with slave devices*/
-    I2C_initMaster(EUSCI_B1_BASE, &i2cConfig);
-
-    /* Disable I2C module to make changes */
-    I2C_disableModule(EUSCI_B1_BASE);
-
-    /* Enable I2C Module to start operations */
-    I2C_enableModule(EUSCI_B1_BASE);
+    I2C_configure();
+    clock_profile_register(I2C_clockChanged);
 
     return;
 }
@@ -186,6 +212,8 @@ void I2C_write16 (unsigned char pointer, unsigned int writeByte)
 
 void I2C_setslave(unsigned int slaveAdr)
 {
+    i2cSlaveAddress = slaveAdr;
+
     /* Specify slave address for I2C */
     I2C_setSlaveAddress(EUSCI_B1_BASE,
         slaveAdr);
@@ -44,7 +44,9 @@
 
 MEMORY
 {
-    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
+    /* the last two sectors (0x3E000 - 0x3FFFF) hold the settings log, see settings/settings_log.h */
+    /* the 14 sectors below them (0x30000 - 0x3DFFF) hold the data log, see datalog/datalog.h */
+    MAIN       (RX) : origin = 0x00000000, length = 0x00030000
     INFO       (RX) : origin = 0x00200000, length = 0x00004000
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
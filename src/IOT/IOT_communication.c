@@ -40,6 +40,8 @@
 #include "IOT/IOT_communication.h"
 #include "msp.h"
 
+#ifndef IOT_LINK_V2
+
 /*
  * GPIO INITIALIZATION FOR IOT COMMUNICATION PROTOCOL 
  */
@@ -131,143 +133,251 @@ void init_GPIOs_IOT(){
     P3->OUT|=BIT6;
 }
 
+/*
+ * PRECOMPUTED PIN STATES
+ *
+ * Every combination of (code, active, value) is translated at compile time in
+ * the state of the seven pins, so send_data does not branch on its arguments
+ * and changes each port with a single write:
+ * - P3 holds four of the pins (P3.0, P3.5, P3.6, P3.7): one masked write
+ * - P2, P5 and P6 hold one pin each: one store to the bit-band alias of the
+ *   pin, which the bus turns into an atomic single bit write
+ */
+
+// pins of the link on port 3
+#define IOT_P3_PINS (BIT0 | BIT5 | BIT6 | BIT7)
+
+/*
+    state of the pins for one message
+    fields:
+    - p3: value of the IOT_P3_PINS bits of P3->OUT (select P3.6 always HIGH)
+    - p2, p5, p6: value (0 or 1) of P2.3, P5.7 and P6.7
+*/
+typedef struct {
+    uint8_t p3;
+    uint8_t p2;
+    uint8_t p5;
+    uint8_t p6;
+} IotPinState;
+
+// codes 1-7 are sent as 7 - code, code 0 (invalid) leaves the lines HIGH
+#define IOT_CODE_BITS(c) (7 - (c))
+// values 1-3 are sent as 4 - value, 4 and invalid values as 00
+#define IOT_VALUE_BITS(v) (((v) >= 1 && (v) <= 3) ? 4 - (v) : 0)
+
+#define IOT_STATE(c, a, v) {                                    \
+    BIT6 |                                                      \
+    ((IOT_CODE_BITS(c) & 1) ? BIT5 : 0) |                       \
+    ((a) ? 0 : BIT7) |                                          \
+    ((IOT_VALUE_BITS(v) & 1) ? BIT0 : 0),                       \
+    (IOT_CODE_BITS(c) >> 2) & 1,                                \
+    (IOT_VALUE_BITS(v) >> 1) & 1,                               \
+    (IOT_CODE_BITS(c) >> 1) & 1                                 \
+}
+#define IOT_STATES_VALUE(c, a) { IOT_STATE(c, a, 0), IOT_STATE(c, a, 1), IOT_STATE(c, a, 2), \
+                                 IOT_STATE(c, a, 3), IOT_STATE(c, a, 4) }
+#define IOT_STATES_ACTIVE(c) { IOT_STATES_VALUE(c, 0), IOT_STATES_VALUE(c, 1) }
+
+// indexed by [code][active][value]
+static const IotPinState iot_pin_states[8][2][5] = {
+    IOT_STATES_ACTIVE(0), IOT_STATES_ACTIVE(1), IOT_STATES_ACTIVE(2), IOT_STATES_ACTIVE(3),
+    IOT_STATES_ACTIVE(4), IOT_STATES_ACTIVE(5), IOT_STATES_ACTIVE(6), IOT_STATES_ACTIVE(7)
+};
+
+// every pin HIGH: the state left by init_GPIOs_IOT
+static const IotPinState iot_idle_state = { IOT_P3_PINS, 1, 1, 1 };
+
+static void iot_apply_state(const IotPinState * state){
+    P3->OUT = (P3->OUT & ~IOT_P3_PINS) | state->p3;
+    BITBAND_PERI(P2->OUT, 3) = state->p2;
+    BITBAND_PERI(P5->OUT, 7) = state->p5;
+    BITBAND_PERI(P6->OUT, 7) = state->p6;
+}
+
 void send_data(int code, bool active, int value){
-    
-    // STEP 1: SIGNAL TRANSMISSION START
-    // Assert the select/control signal to indicate data transmission beginning
-    // This allows the receiving system to prepare for incoming data
-    P3->OUT |= BIT6;  // Set select HIGH: "Data incoming, prepare to receive"
-    
-    // ===============================================================================
-    // STEP 2: ENCODE SENSOR TYPE (3-BIT PARALLEL CODE)
-    // ===============================================================================
-    // Use 3 GPIO pins to encode which sensor is transmitting data
-    // This creates a unique binary signature for each sensor type
-    
-    switch(code){
-        // AIR QUALITY SENSOR - Code 1 (Binary: 110)
-        // ===================================================================
-        case 1: // P2.3=1, P6.7=1, P3.5=0 → Air quality monitoring system
-                    P2->OUT |=  BIT3;    // Data bit 2 = HIGH
-                    P6->OUT |=  BIT7;    // Data bit 1 = HIGH  
-                    P3->OUT &= ~BIT5;    // Data bit 0 = LOW
-                    break;
-                    
-        // TEMPERATURE SENSOR - Code 2 (Binary: 101)
-        // ===================================================================            
-        case 2: // P2.3=1, P6.7=0, P3.5=1 → Temperature monitoring system
-                    P2->OUT |=  BIT3;    // Data bit 2 = HIGH
-                    P6->OUT &= ~BIT7;    // Data bit 1 = LOW
-                    P3->OUT |=  BIT5;    // Data bit 0 = HIGH
-                    break;
-                    
-        // WATER TANK LEVEL - Code 3 (Binary: 100)
-        // ===================================================================
-        case 3: // P2.3=1, P6.7=0, P3.5=0 → Water tank level monitoring
-                    P2->OUT |=  BIT3;    // Data bit 2 = HIGH
-                    P6->OUT &= ~BIT7;    // Data bit 1 = LOW
-                    P3->OUT &= ~BIT5;    // Data bit 0 = LOW
-                    break;
-                    
-        // RESERVOIR MANAGEMENT - Code 4 (Binary: 011)
-        // ===================================================================
-        case 4: // P2.3=0, P6.7=1, P3.5=1 → Water reservoir system
-                    P2->OUT &= ~BIT3;    // Data bit 2 = LOW
-                    P6->OUT |=  BIT7;    // Data bit 1 = HIGH
-                    P3->OUT |=  BIT5;    // Data bit 0 = HIGH
-                    break;
-                    
-        // GROWING LIGHT SYSTEM - Code 5 (Binary: 010)
-        // ===================================================================
-        case 5: // P2.3=0, P6.7=1, P3.5=0 → LED grow light control
-                    P2->OUT &= ~BIT3;    // Data bit 2 = LOW
-                    P6->OUT |=  BIT7;    // Data bit 1 = HIGH
-                    P3->OUT &= ~BIT5;    // Data bit 0 = LOW
-                    break;
-                    
-        // WATER PUMP 1 - Code 6 (Binary: 001)
-        // ===================================================================
-        case 6: // P2.3=0, P6.7=0, P3.5=1 → Primary water pump control
-                    P2->OUT &= ~BIT3;    // Data bit 2 = LOW
-                    P6->OUT &= ~BIT7;    // Data bit 1 = LOW
-                    P3->OUT |=  BIT5;    // Data bit 0 = HIGH
-                    break;
-                    
-        // WATER PUMP 2 - Code 7 (Binary: 000)
-        // ===================================================================
-        case 7: // P2.3=0, P6.7=0, P3.5=0 → Secondary water pump control
-                    P2->OUT &= ~BIT3;    // Data bit 2 = LOW
-                    P6->OUT &= ~BIT7;    // Data bit 1 = LOW
-                    P3->OUT &= ~BIT5;    // Data bit 0 = LOW
-                    break;
+    // out of range arguments behave like the old switches: code lines untouched, value 00
+    if(code < 0 || code > 7){
+        code = 0;
+    }
+    if(value < 0 || value > 4){
+        value = 0;
+    }
+
+    // select is HIGH while the lines change, the receiver ignores them until it falls
+    BITBAND_PERI(P3->OUT, 6) = 1;
+    iot_apply_state(&iot_pin_states[code][active ? 1 : 0][value]);
+
+    // select LOW: all the data bits are stable and valid
+    BITBAND_PERI(P3->OUT, 6) = 0;
+
+    // back to the default HIGH state, the pins are already configured
+    iot_apply_state(&iot_idle_state);
+}
+
+#ifdef IOT_CYCLE_BENCHMARK
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#define BENCHMARK_ROUNDS 64
+
+// the previous implementation: one read-modify-write per pin, then the whole pin setup again
+static void send_data_legacy(int code, bool active, int value){
+    uint8_t code_bits = (code >= 1 && code <= 7) ? IOT_CODE_BITS(code) : 7;
+    uint8_t value_bits = IOT_VALUE_BITS(value);
+
+    P3->OUT |= BIT6;
+    if(code_bits & 4) P2->OUT |= BIT3; else P2->OUT &= ~BIT3;
+    if(code_bits & 2) P6->OUT |= BIT7; else P6->OUT &= ~BIT7;
+    if(code_bits & 1) P3->OUT |= BIT5; else P3->OUT &= ~BIT5;
+    if(active) P3->OUT &= ~BIT7; else P3->OUT |= BIT7;
+    if(value_bits & 2) P5->OUT |= BIT7; else P5->OUT &= ~BIT7;
+    if(value_bits & 1) P3->OUT |= BIT0; else P3->OUT &= ~BIT0;
+    P3->OUT &= ~BIT6;
+    init_GPIOs_IOT();
+}
+
+// sends every message BENCHMARK_ROUNDS times and returns the elapsed Timer32 ticks
+static uint32_t benchmark_run(void (*send)(int, bool, int)){
+    uint16_t round;
+    int code, value;
+
+    Timer32_setCount(TIMER32_1_BASE, UINT32_MAX);
+    uint32_t start = Timer32_getValue(TIMER32_1_BASE);
+    for(round = 0; round < BENCHMARK_ROUNDS; round++){
+        for(code = 1; code <= 7; code++){
+            for(value = 1; value <= 4; value++){
+                send(code, round & 1, value);
             }
-            
-    // ===============================================================================
-    // STEP 3: ENCODE SENSOR STATUS (ACTIVE/INACTIVE FLAG)
-    // ===============================================================================
-    // Single bit indicating whether the reporting sensor is operational
-    // This allows the monitoring system to distinguish between:
-    // - Actual sensor readings (active=true)
-    // - System status updates (active=false)
-    
-    if (active)
-        P3->OUT &= ~BIT7;  // ACTIVE: Set status pin LOW (sensor operational)
-    else
-        P3->OUT |= BIT7;   // INACTIVE: Set status pin HIGH (sensor disabled)
-
-    // ===============================================================================
-    // STEP 4: ENCODE MEASUREMENT VALUE (2-BIT CATEGORICAL CODE)
-    // ===============================================================================
-    // Use 2 pins to encode sensor reading into 4 possible categories
-    // This provides sufficient granularity for most greenhouse monitoring needs
-    
-    switch(value){
-        // VALUE CATEGORY 1 - Code 1 (Binary: 11)
-        // ===================================================================
-        case 1: // P5.7=1, P3.0=1 → High/Critical/Above threshold reading
-                    P5->OUT |= BIT7;     // Value bit 1 = HIGH
-                    P3->OUT |= BIT0;     // Value bit 0 = HIGH
-                    break;
-
-        // VALUE CATEGORY 2 - Code 2 (Binary: 10)  
-        // ===================================================================
-        case 2: // P5.7=1, P3.0=0 → Normal/Optimal/Within range reading
-                    P5->OUT |= BIT7;     // Value bit 1 = HIGH
-                    P3->OUT &= ~BIT0;    // Value bit 0 = LOW
-                    break;
-
-        // VALUE CATEGORY 3 - Code 3 (Binary: 01)
-        // ===================================================================
-        case 3: // P5.7=0, P3.0=1 → Low/Warning/Below threshold reading
-                    P5->OUT &= ~BIT7;    // Value bit 1 = LOW
-                    P3->OUT |= BIT0;     // Value bit 0 = HIGH
-                    break;
-
-        // VALUE CATEGORY 4 - Code 4 (Binary: 00)
-        // ===================================================================
-        case 4: // P5.7=0, P3.0=0 → Error/Unknown/Invalid reading
-                    P5->OUT &= ~BIT7;    // Value bit 1 = LOW
-                    P3->OUT &= ~BIT0;    // Value bit 0 = LOW
-                    break;
-
-        default: 
-            // SAFETY: If invalid value provided, default to error state
-            P5->OUT &= ~BIT7;    // Value bit 1 = LOW
-            P3->OUT &= ~BIT0;    // Value bit 0 = LOW
-            break;
+        }
     }
-    
-    // ===============================================================================
-    // STEP 5: SIGNAL TRANSMISSION COMPLETE
-    // ===============================================================================
-    // Deassert the select signal to indicate end of data transmission
-    // This tells the receiver that all data bits are now stable and valid
-    P3->OUT &= ~BIT6;  // Set select LOW: "Transmission complete, data valid"
-
-    // ===============================================================================
-    // STEP 6: RESET GPIO PINS TO DEFAULT STATE
-    // ===============================================================================
-    // Return all pins to their default HIGH state for the next transmission
-    // This ensures a clean starting point and prevents data corruption
-    init_GPIOs_IOT();  // Reset all pins to default configuration
+    // the timer counts down
+    return start - Timer32_getValue(TIMER32_1_BASE);
+}
+
+void iot_benchmark(IotBenchmark * result){
+    uint32_t calls = (uint32_t)BENCHMARK_ROUNDS * 7 * 4;
+
+    Timer32_initModule(TIMER32_1_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT, TIMER32_FREE_RUN_MODE);
+    Timer32_startTimer(TIMER32_1_BASE, false);
+
+    // the prescaler is 1: ticks are MCLK cycles
+    result->legacy_cycles = benchmark_run(send_data_legacy) / calls;
+    result->table_cycles = benchmark_run(send_data) / calls;
+
+    Timer32_haltTimer(TIMER32_1_BASE);
+}
+#endif
+
+void send_reading(int code, bool active, int value, int32_t reading){
+    // the v1 link has no room for the reading, only the category goes out
+    send_data(code, active, value);
 }
+
+#else
+
+/*
+ * IOT LINK V2 - NIBBLE FRAMES WITH STROBE/ACK HANDSHAKE
+ *
+ * The same seven lines carry the frames of iot_frame.h, 4 bits at a time:
+ * - P2.3, P6.7, P3.5, P3.0: data nibble, bit 3 to bit 0
+ * - P3.7: FRAME, LOW while a frame is being sent
+ * - P3.6: STROBE, toggled by the sender once the nibble is on the data lines
+ * - P5.7: ACK (input), the receiver copies STROBE on it after latching the nibble
+ * The receiver starts a new frame on the falling edge of FRAME and checks the
+ * crc on the rising one. The pins are configured once by init_GPIOs_IOT.
+ */
+
+#include "IOT/iot_frame.h"
+#include "scheduling/scheduler.h"
+
+// polls of the ACK line before the receiver is considered gone
+#define IOT_ACK_TIMEOUT 2000
+
+// frames aborted because the receiver did not acknowledge a nibble
+static uint32_t iot_failed_frames = 0;
+
+void init_GPIOs_IOT(){
+    // data lines, FRAME and STROBE: outputs
+    P2->SEL0 &= ~BIT3;
+    P2->SEL1 &= ~BIT3;
+    P2->DIR |= BIT3;
+    P2->OUT &= ~BIT3;
+
+    P6->SEL0 &= ~BIT7;
+    P6->SEL1 &= ~BIT7;
+    P6->DIR |= BIT7;
+    P6->OUT &= ~BIT7;
+
+    P3->SEL0 &= ~(BIT0 | BIT5 | BIT6 | BIT7);
+    P3->SEL1 &= ~(BIT0 | BIT5 | BIT6 | BIT7);
+    P3->DIR |= BIT0 | BIT5 | BIT6 | BIT7;
+    P3->OUT &= ~(BIT0 | BIT5 | BIT6);
+    // no frame in progress
+    P3->OUT |= BIT7;
+
+    // ACK: input with pull-down, follows STROBE (LOW) when a receiver is connected
+    P5->SEL0 &= ~BIT7;
+    P5->SEL1 &= ~BIT7;
+    P5->DIR &= ~BIT7;
+    P5->REN |= BIT7;
+    P5->OUT &= ~BIT7;
+}
+
+static void iot_put_nibble(uint8_t nibble){
+    P2->OUT = (P2->OUT & ~BIT3) | ((nibble & 0x08) ? BIT3 : 0);
+    P6->OUT = (P6->OUT & ~BIT7) | ((nibble & 0x04) ? BIT7 : 0);
+    P3->OUT = (P3->OUT & ~(BIT5 | BIT0)) | ((nibble & 0x02) ? BIT5 : 0) | ((nibble & 0x01) ? BIT0 : 0);
+}
+
+static bool iot_send_nibble(uint8_t nibble){
+    uint32_t polls;
+    iot_put_nibble(nibble);
+    P3->OUT ^= BIT6;
+
+    bool strobe = (P3->OUT & BIT6) != 0;
+    for(polls = 0; polls < IOT_ACK_TIMEOUT; polls++){
+        if(((P5->IN & BIT7) != 0) == strobe){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool iot_send_frame(const IotFrame * frame){
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    uint8_t len = iot_frame_encode(frame, buf);
+    uint8_t i;
+    bool ok = true;
+
+    P3->OUT &= ~BIT7;
+    for(i = 0; i < len && ok; i++){
+        ok = iot_send_nibble(buf[i] >> 4) && iot_send_nibble(buf[i] & 0x0F);
+    }
+    // a frame cut short fails the crc check of the receiver
+    P3->OUT |= BIT7;
+
+    if(!ok){
+        iot_failed_frames++;
+    }
+    return ok;
+}
+
+void send_reading(int code, bool active, int value, int32_t reading){
+    IotFrame frame = {
+        .code = code,
+        .active = active,
+        .category = value,
+        .reading = reading,
+        .timestamp = scheduler_get_uptime()
+    };
+    iot_send_frame(&frame);
+}
+
+void send_data(int code, bool active, int value){
+    send_reading(code, active, value, 0);
+}
+
+uint32_t iot_get_failed_frames(){
+    return iot_failed_frames;
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * iot_frame.c
+ *
+ * Frames of the v2 IoT link, see iot_frame.h
+ */
+
+#include "IOT/iot_frame.h"
+
+#define HEADER_CODE_MASK 0x07
+#define HEADER_ACTIVE (1 << 3)
+#define HEADER_CATEGORY_SHIFT 4
+#define HEADER_WIDE (1 << 6)
+
+static void put_le(uint8_t * buf, uint32_t value, uint8_t size){
+    uint8_t i;
+    for(i = 0; i < size; i++){
+        buf[i] = value >> (8 * i);
+    }
+}
+
+static uint32_t get_le(const uint8_t * buf, uint8_t size){
+    uint32_t value = 0;
+    uint8_t i;
+    for(i = 0; i < size; i++){
+        value |= (uint32_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+uint8_t iot_frame_crc8(const uint8_t * data, uint8_t len){
+    uint8_t crc = 0;
+    uint8_t i, bit;
+    for(i = 0; i < len; i++){
+        crc ^= data[i];
+        for(bit = 0; bit < 8; bit++){
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint8_t iot_frame_encode(const IotFrame * frame, uint8_t * buf){
+    // readings that fit in 16 bits save 4 nibbles on the wire
+    bool wide = frame->reading < INT16_MIN || frame->reading > INT16_MAX;
+    uint8_t size = wide ? 4 : 2;
+    uint8_t len = 0;
+
+    buf[len] = frame->code & HEADER_CODE_MASK;
+    // like the v1 link, a category out of range is sent as 4 (unknown)
+    uint8_t category = (frame->category >= 1 && frame->category <= 4) ? frame->category : 4;
+    buf[len] |= (category - 1) << HEADER_CATEGORY_SHIFT;
+    if(frame->active){
+        buf[len] |= HEADER_ACTIVE;
+    }
+    if(wide){
+        buf[len] |= HEADER_WIDE;
+    }
+    len++;
+    put_le(&buf[len], (uint32_t)frame->reading, size);
+    len += size;
+    put_le(&buf[len], frame->timestamp, 4);
+    len += 4;
+    buf[len] = iot_frame_crc8(buf, len);
+    return len + 1;
+}
+
+bool iot_frame_decode(const uint8_t * buf, uint8_t len, IotFrame * frame){
+    if(len < 1){
+        return false;
+    }
+    uint8_t size = (buf[0] & HEADER_WIDE) ? 4 : 2;
+    if(len != 1 + size + 4 + 1 || iot_frame_crc8(buf, len - 1) != buf[len - 1]){
+        return false;
+    }
+
+    frame->code = buf[0] & HEADER_CODE_MASK;
+    frame->active = (buf[0] & HEADER_ACTIVE) != 0;
+    frame->category = ((buf[0] >> HEADER_CATEGORY_SHIFT) & 0x03) + 1;
+    if(size == 4){
+        frame->reading = (int32_t)get_le(&buf[1], 4);
+    }else{
+        frame->reading = (int16_t)get_le(&buf[1], 2);
+    }
+    frame->timestamp = get_le(&buf[1 + size], 4);
+    return true;
+}
+
+void iot_decoder_reset(IotDecoder * decoder){
+    decoder->len = 0;
+    decoder->high = false;
+    decoder->overflow = false;
+}
+
+void iot_decoder_push(IotDecoder * decoder, uint8_t nibble){
+    if(decoder->len >= IOT_FRAME_MAX_LEN){
+        decoder->overflow = true;
+        return;
+    }
+    nibble &= 0x0F;
+    if(!decoder->high){
+        decoder->buf[decoder->len] = nibble << 4;
+        decoder->high = true;
+    }else{
+        decoder->buf[decoder->len++] |= nibble;
+        decoder->high = false;
+    }
+}
+
+bool iot_decoder_end(IotDecoder * decoder, IotFrame * frame){
+    bool valid = !decoder->overflow && !decoder->high &&
+                 iot_frame_decode(decoder->buf, decoder->len, frame);
+    iot_decoder_reset(decoder);
+    return valid;
+}
@@ -0,0 +1,162 @@
+/*
+ * iot_publish.c
+ *
+ * Change-only, rate limited publication of the sensor states on the IoT link.
+ */
+
+#include "IOT/iot_publish.h"
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <stdio.h>
+#include "IOT/iot_tx_queue.h"
+#include "scheduling/scheduler.h"
+#include "option_menu/option_menu.h"
+
+static IotPublishState iot_publish_state;
+static task_list_index iot_publish_task_index;
+#endif
+
+// sensors read periodically are limited, pump events always go out at once
+static const uint32_t default_rate_limit[IOT_PUBLISH_CODES] = {
+    0,
+    2000,   // 1: air quality
+    2000,   // 2: temperature
+    1000,   // 3: tank
+    1000,   // 4: reservoir
+    2000,   // 5: light
+    0,      // 6: pump 1
+    0       // 7: pump 2
+};
+
+void iot_publish_state_init(IotPublishState * state){
+    uint8_t code;
+    memset(state, 0, sizeof(IotPublishState));
+    state->heartbeat = IOT_PUBLISH_HEARTBEAT_DEFAULT;
+    for(code = 0; code < IOT_PUBLISH_CODES; code++){
+        state->codes[code].rate_limit = default_rate_limit[code];
+    }
+}
+
+void iot_publish_set_rate_limit(IotPublishState * state, uint8_t code, uint32_t rate_limit){
+    if(code > 0 && code < IOT_PUBLISH_CODES){
+        state->codes[code].rate_limit = rate_limit;
+    }
+}
+
+bool iot_publish_update(IotPublishState * state, uint8_t code, bool active, uint8_t value, int32_t reading, uint32_t now){
+    if(code == 0 || code >= IOT_PUBLISH_CODES){
+        return false;
+    }
+    IotPublishEntry * entry = &state->codes[code];
+    entry->active = active;
+    entry->value = value;
+    entry->reading = reading;
+
+    if(!entry->has_sent){
+        return true;
+    }
+    entry->pending = entry->active != entry->sent_active || entry->value != entry->sent_value;
+    // unsigned difference: correct across the uptime wrap around
+    if(entry->pending && now - entry->last_sent >= entry->rate_limit){
+        return true;
+    }
+    state->suppressed++;
+    return false;
+}
+
+void iot_publish_mark_sent(IotPublishState * state, uint8_t code, uint32_t now){
+    if(code == 0 || code >= IOT_PUBLISH_CODES){
+        return;
+    }
+    IotPublishEntry * entry = &state->codes[code];
+    entry->sent_active = entry->active;
+    entry->sent_value = entry->value;
+    entry->has_sent = true;
+    entry->pending = false;
+    entry->last_sent = now;
+    state->sent++;
+}
+
+uint8_t iot_publish_next_due(const IotPublishState * state, uint32_t now){
+    uint8_t code;
+    for(code = 1; code < IOT_PUBLISH_CODES; code++){
+        const IotPublishEntry * entry = &state->codes[code];
+        if(!entry->has_sent){
+            continue;
+        }
+        uint32_t elapsed = now - entry->last_sent;
+        if(entry->pending && elapsed >= entry->rate_limit){
+            return code;
+        }
+        if(state->heartbeat > 0 && elapsed >= state->heartbeat){
+            return code;
+        }
+    }
+    return 0;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// hands the latest state of code to the tx queue, the pins are driven later by iot_tx_task
+static bool iot_publish_send(uint8_t code, uint32_t now){
+    const IotPublishEntry * entry = &iot_publish_state.codes[code];
+    if(!iot_tx_send(code, entry->active, entry->value, entry->reading)){
+        // still pending: retried by the next run of iot_publish_task
+        return false;
+    }
+    iot_publish_mark_sent(&iot_publish_state, code, now);
+    return true;
+}
+
+void iot_publish(int code, bool active, int value, int32_t reading){
+    uint32_t now = scheduler_get_uptime();
+    if(code < 0 || value < 0){
+        return;
+    }
+    if(iot_publish_update(&iot_publish_state, code, active, value, reading, now)){
+        iot_publish_send(code, now);
+    }
+}
+
+void iot_publish_task(){
+    uint32_t now = scheduler_get_uptime();
+    uint8_t code;
+    // every message queued moves last_sent to now, so the loop ends
+    while((code = iot_publish_next_due(&iot_publish_state, now)) != 0){
+        if(!iot_publish_send(code, now)){
+            break;
+        }
+    }
+}
+
+void iot_publish_init(){
+    iot_publish_state_init(&iot_publish_state);
+
+    STask task = {
+        .fpointer = iot_publish_task,
+        .max_time = IOT_PUBLISH_TASK_PERIOD,
+        .elapsed_time = IOT_PUBLISH_TASK_PERIOD,
+        .is_active = true
+    };
+    iot_publish_task_index = push_task(task);
+}
+
+void update_iot_heartbeat(int32_t new_timer){
+    if(new_timer > 0){
+        iot_publish_state.heartbeat = new_timer;
+    }
+}
+
+static const OptionDesc iot_publish_options[] = {
+    OPTION_TIMER(OPTION_ID_IOT_HEARTBEAT, "iot heartbeat",
+                 IOT_PUBLISH_HEARTBEAT_DEFAULT,
+                 update_iot_heartbeat,
+                 to_string_timer_default)
+};
+
+void add_iot_publish_options(){
+    option_menu_push_options(iot_publish_options, sizeof(iot_publish_options) / sizeof(iot_publish_options[0]));
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * iot_tx_queue.c
+ *
+ * Queue of the messages waiting to be sent on the IoT pins.
+ */
+
+#include "IOT/iot_tx_queue.h"
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "IOT/IOT_communication.h"
+#include "scheduling/scheduler.h"
+
+static IotTxQueue iot_tx_queue;
+static task_list_index iot_tx_task_index;
+#endif
+
+void iot_tx_queue_init(IotTxQueue * queue){
+    memset(queue, 0, sizeof(IotTxQueue));
+}
+
+bool iot_tx_queue_push(IotTxQueue * queue, uint8_t code, bool active, uint8_t value, int32_t reading, uint32_t now){
+    uint8_t i;
+    IotTxMessage * msg;
+
+    for(i = 0; i < queue->count; i++){
+        msg = &queue->msgs[(queue->head + i) % IOT_TX_QUEUE_LEN];
+        if(msg->code == code){
+            // keeps its place and its enqueue time, the latency counts from the first push
+            msg->active = active;
+            msg->value = value;
+            msg->reading = reading;
+            queue->stats.coalesced++;
+            return true;
+        }
+    }
+    if(queue->count == IOT_TX_QUEUE_LEN){
+        queue->stats.overflows++;
+        return false;
+    }
+
+    msg = &queue->msgs[(queue->head + queue->count) % IOT_TX_QUEUE_LEN];
+    msg->code = code;
+    msg->active = active;
+    msg->value = value;
+    msg->reading = reading;
+    msg->enqueued_at = now;
+    queue->count++;
+    queue->stats.enqueued++;
+    if(queue->count > queue->stats.max_pending){
+        queue->stats.max_pending = queue->count;
+    }
+    return true;
+}
+
+bool iot_tx_queue_pop(IotTxQueue * queue, IotTxMessage * msg){
+    if(queue->count == 0){
+        return false;
+    }
+    *msg = queue->msgs[queue->head];
+    queue->head = (queue->head + 1) % IOT_TX_QUEUE_LEN;
+    queue->count--;
+    return true;
+}
+
+void iot_tx_queue_mark_sent(IotTxQueue * queue, const IotTxMessage * msg, uint32_t now){
+    uint32_t latency = now - msg->enqueued_at;
+    queue->stats.sent++;
+    queue->stats.total_latency += latency;
+    if(latency > queue->stats.max_latency){
+        queue->stats.max_latency = latency;
+    }
+}
+
+uint32_t iot_tx_queue_average_latency(const IotTxQueue * queue){
+    if(queue->stats.sent == 0){
+        return 0;
+    }
+    return queue->stats.total_latency / queue->stats.sent;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+bool iot_tx_send(uint8_t code, bool active, uint8_t value, int32_t reading){
+    bool was_disabled = Interrupt_disableMaster();
+    bool ok = iot_tx_queue_push(&iot_tx_queue, code, active, value, reading, scheduler_get_uptime());
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    return ok;
+}
+
+void iot_tx_task(){
+    IotTxMessage msg;
+    uint8_t i;
+    for(i = 0; i < IOT_TX_BURST; i++){
+        bool was_disabled = Interrupt_disableMaster();
+        bool ok = iot_tx_queue_pop(&iot_tx_queue, &msg);
+        if(!was_disabled){
+            Interrupt_enableMaster();
+        }
+        if(!ok){
+            return;
+        }
+        // the handshake runs with the interrupts enabled
+        send_reading(msg.code, msg.active, msg.value, msg.reading);
+
+        was_disabled = Interrupt_disableMaster();
+        iot_tx_queue_mark_sent(&iot_tx_queue, &msg, scheduler_get_uptime());
+        if(!was_disabled){
+            Interrupt_enableMaster();
+        }
+    }
+}
+
+void iot_tx_init(){
+    iot_tx_queue_init(&iot_tx_queue);
+
+    STask task = {
+        .fpointer = iot_tx_task,
+        .max_time = IOT_TX_TASK_PERIOD,
+        .elapsed_time = IOT_TX_TASK_PERIOD,
+        .is_active = true
+    };
+    iot_tx_task_index = push_task(task);
+}
+
+const IotTxStats * iot_tx_get_stats(){
+    return &iot_tx_queue.stats;
+}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * clock_profile.c
+ *
+ * Clock profiles and their switching, see clock_profile.h
+ */
+
+#include "clock/clock_profile.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
+
+static const ClockProfileDesc clock_profiles[CLOCK_PROFILE_COUNT] = {
+    [CLOCK_PROFILE_LOW_POWER]   = {"low power",    3000000,  3000000, 1, 0, 0},
+    [CLOCK_PROFILE_NOMINAL]     = {"nominal",     12000000, 12000000, 1, 0, 0},
+    [CLOCK_PROFILE_PERFORMANCE] = {"performance", 48000000, 24000000, 2, 1, 1}
+};
+
+static ClockListener listeners[CLOCK_PROFILE_MAX_LISTENERS];
+static uint8_t listener_count = 0;
+static ClockProfile current_profile = CLOCK_PROFILE_LOW_POWER;
+
+const ClockProfileDesc * clock_profile_desc(ClockProfile profile){
+    if(profile >= CLOCK_PROFILE_COUNT){
+        return NULL;
+    }
+    return &clock_profiles[profile];
+}
+
+uint8_t clock_profile_plan(ClockProfile from, ClockProfile to, ClockStep * steps){
+    const ClockProfileDesc * old = clock_profile_desc(from);
+    const ClockProfileDesc * new = clock_profile_desc(to);
+    uint8_t count = 0;
+    if(old == NULL || new == NULL || from == to){
+        return 0;
+    }
+    // going up the core needs the higher voltage and the flash the extra wait states before the faster clock
+    if(new->vcore > old->vcore){
+        steps[count++] = CLOCK_STEP_VCORE;
+    }
+    if(new->wait_states > old->wait_states){
+        steps[count++] = CLOCK_STEP_WAIT_STATES;
+    }
+    if(new->mclk_hz != old->mclk_hz || new->smclk_hz != old->smclk_hz){
+        steps[count++] = CLOCK_STEP_CLOCKS;
+    }
+    // going down they can only be lowered once the clock is slow enough
+    if(new->wait_states < old->wait_states){
+        steps[count++] = CLOCK_STEP_WAIT_STATES;
+    }
+    if(new->vcore < old->vcore){
+        steps[count++] = CLOCK_STEP_VCORE;
+    }
+    return count;
+}
+
+uint8_t clock_profile_timer_divider(uint32_t smclk_hz){
+    uint8_t divider = 1;
+    while(divider < 8 && smclk_hz / (divider * 2) >= CLOCK_PROFILE_TIMER_TICK_HZ){
+        divider *= 2;
+    }
+    return divider;
+}
+
+void clock_profile_state_init(){
+    listener_count = 0;
+    current_profile = CLOCK_PROFILE_LOW_POWER;
+}
+
+bool clock_profile_register(ClockListener listener){
+    if(listener_count == CLOCK_PROFILE_MAX_LISTENERS){
+        return false;
+    }
+    listeners[listener_count++] = listener;
+    return true;
+}
+
+ClockProfile clock_profile_get(){
+    return current_profile;
+}
+
+static void notify_listeners(ClockChange change, const ClockProfileDesc * desc){
+    uint8_t i;
+    for(i = 0; i < listener_count; i++){
+        listeners[i](change, desc->mclk_hz, desc->smclk_hz);
+    }
+}
+
+#ifndef SOFTWARE_DEBUG
+
+static uint32_t dco_frequency(uint32_t mclk_hz){
+    switch(mclk_hz){
+        case 12000000:
+            return CS_DCO_FREQUENCY_12;
+        case 48000000:
+            return CS_DCO_FREQUENCY_48;
+        default:
+            return CS_DCO_FREQUENCY_3;
+    }
+}
+
+static uint32_t clock_divider(uint8_t divider){
+    return divider == 2 ? CS_CLOCK_DIVIDER_2 : CS_CLOCK_DIVIDER_1;
+}
+
+static void apply_step(ClockStep step, const ClockProfileDesc * old, const ClockProfileDesc * new){
+    switch(step){
+        case CLOCK_STEP_VCORE:
+            PCM_setCoreVoltageLevel(new->vcore ? PCM_VCORE1 : PCM_VCORE0);
+            break;
+        case CLOCK_STEP_WAIT_STATES:
+            FlashCtl_setWaitState(FLASH_BANK0, new->wait_states);
+            FlashCtl_setWaitState(FLASH_BANK1, new->wait_states);
+            break;
+        case CLOCK_STEP_CLOCKS:
+            // SMCLK must never go above 24 MHz, not even between the two writes
+            if(new->mclk_hz > old->mclk_hz){
+                CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, clock_divider(new->smclk_divider));
+                CS_setDCOCenteredFrequency(dco_frequency(new->mclk_hz));
+            }else{
+                CS_setDCOCenteredFrequency(dco_frequency(new->mclk_hz));
+                CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, clock_divider(new->smclk_divider));
+            }
+            break;
+    }
+}
+
+void clock_profile_init(){
+    const ClockProfileDesc * desc = &clock_profiles[CLOCK_PROFILE_LOW_POWER];
+    clock_profile_state_init();
+    PCM_setCoreVoltageLevel(PCM_VCORE0);
+    FlashCtl_setWaitState(FLASH_BANK0, desc->wait_states);
+    FlashCtl_setWaitState(FLASH_BANK1, desc->wait_states);
+    CS_setDCOCenteredFrequency(dco_frequency(desc->mclk_hz));
+    CS_initClockSignal(CS_MCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, clock_divider(desc->smclk_divider));
+}
+
+void clock_profile_retime_timer_a(uint32_t timer, uint32_t smclk_hz){
+    Timer_A_Type * module = (Timer_A_Type *)timer;
+    uint16_t id;
+    switch(clock_profile_timer_divider(smclk_hz)){
+        case 8:
+            id = TIMER_A_CTL_ID__8;
+            break;
+        case 4:
+            id = TIMER_A_CTL_ID__4;
+            break;
+        case 2:
+            id = TIMER_A_CTL_ID__2;
+            break;
+        default:
+            id = TIMER_A_CTL_ID__1;
+            break;
+    }
+    module->EX0 = TIMER_A_EX0_IDEX__1;
+    // the new divider is only used after the divider logic is cleared
+    module->CTL = (module->CTL & ~TIMER_A_CTL_ID_MASK) | id | TIMER_A_CTL_CLR;
+}
+
+#endif
+
+ClockProfile clock_profile_set(ClockProfile profile){
+    ClockProfile previous = current_profile;
+    const ClockProfileDesc * desc = clock_profile_desc(profile);
+    if(desc == NULL || profile == previous){
+        return previous;
+    }
+
+#ifndef SOFTWARE_DEBUG
+    ClockStep steps[CLOCK_PROFILE_MAX_STEPS];
+    uint8_t count = clock_profile_plan(previous, profile, steps);
+    uint8_t i;
+    // no interrupt may use a peripheral while its dividers do not match the clock
+    bool was_disabled = Interrupt_disableMaster();
+#endif
+    notify_listeners(CLOCK_CHANGE_BEFORE, desc);
+#ifndef SOFTWARE_DEBUG
+    for(i = 0; i < count; i++){
+        apply_step(steps[i], clock_profile_desc(previous), desc);
+    }
+#endif
+    current_profile = profile;
+    notify_listeners(CLOCK_CHANGE_AFTER, desc);
+#ifndef SOFTWARE_DEBUG
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+#endif
+    return previous;
+}
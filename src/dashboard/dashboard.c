@@ -0,0 +1,178 @@
+/*
+ * dashboard.c
+ *
+ * Live sensor values on the LCD, redrawn one widget at a time when they change.
+ */
+
+#include "dashboard/dashboard.h"
+#include "observer/observer.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(SOFTWARE_DEBUG) && defined(SCREEN_DASHBOARD)
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/grlib/grlib.h>
+#include "scheduling/scheduler.h"
+#include "LcdDriver/Crystalfontz128x128_ST7735.h"
+#include "LcdDriver/lcd_glyph_cache.h"
+#include "clock/clock_profile.h"
+
+static Graphics_Context * dashboard_gc;
+static task_list_index dashboard_task_index;
+#endif
+
+// widgets changed since the last refresh, bit i is ObservedValue i
+static volatile uint32_t dashboard_pending = 0;
+
+static const char * const dashboard_labels[OBSERVED_VALUE_COUNT] = {
+    [OBSERVED_LIGHT_LUX]       = "Light  : ",
+    [OBSERVED_LIGHT_ON]        = "Lamp   : ",
+    [OBSERVED_TEMPERATURE]     = "Temp   : ",
+    [OBSERVED_AIR_LEVEL]       = "Air    : ",
+    [OBSERVED_TANK_LEVEL]      = "Tank   : ",
+    [OBSERVED_RESERVOIR_LEVEL] = "Reserv.: ",
+    [OBSERVED_PUMP1]           = "Pump 1 : ",
+    [OBSERVED_PUMP2]           = "Pump 2 : ",
+    [OBSERVED_BUZZER]          = "Buzzer : "
+};
+
+void dashboard_state_init(){
+    dashboard_pending = 0;
+}
+
+void dashboard_on_change(ObservedValue id, int32_t value, uint64_t time){
+    // only which widget changed matters, the refresh task reads the value
+    (void)value;
+    (void)time;
+    if(id < OBSERVED_VALUE_COUNT){
+        dashboard_pending |= 1UL << id;
+    }
+}
+
+uint32_t dashboard_take_pending(){
+#if !defined(SOFTWARE_DEBUG) && defined(SCREEN_DASHBOARD)
+    // the callbacks can run in interrupt context
+    bool was_disabled = Interrupt_disableMaster();
+#endif
+    uint32_t pending = dashboard_pending;
+    dashboard_pending = 0;
+#if !defined(SOFTWARE_DEBUG) && defined(SCREEN_DASHBOARD)
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+#endif
+    return pending;
+}
+
+const char * dashboard_label(ObservedValue id){
+    if(id >= OBSERVED_VALUE_COUNT){
+        return "";
+    }
+    return dashboard_labels[id];
+}
+
+uint16_t dashboard_format_value(ObservedValue id, int32_t value, char * buf, uint16_t buf_len){
+    if(buf_len < DASHBOARD_FIELD_LEN + 1){
+        return 0;
+    }
+    int len;
+    switch(id){
+        case OBSERVED_LIGHT_LUX:
+            len = snprintf(buf, buf_len, "%ld lx", (long)value);
+            break;
+        case OBSERVED_TEMPERATURE:
+            len = snprintf(buf, buf_len, "%ld C", (long)value);
+            break;
+        case OBSERVED_AIR_LEVEL:
+            len = snprintf(buf, buf_len, "%ld ppm", (long)value);
+            break;
+        case OBSERVED_TANK_LEVEL:
+        case OBSERVED_RESERVOIR_LEVEL:
+            len = snprintf(buf, buf_len, "%ld", (long)value);
+            break;
+        case OBSERVED_LIGHT_ON:
+        case OBSERVED_PUMP1:
+        case OBSERVED_PUMP2:
+        case OBSERVED_BUZZER:
+            len = snprintf(buf, buf_len, "%s", value ? "ON" : "OFF");
+            break;
+        default:
+            len = 0;
+            break;
+    }
+    if(len < 0){
+        len = 0;
+    }
+    if(len > DASHBOARD_FIELD_LEN){
+        len = DASHBOARD_FIELD_LEN;
+    }
+    // pad with spaces so a shorter value covers the previous one
+    memset(buf + len, ' ', DASHBOARD_FIELD_LEN - len);
+    buf[DASHBOARD_FIELD_LEN] = '\0';
+    return DASHBOARD_FIELD_LEN;
+}
+
+#if !defined(SOFTWARE_DEBUG) && defined(SCREEN_DASHBOARD)
+
+static void dashboard_draw_field(ObservedValue id, const char * text){
+    Crystalfontz128x128_DrawString(dashboard_gc, (const int8_t *)text, DASHBOARD_FIELD_LEN,
+                                   DASHBOARD_FIELD_COL * LCD_GLYPH_WIDTH,
+                                   (DASHBOARD_FIRST_ROW + id) * LCD_GLYPH_HEIGHT);
+}
+
+void dashboard_task(){
+    uint32_t pending = dashboard_take_pending();
+    if(pending == 0){
+        return;
+    }
+
+    char field[DASHBOARD_FIELD_LEN + 1];
+    uint8_t id;
+    // a few fields are cheap to redraw at any clock, switching the profile
+    // would re-init UART, I2C and SPI and retime the timers every refresh
+    for(id = 0; id < OBSERVED_VALUE_COUNT; id++){
+        if(pending & (1UL << id)){
+            dashboard_format_value((ObservedValue)id, observer_get((ObservedValue)id), field, sizeof(field));
+            dashboard_draw_field((ObservedValue)id, field);
+        }
+    }
+    // only the pixels of the changed characters are sent
+    Graphics_flushBuffer(dashboard_gc);
+}
+
+void dashboard_init(Graphics_Context * context){
+    char field[DASHBOARD_FIELD_LEN + 1];
+    uint8_t id;
+    dashboard_gc = context;
+    dashboard_state_init();
+
+    // rendering and diffing the whole screen is CPU bound, burst at 48 MHz
+    ClockProfile previous = clock_profile_set(CLOCK_PROFILE_PERFORMANCE);
+    Graphics_clearDisplay(dashboard_gc);
+    Crystalfontz128x128_DrawStringCentered(dashboard_gc, (const int8_t *)"GREENHOUSE", -1,
+                                           LCD_HORIZONTAL_MAX / 2, LCD_GLYPH_HEIGHT / 2);
+    for(id = 0; id < OBSERVED_VALUE_COUNT; id++){
+        Crystalfontz128x128_DrawString(dashboard_gc, (const int8_t *)dashboard_labels[id], -1,
+                                       0, (DASHBOARD_FIRST_ROW + id) * LCD_GLYPH_HEIGHT);
+        if(observer_has_value((ObservedValue)id)){
+            dashboard_format_value((ObservedValue)id, observer_get((ObservedValue)id), field, sizeof(field));
+            dashboard_draw_field((ObservedValue)id, field);
+        }else{
+            dashboard_draw_field((ObservedValue)id, "--          ");
+        }
+    }
+    Graphics_flushBuffer(dashboard_gc);
+    clock_profile_set(previous);
+
+    observer_register(dashboard_on_change);
+
+    STask task = {
+        .fpointer = dashboard_task,
+        .max_time = DASHBOARD_REFRESH_DEFAULT,
+        .elapsed_time = DASHBOARD_REFRESH_DEFAULT,
+        .is_active = true
+    };
+    dashboard_task_index = push_task(task);
+}
+
+#endif
@@ -0,0 +1,567 @@
+/*
+ * datalog.c
+ *
+ * Block structured data log in flash, see datalog.h
+ */
+
+#include "datalog/datalog.h"
+#include "history/history.h"
+#include "settings/settings_log.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "observer/observer.h"
+#include "scheduling/scheduler.h"
+#include "scheduling/timer.h"
+#include "uart_communication/uart_comm.h"
+#endif
+
+// the seal word comes first in the header, the CRC covers the block after it
+#define SEAL_WORD_SIZE 16
+#define CRC_SIZE 2
+#define PADDING 0xFF
+
+static uint8_t * block_address(const Datalog * log, int16_t index){
+    return log->base + (uint32_t)index * DATALOG_BLOCK_SIZE;
+}
+
+static const DatalogHeader * block_header(const uint8_t * block){
+    return (const DatalogHeader *)block;
+}
+
+static bool block_sealed(const uint8_t * block){
+    uint8_t i;
+    for(i = 0; i < SEAL_WORD_SIZE; i++){
+        if(block[i] != PADDING){
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t datalog_block_bytes(const uint8_t * block){
+    uint16_t length = block_header(block)->length;
+    return length > DATALOG_PAYLOAD_SIZE ? DATALOG_HEADER_SIZE : DATALOG_HEADER_SIZE + length;
+}
+
+bool datalog_block_check(const uint8_t * block, uint16_t len){
+    const DatalogHeader * header = block_header(block);
+    if(len < DATALOG_HEADER_SIZE || header->magic != DATALOG_MAGIC || !block_sealed(block) ||
+       header->length > DATALOG_PAYLOAD_SIZE || len < DATALOG_HEADER_SIZE + header->length){
+        return false;
+    }
+    return settings_log_crc16(block + CRC_SIZE, DATALOG_HEADER_SIZE - CRC_SIZE + header->length) == header->crc;
+}
+
+/*
+    decodes the records in the first limit bytes of the payload, up to the padding or a cut record
+    returns:
+    - the bytes of the records decoded
+*/
+static uint16_t payload_decode(const uint8_t * block, uint16_t limit, DatalogSampleFP fn, void * context, uint16_t * count){
+    const uint8_t * payload = block + DATALOG_HEADER_SIZE;
+    int32_t values[DATALOG_MAX_IDS];
+    uint32_t time = block_header(block)->start_time;
+    uint16_t pos = 0;
+    uint8_t id;
+    int32_t delta;
+    uint32_t elapsed;
+    uint8_t len;
+
+    memset(values, 0, sizeof(values));
+    *count = 0;
+    while(pos < limit && payload[pos] != PADDING){
+        len = history_decode_record(&payload[pos], limit - pos, &id, &delta, &elapsed);
+        if(len == 0 || id >= DATALOG_MAX_IDS){
+            break;
+        }
+        time += elapsed;
+        values[id] = (int32_t)((uint32_t)values[id] + (uint32_t)delta);
+        fn(context, id, time, values[id]);
+        (*count)++;
+        pos += len;
+    }
+    return pos;
+}
+
+uint16_t datalog_block_decode(const uint8_t * block, DatalogSampleFP fn, void * context){
+    uint16_t count;
+    payload_decode(block, block_header(block)->length, fn, context, &count);
+    return count;
+}
+
+void datalog_state_init(Datalog * log, uint8_t * base, uint32_t size, uint32_t sector_size,
+                        DatalogProgramFP program, DatalogEraseFP erase){
+    log->base = base;
+    log->block_count = size / DATALOG_BLOCK_SIZE;
+    log->blocks_per_sector = sector_size / DATALOG_BLOCK_SIZE;
+    log->program = program;
+    log->erase = erase;
+    log->boot = 0;
+    log->oldest = -1;
+    log->newest = -1;
+    log->open = false;
+    log->written = 0;
+    log->stage_len = 0;
+}
+
+// programs the seal word of the open block, from the summary kept in RAM
+static bool block_seal(Datalog * log, uint8_t * block){
+    uint8_t seal[DATALOG_HEADER_SIZE];
+    // the CRC covers the seal word being programmed and the open word and payload in flash
+    memcpy(seal, &log->header, SEAL_WORD_SIZE);
+    memcpy(seal + SEAL_WORD_SIZE, block + SEAL_WORD_SIZE, DATALOG_HEADER_SIZE - SEAL_WORD_SIZE);
+    log->header.crc = settings_log_crc16(seal + CRC_SIZE, DATALOG_HEADER_SIZE - CRC_SIZE);
+    log->header.crc = settings_log_crc16_update(log->header.crc, block + DATALOG_HEADER_SIZE, log->header.length);
+    log->open = false;
+    return log->program(block, &log->header, SEAL_WORD_SIZE);
+}
+
+// summary of the records of a block left open by a reset
+static void recover_sample(void * context, uint8_t id, uint32_t time, int32_t value){
+    DatalogHeader * header = context;
+    (void)value;
+    if(header->count == 0){
+        header->first_time = time;
+    }
+    header->last_time = time;
+    header->mask |= 1U << id;
+    header->count++;
+}
+
+bool datalog_mount(Datalog * log){
+    int16_t i;
+    uint8_t * block;
+    uint16_t programmed;
+    uint16_t count;
+
+    log->oldest = -1;
+    log->newest = -1;
+    log->open = false;
+    for(i = 0; i < log->block_count; i++){
+        const DatalogHeader * header = block_header(block_address(log, i));
+        if(header->magic != DATALOG_MAGIC){
+            continue;
+        }
+        if(log->newest == -1 || header->sequence > block_header(block_address(log, log->newest))->sequence){
+            log->newest = i;
+        }
+        if(log->oldest == -1 || header->sequence < block_header(block_address(log, log->oldest))->sequence){
+            log->oldest = i;
+        }
+    }
+    if(log->newest == -1){
+        log->boot = 0;
+        return true;
+    }
+    block = block_address(log, log->newest);
+    log->boot = block_header(block)->boot + 1;
+    if(block_sealed(block)){
+        return true;
+    }
+
+    // left open by a reset: the payload was programmed a word at a time, records never hold 16 bytes of padding
+    for(programmed = 0; programmed < DATALOG_PAYLOAD_SIZE; programmed += DATALOG_WORD_SIZE){
+        const uint8_t * word = block + DATALOG_HEADER_SIZE + programmed;
+        for(i = 0; i < DATALOG_WORD_SIZE && word[i] == PADDING; i++);
+        if(i == DATALOG_WORD_SIZE){
+            break;
+        }
+    }
+    log->header = *block_header(block);
+    log->header.mask = 0;
+    log->header.count = 0;
+    log->header.first_time = log->header.start_time;
+    log->header.last_time = log->header.start_time;
+    log->header.length = payload_decode(block, programmed, recover_sample, &log->header, &count);
+    return block_seal(log, block);
+}
+
+// opens the block after the newest one, erasing its sector first if the block starts one
+static bool block_open(Datalog * log, uint32_t time){
+    int16_t next = log->newest == -1 ? 0 : (log->newest + 1) % log->block_count;
+    uint32_t sequence = log->newest == -1 ? 1 : block_header(block_address(log, log->newest))->sequence + 1;
+    uint8_t * block = block_address(log, next);
+
+    if(next % log->blocks_per_sector == 0){
+        if(!log->erase(block)){
+            return false;
+        }
+        // the oldest blocks were in the erased sector
+        if(log->oldest >= next && log->oldest < next + log->blocks_per_sector){
+            log->oldest = (next + log->blocks_per_sector) % log->block_count;
+        }
+    }
+    memset(&log->header, PADDING, sizeof(DatalogHeader));
+    log->header.magic = DATALOG_MAGIC;
+    log->header.sequence = sequence;
+    log->header.boot = log->boot;
+    log->header.start_time = time;
+    if(!log->program(block + SEAL_WORD_SIZE, (const uint8_t *)&log->header + SEAL_WORD_SIZE,
+                     DATALOG_HEADER_SIZE - SEAL_WORD_SIZE)){
+        return false;
+    }
+    log->header.mask = 0;
+    log->header.count = 0;
+    log->header.length = 0;
+    log->newest = next;
+    if(log->oldest == -1){
+        log->oldest = next;
+    }
+    log->open = true;
+    log->written = 0;
+    log->stage_len = 0;
+    log->time = time;
+    memset(log->values, 0, sizeof(log->values));
+    return true;
+}
+
+// programs the staged flash word
+static bool stage_flush(Datalog * log){
+    uint8_t * address = block_address(log, log->newest) + DATALOG_HEADER_SIZE + log->written;
+    // the word is used even if programming failed, the CRC tells the host
+    log->written += DATALOG_WORD_SIZE;
+    log->stage_len = 0;
+    return log->program(address, log->stage, DATALOG_WORD_SIZE);
+}
+
+bool datalog_seal(Datalog * log){
+    if(!log->open){
+        return true;
+    }
+    if(log->stage_len > 0){
+        memset((uint8_t *)log->stage + log->stage_len, PADDING, DATALOG_WORD_SIZE - log->stage_len);
+        if(!stage_flush(log)){
+            log->open = false;
+            return false;
+        }
+    }
+    return block_seal(log, block_address(log, log->newest));
+}
+
+bool datalog_append(Datalog * log, uint8_t id, uint32_t time, int32_t value){
+    uint8_t record[DATALOG_MAX_RECORD_LEN];
+    uint8_t len;
+    uint8_t i;
+    bool ok = true;
+    if(id >= DATALOG_MAX_IDS){
+        return false;
+    }
+    if(log->open && time - log->header.start_time >= DATALOG_BLOCK_SPAN_MS){
+        ok = datalog_seal(log);
+    }
+    if(!log->open && !block_open(log, time)){
+        return false;
+    }
+    len = history_encode_record(record, id, (int32_t)((uint32_t)value - (uint32_t)log->values[id]), time - log->time);
+    if(log->header.length + len > DATALOG_PAYLOAD_SIZE){
+        // the first record of a value in a block holds its full value
+        ok = datalog_seal(log) && ok;
+        if(!block_open(log, time)){
+            return false;
+        }
+        len = history_encode_record(record, id, value, 0);
+    }
+    for(i = 0; i < len; i++){
+        ((uint8_t *)log->stage)[log->stage_len++] = record[i];
+        if(log->stage_len == DATALOG_WORD_SIZE){
+            ok = stage_flush(log) && ok;
+        }
+    }
+    if(log->header.count == 0){
+        log->header.first_time = time;
+    }
+    log->header.last_time = time;
+    log->header.mask |= 1U << id;
+    log->header.count++;
+    log->header.length += len;
+    log->time = time;
+    log->values[id] = value;
+    return ok;
+}
+
+bool datalog_range(const Datalog * log, uint32_t * first, uint32_t * last){
+    if(log->newest == -1){
+        return false;
+    }
+    *first = block_header(block_address(log, log->oldest))->sequence;
+    *last = block_header(block_address(log, log->newest))->sequence;
+    if(log->open){
+        if(*last == *first){
+            return false;
+        }
+        (*last)--;
+    }
+    return true;
+}
+
+const uint8_t * datalog_find(const Datalog * log, uint32_t sequence){
+    uint32_t first;
+    uint32_t last;
+    if(!datalog_range(log, &first, &last) || sequence < first || sequence > last){
+        return NULL;
+    }
+    const uint8_t * block = block_address(log, (log->oldest + (sequence - first)) % log->block_count);
+    if(block_header(block)->magic != DATALOG_MAGIC || block_header(block)->sequence != sequence ||
+       !block_sealed(block)){
+        return NULL;
+    }
+    return block;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// sectors 16 to 29 of bank 1
+#define DATALOG_FLASH_SECTOR_MASK (FLASH_SECTOR16 | FLASH_SECTOR17 | FLASH_SECTOR18 | FLASH_SECTOR19 | \
+                                   FLASH_SECTOR20 | FLASH_SECTOR21 | FLASH_SECTOR22 | FLASH_SECTOR23 | \
+                                   FLASH_SECTOR24 | FLASH_SECTOR25 | FLASH_SECTOR26 | FLASH_SECTOR27 | \
+                                   FLASH_SECTOR28 | FLASH_SECTOR29)
+// changes waiting for the task, the observer callbacks may run in interrupts
+#define DATALOG_QUEUE_LEN 32
+// longest reply line, terminator included
+#define DATALOG_LINE_LEN (32 + 2 * DATALOG_LINE_BYTES)
+
+static Datalog datalog;
+
+static struct {
+    uint8_t id;
+    uint32_t time;
+    int32_t value;
+} datalog_queue[DATALOG_QUEUE_LEN];
+static volatile uint8_t datalog_queue_read = 0;
+static volatile uint8_t datalog_queue_write = 0;
+// changes lost because the queue was full
+static volatile uint32_t datalog_queue_dropped = 0;
+// time of the last change queued, the times of the log never go back
+static uint32_t datalog_queue_time = 0;
+
+// block being sent, datalog_send_offset is -1 when no block is being sent
+static uint32_t datalog_send_sequence;
+static volatile int16_t datalog_send_offset = -1;
+
+static bool datalog_flash_program(uint8_t * address, const void * data, uint16_t len){
+    bool ok;
+    FlashCtl_unprotectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, DATALOG_FLASH_SECTOR_MASK);
+    ok = FlashCtl_programMemory((void *)data, address, len);
+    FlashCtl_protectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, DATALOG_FLASH_SECTOR_MASK);
+    return ok;
+}
+
+static bool datalog_flash_erase(uint8_t * sector){
+    bool ok;
+    FlashCtl_unprotectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, DATALOG_FLASH_SECTOR_MASK);
+    ok = FlashCtl_eraseSector((uint32_t)sector);
+    FlashCtl_protectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, DATALOG_FLASH_SECTOR_MASK);
+    return ok;
+}
+
+static void datalog_task();
+
+// queues datalog_task, from the observer callback
+static void datalog_task_schedule(){
+    disable_timer_interrupt();
+    STask t = {
+        datalog_task,
+        0,
+        0,
+        true
+    };
+    enqueue_task(&t);
+    scheduler_state = AWAKE;
+    enable_timer_interrupt();
+}
+
+// observer callback, may be called from an interrupt
+static void datalog_on_change(ObservedValue id, int32_t value, uint64_t time){
+    bool was_disabled = Interrupt_disableMaster();
+    uint8_t next = (datalog_queue_write + 1) % DATALOG_QUEUE_LEN;
+    // a sample dated by a task and queued after one from an interrupt
+    if((int32_t)((uint32_t)time - datalog_queue_time) > 0){
+        datalog_queue_time = time;
+    }
+    if(next == datalog_queue_read){
+        datalog_queue_dropped++;
+    }else{
+        datalog_queue[datalog_queue_write].id = id;
+        datalog_queue[datalog_queue_write].time = datalog_queue_time;
+        datalog_queue[datalog_queue_write].value = value;
+        datalog_queue_write = next;
+        // a burst of changes: drain the queue now instead of at the next period
+        if((next + DATALOG_QUEUE_LEN - datalog_queue_read) % DATALOG_QUEUE_LEN == DATALOG_QUEUE_LEN / 2){
+            datalog_task_schedule();
+        }
+    }
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+// moves the queued changes to flash, programming is slow: it is not done in the observer callbacks
+static void datalog_task(){
+    while(datalog_queue_read != datalog_queue_write){
+        uint8_t read = datalog_queue_read;
+        datalog_append(&datalog, datalog_queue[read].id, datalog_queue[read].time, datalog_queue[read].value);
+        datalog_queue_read = (read + 1) % DATALOG_QUEUE_LEN;
+    }
+    // a quiet block is sealed on time too, so the host can download it
+    if(datalog.open && scheduler_get_uptime() - datalog.header.start_time >= DATALOG_BLOCK_SPAN_MS){
+        datalog_seal(&datalog);
+    }
+}
+
+void datalog_init(){
+    datalog_state_init(&datalog, (uint8_t *)DATALOG_FLASH_START, DATALOG_FLASH_SIZE, DATALOG_FLASH_SECTOR_SIZE,
+                       datalog_flash_program, datalog_flash_erase);
+    datalog_mount(&datalog);
+    observer_register(datalog_on_change);
+
+    STask task = {
+        .fpointer = datalog_task,
+        .max_time = DATALOG_TASK_PERIOD,
+        .elapsed_time = DATALOG_TASK_PERIOD,
+        .is_active = true
+    };
+    push_task(task);
+}
+
+static void datalog_reply(const char * buf, int len, void (*callback)(void)){
+    if(len > 0 && len < DATALOG_LINE_LEN){
+        if(!uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, callback) && callback != NULL){
+            datalog_send_offset = -1;
+        }
+    }
+}
+
+void datalog_info(const char * str){
+    char buf[DATALOG_LINE_LEN];
+    uint32_t first = 0;
+    uint32_t last = 0;
+    datalog_range(&datalog, &first, &last);
+    datalog_reply(buf, snprintf(buf, sizeof(buf), "LOG:%lu,%lu,%u,%lu$",
+                                (unsigned long)first, (unsigned long)last, datalog.boot,
+                                (unsigned long)datalog_queue_dropped), NULL);
+}
+
+static void datalog_line_sent();
+
+// sends the next LOGD line of the block, the following one is queued once it has gone out
+static void datalog_send_task(){
+    char buf[DATALOG_LINE_LEN];
+    const uint8_t * block = datalog_find(&datalog, datalog_send_sequence);
+    int16_t offset = datalog_send_offset;
+    uint16_t bytes;
+    uint16_t i;
+    int len;
+    if(offset < 0){
+        return;
+    }
+    if(block == NULL){
+        // erased by the log wrapping around meanwhile
+        datalog_send_offset = -1;
+        datalog_reply(buf, snprintf(buf, sizeof(buf), "LOG:ERR,%lu$", (unsigned long)datalog_send_sequence), NULL);
+        return;
+    }
+    bytes = datalog_block_bytes(block) - offset;
+    if(bytes > DATALOG_LINE_BYTES){
+        bytes = DATALOG_LINE_BYTES;
+    }
+    len = snprintf(buf, sizeof(buf), "LOGD:%lu,%u,", (unsigned long)datalog_send_sequence, offset);
+    for(i = 0; i < bytes; i++){
+        len += snprintf(buf + len, sizeof(buf) - len, "%02X", block[offset + i]);
+    }
+    len += snprintf(buf + len, sizeof(buf) - len, "$");
+    datalog_send_offset = offset + bytes < datalog_block_bytes(block) ? offset + bytes : -1;
+    datalog_reply(buf, len, datalog_send_offset == -1 ? NULL : datalog_line_sent);
+}
+
+// called from the UART interrupt once a line has been sent
+static void datalog_line_sent(){
+    disable_timer_interrupt();
+    STask t = {
+        datalog_send_task,
+        0,
+        0,
+        true
+    };
+    enqueue_task(&t);
+    scheduler_state = AWAKE;
+    enable_timer_interrupt();
+}
+
+void datalog_get(const char * str){
+    char buf[DATALOG_LINE_LEN];
+    unsigned long sequence = strtoul(str, NULL, 10);
+    const uint8_t * block = datalog_find(&datalog, sequence);
+    // one block at a time, the lines of two would be interleaved
+    if(datalog_send_offset != -1){
+        return;
+    }
+    if(block == NULL){
+        datalog_reply(buf, snprintf(buf, sizeof(buf), "LOG:ERR,%lu$", sequence), NULL);
+        return;
+    }
+    datalog_send_sequence = sequence;
+    datalog_send_offset = 0;
+    datalog_reply(buf, snprintf(buf, sizeof(buf), "LOGB:%lu,%u$", sequence, datalog_block_bytes(block)),
+                  datalog_line_sent);
+}
+
+#ifdef DATALOG_BENCHMARK
+#define BENCHMARK_APPENDS 256
+#define BENCHMARK_BLOCKS 2
+
+// log in RAM for the benchmark, the records must not end up in the real log
+static Datalog benchmark_log;
+static uint32_t benchmark_region[BENCHMARK_BLOCKS * DATALOG_BLOCK_SIZE / 4];
+
+// like flash, programming only clears bits
+static bool benchmark_program(uint8_t * address, const void * data, uint16_t len){
+    uint16_t i;
+    for(i = 0; i < len; i++){
+        address[i] &= ((const uint8_t *)data)[i];
+    }
+    return true;
+}
+
+static bool benchmark_erase(uint8_t * sector){
+    memset(sector, 0xFF, DATALOG_BLOCK_SIZE);
+    return true;
+}
+
+void datalog_benchmark(DatalogBenchmark * result){
+    uint32_t total = 0;
+    uint32_t worst = 0;
+    uint16_t i;
+
+    memset(benchmark_region, 0xFF, sizeof(benchmark_region));
+    datalog_state_init(&benchmark_log, (uint8_t *)benchmark_region, sizeof(benchmark_region), DATALOG_BLOCK_SIZE,
+                       benchmark_program, benchmark_erase);
+    datalog_mount(&benchmark_log);
+
+    Timer32_initModule(TIMER32_1_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT, TIMER32_FREE_RUN_MODE);
+    Timer32_startTimer(TIMER32_1_BASE, false);
+    for(i = 0; i < BENCHMARK_APPENDS; i++){
+        Timer32_setCount(TIMER32_1_BASE, UINT32_MAX);
+        uint32_t start = Timer32_getValue(TIMER32_1_BASE);
+        // a small change every second, like a sensor
+        datalog_append(&benchmark_log, DATALOG_MAX_IDS - 1, (uint32_t)i * 1000, (i & 3) - 1);
+        // the timer counts down, the prescaler is 1: ticks are MCLK cycles
+        uint32_t cycles = start - Timer32_getValue(TIMER32_1_BASE);
+        total += cycles;
+        if(cycles > worst){
+            worst = cycles;
+        }
+    }
+    Timer32_haltTimer(TIMER32_1_BASE);
+    result->append_cycles = total / BENCHMARK_APPENDS;
+    result->worst_cycles = worst;
+}
+#endif
+
+#endif
@@ -5,6 +5,7 @@
 #include "environment_systems/air_quality.h"
 #include "environment_systems/temperature.h"
 #include "environment_systems/buzzer.h"
+#include "observer/observer.h"
 
 #include <stdio.h>
 #include <stdint.h>
@@ -15,7 +16,9 @@
 #ifndef SOFTWARE_DEBUG
 #include "scheduling/scheduler.h"
 #include "IOT/IOT_communication.h"
+#include "IOT/iot_publish.h"
 #include "adc/adc.h"
+#include "clock/clock_profile.h"
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #endif
 
@@ -23,7 +26,7 @@
 
 // Global air quality data structure
 static Air air = {
-    .threshold = 500, // Default air quality threshold (ppm)
+    .threshold = DEFAULT_AIR_THRESHOLD, // Default air quality threshold (ppm)
     .current_level = 0,
     .stack_pos = 0
 };
@@ -32,7 +35,7 @@ static Air air = {
 
 // Global air quality for testing purposes
 static Air air = {
-    .threshold = 500,
+    .threshold = DEFAULT_AIR_THRESHOLD,
     .current_level = 0
 };
 
@@ -104,6 +107,7 @@ void air_set_threshold(uint32_t level){
 
 void air_set_level(uint32_t level){
     air.current_level = level;
+    observer_notify(OBSERVED_AIR_LEVEL, level);
 
 #ifdef DEBUG
     // Debug message to indicate level update
@@ -122,24 +126,8 @@ uint32_t air_get_level(){
 }
 
 bool exceeding_threshold(){
-    // Check if current level exceeds threshold
-    if(air.current_level > air.threshold){
-
-    #ifdef DEBUG
-        // Debug message to indicate threshold has been exceeded
-        printf("Air level %d exceeds threshold %d\n", air.current_level, air.threshold);
-    #endif
-
-        return true;
-    }else{ // If current level is below threshold
-
-        #ifdef DEBUG
-            // Debug message to indicate air quality is within threshold
-            printf("Air level %d is within threshold %d\n", air.current_level, air.threshold);
-        #endif
-
-        return false;
-    }
+    // No logging here, the result is printed by the update functions
+    return air.current_level > air.threshold;
 }
 
 #ifndef SOFTWARE_DEBUG
@@ -172,9 +160,17 @@ void update_air(){
     // Check if the new reading exceeds the safety threshold
     bool exceeding = exceeding_threshold();
 
+#ifdef DEBUG
+    if(exceeding){
+        printf("Air level %d exceeds threshold %d\n", air.current_level, air.threshold);
+    }else{
+        printf("Air level %d is within threshold %d\n", air.current_level, air.threshold);
+    }
+#endif
+
     if(exceeding){ // Turns buzzer on if threshold is exceeding
         // Sending data to IOT system to indicate air quality issue
-        send_data(1,0,2);
+        iot_publish(1, 0, 2, level);
         // Calling function to activate the buzzer if in automatic mode
         if(!get_buzzer_manual_mode()){
             turn_on_buzzer();
@@ -182,7 +178,7 @@ void update_air(){
         
     } else {
         // Sending data to IOT system to indicate air quality is normal
-        send_data(1,0,1);
+        iot_publish(1, 0, 1, level);
         // Calling function to deactivate buzzer if in automatic mode
         if(!get_buzzer_manual_mode()){
             turn_off_buzzer(would_goldilocks_like_this(), exceeding);
@@ -200,6 +196,14 @@ void update_air_hal(uint32_t level){
     // Check if the new reading exceeds the safety threshold
     bool exceeding = exceeding_threshold();
 
+#ifdef DEBUG
+    if(exceeding){
+        printf("Air level %d exceeds threshold %d\n", air.current_level, air.threshold);
+    }else{
+        printf("Air level %d is within threshold %d\n", air.current_level, air.threshold);
+    }
+#endif
+
     if(exceeding){ // Turns buzzer on if threshold is exceeded and in automatic mode 
         // Calling function to activate the buzzer if in automatic mode
         if(!get_buzzer_manual_mode()){
@@ -220,6 +224,8 @@ float calibrateR0(int32_t no_samples) {
     float sumRs = 0.0f;      // Sum of all valid resistance readings
     int valid_samples = 0;   // Count of valid samples (non-zero voltage)
     int i = 0;
+    // The float math of every sample runs in a 48 MHz burst
+    ClockProfile previous = clock_profile_set(CLOCK_PROFILE_PERFORMANCE);
     
 
     // Take multiple samples for averaging
@@ -240,6 +246,7 @@ float calibrateR0(int32_t no_samples) {
             float Rs = RL * ((VCC / Vout) - 1.0f);
             sumRs += Rs;
     }
+    clock_profile_set(previous);
     printf("Sum: %f, samples: %d\n", sumRs, valid_samples);
     
     // Return the average resistance value
@@ -248,7 +255,7 @@ float calibrateR0(int32_t no_samples) {
 
 void update_air_timer(int32_t new_timer){
     // setting the new timer value as specified by user
-    task_list.task_array[air.stack_pos].max_time = new_timer;
+    set_task_period(air.stack_pos, new_timer);
     return;
 }
 #endif
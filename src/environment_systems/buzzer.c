@@ -16,13 +16,13 @@
  * - Manual Mode: User has direct control over buzzer on/off state
  * 
  * HARDWARE CONFIGURATION:
- * - Connected to pin P8.2 (Timer A3, CCR2)
- * - Uses Timer A3 for PWM generation
- * - 1 kHz tone frequency (3 MHz clock / 3000 = 1 kHz)
+ * - Driven by the PWM_BUZZER hardware PWM channel (pin P8.2, Timer A3 CCR2, see pwm/pwm.h)
+ * - 1 kHz tone frequency (3 MHz timer clock / 3000 = 1 kHz)
  * - 50% duty cycle for clear audio output
  */
 
 #include "environment_systems/buzzer.h"
+#include "observer/observer.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -30,54 +30,7 @@
 // HARDWARE-SPECIFIC INCLUDES (only when using hardware)
 #ifndef SOFTWARE_DEBUG
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
-#endif
-
-#ifndef SOFTWARE_DEBUG
-
-/*
- * BUZZER TIMER CONFIGURATION
- * 
- * This configuration sets up Timer A3 to generate the base timing for our PWM signal.
- * The timer counts from 0 up to a specified period value, then resets to 0.
- * When used with compare/capture registers, this creates precise timing for audio generation.
- * 
- * FREQUENCY CALCULATION:
- * - System Clock (SMCLK): 3 MHz
- * - Timer Period: 3000 counts
- * - Output Frequency: 3 MHz / 3000 = 1 kHz
- * 
- * A 1 kHz tone is in the audible range and provides clear alert notification
- * without being too harsh or annoying for continuous operation.
- */
-Timer_A_UpModeConfig buzzerTimerConfig = {
-    .clockSource = TIMER_A_CLOCKSOURCE_SMCLK,              // Use 3 MHz system master clock
-    .clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1,   // No clock division
-    .timerPeriod = 3000,                                   // Count to 3000 for 1 kHz frequency
-    .timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_DISABLE,       // Disable timer overflow interrupts
-    .captureCompareInterruptEnable_CCR0_CCIE = TIMER_A_CCIE_CCR0_INTERRUPT_DISABLE,  // Disable CCR0 interrupts
-    .timerClear = TIMER_A_DO_CLEAR                         // Clear timer when configuring
-};
-
-/*
- * BUZZER PWM CONFIGURATION
- * 
- * This configuration sets up the PWM (Pulse Width Modulation) output that actually
- * drives the buzzer. PWM works by rapidly switching the output pin high and low.
- * The ratio of high-time to total period determines the "duty cycle."
- * 
- * For audio generation:
- * - We use 50% duty cycle (1500 out of 3000 counts)
- * - This creates a square wave with equal high and low periods
- * - Square waves are efficient for driving piezo buzzers
- * - The toggle mode automatically creates the square wave pattern
- */
-Timer_A_CompareModeConfig buzzerPWMConfig = {
-    .compareRegister = BUZZER_CCR,                         // Use CCR2 for P8.2 output
-    .compareInterruptEnable = TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,  // No interrupts needed
-    .compareOutputMode = TIMER_A_OUTPUTMODE_TOGGLE_SET,    // Toggle output on compare match
-    .compareValue = 1500                                   // 50% duty cycle (1500/3000)
-};
-
+#include "pwm/pwm.h"
 #endif
 
 /*
@@ -87,33 +40,20 @@ Timer_A_CompareModeConfig buzzerPWMConfig = {
 void init_buzzer() {
     
 #ifndef SOFTWARE_DEBUG
-    // STEP 1: GPIO CONFIGURATION
-    // Configure pin P8.2 to work with Timer A3's CCR2 output, 
-    // which connects the timer's PWM output directly to the physical buzzer pin
-    
-    GPIO_setAsPeripheralModuleFunctionOutputPin(
-        BUZZER_PORT,                    // Port P8
-        BUZZER_PIN,                     // Pin 2
-        GPIO_PRIMARY_MODULE_FUNCTION    // Primary function = Timer A3.2 output
-    );
-    
-    // STEP 2: TIMER CONFIGURATION
-    // Set up Timer A3 in "up mode" where it counts from 0 to the period value
-    // This creates the base timing for our 1 kHz audio frequency
-    Timer_A_configureUpMode(BUZZER_TIMER, &buzzerTimerConfig);
-    
-    // STEP 3: PWM COMPARE CONFIGURATION
-    // Set up the compare/capture register that creates the actual PWM output
-    // This determines when during each timer cycle the output pin toggles
-    Timer_A_initCompare(BUZZER_TIMER, &buzzerPWMConfig);
+    // STEP 1: PWM CHANNEL CONFIGURATION
+    // The timer counts from 0 to BUZZER_PERIOD (1 kHz with the 3 MHz timer clock, kept
+    // across clock profile switches) and drives the buzzer pin directly
+    // The channel starts stopped with its pin low (buzzer silent)
+    pwm_init(PWM_BUZZER, BUZZER_PERIOD);
     
-    // STEP 4: ENSURE BUZZER STARTS IN OFF STATE
-    // Stop the timer to ensure no PWM output (buzzer silent)
-    Timer_A_stopTimer(BUZZER_TIMER);
+    // STEP 2: 50% DUTY CYCLE
+    // A square wave, high for half of the period and low for the other half,
+    // is efficient for driving piezo buzzers
+    pwm_set(PWM_BUZZER, BUZZER_PERIOD / 2);
     
 #endif
 
-    // STEP 5: INITIALIZE SOFTWARE STATE VARIABLES
+    // STEP 3: INITIALIZE SOFTWARE STATE VARIABLES
     // Set buzzer state to off (no audio output)
     is_on = false;
     
@@ -167,11 +107,12 @@ void turn_on_buzzer() {
     if (!is_on) {
         // Update internal state to reflect buzzer is now active
         is_on = true;
+        observer_notify(OBSERVED_BUZZER, true);
 
 #ifndef SOFTWARE_DEBUG
-        // Starting the PWM timer, to begin the automatic PWM generation that drives the buzzer
+        // Starting the PWM channel, to begin the automatic PWM generation that drives the buzzer
         // The timer will continue running until explicitly stopped
-        Timer_A_startCounter(BUZZER_TIMER, TIMER_A_UP_MODE);
+        pwm_start(PWM_BUZZER);
 #endif
 
 #ifdef DEBUG
@@ -192,11 +133,12 @@ void turn_off_buzzer(int8_t temp, bool air) {
         
         // Update internal state to reflect buzzer is now inactive
         is_on = false;
+        observer_notify(OBSERVED_BUZZER, false);
 
 #ifndef SOFTWARE_DEBUG
         // Stopping the PWM signal generation, silencing the buzzer
-        // The timer hardware goes into idle state until restarted
-        Timer_A_stopTimer(BUZZER_TIMER);
+        // The timer hardware goes into idle state until restarted, with the pin low
+        pwm_stop(PWM_BUZZER);
 #endif
 
 #ifdef DEBUG
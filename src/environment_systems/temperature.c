@@ -23,6 +23,7 @@
 #include "environment_systems/temperature.h"
 #include "environment_systems/air_quality.h"
 #include "environment_systems/buzzer.h"
+#include "observer/observer.h"
 
 #include <stdio.h>
 #include <stdint.h>
@@ -32,6 +33,7 @@
 #ifndef SOFTWARE_DEBUG
 #include "scheduling/scheduler.h"
 #include "IOT/IOT_communication.h"
+#include "IOT/iot_publish.h"
 #include "msp.h"
 #include "../lib/HAL_I2C.h" // I2C communication library for sensor interface
 #endif
@@ -150,6 +152,7 @@ void temp_set_current_temperature(uint8_t temperature) {
 
     // STORE: Update the global temperature state
     ts.current_temperature = temperature;
+    observer_notify(OBSERVED_TEMPERATURE, temperature);
 
    #ifdef DEBUG
     // Logging temperature updates for development monitoring
@@ -160,54 +163,21 @@ void temp_set_current_temperature(uint8_t temperature) {
 
 int8_t would_goldilocks_like_this() {
     
-    // CONDITION 1: TOO COLD - Temperature below acceptable minimum
+    // Only compares the current temperature with the thresholds: no logging and no
+    // IoT message, so any module can call it (the status is published by update_temperature)
+
+    // TOO COLD - Temperature below acceptable minimum
     // Plants may experience stunted growth, frost damage, or metabolic slowdown
     if(ts.current_temperature < ts.lower_threshold){
-
-        #ifdef DEBUG
-        // Logging cold temperature detection for monitoring
-        puts("Temperature is too low\n");
-        #endif
-        
-#ifndef SOFTWARE_DEBUG
-        // Sends "too cold" status to monitoring system thorough IOT
-        send_data(2, 0, 1);
-#endif
-        // -1 indicates temperature is below acceptable range
         return -1;
-        
-    // CONDITION 2: TOO HOT - Temperature above acceptable maximum  
+    }
+    // TOO HOT - Temperature above acceptable maximum
     // Plants may experience heat stress, wilting, or cellular damage
-    }else if(ts.current_temperature > ts.higher_threshold){
-
-        #ifdef DEBUG
-        // Logging hot temperature detection for monitoring
-        puts("Temperature is too high\n");
-        #endif
-        
-#ifndef SOFTWARE_DEBUG
-        // Sends "too hot" status to monitoring system through IOT
-        send_data(2, 0, 3);
-#endif
-        // +1 indicates temperature is above acceptable range
+    if(ts.current_temperature > ts.higher_threshold){
         return 1;
-        
-    // CONDITION 3: JUST RIGHT - Temperature within perfect range
-    // Plants experience optimal growing conditions for photosynthesis and growth
-    }else{
-        
-        #ifdef DEBUG
-            // Log perfect temperature condition for monitoring
-            puts("Temperature is just right\n");
-        #endif
-        
-#ifndef SOFTWARE_DEBUG
-            // Sends "perfect" status to monitoring system
-            send_data(2, 0, 2);
-#endif
-            // 0 indicates temperature is within ideal range
-            return 0;
     }
+    // JUST RIGHT - Temperature within perfect range
+    return 0;
 }
 
 /*
@@ -268,6 +238,23 @@ void update_temperature(){
     // STEP 4: GOLDILOCKS EVALUATION
     int8_t comp = would_goldilocks_like_this();
 
+    #ifdef DEBUG
+    // Logging the evaluation for monitoring
+    if(comp < 0){
+        puts("Temperature is too low\n");
+    }else if(comp > 0){
+        puts("Temperature is too high\n");
+    }else{
+        puts("Temperature is just right\n");
+    }
+    #endif
+
+#ifndef SOFTWARE_DEBUG
+    // Sends the status to the monitoring system through IOT:
+    // 1 = too cold, 2 = perfect, 3 = too hot
+    iot_publish(2, 0, comp + 2, ts.current_temperature);
+#endif
+
     // STEP 5: AUTOMATED ALERT MANAGEMENT
     // Control buzzer alerts based on temperature status and user preferences
     
@@ -295,9 +282,9 @@ void update_temperature(){
 #ifndef SOFTWARE_DEBUG
 void update_temperature_timer(int32_t new_timer){
     
-    // DIRECT SCHEDULER UPDATE: Modify the task timing in the scheduler
-    // Access the specific temperature task in the scheduler's task array
-    // using the stored position (ts.stack_pos) and update its timing
-    task_list.task_array[ts.stack_pos].max_time = new_timer;
+    // SCHEDULER UPDATE: Modify the task timing in the scheduler
+    // The temperature task is found through its stored position (ts.stack_pos),
+    // the period is changed with the scheduler tick masked
+    set_task_period(ts.stack_pos, new_timer);
 }
 #endif
@@ -0,0 +1,424 @@
+/*
+ * history.c
+ *
+ * Delta encoded history of the observed values, see history.h
+ */
+
+#include "history/history.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "scheduling/scheduler.h"
+#include "scheduling/timer.h"
+#include "uart_communication/uart_comm.h"
+#endif
+
+static uint32_t zigzag_encode(int32_t delta){
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t bits){
+    return (int32_t)(bits >> 1) ^ -(int32_t)(bits & 1);
+}
+
+static uint8_t varint_put(uint8_t * out, uint32_t value){
+    uint8_t len = 0;
+    while(value >= 0x80){
+        out[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[len++] = value;
+    return len;
+}
+
+uint8_t history_encode_record(uint8_t * out, uint8_t id, int32_t delta, uint32_t elapsed){
+    uint32_t bits = zigzag_encode(delta);
+    uint8_t len = 1;
+    if(bits < HISTORY_DELTA_ESCAPE){
+        out[0] = (id << 4) | bits;
+    }else{
+        out[0] = (id << 4) | HISTORY_DELTA_ESCAPE;
+        len += varint_put(&out[len], bits);
+    }
+    len += varint_put(&out[len], elapsed);
+    return len;
+}
+
+// reads a varint of at most 5 bytes, returns its length or 0 if it does not end in len bytes
+static uint8_t varint_get(const uint8_t * in, uint16_t len, uint32_t * value){
+    uint8_t i;
+    *value = 0;
+    for(i = 0; i < len && i < 5; i++){
+        *value |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if(!(in[i] & 0x80)){
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t history_decode_record(const uint8_t * in, uint16_t len, uint8_t * id, int32_t * delta, uint32_t * elapsed){
+    uint8_t pos = 1;
+    uint8_t field;
+    uint32_t bits;
+    if(len == 0){
+        return 0;
+    }
+    *id = in[0] >> 4;
+    bits = in[0] & 0x0F;
+    if(bits == HISTORY_DELTA_ESCAPE){
+        field = varint_get(&in[pos], len - pos, &bits);
+        if(field == 0){
+            return 0;
+        }
+        pos += field;
+    }
+    *delta = zigzag_decode(bits);
+    field = varint_get(&in[pos], len - pos, elapsed);
+    if(field == 0){
+        return 0;
+    }
+    return pos + field;
+}
+
+// decodes the record at pos of the ring, returns its length
+static uint16_t record_decode(const History * history, uint16_t pos, uint8_t * id, int32_t * delta, uint32_t * elapsed){
+    uint8_t record[HISTORY_MAX_RECORD_LEN];
+    uint8_t i;
+    for(i = 0; i < HISTORY_MAX_RECORD_LEN; i++){
+        record[i] = history->buf[(pos + i) % history->size];
+    }
+    return history_decode_record(record, HISTORY_MAX_RECORD_LEN, id, delta, elapsed);
+}
+
+static void state_apply(HistoryState * state, uint8_t id, int32_t delta, uint32_t elapsed){
+    state->time += elapsed;
+    // wraps like the subtraction in history_record
+    state->values[id] = (int32_t)((uint32_t)state->values[id] + (uint32_t)delta);
+    state->known |= 1U << id;
+}
+
+static void history_drop_oldest(History * history){
+    uint8_t id;
+    int32_t delta;
+    uint32_t elapsed;
+    uint16_t len = record_decode(history, history->tail, &id, &delta, &elapsed);
+    state_apply(&history->base, id, delta, elapsed);
+    history->tail = (history->tail + len) % history->size;
+    history->used -= len;
+    history->records--;
+    history->dropped++;
+}
+
+void history_state_init(History * history, uint8_t * buf, uint16_t size, uint32_t now){
+    history->buf = buf;
+    history->size = size;
+    history->head = 0;
+    history->tail = 0;
+    history->used = 0;
+    history->records = 0;
+    memset(&history->base, 0, sizeof(HistoryState));
+    history->base.time = now;
+    history->last = history->base;
+    history->dropped = 0;
+}
+
+bool history_record(History * history, uint8_t id, uint32_t time, int32_t value){
+    uint8_t record[HISTORY_MAX_RECORD_LEN];
+    uint8_t len;
+    uint8_t i;
+    if(id >= HISTORY_MAX_IDS){
+        return false;
+    }
+    int32_t delta = (int32_t)((uint32_t)value - (uint32_t)history->last.values[id]);
+    uint32_t elapsed = time - history->last.time;
+    len = history_encode_record(record, id, delta, elapsed);
+
+    while(history->size - history->used < len){
+        history_drop_oldest(history);
+    }
+    for(i = 0; i < len; i++){
+        history->buf[history->head] = record[i];
+        history->head = (history->head + 1) % history->size;
+    }
+    history->used += len;
+    history->records++;
+    state_apply(&history->last, id, delta, elapsed);
+    return true;
+}
+
+/*
+    adds the value held over [start, end) to the windows it overlaps
+    (times relative to the start of the first window); a record at the current time
+    gives an empty segment, it still counts for the minimum and the maximum
+*/
+static void aggregate_segment(HistoryAggregate * out, uint32_t window, uint8_t count,
+                              int64_t start, int64_t end, int32_t value){
+    int64_t total = (int64_t)window * count;
+    bool point = start == end;
+    uint8_t w;
+    if(start < 0){
+        start = 0;
+    }
+    if(end > total){
+        end = total;
+    }
+    if(end < start || (end == start && (!point || start == total))){
+        return;
+    }
+    for(w = start / window; w < count && (int64_t)w * window < end + point; w++){
+        int64_t window_start = (int64_t)w * window;
+        int64_t window_end = window_start + window;
+        int64_t overlap = (end < window_end ? end : window_end) - (start > window_start ? start : window_start);
+        if(value < out[w].min){
+            out[w].min = value;
+        }
+        if(value > out[w].max){
+            out[w].max = value;
+        }
+        out[w].sum += (int64_t)value * overlap;
+        out[w].covered += overlap;
+    }
+}
+
+void history_aggregate(const History * history, uint8_t id, uint32_t from, uint32_t window,
+                       uint8_t count, uint32_t now, HistoryAggregate * out){
+    // only the time and the value of id are followed, not a whole HistoryState (the stack is small)
+    uint32_t time = history->base.time;
+    uint16_t pos = history->tail;
+    uint16_t r;
+    uint8_t record_id;
+    int32_t delta;
+    uint32_t elapsed;
+    uint8_t w;
+
+    if(count > HISTORY_MAX_WINDOWS){
+        count = HISTORY_MAX_WINDOWS;
+    }
+    for(w = 0; w < count; w++){
+        out[w].min = INT32_MAX;
+        out[w].max = INT32_MIN;
+        out[w].covered = 0;
+        out[w].records = 0;
+        out[w].sum = 0;
+    }
+    bool known = id < HISTORY_MAX_IDS && (history->base.known & (1U << id));
+    int32_t value = history->base.values[id < HISTORY_MAX_IDS ? id : 0];
+    uint32_t since = time;
+
+    for(r = 0; r < history->records; r++){
+        pos = (pos + record_decode(history, pos, &record_id, &delta, &elapsed)) % history->size;
+        time += elapsed;
+        if(record_id != id){
+            continue;
+        }
+        // a value replaced at the same time was never held
+        if(known && time != since){
+            aggregate_segment(out, window, count, (int64_t)since - from, (int64_t)time - from, value);
+        }
+        known = true;
+        // wraps like state_apply
+        value = (int32_t)((uint32_t)value + (uint32_t)delta);
+        since = time;
+        int64_t at = (int64_t)time - from;
+        if(at >= 0 && at < (int64_t)window * count){
+            out[at / window].records++;
+        }
+    }
+    if(known){
+        aggregate_segment(out, window, count, (int64_t)since - from, (int64_t)now - from, value);
+    }
+
+    for(w = 0; w < count; w++){
+        if(out[w].min > out[w].max){
+            // never known during the window
+            out[w].min = 0;
+            out[w].max = 0;
+            out[w].avg = 0;
+        }else if(out[w].covered == 0){
+            out[w].avg = out[w].min;
+        }else{
+            out[w].avg = out[w].sum / (int64_t)out[w].covered;
+        }
+    }
+}
+
+uint8_t history_query_windows(const HistoryQuery * query){
+    uint32_t windows = (query->to - query->from - 1) / query->window + 1;
+    return windows > HISTORY_MAX_WINDOWS ? HISTORY_MAX_WINDOWS : windows;
+}
+
+// parses an unsigned number followed by the given character
+static const char * parse_field(const char * str, char end, uint32_t * value){
+    uint64_t number = 0;
+    if(*str < '0' || *str > '9'){
+        return NULL;
+    }
+    while(*str >= '0' && *str <= '9'){
+        number = number * 10 + (*str - '0');
+        if(number > UINT32_MAX){
+            return NULL;
+        }
+        str++;
+    }
+    if(*str != end){
+        return NULL;
+    }
+    *value = number;
+    return end == '\0' ? str : str + 1;
+}
+
+bool history_parse_query(const char * str, HistoryQuery * query){
+    uint32_t id;
+    HistoryQuery parsed;
+    str = parse_field(str, ',', &id);
+    if(str != NULL){
+        str = parse_field(str, ',', &parsed.from);
+    }
+    if(str != NULL){
+        str = parse_field(str, ',', &parsed.to);
+    }
+    if(str != NULL){
+        str = parse_field(str, '\0', &parsed.window);
+    }
+    if(str == NULL || id >= OBSERVED_VALUE_COUNT || parsed.to <= parsed.from || parsed.window == 0){
+        return false;
+    }
+    parsed.id = id;
+    *query = parsed;
+    return true;
+}
+
+uint16_t history_format_window(char * buf, uint16_t len, uint8_t index, const HistoryAggregate * aggregate){
+    int written;
+    if(aggregate->covered == 0 && aggregate->records == 0){
+        written = snprintf(buf, len, "HST:%u,,,,%u$", index, aggregate->records);
+    }else{
+        written = snprintf(buf, len, "HST:%u,%ld,%ld,%ld,%u$", index, (long)aggregate->min,
+                           (long)aggregate->max, (long)aggregate->avg, aggregate->records);
+    }
+    if(written < 0 || written >= len){
+        return 0;
+    }
+    return written;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// longest line of a reply, terminator included
+#define HISTORY_LINE_LEN 64
+
+static uint8_t history_buf[HISTORY_BUF_LEN];
+static History history;
+
+// windows of the query being sent, history_next is -1 when no query is in progress
+static HistoryAggregate history_windows[HISTORY_MAX_WINDOWS];
+static uint8_t history_window_count;
+static volatile int16_t history_next = -1;
+// ring state the windows are computed from, kept off the stack
+static History history_snapshot;
+
+// observer callback, may be called from an interrupt
+static void history_on_change(ObservedValue id, int32_t value, uint64_t time){
+    bool was_disabled = Interrupt_disableMaster();
+    uint32_t ms = time;
+    // a sample dated by a task and recorded after one from an interrupt
+    if((int32_t)(ms - history.last.time) < 0){
+        ms = history.last.time;
+    }
+    history_record(&history, id, ms, value);
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+void history_init(){
+    history_state_init(&history, history_buf, HISTORY_BUF_LEN, 0);
+    observer_register(history_on_change);
+}
+
+static void history_line_sent();
+
+// sends the next HST line, the following one is queued once it has gone out
+static void history_send_task(){
+    char buf[HISTORY_LINE_LEN];
+    int16_t index = history_next;
+    uint16_t len;
+    if(index < 0 || index >= history_window_count){
+        history_next = -1;
+        return;
+    }
+    history_next = index + 1;
+    len = history_format_window(buf, sizeof(buf), index, &history_windows[index]);
+    if(len == 0 || !uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, history_line_sent)){
+        history_next = -1;
+    }
+}
+
+// called from the UART interrupt once a line has been sent
+static void history_line_sent(){
+    disable_timer_interrupt();
+    STask t = {
+        history_send_task,
+        0,
+        0,
+        true
+    };
+    enqueue_task(&t);
+    scheduler_state = AWAKE;
+    enable_timer_interrupt();
+}
+
+void history_query(const char * str){
+    char buf[HISTORY_LINE_LEN];
+    HistoryQuery query;
+    bool consistent;
+    uint8_t tries = 0;
+    int len;
+
+    // one query at a time, the lines of two would be interleaved
+    if(history_next != -1){
+        return;
+    }
+    if(!history_parse_query(str, &query)){
+        len = snprintf(buf, sizeof(buf), "HIST:ERR$");
+        uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, NULL);
+        return;
+    }
+    history_window_count = history_query_windows(&query);
+    // the records are decoded with interrupts enabled, from a copy of the ring state: new records
+    // only go in the free space, unless older ones are dropped meanwhile, then it is done again
+    do{
+        bool was_disabled = Interrupt_disableMaster();
+        // the state after the newest record is not needed to decode the ring
+        history_snapshot.buf = history.buf;
+        history_snapshot.size = history.size;
+        history_snapshot.tail = history.tail;
+        history_snapshot.records = history.records;
+        history_snapshot.base = history.base;
+        history_snapshot.dropped = history.dropped;
+        uint32_t now = scheduler_get_uptime();
+        if(!was_disabled){
+            Interrupt_enableMaster();
+        }
+        history_aggregate(&history_snapshot, query.id, query.from, query.window, history_window_count, now, history_windows);
+        was_disabled = Interrupt_disableMaster();
+        consistent = history.dropped == history_snapshot.dropped;
+        if(!was_disabled){
+            Interrupt_enableMaster();
+        }
+    }while(!consistent && ++tries < 3);
+
+    history_next = 0;
+    len = snprintf(buf, sizeof(buf), "HIST:%u,%lu,%lu,%u$", query.id, (unsigned long)query.from,
+                   (unsigned long)query.window, history_window_count);
+    if(!uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, history_line_sent)){
+        history_next = -1;
+    }
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "light_system/growing_light.h"
+#include "observer/observer.h"
+#include "light_system/light_pid.h"
 
 // Standard C library includes for basic functionality
 #include <stdio.h>    // For printf() and other input/output functions
@@ -9,11 +11,14 @@
 #ifndef SOFTWARE_DEBUG
 #include "scheduling/scheduler.h"      // For task scheduling functionality
 #include "IOT/IOT_communication.h"    // For sending data to IoT systems
+#include "IOT/iot_publish.h"
 
 // Hardware-specific includes for MSP432 microcontroller
 #include "msp.h"                                           // MSP432 basic definitions
 #include "ti/devices/msp432p4xx/driverlib/driverlib.h"     // TI driver library
 #include "../lib/HAL_I2C.h"                                // I2C communication library
+#include "pwm/pwm.h"                                       // Hardware PWM output driving the lights
+#include "scheduling/calendar.h"                           // Wall clock for the photoperiod
 #endif
 
 // Global variable: Our grow light system state, which holds all the important information
@@ -24,6 +29,8 @@ GrowLight gl = {
     .threshold = DEFAULT_THRESHOLD,    // Light level that triggers our lights
     .manual_mode = false,              // Start in automatic mode
     .on = false,                       // Lights are initially off
+    .last_lux = 0,                     // No sensor reading yet
+    .closed_loop = false,              // Proportional law
     .stack_pos = 0                     // Position in the task scheduler
 };
 #else
@@ -32,32 +39,14 @@ GrowLight gl = {
     .current_brightness = 0,           // Start with lights off
     .threshold = DEFAULT_THRESHOLD,    // Light level threshold
     .manual_mode = false,              // Start in automatic mode
-    .on = false                        // Lights are initially off
+    .on = false,                       // Lights are initially off
+    .last_lux = 0,                     // No sensor reading yet
+    .closed_loop = false               // Proportional law
 };
 #endif
 
-// Only compiles when we're using real hardware
-#ifndef SOFTWARE_DEBUG
-
-// Timer configuration for PWM (Pulse Width Modulation), which controls the brightness of the grow lights,
-// determined by the ratio of on-time to off-time
-const Timer_A_UpModeConfig upConfig_led = {
-    .clockSource = TIMER_A_CLOCKSOURCE_SMCLK,              // Use system master clock
-    .clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1,   // Don't divide the clock
-    .timerPeriod = PWM_PERIOD,                             // How long each PWM cycle takes
-    .timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_ENABLE,        // Enable timer interrupts
-    .captureCompareInterruptEnable_CCR0_CCIE = TIMER_A_CCIE_CCR0_INTERRUPT_DISABLE,  // Disable CCR0 interrupts
-    .timerClear = TIMER_A_DO_CLEAR                         // Clear timer when starting
-};
-
-// PWM compare configuration, which determines the brightness level
-Timer_A_CompareModeConfig compareConfig_led = {
-    .compareRegister = TIMER_A_CAPTURECOMPARE_REGISTER_1,               // Use CCR1 register
-    .compareInterruptEnable = TIMER_A_CAPTURECOMPARE_INTERRUPT_ENABLE,  // Enable interrupts
-    .compareOutputMode = TIMER_A_OUTPUTMODE_RESET_SET,                  // Reset/Set output mode for PWM
-    .compareValue = 0                                                   // Start with 0% duty cycle (off)
-};
-#endif
+// PID controller of the closed loop mode
+static LightPid gl_pid;
 
 /**
  * @brief Sets up the entire grow light system
@@ -69,6 +58,9 @@ Timer_A_CompareModeConfig compareConfig_led = {
  * - Create a scheduled task that will run our light control logic
  */
 void grow_light_init() {
+    // The closed loop controller outputs a brightness between off and full
+    light_pid_init(&gl_pid, LIGHT_PID_KP, LIGHT_PID_KI, LIGHT_PID_KD, 0, MAX_BRIGHTNESS);
+
 #ifndef SOFTWARE_DEBUG
     // STEP 1: Initialize I2C communication for the OPT3001 light sensor
     // I2C is a communication protocol that lets us talk to the sensor
@@ -78,19 +70,17 @@ void grow_light_init() {
     // STEP 2: Configure GPIO (General Purpose Input/Output) pins
     // These pins control our physical LED lights
     
-    // Set up the PWM output pin (P7.7) to connect to Timer_A1.1
-    GPIO_setAsPeripheralModuleFunctionOutputPin(CCR1_PORT, CCR1_PIN, GPIO_PRIMARY_MODULE_FUNCTION);
-    
     // Set up the basic LED control pin (P1.0) as a simple output
+    // It shows whether the lights are on, the brightness itself is on the PWM output
     GPIO_setAsOutputPin(LED_PORT, LED_PIN);
     
     // Make sure the LED starts in the OFF state
     GPIO_setOutputLowOnPin(LED_PORT, LED_PIN);
 
-    // STEP 3: Initialize and configure Timer_A1 for PWM control
-    // PWM (Pulse Width Modulation) controls brightness by rapidly switching on/off
-    Timer_A_configureUpMode(TIMER_A1_BASE, &upConfig_led);     // Set up the timer
-    Timer_A_initCompare(TIMER_A1_BASE, &compareConfig_led);    // Set up PWM compare
+    // STEP 3: Configure the hardware PWM channel of the lights
+    // PWM (Pulse Width Modulation) controls brightness by rapidly switching on/off,
+    // the timer output does it on its own so no interrupt runs for each cycle
+    pwm_init(PWM_GROW_LIGHT, PWM_PERIOD);
 
     // STEP 4: Create and schedule the light update task
     // This task will run every 10.5 seconds to check light levels and adjust our grow lights
@@ -104,6 +94,10 @@ void grow_light_init() {
     // Add our task to the system scheduler and remember where it is
     gl.stack_pos = push_task(light_task);
 
+    // STEP 5: Update the lights as soon as the photoperiod starts and ends
+    calendar_add(CALENDAR_EVERY_DAY, PHOTOPERIOD_START_HOUR, 0, update_light);
+    calendar_add(CALENDAR_EVERY_DAY, PHOTOPERIOD_END_HOUR, 0, update_light);
+
 #ifdef DEBUG
     puts("Added light task to scheduler");   // Debug message (only shows if DEBUG is enabled)
 #endif
@@ -158,19 +152,24 @@ static uint32_t calculate_brightness(uint32_t sensor_val) {
     return ((gl.threshold - sensor_val) * MAX_BRIGHTNESS) / gl.threshold;
 }
 
+static uint32_t calculate_pid_brightness(uint32_t sensor_val) {
+    // The threshold is the light level to keep, our own lights included
+    return light_pid_update(&gl_pid, gl.threshold, sensor_val);
+}
+
 static void send_light_level_data(uint32_t sensor_val) {
     // Only send data when we're using real hardware (not in software debug mode)
 #ifndef SOFTWARE_DEBUG
     // Determine what category of light level we have and send appropriate code
     if (sensor_val < MIN_BRIGHTNESS) {
         // It's dark - send "dark" signal
-        send_data(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_DARK);
+        iot_publish(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_DARK, sensor_val);
     } else if (sensor_val < MAX_BRIGHTNESS) {
         // It's medium brightness - send "medium" signal  
-        send_data(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_MEDIUM);
+        iot_publish(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_MEDIUM, sensor_val);
     } else {
         // It's bright - send "bright" signal
-        send_data(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_BRIGHT);
+        iot_publish(IOT_LIGHT_SENSOR_ID, 0, IOT_LIGHT_BRIGHT, sensor_val);
     }
 #endif
 }
@@ -181,18 +180,20 @@ static void control_hardware_light(bool should_be_on) {
     if (should_be_on && !gl.on) {
         // Turn lights ON
         gl.on = true;  // Update our state tracking
-        Timer_A_startCounter(TIMER_A1_BASE, TIMER_A_UP_MODE);  // Start PWM timer
+        pwm_start(PWM_GROW_LIGHT);                     // Start the PWM output
+        GPIO_setOutputHighOnPin(LED_PORT, LED_PIN);    // Show that the lights are on
     } else if (!should_be_on && gl.on) {
         // Turn lights OFF
         gl.on = false;  // Update our state tracking
-        Timer_A_stopTimer(TIMER_A1_BASE);              // Stop PWM timer
-        Timer_A_clearInterruptFlag(TIMER_A1_BASE);     // Clear any pending interrupts
+        pwm_set(PWM_GROW_LIGHT, 0);                    // Fade in from zero when turned on again
+        pwm_stop(PWM_GROW_LIGHT);                      // Stop the PWM output, its pin goes low
         GPIO_setOutputLowOnPin(LED_PORT, LED_PIN);     // Make sure LED pin is off
     }
 #else
     // In software debug mode, just update our state variable
     gl.on = should_be_on;
 #endif
+    observer_notify(OBSERVED_LIGHT_ON, gl.on);
 }
 
 /********************************************
@@ -215,6 +216,14 @@ bool grow_light_get_mode() {
     return gl.manual_mode;
 }
 
+bool grow_light_get_closed_loop() {
+    return gl.closed_loop;
+}
+
+uint32_t grow_light_get_lux() {
+    return gl.last_lux;
+}
+
 /********************************************
  *                  SETTER FUNCTIONS       *
  ********************************************/
@@ -228,9 +237,9 @@ void grow_light_set_brightness(uint32_t brightness) {
     gl.current_brightness = brightness;
 
 #ifndef SOFTWARE_DEBUG
-    // Update the hardware PWM timer with the new brightness value
-    // This actually changes how bright the LED lights are
-    Timer_A_setCompareValue(TIMER_A1_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_1, brightness);
+    // Fade the hardware PWM duty to the new brightness value (scaled to the PWM period)
+    // The timer changes it by a small step at the end of each PWM cycle, so the lights never jump
+    pwm_fade(PWM_GROW_LIGHT, pwm_duty_counts(brightness, MAX_BRIGHTNESS, PWM_PERIOD), GROW_LIGHT_FADE_STEP);
 #endif
 
 #ifdef DEBUG
@@ -273,6 +282,10 @@ void grow_light_set_mode(int32_t manual_mode) {
     
     // Update our internal state
     gl.manual_mode = enable_manual;
+    if (!enable_manual) {
+        // The closed loop controller continues from the brightness it left
+        light_pid_reset(&gl_pid, gl.current_brightness);
+    }
 
 #ifdef DEBUG
     printf("Manual mode %s\n", enable_manual ? "enabled" : "disabled");
@@ -281,16 +294,31 @@ void grow_light_set_mode(int32_t manual_mode) {
 #ifndef SOFTWARE_DEBUG
     // Control the automatic timer based on the mode
     if (enable_manual) {
-        // Entering manual mode: Stop the automatic timer
-        Timer_A_stopTimer(TIMER_A1_BASE);           // Stop the timer
-        Timer_A_clearInterruptFlag(TIMER_A1_BASE);  // Clear any pending interrupts
+        // Entering manual mode: Stop the automatic PWM output
+        pwm_stop(PWM_GROW_LIGHT);
     } else {
-        // Entering automatic mode: Start the automatic timer
-        Timer_A_startCounter(TIMER_A1_BASE, TIMER_A_UP_MODE);
+        // Entering automatic mode: Start the automatic PWM output at the automatic brightness
+        pwm_start(PWM_GROW_LIGHT);
+        pwm_fade(PWM_GROW_LIGHT, pwm_duty_counts(gl.current_brightness, MAX_BRIGHTNESS, PWM_PERIOD), GROW_LIGHT_FADE_STEP);
     }
 #endif
 }
 
+void grow_light_set_closed_loop(int32_t closed_loop) {
+    bool enable = (closed_loop != 0);
+    if (enable == gl.closed_loop) {
+        return;  // Exit early - already using the requested law
+    }
+
+    // Start the controller from the current brightness (bumpless transfer)
+    light_pid_reset(&gl_pid, gl.current_brightness);
+    gl.closed_loop = enable;
+
+#ifdef DEBUG
+    printf("Light control %s\n", enable ? "closed loop" : "proportional");
+#endif
+}
+
 void power_on_or_off(int32_t on) {
     // Safety check: Only allow manual control when in manual mode
     if (!gl.manual_mode) {
@@ -307,14 +335,18 @@ void power_on_or_off(int32_t on) {
 
     // Update our internal state
     gl.on = desired_state;
+    observer_notify(OBSERVED_LIGHT_ON, gl.on);
 
 #ifndef SOFTWARE_DEBUG
     // Control the actual hardware based on desired state
     if (desired_state) {
-        // Turn lights ON: Set the GPIO pin high (3.3V)
+        // Turn lights ON: full duty on the PWM output and the LED pin high (3.3V)
+        pwm_set(PWM_GROW_LIGHT, PWM_PERIOD);
+        pwm_start(PWM_GROW_LIGHT);
         GPIO_setOutputHighOnPin(LED_PORT, LED_PIN);
     } else {
-        // Turn lights OFF: Set the GPIO pin low (0V)
+        // Turn lights OFF: PWM output and LED pin low (0V)
+        pwm_stop(PWM_GROW_LIGHT);
         GPIO_setOutputLowOnPin(LED_PORT, LED_PIN);
     }
 #endif
@@ -342,14 +374,26 @@ void update_light() {
     
     // STEP 2: Process the raw sensor data into a meaningful light level
     uint32_t sensor_val = process_sensor_data(raw);
+    gl.last_lux = sensor_val;               // Remember it for the telemetry frames
+    observer_notify(OBSERVED_LIGHT_LUX, sensor_val);
     
 #ifdef DEBUG
     // Show the processed sensor reading (only if debug is enabled)
     printf("Sensor value: %d\n", sensor_val);
 #endif
 
-    // STEP 3: Calculate how bright our grow lights should be
-    uint32_t calculated_brightness = calculate_brightness(sensor_val);
+    // STEP 3: Calculate how bright our grow lights should be (off outside the photoperiod,
+    // which is only known once the clock has been set)
+    uint32_t calculated_brightness;
+    if (calendar_time_valid() &&
+        !calendar_now_in_window(PHOTOPERIOD_START_HOUR * 60, PHOTOPERIOD_END_HOUR * 60)) {
+        calculated_brightness = 0;
+        light_pid_reset(&gl_pid, 0);        // The controller starts from off in the morning
+    } else if (gl.closed_loop) {
+        calculated_brightness = calculate_pid_brightness(sensor_val);
+    } else {
+        calculated_brightness = calculate_brightness(sensor_val);
+    }
     
     // STEP 4: Determine if lights should be on (any brightness > 0 means "on")
     bool should_be_on = (calculated_brightness > 0);
@@ -371,12 +415,15 @@ void update_light_hal(uint32_t raw) {
 
     // STEP 1: Process the simulated sensor data into a meaningful light level
     uint32_t sensor_val = process_sensor_data(raw);
+    gl.last_lux = sensor_val;               // Remember it for the telemetry frames
+    observer_notify(OBSERVED_LIGHT_LUX, sensor_val);
     
     // STEP 2: Display the processed sensor reading (always show in simulation mode)
     printf("Sensor value: %d\n", sensor_val);
 
     // STEP 3: Calculate how bright our grow lights should be
-    uint32_t calculated_brightness = calculate_brightness(sensor_val);
+    uint32_t calculated_brightness = gl.closed_loop ? calculate_pid_brightness(sensor_val)
+                                                    : calculate_brightness(sensor_val);
     
     // STEP 4: Determine if lights should be on
     bool should_be_on = (calculated_brightness > 0);
@@ -392,35 +439,12 @@ void update_light_hal(uint32_t raw) {
 
 #ifndef SOFTWARE_DEBUG
 
-void TA1_N_IRQHandler(void) {
-    // Handle CCR1 interrupt (timer reached the "compare" value)
-    // This happens when it's time to turn the LED OFF during a PWM cycle
-    if (Timer_A_getCaptureCompareInterruptStatus(TIMER_A1_BASE,
-                                                 TIMER_A_CAPTURECOMPARE_REGISTER_1,
-                                                 TIMER_A_CAPTURECOMPARE_INTERRUPT_FLAG)) {
-        // Clear the interrupt flag (tell hardware we handled this interrupt)
-        Timer_A_clearCaptureCompareInterrupt(TIMER_A1_BASE,
-                                             TIMER_A_CAPTURECOMPARE_REGISTER_1);
-        // Turn the LED off for the remainder of this PWM cycle
-        GPIO_setOutputLowOnPin(LED_PORT, LED_PIN);
-    }
-    
-    // Handle timer overflow interrupt (timer reached its maximum and reset to 0)
-    // This happens at the start of each PWM cycle - time to turn LED ON
-    if (TIMER_A1->CTL & TIMER_A_CTL_IFG) {
-        // Clear the interrupt flag
-        TIMER_A1->CTL &= ~TIMER_A_CTL_IFG;
-        // Turn the LED on for the start of this PWM cycle
-        GPIO_setOutputHighOnPin(LED_PORT, LED_PIN);
-    }
-}
-
 void update_light_timer(int32_t new_timer) {
     // Input validation: Make sure the new timer value makes sense
     if (new_timer > 0) {
         // Update the timer value for our light control task in the scheduler
         // gl.stack_pos remembers where our task is stored in the task list
-        task_list.task_array[gl.stack_pos].max_time = new_timer;
+        set_task_period(gl.stack_pos, new_timer);
     }
     // If new_timer is 0 or negative, we ignore it (invalid input)
 }
@@ -0,0 +1,54 @@
+/*
+ * light_pid.c
+ *
+ * Fixed point PID controller, see light_pid.h
+ */
+
+#include "light_system/light_pid.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+static int64_t clamp64(int64_t value, int64_t min, int64_t max){
+    if(value < min){
+        return min;
+    }
+    if(value > max){
+        return max;
+    }
+    return value;
+}
+
+void light_pid_init(LightPid * pid, int32_t kp, int32_t ki, int32_t kd, int32_t out_min, int32_t out_max){
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->out_min = out_min;
+    pid->out_max = out_max;
+    light_pid_reset(pid, out_min);
+}
+
+void light_pid_reset(LightPid * pid, int32_t output){
+    pid->integral = clamp64(output, pid->out_min, pid->out_max) << LIGHT_PID_Q;
+    pid->last_measurement = 0;
+    pid->primed = false;
+}
+
+int32_t light_pid_update(LightPid * pid, int32_t setpoint, int32_t measurement){
+    int64_t error = (int64_t)setpoint - measurement;
+    int64_t out_min = (int64_t)pid->out_min << LIGHT_PID_Q;
+    int64_t out_max = (int64_t)pid->out_max << LIGHT_PID_Q;
+    int64_t derivative = 0;
+
+    if(pid->primed){
+        // on the measurement: a new setpoint does not make the output jump
+        derivative = -(int64_t)pid->kd * ((int64_t)measurement - pid->last_measurement);
+    }
+    pid->last_measurement = measurement;
+    pid->primed = true;
+
+    // clamped, so it does not wind up while the output is saturated
+    pid->integral = clamp64(pid->integral + (int64_t)pid->ki * error, out_min, out_max);
+
+    int64_t output = (int64_t)pid->kp * error + pid->integral + derivative;
+    return clamp64(output, out_min, out_max) >> LIGHT_PID_Q;
+}
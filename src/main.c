@@ -33,18 +33,32 @@
 #include "water_management/water_init.h"
 #include "water_management/water_reading.h"
 #include "water_management/pump_management.h"
+#include "IOT/IOT_communication.h"
+#include "IOT/iot_publish.h"
+#include "IOT/iot_tx_queue.h"
 
 // SYSTEM INFRASTRUCTURE INCLUDES
 #include "scheduling/scheduler.h"
 #include "scheduling/timer.h"
+#include "scheduling/calendar.h"
+#include "scheduling/uptime.h"
 #include "option_menu/option_menu.h"
 #include "option_menu/options.h"
+#include "settings/settings_log.h"
 #include "uart_communication/uart_comm.h"
 #include "adc/adc.h"
+#include "telemetry/telemetry.h"
+#include "observer/observer.h"
+#include "history/history.h"
+#include "datalog/datalog.h"
+#include "dashboard/dashboard.h"
+#include "clock/clock_profile.h"
+#include "power/idle.h"
 
 // HARDWARE ABSTRACTION LAYER INCLUDES
 #include "../lib/HAL_I2C.h"                        // I2C communication library
 #include "../include/LcdDriver/Crystalfontz128x128_ST7735.h"  // LCD driver
+#include "../include/LcdDriver/lcd_glyph_cache.h"              // Cached text rendering
 
 // STANDARD C LIBRARY
 #include <stdio.h>                                 // Standard input/output functions
@@ -79,29 +93,82 @@ void _graphicsInit() {
     GrContextFontSet(&g_sContext, &g_sFontFixed6x8);                // Font size and style
     
     // STEP 5: Clear the display to start with a blank screen
+    // (the driver draws in its scene buffer, flushing sends the changes to the LCD)
     Graphics_clearDisplay(&g_sContext);
+    Graphics_flushBuffer(&g_sContext);
 }
 
-/*****************************************
- *   USER INTERFACE MENU CONFIGURATION   *
- *****************************************/
+#if defined(SCREEN_OPTION_MENU_WORKS) && defined(LCD_GLYPH_BENCHMARK)
+/**
+ * @brief Measures text drawing speed through grlib and through the glyph cache
+ *
+ * The result is sent through UART as "GLYPH:<chars>,<grlib chars/s>,<cache chars/s>$".
+ * Must be called after _graphicsInit and uart_init.
+ */
+void _glyphBenchmark() {
+    LcdGlyphBenchmark result;
+    char buf[48];
+
+    lcd_glyph_benchmark(&g_sContext, &result);
+    int len = snprintf(buf, sizeof(buf), "GLYPH:%lu,%lu,%lu$",
+                       (unsigned long)result.chars,
+                       (unsigned long)result.grlib_cps,
+                       (unsigned long)result.cache_cps);
+    if (len > 0 && len < sizeof(buf)) {
+        uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, NULL);
+    }
+}
+#endif
 
+#ifdef DATALOG_BENCHMARK
 /**
- * @brief Creates and configures all user interface menu options
- * 
- * This function builds the complete menu system that allows users to:
- * - Control and configure the grow light system
- * - Adjust temperature monitoring settings
- * - Configure air quality monitoring
- * - Control the alert buzzer
- * - Manage water system settings
- * 
- * Each menu option is linked to a specific control function that gets called
- * when the user changes that setting.
+ * @brief Measures the cost of appending a record to the data log
+ *
+ * The records go to a log simulated in RAM, the log in flash is left alone.
+ * The result is sent through UART as "LOGCYC:<average cycles>,<worst cycles>$".
+ * Must be called after datalog_init and uart_init.
  */
-void add_tasks_to_option_menu() {
-    int err;  // Error flag for option creation validation
+void _datalogBenchmark() {
+    DatalogBenchmark result;
+    char buf[32];
+
+    datalog_benchmark(&result);
+    int len = snprintf(buf, sizeof(buf), "LOGCYC:%lu,%lu$",
+                       (unsigned long)result.append_cycles,
+                       (unsigned long)result.worst_cycles);
+    if (len > 0 && len < sizeof(buf)) {
+        uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, NULL);
+    }
+}
+#endif
+
+#if defined(IOT_CYCLE_BENCHMARK) && !defined(IOT_LINK_V2)
+/**
+ * @brief Measures the cost of send_data against the previous per-pin implementation
+ *
+ * The result is sent through UART as "IOTCYC:<legacy cycles>,<table cycles>$".
+ * Must be called after init_GPIOs_IOT and uart_init.
+ */
+void _iotBenchmark() {
+    IotBenchmark result;
+    char buf[32];
+
+    iot_benchmark(&result);
+    int len = snprintf(buf, sizeof(buf), "IOTCYC:%lu,%lu$",
+                       (unsigned long)result.legacy_cycles,
+                       (unsigned long)result.table_cycles);
+    if (len > 0 && len < sizeof(buf)) {
+        uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, NULL);
+    }
+}
+#endif
+
+/*****************************************
+ *   USER INTERFACE MENU CONFIGURATION   *
+ *****************************************/
 
+// Options of the modules configured here, the water, telemetry and IoT modules have their own tables
+static const OptionDesc system_options[] = {
     /*
      * LIGHT SYSTEM CONFIGURATION SECTION
      */
@@ -110,43 +177,42 @@ void add_tasks_to_option_menu() {
      * GROW LIGHT POWER CONTROL
      * Allows manual on/off control of the grow lights (only works in manual mode)
      */
-    OptionUnion opt_led_s_power = option_u_new_switch(false);  // Create switch, initially off
-    Option leds_switch = option_new("power leds",              // Display name in menu
-                                   SWITCH,                      // Type of control (on/off switch)
-                                   opt_led_s_power,            // The switch value
-                                   power_on_or_off,            // Function to call when changed
-                                   to_string_switch_default);  // How to display the value
-    option_menu_push_option(leds_switch);  // Add to the menu
+    OPTION_SWITCH(OPTION_ID_POWER_LEDS,
+                  "power leds",                 // Display name in menu
+                  false,                        // Initially off
+                  power_on_or_off,              // Function to call when changed
+                  to_string_switch_default),    // How to display the value
 
     /*
      * LIGHT CONTROL MODE SELECTION
      * Switches between automatic (sensor-controlled) and manual (user-controlled) modes
      */
-    OptionUnion opt_led_s_mode = option_u_new_switch(false);   // Create switch for mode
-    Option leds_manual = option_new("light mode",              // Display name
-                                   SWITCH,                      // Switch type
-                                   opt_led_s_mode,             // Switch value
-                                   grow_light_set_mode,        // Function to change mode
-                                   to_string_manual_auto);     // Display "Manual/Auto"
-    option_menu_push_option(leds_manual);
+    OPTION_SWITCH(OPTION_ID_LIGHT_MODE,
+                  "light mode",                 // Display name
+                  false,                        // Automatic
+                  grow_light_set_mode,          // Function to change mode
+                  to_string_manual_auto),       // Display "Manual/Auto"
+
+    /*
+     * LIGHT CONTROL LAW SELECTION
+     * Switches the automatic mode between the proportional law and the PID controller
+     * keeping the measured light level at the threshold
+     */
+    OPTION_SWITCH(OPTION_ID_LIGHT_CLOSED_LOOP,
+                  "light closed loop",          // Display name
+                  false,                        // Proportional by default
+                  grow_light_set_closed_loop,   // Function to change the law
+                  to_string_switch_default),    // Display "ON/OFF"
 
     /*
      * LIGHT SENSOR UPDATE TIMER
      * Controls how often the system checks the light sensor and updates grow lights
      */
-    OptionUnion opt_led_t = option_u_new_timer("10s", &err);   // Default: check every 10 seconds
-    if (err == 1) {  // Check if the timer value was invalid
-        #ifdef DEBUG
-        puts("10s is not on the list of possible timing values\n");
-        #endif
-        return;  // Exit if we can't create this option
-    }
-    Option leds_timer = option_new("light timer",              // Display name
-                                  TIMER,                        // Timer type control
-                                  opt_led_t,                   // Timer value
-                                  update_light_timer,          // Function to update timer
-                                  to_string_timer_default);    // How to display timer value
-    option_menu_push_option(leds_timer);
+    OPTION_TIMER(OPTION_ID_LIGHT_TIMER,
+                 "light timer",                 // Display name
+                 10000,                         // Default: check every 10 seconds
+                 update_light_timer,            // Function to update timer
+                 to_string_timer_default),      // How to display timer value
 
     /*
      * LIGHT BRIGHTNESS THRESHOLD
@@ -154,23 +220,14 @@ void add_tasks_to_option_menu() {
      * Higher values -> grow lights turn on in darker conditions
      * Lower values -> grow lights only turn on when it's very dark
      */
-    OptionUnion opt_led_thr = option_u_new_threshold(grow_light_get_threshold(), // Current threshold
-                                                    MIN_BRIGHTNESS,              // Minimum allowed value
-                                                    MAX_BRIGHTNESS,              // Maximum allowed value
-                                                    20,                          // Step size for adjustment
-                                                    &err);                       // Error flag
-    if (err == 1) {  // Check if current threshold is out of range
-        #ifdef DEBUG
-        puts("Current threshold exceeds the range\n");
-        #endif
-        return;
-    }
-    Option leds_threshold = option_new("change light threshold", // Display name
-                                    THRESHOLD,                   // Threshold adjustment control
-                                    opt_led_thr,                 // Threshold settings
-                                    grow_light_set_threshold,    // Function to update threshold
-                                    to_string_threshold_default);// How to display threshold
-    option_menu_push_option(leds_threshold);
+    OPTION_THRESHOLD(OPTION_ID_LIGHT_THRESHOLD,
+                     "change light threshold",  // Display name
+                     DEFAULT_THRESHOLD,         // Default threshold of the grow light
+                     MIN_BRIGHTNESS,            // Minimum allowed value
+                     MAX_BRIGHTNESS,            // Maximum allowed value
+                     20,                        // Step size for adjustment
+                     grow_light_set_threshold,  // Function to update threshold
+                     to_string_threshold_default), // How to display threshold
 
     /*
      * TEMPERATURE SYSTEM CONFIGURATION SECTION
@@ -180,86 +237,52 @@ void add_tasks_to_option_menu() {
      * TEMPERATURE SENSOR UPDATE TIMER
      * Controls how often the system checks temperature sensors
      */
-    OptionUnion opt_temp_t = option_u_new_timer("5s", &err);  // Check every 5 seconds
-    if (err == 1) {
-        #ifdef DEBUG
-        puts("5s is not on the list of possible timing values\n");
-        #endif
-        return;
-    }
-    Option temp_timer = option_new("temp sensor timer",         // Display name
-                                  TIMER,                        // Timer control
-                                  opt_temp_t,                  // Timer value
-                                  update_temperature_timer,    // Function to update timer
-                                  to_string_timer_default);    // Display format
-    option_menu_push_option(temp_timer);
+    OPTION_TIMER(OPTION_ID_TEMP_TIMER,
+                 "temp sensor timer",           // Display name
+                 5000,                          // Check every 5 seconds
+                 update_temperature_timer,      // Function to update timer
+                 to_string_timer_default),      // Display format
 
     /*
      * HIGH TEMPERATURE THRESHOLD
      * Temperature level that triggers cooling or alerts (e.g., turn on fans, open vents)
      */
-    OptionUnion opt_temp_higher_thr = option_u_new_threshold(temp_get_higher_threshold(), // Current value
-                                                            0,                           // Minimum (0°C)
-                                                            42,                          // Maximum (42°C)
-                                                            5,                           // Step size (5°C)
-                                                            &err);
-    if (err == 1) {
-        #ifdef DEBUG
-        puts("Current threshold exceeds the range\n");
-        #endif
-        return;
-    }
-    Option temp_higher_threshold = option_new("change temp higher threshold",
-                                             THRESHOLD,
-                                             opt_temp_higher_thr,
-                                             temp_set_higher_threshold,
-                                             to_string_threshold_default);
-    option_menu_push_option(temp_higher_threshold);
+    OPTION_THRESHOLD(OPTION_ID_TEMP_HIGHER_THRESHOLD,
+                     "change temp higher threshold",
+                     DEFAULT_HIGHER_THRESHOLD,  // Default value
+                     0,                         // Minimum (0°C)
+                     42,                        // Maximum (42°C)
+                     5,                         // Step size (5°C)
+                     temp_set_higher_threshold,
+                     to_string_threshold_default),
 
     /*
-     * LOW TEMPERATURE THRESHOLD  
+     * LOW TEMPERATURE THRESHOLD
      * Temperature level that triggers alerts indicating it's too cold
      */
-    OptionUnion opt_temp_lower_thr = option_u_new_threshold(temp_get_lower_threshold(),
-                                                           0,      // Minimum (0°C)
-                                                           40,     // Maximum (42°C)  
-                                                           5,      // Step size (5°C)
-                                                           &err);
-    if (err == 1) {
-        #ifdef DEBUG
-        puts("Current threshold exceeds the range\n");
-        #endif
-        return;
-    }
-    Option temp_lower_threshold = option_new("change temp lower threshold",
-                                            THRESHOLD,
-                                            opt_temp_lower_thr,
-                                            temp_set_lower_threshold,
-                                            to_string_threshold_default);
-    option_menu_push_option(temp_lower_threshold);
+    OPTION_THRESHOLD(OPTION_ID_TEMP_LOWER_THRESHOLD,
+                     "change temp lower threshold",
+                     DEFAULT_LOWER_THRESHOLD,   // Default value
+                     0,                         // Minimum (0°C)
+                     40,                        // Maximum (42°C)
+                     5,                         // Step size (5°C)
+                     temp_set_lower_threshold,
+                     to_string_threshold_default),
 
     /*
      * AIR QUALITY SENSOR CONFIGURATION SECTION
      */
-    
+
     /*
      * AIR QUALITY SENSOR UPDATE TIMER
      * Controls how often the system checks air quality sensors
      * Air quality changes more slowly than temperature, so we check less frequently
      */
-    OptionUnion opt_air_t = option_u_new_timer("20s", &err);  // Check every 20 seconds
-    if (err == 1) {
-        #ifdef DEBUG
-        puts("20s is not on the list of possible timing values\n");
-        #endif
-        return;
-    }
-    Option air_timer = option_new("air system timer",      // Display name
-                                 TIMER,                    // Timer control
-                                 opt_air_t,                // Timer value  
-                                 update_air_timer,         // Function to update timer
-                                 to_string_timer_default); // Display format
-    option_menu_push_option(air_timer);
+    OPTION_TIMER(OPTION_ID_AIR_TIMER,
+                 "air system timer",            // Display name
+                 20000,                         // Check every 20 seconds
+                 update_air_timer,              // Function to update timer
+                 to_string_timer_default),      // Display format
 
     /*
      * AIR QUALITY THRESHOLD
@@ -267,23 +290,14 @@ void add_tasks_to_option_menu() {
      * Higher values = more sensitive (triggers at better air quality)
      * Lower values = less sensitive (only triggers when air is poor)
      */
-    OptionUnion opt_air_thr = option_u_new_threshold(air_get_threshold(), // Current threshold
-                                                    0,                    // Minimum value
-                                                    50,                   // Maximum value  
-                                                    5,                    // Step size
-                                                    &err);
-    if (err == 1) {
-        #ifdef DEBUG
-        puts("Current threshold exceeds the range\n");
-        #endif
-        return;
-    }
-    Option air_threshold = option_new("change air threshold",      // Display name
-                                     THRESHOLD,                    // Threshold control
-                                     opt_air_thr,                 // Threshold settings
-                                     air_set_threshold,           // Function to update threshold
-                                     to_string_threshold_default); // Display format
-    option_menu_push_option(air_threshold);
+    OPTION_THRESHOLD(OPTION_ID_AIR_THRESHOLD,
+                     "change air threshold",    // Display name
+                     DEFAULT_AIR_THRESHOLD,     // Default threshold
+                     0,                         // Minimum value
+                     50,                        // Maximum value
+                     5,                         // Step size
+                     air_set_threshold,         // Function to update threshold
+                     to_string_threshold_default), // Display format
 
     /*
      * BUZZER/ALERT SYSTEM CONFIGURATION SECTION
@@ -293,30 +307,57 @@ void add_tasks_to_option_menu() {
      * BUZZER POWER CONTROL
      * Manual on/off control for the alert buzzer
      */
-    OptionUnion opt_buzzer_s_power = option_u_new_switch(false);   // Initially off
-    Option buzzer_switch = option_new("power buzzer",             // Display name
-                                     SWITCH,                       // Switch control
-                                     opt_buzzer_s_power,          // Switch value
-                                     manual_power_buzzer,         // Function to control buzzer
-                                     to_string_switch_default);   // Display format
-    option_menu_push_option(buzzer_switch);  // Fixed: was adding leds_switch instead
+    OPTION_SWITCH(OPTION_ID_POWER_BUZZER,
+                  "power buzzer",               // Display name
+                  false,                        // Initially off
+                  manual_power_buzzer,          // Function to control buzzer
+                  to_string_switch_default),    // Display format
 
     /*
      * BUZZER MODE CONTROL
      * Switches between automatic (triggered by system alerts) and manual modes
      */
-    OptionUnion opt_buzzer_s_mode = option_u_new_switch(false);
-    Option buzzer_manual = option_new("buzzer mode",              // Display name
-                                     SWITCH,                      // Switch control
-                                     opt_buzzer_s_mode,          // Switch value
-                                     set_buzzer_mode,            // Function to change mode
-                                     to_string_manual_auto);     // Display "Manual/Auto"
-    option_menu_push_option(buzzer_manual);  // Fixed: was adding leds_manual instead
+    OPTION_SWITCH(OPTION_ID_BUZZER_MODE,
+                  "buzzer mode",                // Display name
+                  false,                        // Automatic
+                  set_buzzer_mode,              // Function to change mode
+                  to_string_manual_auto)        // Display "Manual/Auto"
+};
+
+/**
+ * @brief Creates and configures all user interface menu options
+ * 
+ * This function builds the complete menu system that allows users to:
+ * - Control and configure the grow light system
+ * - Adjust temperature monitoring settings
+ * - Configure air quality monitoring
+ * - Control the alert buzzer
+ * - Manage water system settings
+ * 
+ * Each menu option is linked to a specific control function that gets called
+ * when the user changes that setting. The options are described by const
+ * tables (kept in flash), see option_menu/options.h.
+ */
+void add_tasks_to_option_menu() {
+    // The descriptors stay in flash, only the values are copied to the option list
+    option_menu_push_options(system_options, sizeof(system_options) / sizeof(system_options[0]));
 
     /*
      * WATER SYSTEM CONFIGURATION SECTION
      */
     add_water_options();  // This function is defined in the water management module
+
+    /*
+     * TELEMETRY CONFIGURATION SECTION
+     * How often the snapshot frame with all the sensor values is sent through UART
+     */
+    add_telemetry_options();  // This function is defined in the telemetry module
+
+    /*
+     * IOT CONFIGURATION SECTION
+     * How often an unchanged sensor state is repeated to the IoT receiver
+     */
+    add_iot_publish_options();  // This function is defined in the IoT publication module
 }
 
 /**************************************
@@ -348,17 +389,17 @@ void _hwInit() {
     // This prevents interrupts from firing before everything is properly set up
     Interrupt_disableMaster();
 
+    // Forget every value observer before the modules start notifying their values
+    observer_init();
+    // Record the changes of the observed values in RAM, for the history queries (see history/history.h)
+    history_init();
+
     // STEP 2: CLOCK SYSTEM CONFIGURATION
     
-    // Set the main CPU clock (DCO - Digitally Controlled Oscillator) to 3 MHz
-    // This determines how fast the microcontroller processes instructions
-    CS_setDCOCenteredFrequency(CS_DCO_FREQUENCY_3);
-    
-    // Configure SMCLK (Sub-Main Clock) to also run at 3 MHz
-    // SMCLK is used by peripheral modules like timers and communication interfaces
-    CS_initClockSignal(CS_SMCLK,           // Which clock signal to configure
-                      CS_DCOCLK_SELECT,    // Use DCO as the source
-                      CS_CLOCK_DIVIDER_1); // Don't divide the frequency (keep it at 3 MHz)
+    // Start in the low power profile: CPU clock (MCLK) and peripheral clock (SMCLK) at 3 MHz
+    // The drivers initialized below register to recompute their dividers when the profile
+    // changes, so heavy work can run in a 48 MHz burst (see clock/clock_profile.h)
+    clock_profile_init();
 
     // STEP 3: CORE SYSTEM SERVICES INITIALIZATION
     
@@ -368,6 +409,18 @@ void _hwInit() {
     
     // Initialize system timing functions used by the scheduler
     timer_init();
+
+    // Sleep between tasks in the deepest state the active peripherals allow
+    // (starts the 32 kHz clock measuring the sleeps and the residency report)
+    idle_init();
+
+    // Monotonic uptime clock on the 32 kHz clock, keeps counting in LPM3: dates the sensor samples
+    // and the scheduler uptime (see scheduling/uptime.h)
+    uptime_init();
+
+    // Wall clock on the RTC (32 kHz clock) for the rules run at a time of day, like the photoperiod
+    // of the grow lights; the modules below add their rules (see scheduling/calendar.h)
+    calendar_init();
     
     // Initialize ADC (Analog-to-Digital Converter) for reading analog sensors
     // This allows us to read continuous values like temperature, light levels, etc.
@@ -376,7 +429,12 @@ void _hwInit() {
     // STEP 4: USER INTERFACE INITIALIZATION
     
     // Initialize the option menu system
-    // _graphicsInit();
+#if defined(SCREEN_OPTION_MENU_WORKS) && defined(SCREEN_DASHBOARD)
+#error "the option menu and the dashboard cannot share the screen"
+#endif
+#if defined(SCREEN_OPTION_MENU_WORKS) || defined(SCREEN_DASHBOARD)
+    _graphicsInit();
+#endif
 
     // Set up the menu system that allows users to configure system settings
     option_menu_init(&g_sContext);  // Pass the graphics context for display
@@ -392,6 +450,10 @@ void _hwInit() {
     
     // Initialize IoT communication GPIO pins for sending data to external systems
     init_GPIOs_IOT();
+    // The IoT messages are queued and sent by a task, the sensor tasks never wait for the receiver
+    iot_tx_init();
+    // Only changed sensor states (and periodic heartbeats) reach the IoT pins
+    iot_publish_init();
     
     // UART communication initialization
     // This sets up serial communication with the computer running the python script
@@ -414,11 +476,38 @@ void _hwInit() {
     // Initialize water management system (pumps, sensors, irrigation control)
     water_init();
 
+    // Start the periodic telemetry frames (needs UART and every module above)
+    telemetry_init();
+
+#ifdef SCREEN_DASHBOARD
+    // Show the live sensor values on the screen (the option menu stays on UART)
+    dashboard_init(&g_sContext);
+#endif
+
+#if defined(IOT_CYCLE_BENCHMARK) && !defined(IOT_LINK_V2)
+    // Optional IoT pin encoding benchmark, the result is sent once interrupts are enabled
+    _iotBenchmark();
+#endif
+
+#if defined(SCREEN_OPTION_MENU_WORKS) && defined(LCD_GLYPH_BENCHMARK)
+    // Optional text rendering benchmark, the result is sent once interrupts are enabled
+    _glyphBenchmark();
+#endif
+
+    // Restore the option values saved in flash, before any task runs (see settings/settings_log.h)
+    settings_init();
+    option_menu_load_settings();
+
+    // Append the changes of the observed values to the data log in flash, kept across resets for
+    // the host to download (see datalog/datalog.h)
+    datalog_init();
+#ifdef DATALOG_BENCHMARK
+    // Optional data log append benchmark, the result is sent once interrupts are enabled
+    _datalogBenchmark();
+#endif
+
     // STEP 7: INTERRUPT SYSTEM ACTIVATION
     
-    // Enable specific interrupt for Timer_A1 (used by the grow light PWM system)
-    Interrupt_enableInterrupt(INT_TA1_N);
-    
     // Re-enable global interrupts - system is now ready to respond to events
     // This MUST be the last step - everything must be initialized before enabling interrupts
     Interrupt_enableMaster();
@@ -474,14 +563,15 @@ void main(void) {
         if (scheduler_state == AWAKE) {
             // Runs the task scheduler
             scheduler();
+        } else {
+            // Nothing to run: sleep until the next interrupt
+            // The system will wake up automatically when:
+            // - A timer expires (time for the next sensor reading)
+            // - A user presses a button
+            // - An interrupt occurs
+            // LPM3 is only used when no peripheral needs the fast clocks, see power/idle.h
+            idle_sleep();
         }
-        
-        // Note: When scheduler_state != AWAKE, the system enters a low-power mode
-        // This saves battery power when no immediate tasks need to be performed
-        // The system will wake up automatically when:
-        // - A timer expires (time for the next sensor reading)
-        // - A user presses a button
-        // - An interrupt occurs
     }
     return;
 }
@@ -0,0 +1,80 @@
+/*
+ * observer.c
+ *
+ * Change notification for the module values, see observer.h
+ */
+
+#include "observer/observer.h"
+#include "scheduling/uptime.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+static ObserverCallback callbacks[OBSERVER_MAX_CALLBACKS];
+static uint8_t callback_count = 0;
+
+static volatile int32_t last_values[OBSERVED_VALUE_COUNT];
+static volatile uint64_t last_times[OBSERVED_VALUE_COUNT];
+// bit i is set once value i has been notified at least once
+static volatile uint32_t notified = 0;
+
+void observer_init(){
+    uint8_t i;
+    callback_count = 0;
+    notified = 0;
+    for(i = 0; i < OBSERVED_VALUE_COUNT; i++){
+        last_values[i] = 0;
+        last_times[i] = 0;
+    }
+}
+
+bool observer_register(ObserverCallback callback){
+    if(callback_count == OBSERVER_MAX_CALLBACKS){
+        return false;
+    }
+    callbacks[callback_count++] = callback;
+    return true;
+}
+
+void observer_notify(ObservedValue id, int32_t value){
+    if(id >= OBSERVED_VALUE_COUNT){
+        return;
+    }
+    uint64_t time = uptime_now_ms();
+    last_times[id] = time;
+    if((notified & (1UL << id)) && last_values[id] == value){
+        return;
+    }
+    last_values[id] = value;
+    notified |= 1UL << id;
+
+    uint8_t i;
+    for(i = 0; i < callback_count; i++){
+        callbacks[i](id, value, time);
+    }
+}
+
+int32_t observer_get(ObservedValue id){
+    if(id >= OBSERVED_VALUE_COUNT){
+        return 0;
+    }
+    return last_values[id];
+}
+
+bool observer_has_value(ObservedValue id){
+    if(id >= OBSERVED_VALUE_COUNT){
+        return false;
+    }
+    return (notified & (1UL << id)) != 0;
+}
+
+uint64_t observer_get_time(ObservedValue id){
+    uint64_t time;
+    if(id >= OBSERVED_VALUE_COUNT){
+        return 0;
+    }
+    // two words: read again if an interrupt notified the value in between
+    do{
+        time = last_times[id];
+    }while(time != last_times[id]);
+    return time;
+}
@@ -7,11 +7,17 @@
 
 #include "option_menu/option_menu.h"
 #include "option_menu/option_menu_input.h"
+#include "option_menu/option_menu_dirty.h"
 #include "scheduling/scheduler.h"
+#include "scheduling/timer.h"
+#include "settings/settings_log.h"
 #include "uart_communication/uart_comm.h"
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/grlib/grlib.h>
 #include <stdio.h>
+#ifdef SCREEN_OPTION_MENU_WORKS
+#include "LcdDriver/Crystalfontz128x128_ST7735.h"
+#endif
 
 Graphics_Context * gc;
 
@@ -20,16 +26,40 @@ struct {
    task_list_index display_on_screen;
 } option_menu_tasks;
 
-int32_t option_menu_push_option(Option option) {
-    if (option_list.len == MAX_OPTIONS) {
+#if MAX_OPTIONS > OPTION_DIRTY_MAX_OPTIONS
+#error "the change tracker cannot hold MAX_OPTIONS options"
+#endif
+
+// what must be drawn again and which values must be confirmed
+static OptionMenuDirty option_menu_dirty = {
+    .redraw = true
+};
+
+void option_menu_mark_dirty(){
+    option_dirty_mark_redraw(&option_menu_dirty);
+}
+
+int32_t option_menu_push_option(const OptionDesc * desc) {
+    if (option_list.len == MAX_OPTIONS ||
+        option_find_by_id(option_list.arr, option_list.len, desc->id) != -1) {
         return -1;
     }
-    option_list.arr[option_list.len] = option;
+    option_list.arr[option_list.len] = option_from_desc(desc);
     if (current_setting == -1) {
         current_setting = 0;
     }
+    option_dirty_mark_redraw(&option_menu_dirty);
     return option_list.len++;
 }
+int32_t option_menu_push_options(const OptionDesc * table, int32_t count) {
+    int32_t i;
+    for (i = 0; i < count; i++) {
+        if (option_menu_push_option(&table[i]) == -1) {
+            break;
+        }
+    }
+    return i;
+}
 int32_t option_menu_pop_option() {
     if (current_setting == option_list.len) {
         current_setting--;
@@ -38,12 +68,15 @@ int32_t option_menu_pop_option() {
         return -1;
     }
     option_list.len--;
+    option_dirty_forget(&option_menu_dirty, option_list.len);
+    option_dirty_mark_redraw(&option_menu_dirty);
     return 1;
 }
 
 void option_menu_init_option_list() {
     option_list.len = 0;
     current_setting = 0;
+    option_dirty_init(&option_menu_dirty);
 
 }
 
@@ -51,6 +84,7 @@ int option_menu_nav_next_option(){
     if ( current_setting >= option_list.len-1){
         return -1;
     }
+    option_dirty_mark_redraw(&option_menu_dirty);
     return ++current_setting;
 
 }
@@ -59,39 +93,113 @@ int option_menu_nav_prev_option(){
         return -1;
     }
 
+    option_dirty_mark_redraw(&option_menu_dirty);
     return --current_setting;
 
 }
 
 void option_menu_decrement_current(){
     if(current_setting == -1){return;}
-    option_decrement(&option_list.arr[current_setting]);
+    Option * curr = &option_list.arr[current_setting];
+    int32_t old_value = option_get_value(curr);
+    option_decrement(curr);
+    // values clamped at the minimum don't need to be redrawn nor confirmed
+    if(option_get_value(curr) != old_value){
+        option_dirty_mark_changed(&option_menu_dirty, current_setting);
+    }
 }
 void option_menu_increment_current(){
     if(current_setting == -1){return;}
-    option_increment(&option_list.arr[current_setting]);
+    Option * curr = &option_list.arr[current_setting];
+    int32_t old_value = option_get_value(curr);
+    option_increment(curr);
+    if(option_get_value(curr) != old_value){
+        option_dirty_mark_changed(&option_menu_dirty, current_setting);
+    }
 }
 
+int32_t option_menu_set_value(int32_t index, int32_t value){
+    if(index < 0 || index >= option_list.len){
+        return -1;
+    }
+    Option * option = &option_list.arr[index];
+    int32_t old_value = option_get_value(option);
+    if(option_set_value(option, value) == -1){
+        return -1;
+    }
+    if(option_get_value(option) != old_value){
+        option_dirty_mark_changed(&option_menu_dirty, index);
+    }
+    return 1;
+}
 
 void option_change_confirm(){
-    int i;
-    for (i =0;i<option_list.len;i++){
-        if(option_list.arr[i].changed){
-            option_list.arr[i].on_change_action(option_get_value(&option_list.arr[i]));
-            option_list.arr[i].changed = false;
+    uint32_t pending[OPTION_DIRTY_WORDS];
+    uint32_t bits;
+    int32_t i;
+    int w;
+
+    // the actions change task periods: they all run with the scheduler tick masked,
+    // so the tick never sees only part of the new configuration
+    disable_timer_interrupt();
+    option_dirty_take_changed(&option_menu_dirty, pending);
+    for (w = 0; w < OPTION_DIRTY_WORDS; w++){
+        // only the changed options are visited, lowest index first
+        for (bits = pending[w]; bits != 0; bits &= bits - 1){
+            i = w * 32 + __CLZ(__RBIT(bits));
+            option_list.arr[i].desc->on_change_action(option_get_value(&option_list.arr[i]));
+        }
+    }
+    enable_timer_interrupt();
+
+    // kept across resets, nothing is written if the stored value is the same;
+    // flash writes are slow, they are done with the tick running
+    for (w = 0; w < OPTION_DIRTY_WORDS; w++){
+        for (bits = pending[w]; bits != 0; bits &= bits - 1){
+            i = w * 32 + __CLZ(__RBIT(bits));
+            settings_save(option_list.arr[i].desc->id, option_get_value(&option_list.arr[i]));
         }
     }
-    return;
+}
+
+// the settings are stored with the id of the option as key
+static void option_menu_apply_setting(uint16_t key, int32_t value){
+    int32_t i = key > UINT8_MAX ? -1 : option_find_by_id(option_list.arr, option_list.len, key);
+    // a value no longer valid for the option (e.g. its range changed) is ignored
+    if(i != -1 && option_set_value(&option_list.arr[i], value) == 1){
+        option_dirty_mark_changed(&option_menu_dirty, i);
+    }
+}
+
+// the records of removed options, and the hashed keys of the older logs, are not kept by the compactions
+static bool option_menu_keep_setting(uint16_t key){
+    return key <= UINT8_MAX && option_find_by_id(option_list.arr, option_list.len, key) != -1;
+}
+
+void option_menu_load_settings(){
+    settings_replay(option_menu_apply_setting);
+    settings_set_filter(option_menu_keep_setting);
+    // each restored option runs its action once, with its latest value
+    option_change_confirm();
+    option_dirty_mark_redraw(&option_menu_dirty);
 }
 
 
 void option_menu_draw_current_option(){
+    if(!option_dirty_needs_redraw(&option_menu_dirty)){
+        return;
+    }
     #ifdef SCREEN_OPTION_MENU_WORKS
+    option_dirty_drawn(&option_menu_dirty);
+    // the driver draws in its frame buffer: only the pixels that differ from the
+    // previous frame are sent to the display when the buffer is flushed
     Graphics_clearDisplay(gc);
 
+    // text goes through the driver's glyph cache, one burst per line on the next flush
     if(current_setting == -1) {
-        Graphics_drawStringCentered(gc,(int8_t *)"no option selected", 18, 64,64, OPAQUE_TEXT);
+        Crystalfontz128x128_DrawStringCentered(gc,(int8_t *)"no option selected", 18, 64,64);
        // printf("no option selected");
+        Graphics_flushBuffer(gc);
         return;
     }
 //    Graphics_Rectangle fill_rect = {
@@ -103,20 +211,20 @@ void option_menu_draw_current_option(){
 //    };
     Option curr = option_list.arr[current_setting];
     //Graphics_fillRectangle(gc,&fill_rect);
-    Graphics_drawStringCentered(gc,
-                        (int8_t *) curr.name,
+    Crystalfontz128x128_DrawStringCentered(gc,
+                        (int8_t *) curr.desc->name,
                                 OPTION_NAME_MAX_LENGTH,
                                 64,
-                                48,
-                                OPAQUE_TEXT);
+                                48);
 
    // printf("%s\n",curr.name);
     char buf[20];
-    curr.to_string(buf,option_get_value(&curr),20);
+    curr.desc->to_string(buf,option_get_value(&curr),20);
     //printf("%d: ",option_get_value(&curr));
-    Graphics_drawStringCentered(gc,"<",1,32,64, OPAQUE_TEXT);
-    Graphics_drawStringCentered(gc,(int8_t *) buf,20,64,64, OPAQUE_TEXT);
-    Graphics_drawStringCentered(gc,">",1,96,64, OPAQUE_TEXT);
+    Crystalfontz128x128_DrawStringCentered(gc,(int8_t *)"<",1,32,64);
+    Crystalfontz128x128_DrawStringCentered(gc,(int8_t *) buf,20,64,64);
+    Crystalfontz128x128_DrawStringCentered(gc,(int8_t *)">",1,96,64);
+    Graphics_flushBuffer(gc);
 
     //printf("%s\n",buf);
     #else
@@ -124,7 +232,10 @@ void option_menu_draw_current_option(){
     if(current_setting == -1) {
         Graphics_drawStringCentered(gc,(int8_t *)"no option selected", 18, 64,64, OPAQUE_TEXT);
 
-            UART_write("no option selected", 18, NULL );
+            // the string terminator is sent too, it still delimits the lines as the old fixed size writes did
+            if(uart_send(UART_TX_MENU, 0, (const uint8_t *)"no option selected", 19, NULL)){
+                option_dirty_drawn(&option_menu_dirty);
+            }
            // printf("no option selected");
 
             return;
@@ -137,22 +248,31 @@ void option_menu_draw_current_option(){
     //Graphics_fillRectangle(gc,&fill_rect);
     /*
     Graphics_drawStringCentered(gc,
-                        (int8_t *) curr.name,
+                        (int8_t *) curr.desc->name,
                                 OPTION_NAME_MAX_LENGTH,
                                 64,
                                 48,
                                 OPAQUE_TEXT);
     */
     char val_buf[20];
-    curr.to_string(val_buf,option_get_value(&curr),20);
+    curr.desc->to_string(val_buf,option_get_value(&curr),20);
     char buf[80];
-    snprintf(buf,80, "%s < %s >",curr.name,val_buf );
+    int len = snprintf(buf,80, "%s < %s >",curr.desc->name,val_buf );
+    if(len < 0){
+        return;
+    }
+    if(len >= 80){
+        len = 79;
+    }
     /*
     Graphics_drawStringCentered(gc,"<",1,32,64, OPAQUE_TEXT);
     Graphics_drawStringCentered(gc,(int8_t *) val_buf,20,64,64, OPAQUE_TEXT);
     Graphics_drawStringCentered(gc,">",1,96,64, OPAQUE_TEXT);
     */
-    UART_write(buf,80,NULL);
+    // only the string and its terminator are sent, a pending menu line is replaced by the newer one
+    if(uart_send(UART_TX_MENU, 0, (const uint8_t *)buf, len + 1, NULL)){
+        option_dirty_drawn(&option_menu_dirty);
+    }
 
     #endif
 }
@@ -0,0 +1,57 @@
+/*
+ * option_menu_dirty.c
+ *
+ * Change tracking of the option menu, see option_menu_dirty.h
+ */
+
+#include "option_menu/option_menu_dirty.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+void option_dirty_init(OptionMenuDirty * dirty){
+    dirty->redraw = true;
+    memset(dirty->changed, 0, sizeof(dirty->changed));
+}
+
+void option_dirty_mark_redraw(OptionMenuDirty * dirty){
+    dirty->redraw = true;
+}
+
+bool option_dirty_needs_redraw(const OptionMenuDirty * dirty){
+    return dirty->redraw;
+}
+
+void option_dirty_drawn(OptionMenuDirty * dirty){
+    dirty->redraw = false;
+}
+
+void option_dirty_mark_changed(OptionMenuDirty * dirty, int32_t index){
+    if(index < 0 || index >= OPTION_DIRTY_MAX_OPTIONS){
+        return;
+    }
+    dirty->changed[index >> 5] |= 1UL << (index & 31);
+    dirty->redraw = true;
+}
+
+void option_dirty_forget(OptionMenuDirty * dirty, int32_t index){
+    if(index < 0 || index >= OPTION_DIRTY_MAX_OPTIONS){
+        return;
+    }
+    dirty->changed[index >> 5] &= ~(1UL << (index & 31));
+}
+
+bool option_dirty_is_changed(const OptionMenuDirty * dirty, int32_t index){
+    if(index < 0 || index >= OPTION_DIRTY_MAX_OPTIONS){
+        return false;
+    }
+    return (dirty->changed[index >> 5] & (1UL << (index & 31))) != 0;
+}
+
+void option_dirty_take_changed(OptionMenuDirty * dirty, uint32_t * pending){
+    uint8_t w;
+    for(w = 0; w < OPTION_DIRTY_WORDS; w++){
+        pending[w] = dirty->changed[w];
+        dirty->changed[w] = 0;
+    }
+}
@@ -0,0 +1,226 @@
+/*
+ * option_remote.c
+ *
+ * Options read and changed through UART by id, see option_remote.h
+ */
+
+#include "option_menu/option_remote.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifndef SOFTWARE_DEBUG
+#include "option_menu/option_menu.h"
+#include "uart_communication/uart_comm.h"
+#include "scheduling/scheduler.h"
+#include "scheduling/timer.h"
+
+#if OPTION_REMOTE_FRAME_LEN > READ_BUF_LEN || OPTION_REMOTE_FRAME_LEN >= UART_BUF_LEN
+#error "a SET frame does not fit in the UART receive buffers"
+#endif
+#endif
+
+// parses a decimal number in [min, max], returns the first character after it or NULL
+static const char * parse_number(const char * str, int32_t min, int32_t max, int32_t * value){
+    bool negative = false;
+    int64_t number = 0;
+    if(*str == '-'){
+        negative = true;
+        str++;
+    }
+    if(*str < '0' || *str > '9'){
+        return NULL;
+    }
+    while(*str >= '0' && *str <= '9'){
+        number = number * 10 + (*str - '0');
+        if(number > (int64_t)INT32_MAX + 1){
+            return NULL;
+        }
+        str++;
+    }
+    if(negative){
+        number = -number;
+    }
+    if(number < min || number > max){
+        return NULL;
+    }
+    *value = number;
+    return str;
+}
+
+bool option_remote_parse_id(const char * str, uint8_t * id){
+    int32_t value;
+    str = parse_number(str, 0, UINT8_MAX, &value);
+    if(str == NULL || *str != '\0'){
+        return false;
+    }
+    *id = value;
+    return true;
+}
+
+int8_t option_remote_parse_assignments(const char * str, OptionAssignment * assignments, uint8_t max){
+    uint8_t count = 0;
+    int32_t id;
+    int32_t value;
+    do{
+        if(count == max){
+            return -1;
+        }
+        str = parse_number(str, 0, UINT8_MAX, &id);
+        if(str == NULL || *str != '='){
+            return -1;
+        }
+        str = parse_number(str + 1, INT32_MIN, INT32_MAX, &value);
+        if(str == NULL || (*str != ',' && *str != '\0')){
+            return -1;
+        }
+        assignments[count].id = id;
+        assignments[count].value = value;
+        count++;
+    }while(*str++ == ',');
+    return count;
+}
+
+int8_t option_remote_check(const Option * options, int32_t count,
+                           const OptionAssignment * assignments, uint8_t assignment_count,
+                           int32_t * indexes){
+    uint8_t i;
+    for(i = 0; i < assignment_count; i++){
+        indexes[i] = option_find_by_id(options, count, assignments[i].id);
+        if(indexes[i] == -1 || !option_check_value(options[indexes[i]].desc, assignments[i].value)){
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint16_t option_remote_format_option(char * buf, size_t len, Option * option){
+    const OptionDesc * desc = option->desc;
+    int32_t min_value = desc->min_value;
+    int32_t max_value = desc->max_value;
+    int32_t increments = desc->increments;
+    int written;
+    switch(desc->type){
+    case THRESHOLD:
+        break;
+    case TIMER:
+        min_value = timer_option_get_value(0);
+        max_value = timer_option_get_value(TIMER_OPTION_ARR_LEN - 1);
+        increments = 0;
+        break;
+    case SWITCH:
+        min_value = 0;
+        max_value = 1;
+        increments = 1;
+        break;
+    }
+    written = snprintf(buf, len, "OPT:%u,%u,%ld,%ld,%ld,%ld,%s$",
+                       desc->id, (unsigned)desc->type, (long)option_get_value(option),
+                       (long)min_value, (long)max_value, (long)increments, desc->name);
+    if(written < 0 || (size_t)written >= len){
+        return 0;
+    }
+    return written;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// next option of the LIST being sent, -1 when no LIST is in progress
+static volatile int32_t option_remote_list_next = -1;
+
+static void option_remote_reply(const char * buf, int len, void (*callback)(void)){
+    if(len > 0 && len < OPTION_REMOTE_LINE_LEN){
+        uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, callback);
+    }
+}
+
+void option_remote_get(const char * str){
+    char buf[OPTION_REMOTE_LINE_LEN];
+    uint8_t id = 0;
+    int32_t index = -1;
+    int len;
+    if(option_remote_parse_id(str, &id)){
+        index = option_find_by_id(option_list.arr, option_list.len, id);
+    }
+    if(index == -1){
+        len = snprintf(buf, sizeof(buf), "GET:ERR,%u$", id);
+    }else{
+        len = snprintf(buf, sizeof(buf), "VAL:%u,%ld$", id, (long)option_get_value(&option_list.arr[index]));
+    }
+    option_remote_reply(buf, len, NULL);
+}
+
+void option_remote_set(const char * str){
+    // about 480 bytes, too much for the stack under option_change_confirm and
+    // the flash writes; the messages are handled one at a time by the main loop
+    static OptionAssignment assignments[OPTION_REMOTE_MAX_ASSIGNMENTS];
+    static int32_t indexes[OPTION_REMOTE_MAX_ASSIGNMENTS];
+    static char buf[OPTION_REMOTE_LINE_LEN];
+    int8_t count = option_remote_parse_assignments(str, assignments, OPTION_REMOTE_MAX_ASSIGNMENTS);
+    int8_t bad = count < 0 ? -1 : option_remote_check(option_list.arr, option_list.len, assignments, count, indexes);
+    int8_t i;
+    int len;
+
+    if(count < 0){
+        len = snprintf(buf, sizeof(buf), "SET:ERR,0$");
+    }else if(bad >= 0){
+        len = snprintf(buf, sizeof(buf), "SET:ERR,%u$", assignments[bad].id);
+    }else{
+        // nothing is changed before every value has been checked
+        for(i = 0; i < count; i++){
+            option_menu_set_value(indexes[i], assignments[i].value);
+        }
+        option_change_confirm();
+        len = snprintf(buf, sizeof(buf), "SET:OK,%d$", count);
+    }
+    option_remote_reply(buf, len, NULL);
+}
+
+static void option_remote_list_sent();
+
+// sends the next OPT line, the following one is queued once it has gone out
+static void option_remote_list_task(){
+    char buf[OPTION_REMOTE_LINE_LEN];
+    int32_t index = option_remote_list_next;
+    uint16_t len;
+    if(index < 0 || index >= option_list.len){
+        option_remote_list_next = -1;
+        return;
+    }
+    option_remote_list_next = index + 1;
+    len = option_remote_format_option(buf, sizeof(buf), &option_list.arr[index]);
+    // a dropped line ends the LIST, the host sees fewer lines than announced
+    if(len == 0 || !uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, option_remote_list_sent)){
+        option_remote_list_next = -1;
+    }
+}
+
+// called from the UART interrupt once a line of the LIST has been sent
+static void option_remote_list_sent(){
+    disable_timer_interrupt();
+    STask t = {
+        option_remote_list_task,
+        0,
+        0,
+        true
+    };
+    enqueue_task(&t);
+    scheduler_state = AWAKE;
+    enable_timer_interrupt();
+}
+
+void option_remote_list(const char * str){
+    char buf[OPTION_REMOTE_LINE_LEN];
+    int len;
+    // one LIST at a time, the lines of two would be interleaved
+    if(option_remote_list_next != -1){
+        return;
+    }
+    option_remote_list_next = 0;
+    len = snprintf(buf, sizeof(buf), "LIST:%ld$", (long)option_list.len);
+    if(!uart_send(UART_TX_REPLY, 0, (const uint8_t *)buf, len + 1, option_remote_list_sent)){
+        option_remote_list_next = -1;
+    }
+}
+
+#endif
@@ -4,7 +4,7 @@
 #include <string.h>
 #include <stdio.h>
 
-TimerAmount timer_option_arr[TIMER_OPTION_ARR_LEN] = {
+const TimerAmount timer_option_arr[TIMER_OPTION_ARR_LEN] = {
     {"2ms",2},
     {"10ms",10},
     {"100ms",100},
@@ -24,115 +24,133 @@ TimerAmount timer_option_arr[TIMER_OPTION_ARR_LEN] = {
     {"1h",3600000},
     {"2h",7200000}
 };
-char OUT_OF_RANGE[13] =  "out of range";
+static const char OUT_OF_RANGE[13] =  "out of range";
 
-OptionUnion option_u_new_threshold(int32_t value, int32_t min_value,
-                                   int32_t max_value, int32_t increments,
-                                   int *error) {
-    if (min_value > max_value || (min_value > value || max_value < min_value)) {
-        *error = 1;
+Option option_from_desc(const OptionDesc *desc) {
+    Option ret;
+    ret.desc = desc;
+    switch (desc->type) {
+    case SWITCH:
+        ret.value = desc->default_value != 0;
+        break;
+    case THRESHOLD:
+        ret.value = desc->default_value;
+        break;
+    case TIMER:
+        ret.value = timer_option_get_index_by_value(desc->default_value);
+        break;
     }
-    OptionUnion u;
-
-    u.threshold = (OptionTU){value, min_value, max_value, increments};
-    *error = 0;
-    return u;
+    return ret;
 }
-OptionUnion option_u_new_timer(char *name, int *error) {
-    OptionUnion u;
-    t_arr_index index = timer_option_get_index(name);
-    if (index == -1) {
-        *error = 1;
+
+int32_t option_get_value(Option *option) {
+    switch (option->desc->type) {
+    case SWITCH:
+    case THRESHOLD:
+        return option->value;
+    case TIMER:
+        return timer_option_get_value(option->value);
     }
-    u.timer = index;
-    return u;
-}
-OptionUnion option_u_new_switch(bool sswitch) {
-    OptionUnion u;
-    u.sswitch = sswitch;
-    return u;
+    return -1;
 }
 
-Option option_new(char *name, OptionType type, OptionUnion value,
-                  OnChangeFP action, FmtStringFP to_string) {
-    Option ret;
-    strncpy(ret.name, name, OPTION_NAME_MAX_LENGTH);
-    ret.type = type;
-    ret.value = value;
-    ret.on_change_action = action;
-    ret.to_string = to_string;
-    ret.changed = false;
-    return ret;
+int32_t option_set_value(Option *option, int32_t value) {
+    const OptionDesc *desc = option->desc;
+    switch (desc->type) {
+    case SWITCH:
+        option->value = value != 0;
+        break;
+    case THRESHOLD:
+        if (value < desc->min_value || value > desc->max_value) {
+            return -1;
+        }
+        option->value = value;
+        break;
+    case TIMER: {
+        t_arr_index index = timer_option_get_index_by_value(value);
+        if (index == -1) {
+            return -1;
+        }
+        option->value = index;
+        break;
+    }
+    }
+    return 1;
 }
 
-int32_t option_get_value(Option *option) {
-    switch (option->type) {
+bool option_check_value(const OptionDesc *desc, int32_t value) {
+    switch (desc->type) {
     case SWITCH:
-        return option->value.sswitch;
+        return value == 0 || value == 1;
     case THRESHOLD:
-        return option->value.threshold.value;
+        if (value < desc->min_value || value > desc->max_value) {
+            return false;
+        }
+        // the menu clamps on the maximum, even off the step
+        return value == desc->max_value || desc->increments <= 0 ||
+               (value - desc->min_value) % desc->increments == 0;
     case TIMER:
-        return timer_option_get_value(option->value.timer);
+        return timer_option_get_index_by_value(value) != -1;
+    }
+    return false;
+}
+
+int32_t option_find_by_id(const Option *options, int32_t count, uint8_t id) {
+    int32_t i;
+    for (i = 0; i < count; i++) {
+        if (options[i].desc->id == id) {
+            return i;
+        }
     }
     return -1;
 }
 
 int32_t option_increment(Option *option) {
-    switch (option->type) {
+    const OptionDesc *desc = option->desc;
+    switch (desc->type) {
     case SWITCH:
-        option->value.sswitch = !option->value.sswitch;
+        option->value = !option->value;
         break;
-    case THRESHOLD: {
-        OptionTU value = option->value.threshold;
-        if (value.max_value <= value.value + value.increments) {
-            value.value = value.max_value;
+    case THRESHOLD:
+        if (desc->max_value <= option->value + desc->increments) {
+            option->value = desc->max_value;
         } else {
-            value.value += value.increments;
+            option->value += desc->increments;
         }
-        option->value.threshold = value;
         break;
-    }
-    case TIMER: {
-        t_arr_index index = option->value.timer;
-        if (index >= TIMER_OPTION_ARR_LEN - 1) {
-            option->value.timer = TIMER_OPTION_ARR_LEN-1;
+    case TIMER:
+        if (option->value >= TIMER_OPTION_ARR_LEN - 1) {
+            option->value = TIMER_OPTION_ARR_LEN-1;
 
         }else{
-            option->value.timer++;
+            option->value++;
         }
         break;
     }
-    }
-    option->changed = true;
     return 1;
 }
 int32_t option_decrement(Option *option) {
-    switch (option->type) {
+    const OptionDesc *desc = option->desc;
+    switch (desc->type) {
     case SWITCH:
-        option->value.sswitch = !option->value.sswitch;
+        option->value = !option->value;
         break;
-    case THRESHOLD: {
-        OptionTU value = option->value.threshold;
-        if (value.value - value.min_value < value.increments) {
-            value.value = value.min_value;
+    case THRESHOLD:
+        if (option->value - desc->min_value < desc->increments) {
+            option->value = desc->min_value;
         } else {
-            value.value = value.value - value.increments;
+            option->value = option->value - desc->increments;
         }
-        option->value.threshold = value;
         break;
-    }
-    case TIMER: {
-        t_arr_index index = option->value.timer;
-        if (index <= 0) {
-            option->value.timer = 0;
+    case TIMER:
+        if (option->value <= 0) {
+            option->value = 0;
 
         }else{
-            option->value.timer--;
+            option->value--;
         }
         break;
     }
-    }
-    option->changed=true;
     return 1;
 }
 
@@ -144,7 +162,7 @@ for the timer it should be different
 - static array
 */
 
-int32_t timer_option_get_index(char *str) {
+int32_t timer_option_get_index(const char *str) {
     int i;
     for (i = 0; i < TIMER_OPTION_ARR_LEN; i++) {
         if (!strcmp(str, timer_option_arr[i].name)) {
@@ -159,21 +177,24 @@ int32_t timer_option_get_value(t_arr_index index) {
     }
     return -1;
 }
-char *timer_option_get_name(t_arr_index index) {
+const char *timer_option_get_name(t_arr_index index) {
     if (index >= 0 && index < TIMER_OPTION_ARR_LEN) {
         return timer_option_arr[index].name;
     }
     return OUT_OF_RANGE;
 }
-char * timer_option_get_name_by_value(int32_t value){
+const char * timer_option_get_name_by_value(int32_t value){
+    return timer_option_get_name(timer_option_get_index_by_value(value));
+}
+t_arr_index timer_option_get_index_by_value(int32_t value){
     int i;
     for(i= 0; i < TIMER_OPTION_ARR_LEN;i++){
         if(value == timer_option_arr[i].value){
-            return timer_option_arr[i].name;
+            return i;
 
         }
     }
-    return OUT_OF_RANGE;
+    return -1;
 }
 
 
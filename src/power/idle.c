@@ -0,0 +1,219 @@
+/*
+ * idle.c
+ *
+ * Sleep state selection and residency counters, see idle.h
+ */
+
+#include "power/idle.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stdio.h>
+#include "scheduling/scheduler.h"
+#include "uart_communication/uart_comm.h"
+#include "pwm/pwm.h"
+#if defined(SCREEN_OPTION_MENU_WORKS) || defined(SCREEN_DASHBOARD)
+#include "LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#endif
+#endif
+
+void idle_stats_init(IdleStats * stats){
+    memset(stats, 0, sizeof(IdleStats));
+}
+
+IdleState idle_choose_state(uint32_t busy, int32_t ms_to_next){
+    if(busy != 0 || ms_to_next < IDLE_LPM3_MIN_MS){
+        return IDLE_LPM0;
+    }
+    return IDLE_LPM3;
+}
+
+uint16_t idle_wake_ticks(int32_t ms_to_next){
+    if((int64_t)ms_to_next * IDLE_TICKS_PER_SECOND >= (int64_t)IDLE_WAKE_LONG_TICKS * 1000){
+        return IDLE_WAKE_LONG_TICKS;
+    }
+    return IDLE_WAKE_SHORT_TICKS;
+}
+
+void idle_stats_record(IdleStats * stats, IdleState state, uint32_t busy, uint32_t ticks){
+    uint8_t i;
+    if(state >= IDLE_STATE_COUNT){
+        return;
+    }
+    stats->entries[state]++;
+    stats->ticks[state] += ticks;
+    for(i = 0; i < IDLE_BUSY_COUNT; i++){
+        if(busy & (1UL << i)){
+            stats->blocked[i]++;
+        }
+    }
+}
+
+uint32_t idle_credit_ms(IdleStats * stats, uint32_t ticks){
+    uint64_t total = (uint64_t)ticks * 1000 + stats->credit_carry;
+    stats->credit_carry = total % IDLE_TICKS_PER_SECOND;
+    return total / IDLE_TICKS_PER_SECOND;
+}
+
+uint16_t idle_residency_permille(const IdleStats * stats, IdleState state, uint32_t uptime_ms){
+    if(state >= IDLE_STATE_COUNT || uptime_ms == 0){
+        return 0;
+    }
+    uint64_t ms = stats->ticks[state] * 1000 / IDLE_TICKS_PER_SECOND;
+    if(ms >= uptime_ms){
+        return 1000;
+    }
+    return ms * 1000 / uptime_ms;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// how long to wait for the 32 kHz crystal before falling back to REFO
+#define IDLE_LFXT_TIMEOUT 100000
+
+static IdleStats idle_stats;
+static task_list_index idle_report_index;
+
+// BCLK ticks from the RTC prescalers (RT1PS:RT0PS), they keep counting in LPM3
+static uint16_t idle_now(){
+    uint16_t first;
+    uint16_t second;
+    // the prescalers run on BCLK, read until two reads agree
+    do{
+        first = RTC_C->PS;
+        second = RTC_C->PS;
+    }while(first != second);
+    return first;
+}
+
+static uint32_t idle_busy(){
+    uint32_t busy = 0;
+    if(uart_is_active(IDLE_UART_HOLD_MS)){
+        busy |= 1UL << IDLE_BUSY_UART;
+    }
+    if(I2C_isBusBusy(EUSCI_B1_BASE)){
+        busy |= 1UL << IDLE_BUSY_I2C;
+    }
+    // the PWM timers run on SMCLK
+    if(pwm_is_running(PWM_BUZZER)){
+        busy |= 1UL << IDLE_BUSY_BUZZER;
+    }
+    if(pwm_is_running(PWM_GROW_LIGHT)){
+        busy |= 1UL << IDLE_BUSY_GROW_LIGHT;
+    }
+    // a conversion in progress, or the repeated sequence sampling the joystick and the water sensors
+    if(ADC14_isBusy() ||
+       (ADC14->CTL0 & (ADC14_CTL0_ENC | ADC14_CTL0_CONSEQ_2)) == (ADC14_CTL0_ENC | ADC14_CTL0_CONSEQ_2)){
+        busy |= 1UL << IDLE_BUSY_ADC;
+    }
+#if defined(SCREEN_OPTION_MENU_WORKS) || defined(SCREEN_DASHBOARD)
+    if(HAL_LCD_isBusy()){
+        busy |= 1UL << IDLE_BUSY_LCD;
+    }
+#endif
+    return busy;
+}
+
+void idle_init(){
+    idle_stats_init(&idle_stats);
+
+    // BCLK from the 32 kHz crystal, or from REFO if it does not start
+    GPIO_setAsPeripheralModuleFunctionOutputPin(GPIO_PORT_PJ, GPIO_PIN0 | GPIO_PIN1, GPIO_PRIMARY_MODULE_FUNCTION);
+    if(CS_startLFXTWithTimeout(CS_LFXT_DRIVE3, IDLE_LFXT_TIMEOUT)){
+        CS_initClockSignal(CS_BCLK, CS_LFXTCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    }else{
+        CS_setReferenceOscillatorFrequency(CS_REFO_32KHZ);
+        CS_initClockSignal(CS_BCLK, CS_REFOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    }
+    RTC_C_startClock();
+
+    // LPM3 is entered even if an SMCLK peripheral asks for its clock, idle_busy decides instead
+    PCM_enableRudeMode();
+    Interrupt_enableInterrupt(INT_WDT_A);
+
+    STask task = {
+        .fpointer = idle_report_task,
+        .max_time = IDLE_REPORT_INTERVAL,
+        .elapsed_time = IDLE_REPORT_INTERVAL,
+        .is_active = true
+    };
+    idle_report_index = push_task(task);
+}
+
+void idle_sleep(){
+    // an interrupt arriving while they are masked still ends the WFI, it is served after it
+    bool was_disabled = Interrupt_disableMaster();
+    int32_t ms_to_next = scheduler_ms_to_next_task();
+    // tasks queued after the scheduler emptied the queue but before it went to SLEEPING
+    if(scheduler_state == AWAKE || ms_to_next == 0){
+        scheduler_state = AWAKE;
+        if(!was_disabled){
+            Interrupt_enableMaster();
+        }
+        return;
+    }
+
+    uint32_t busy = idle_busy();
+    IdleState state = idle_choose_state(busy, ms_to_next);
+    uint16_t start = idle_now();
+
+    if(state == IDLE_LPM3){
+        WDT_A_initIntervalTimer(WDT_A_CLOCKSOURCE_BCLK,
+                                idle_wake_ticks(ms_to_next) == IDLE_WAKE_LONG_TICKS ?
+                                WDT_A_CLOCKITERATIONS_8192 : WDT_A_CLOCKITERATIONS_512);
+        WDT_A_startTimer();
+        if(!PCM_gotoLPM3()){
+            state = IDLE_LPM0;
+            PCM_gotoLPM0();
+        }
+        WDT_A_holdTimer();
+    }else{
+        PCM_gotoLPM0();
+    }
+
+    // the prescalers wrap every 2 s, longer than the longest sleep
+    uint16_t slept = idle_now() - start;
+    idle_stats_record(&idle_stats, state, busy, slept);
+    if(state == IDLE_LPM3){
+        // the scheduler timer was stopped: give it the time it missed
+        timer_interrupt(idle_credit_ms(&idle_stats, slept));
+    }
+
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+void idle_get_stats(IdleStats * stats){
+    bool was_disabled = Interrupt_disableMaster();
+    *stats = idle_stats;
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+void idle_report_task(){
+    IdleStats stats;
+    char buf[48];
+    uint32_t uptime = scheduler_get_uptime();
+
+    idle_get_stats(&stats);
+    int len = snprintf(buf, sizeof(buf), "IDLE:%u,%u,%lu,%lu$",
+                       idle_residency_permille(&stats, IDLE_LPM0, uptime),
+                       idle_residency_permille(&stats, IDLE_LPM3, uptime),
+                       (unsigned long)stats.entries[IDLE_LPM0],
+                       (unsigned long)stats.entries[IDLE_LPM3]);
+    if(len > 0 && len < sizeof(buf)){
+        uart_send(UART_TX_TELEMETRY, IDLE_REPORT_KEY, (const uint8_t *)buf, len + 1, NULL);
+    }
+}
+
+// ends a LPM3 sleep, the interval is restarted for every sleep
+void WDT_A_IRQHandler(void){
+    WDT_A_holdTimer();
+}
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * pwm.c
+ *
+ * Hardware PWM channels, see pwm.h
+ */
+
+#include "pwm/pwm.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "clock/clock_profile.h"
+#endif
+
+uint16_t pwm_duty_counts(uint32_t value, uint32_t max, uint16_t period){
+    if(max == 0 || value >= max){
+        return period;
+    }
+    return (uint16_t)((uint64_t)value * period / max);
+}
+
+uint16_t pwm_compare_value(uint16_t counts, uint16_t period){
+    if(counts >= period){
+        return period + 1;
+    }
+    return counts;
+}
+
+uint16_t pwm_fade_step(uint16_t current, uint16_t target, uint16_t step){
+    if(step == 0){
+        return target;
+    }
+    if(current < target){
+        return target - current > step ? current + step : target;
+    }
+    return current - target > step ? current - step : target;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+/*
+    where a channel comes out
+    fields:
+    - timer: base address of the Timer_A module
+    - ccr: index of the compare register driving the pin (1 to 4)
+    - interrupt: the CCR0 interrupt of the module
+    - port, pin, function: the pin connected to the timer output
+*/
+typedef struct {
+    uint32_t timer;
+    uint8_t ccr;
+    uint32_t interrupt;
+    uint_fast8_t port;
+    uint_fast16_t pin;
+    uint_fast8_t function;
+} PwmPinMap;
+
+static const PwmPinMap pwm_pins[PWM_CHANNEL_COUNT] = {
+    // TA1.1 is port mapped on P7.7 by default
+    [PWM_GROW_LIGHT] = {TIMER_A1_BASE, 1, INT_TA1_0, GPIO_PORT_P7, GPIO_PIN7, GPIO_PRIMARY_MODULE_FUNCTION},
+    [PWM_BUZZER]     = {TIMER_A3_BASE, 2, INT_TA3_0, GPIO_PORT_P8, GPIO_PIN2, GPIO_PRIMARY_MODULE_FUNCTION}
+};
+
+/*
+    state of a channel
+    fields:
+    - period: period in timer counts
+    - duty: duty (in counts) in the compare register, or to write at the next start
+    - target: duty at the end of the current change
+    - step: counts per period boundary towards target, 0 to jump to it
+    - initialized: true once pwm_init configured the timer
+*/
+typedef struct {
+    uint16_t period;
+    uint16_t duty;
+    uint16_t target;
+    uint16_t step;
+    bool initialized;
+} PwmState;
+
+static PwmState pwm_states[PWM_CHANNEL_COUNT];
+static bool pwm_listening = false;
+
+static Timer_A_Type * pwm_timer(PwmChannel channel){
+    return (Timer_A_Type *)pwm_pins[channel].timer;
+}
+
+// writes the duty, the output unit keeps the level it has until its next event
+static void pwm_apply(PwmChannel channel){
+    Timer_A_Type * timer = pwm_timer(channel);
+    uint8_t ccr = pwm_pins[channel].ccr;
+    uint16_t counts = pwm_states[channel].duty;
+
+    if(counts == 0){
+        // mode 0 drives the OUT bit, which is 0
+        timer->CCTL[ccr] = TIMER_A_CCTLN_OUTMOD_0;
+        timer->CCR[ccr] = 0;
+        return;
+    }
+    timer->CCR[ccr] = pwm_compare_value(counts, pwm_states[channel].period);
+    if((timer->CCTL[ccr] & TIMER_A_CCTLN_OUTMOD_MASK) != TIMER_A_CCTLN_OUTMOD_7){
+        // coming from 0% the pin is low, it is set at the end of this period
+        timer->CCTL[ccr] = TIMER_A_CCTLN_OUTMOD_7;
+    }else if(counts <= timer->R){
+        // the counter already passed the new reset point: reset the pin by hand
+        timer->CCTL[ccr] = TIMER_A_CCTLN_OUTMOD_0;
+        timer->CCTL[ccr] = TIMER_A_CCTLN_OUTMOD_7;
+    }
+}
+
+static void pwm_boundary(PwmChannel channel){
+    Timer_A_Type * timer = pwm_timer(channel);
+    PwmState * state = &pwm_states[channel];
+
+    timer->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+    state->duty = pwm_fade_step(state->duty, state->target, state->step);
+    pwm_apply(channel);
+    if(state->duty == state->target){
+        timer->CCTL[0] &= ~TIMER_A_CCTLN_CCIE;
+    }
+}
+
+// starts a change of duty, at the next period boundaries if the channel is running
+static void pwm_change(PwmChannel channel, uint16_t counts, uint16_t step){
+    Timer_A_Type * timer = pwm_timer(channel);
+    PwmState * state = &pwm_states[channel];
+    if(counts > state->period){
+        counts = state->period;
+    }
+
+    bool was_disabled = Interrupt_disableMaster();
+    state->target = counts;
+    state->step = step;
+    if(timer->CTL & TIMER_A_CTL_MC_MASK){
+        // CCIFG may still be set from an earlier period
+        timer->CCTL[0] = (timer->CCTL[0] & ~TIMER_A_CCTLN_CCIFG) | TIMER_A_CCTLN_CCIE;
+    }else{
+        // a stopped channel gets it from pwm_start
+        state->duty = counts;
+    }
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+// keeps every period when a clock profile switch changes SMCLK
+static void pwm_clock_changed(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz){
+    uint8_t i;
+    if(change != CLOCK_CHANGE_AFTER){
+        return;
+    }
+    for(i = 0; i < PWM_CHANNEL_COUNT; i++){
+        if(pwm_states[i].initialized){
+            clock_profile_retime_timer_a(pwm_pins[i].timer, smclk_hz);
+        }
+    }
+}
+
+void pwm_init(PwmChannel channel, uint16_t period){
+    const PwmPinMap * map = &pwm_pins[channel];
+    Timer_A_Type * timer = pwm_timer(channel);
+
+    pwm_states[channel].period = period;
+    pwm_states[channel].duty = 0;
+    pwm_states[channel].target = 0;
+    pwm_states[channel].step = 0;
+    pwm_states[channel].initialized = true;
+
+    // stopped, up mode to CCR0, no overflow interrupt
+    timer->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    timer->CCTL[0] = 0;
+    timer->CCR[0] = period;
+    timer->CCTL[map->ccr] = TIMER_A_CCTLN_OUTMOD_0;
+    timer->CCR[map->ccr] = 0;
+    clock_profile_retime_timer_a(map->timer, CS_getSMCLK());
+
+    GPIO_setAsPeripheralModuleFunctionOutputPin(map->port, map->pin, map->function);
+    Interrupt_enableInterrupt(map->interrupt);
+
+    if(!pwm_listening){
+        pwm_listening = clock_profile_register(pwm_clock_changed);
+    }
+}
+
+void pwm_set(PwmChannel channel, uint16_t counts){
+    pwm_change(channel, counts, 0);
+}
+
+void pwm_fade(PwmChannel channel, uint16_t counts, uint16_t step){
+    pwm_change(channel, counts, step);
+}
+
+void pwm_start(PwmChannel channel){
+    Timer_A_Type * timer = pwm_timer(channel);
+
+    bool was_disabled = Interrupt_disableMaster();
+    if(!(timer->CTL & TIMER_A_CTL_MC_MASK)){
+        timer->CTL |= TIMER_A_CTL_CLR;
+        pwm_apply(channel);
+        timer->CTL |= TIMER_A_CTL_MC__UP;
+    }
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+void pwm_stop(PwmChannel channel){
+    Timer_A_Type * timer = pwm_timer(channel);
+
+    bool was_disabled = Interrupt_disableMaster();
+    timer->CTL &= ~TIMER_A_CTL_MC_MASK;
+    timer->CCTL[0] &= ~(TIMER_A_CCTLN_CCIE | TIMER_A_CCTLN_CCIFG);
+    // a fade in progress ends where it was going
+    pwm_states[channel].duty = pwm_states[channel].target;
+    // drive the pin low until the next start
+    timer->CCTL[pwm_pins[channel].ccr] = TIMER_A_CCTLN_OUTMOD_0;
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+}
+
+bool pwm_is_running(PwmChannel channel){
+    return (pwm_timer(channel)->CTL & TIMER_A_CTL_MC_MASK) != 0;
+}
+
+void TA1_0_IRQHandler(void){
+    pwm_boundary(PWM_GROW_LIGHT);
+}
+
+void TA3_0_IRQHandler(void){
+    pwm_boundary(PWM_BUZZER);
+}
+
+#endif
@@ -0,0 +1,296 @@
+/*
+ * calendar.c
+ *
+ * Calendar rules on the RTC, see calendar.h
+ */
+
+#include "scheduling/calendar.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "scheduling/scheduler.h"
+#include "scheduling/timer.h"
+#include "scheduling/uptime.h"
+#endif
+
+void calendar_state_init(Calendar * calendar){
+    calendar->count = 0;
+    calendar->last_minute = CALENDAR_MINUTES_PER_WEEK - 1;
+    calendar->synced = false;
+}
+
+int8_t calendar_add_rule(Calendar * calendar, uint8_t days, uint8_t hour, uint8_t minute, CalendarFP fpointer){
+    if(calendar->count == CALENDAR_MAX_RULES || fpointer == NULL ||
+       days == 0 || days > CALENDAR_EVERY_DAY || hour > 23 || minute > 59){
+        return -1;
+    }
+    CalendarRule * rule = &calendar->rules[calendar->count];
+    rule->fpointer = fpointer;
+    rule->days = days;
+    rule->minute_of_day = hour * 60 + minute;
+    return calendar->count++;
+}
+
+uint16_t calendar_minute_of_week(const CalendarTime * time){
+    if(time->day_of_week > 6 || time->hour > 23 || time->minute > 59){
+        return CALENDAR_MINUTES_PER_WEEK;
+    }
+    return time->day_of_week * CALENDAR_MINUTES_PER_DAY + time->hour * 60 + time->minute;
+}
+
+void calendar_sync(Calendar * calendar, uint16_t now){
+    calendar->last_minute = (now + CALENDAR_MINUTES_PER_WEEK - 1) % CALENDAR_MINUTES_PER_WEEK;
+    calendar->synced = true;
+}
+
+// minutes from `from` to the first time the rule is due after it, from 1 to a week
+static uint16_t rule_distance(const CalendarRule * rule, uint16_t from){
+    uint16_t best = CALENDAR_MINUTES_PER_WEEK;
+    uint8_t day;
+    for(day = 0; day < 7; day++){
+        if(!(rule->days & CALENDAR_DAY(day))){
+            continue;
+        }
+        uint16_t at = day * CALENDAR_MINUTES_PER_DAY + rule->minute_of_day;
+        uint16_t distance = (at + CALENDAR_MINUTES_PER_WEEK - from) % CALENDAR_MINUTES_PER_WEEK;
+        if(distance == 0){
+            distance = CALENDAR_MINUTES_PER_WEEK;
+        }
+        if(distance < best){
+            best = distance;
+        }
+    }
+    return best;
+}
+
+uint8_t calendar_due(Calendar * calendar, uint16_t now, CalendarFP * due){
+    uint16_t elapsed = (now + CALENDAR_MINUTES_PER_WEEK - calendar->last_minute) % CALENDAR_MINUTES_PER_WEEK;
+    uint8_t count = 0;
+    uint8_t i;
+    // the time of the RTC means nothing before it is set
+    if(!calendar->synced){
+        calendar->last_minute = now;
+        return 0;
+    }
+    for(i = 0; i < calendar->count; i++){
+        // due in (last_minute, now]
+        if(rule_distance(&calendar->rules[i], calendar->last_minute) <= elapsed){
+            due[count++] = calendar->rules[i].fpointer;
+        }
+    }
+    calendar->last_minute = now;
+    return count;
+}
+
+bool calendar_next(const Calendar * calendar, uint16_t now, uint16_t * next){
+    uint16_t best = CALENDAR_MINUTES_PER_WEEK + 1;
+    uint8_t i;
+    for(i = 0; i < calendar->count; i++){
+        uint16_t distance = rule_distance(&calendar->rules[i], now);
+        if(distance < best){
+            best = distance;
+        }
+    }
+    if(best > CALENDAR_MINUTES_PER_WEEK){
+        return false;
+    }
+    *next = (now + best) % CALENDAR_MINUTES_PER_WEEK;
+    return true;
+}
+
+bool calendar_in_window(uint16_t minute_of_day, uint16_t start, uint16_t end){
+    if(start <= end){
+        return minute_of_day >= start && minute_of_day < end;
+    }
+    // e.g. 22:00 to 06:00
+    return minute_of_day >= start || minute_of_day < end;
+}
+
+// parses an unsigned number up to max, followed by the given character
+static const char * parse_field(const char * str, uint8_t max, char end, uint8_t * value){
+    uint16_t number = 0;
+    if(*str < '0' || *str > '9'){
+        return NULL;
+    }
+    while(*str >= '0' && *str <= '9'){
+        number = number * 10 + (*str - '0');
+        if(number > max){
+            return NULL;
+        }
+        str++;
+    }
+    if(*str != end){
+        return NULL;
+    }
+    *value = number;
+    return end == '\0' ? str : str + 1;
+}
+
+bool calendar_parse_time(const char * str, CalendarTime * time){
+    CalendarTime parsed;
+    str = parse_field(str, 6, ',', &parsed.day_of_week);
+    if(str != NULL){
+        str = parse_field(str, 23, ',', &parsed.hour);
+    }
+    if(str != NULL){
+        str = parse_field(str, 59, ',', &parsed.minute);
+    }
+    if(str != NULL){
+        str = parse_field(str, 59, '\0', &parsed.second);
+    }
+    if(str == NULL){
+        return false;
+    }
+    *time = parsed;
+    return true;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+static Calendar calendar;
+
+// must be called with interrupts disabled
+static void calendar_arm(uint16_t now){
+    uint16_t next;
+    // no alarm before the clock is set, no rule would run
+    if(!calendar.synced || !calendar_next(&calendar, now, &next)){
+        RTC_C_disableInterrupt(RTC_C_CLOCK_ALARM_INTERRUPT);
+        return;
+    }
+    // the alarm matches minute, hour and day of week, not the day of the month
+    RTC_C_setCalendarAlarm((next % CALENDAR_MINUTES_PER_DAY) % 60,
+                           (next % CALENDAR_MINUTES_PER_DAY) / 60,
+                           next / CALENDAR_MINUTES_PER_DAY,
+                           RTC_C_ALARMCONDITION_OFF);
+    RTC_C_clearInterruptFlag(RTC_C_CLOCK_ALARM_INTERRUPT);
+    RTC_C_enableInterrupt(RTC_C_CLOCK_ALARM_INTERRUPT);
+}
+
+static uint16_t calendar_now(){
+    CalendarTime time;
+    calendar_get_time(&time);
+    return calendar_minute_of_week(&time);
+}
+
+// queues calendar_task, from the alarm interrupt or after the clock is set
+static void calendar_schedule(){
+    disable_timer_interrupt();
+    STask t = {
+        calendar_task,
+        0,
+        0,
+        true
+    };
+    enqueue_task(&t);
+    scheduler_state = AWAKE;
+    enable_timer_interrupt();
+}
+
+// writes the RTC, must be called with interrupts disabled
+static void calendar_write_rtc(const CalendarTime * time){
+    RTC_C_Calendar rtc = RTC_C_getCalendarTime();
+    rtc.seconds = time->second;
+    rtc.minutes = time->minute;
+    rtc.hours = time->hour;
+    rtc.dayOfWeek = time->day_of_week;
+    // keep a valid date, only the day of the week is used
+    if(rtc.dayOfmonth == 0 || rtc.month == 0){
+        rtc.dayOfmonth = 1;
+        rtc.month = 1;
+        rtc.year = 2025;
+    }
+    // holds the calendar while it is written, the prescalers used by the idle manager keep their count
+    RTC_C_initCalendar(&rtc, RTC_C_FORMAT_BINARY);
+    RTC_C_startClock();
+}
+
+void calendar_init(){
+    CalendarTime midnight = {0, 0, 0, 0};
+    calendar_state_init(&calendar);
+    bool was_disabled = Interrupt_disableMaster();
+    calendar_write_rtc(&midnight);
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    Interrupt_enableInterrupt(INT_RTC_C);
+}
+
+int8_t calendar_add(uint8_t days, uint8_t hour, uint8_t minute, CalendarFP fpointer){
+    bool was_disabled = Interrupt_disableMaster();
+    int8_t index = calendar_add_rule(&calendar, days, hour, minute, fpointer);
+    if(index >= 0){
+        calendar_arm(calendar_now());
+    }
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    return index;
+}
+
+void calendar_set_time(const CalendarTime * time){
+    uint16_t now = calendar_minute_of_week(time);
+    if(now == CALENDAR_MINUTES_PER_WEEK){
+        return;
+    }
+
+    bool was_disabled = Interrupt_disableMaster();
+    calendar_write_rtc(time);
+    calendar_sync(&calendar, now);
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    // rules due at the new time, and the alarm for the next ones
+    calendar_schedule();
+}
+
+bool calendar_time_valid(){
+    return calendar.synced;
+}
+
+void calendar_get_time(CalendarTime * time){
+    RTC_C_Calendar rtc = RTC_C_getCalendarTime();
+    time->day_of_week = rtc.dayOfWeek;
+    time->hour = rtc.hours;
+    time->minute = rtc.minutes;
+    time->second = rtc.seconds;
+}
+
+bool calendar_now_in_window(uint16_t start, uint16_t end){
+    CalendarTime time;
+    calendar_get_time(&time);
+    return calendar_in_window(time.hour * 60 + time.minute, start, end);
+}
+
+void calendar_task(){
+    CalendarFP due[CALENDAR_MAX_RULES];
+    uint8_t count;
+    uint8_t i;
+
+    bool was_disabled = Interrupt_disableMaster();
+    uint16_t now = calendar_now();
+    count = calendar_due(&calendar, now, due);
+    calendar_arm(now);
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+
+    for(i = 0; i < count; i++){
+        due[i]();
+    }
+}
+
+void RTC_C_IRQHandler(void){
+    uint32_t status = RTC_C_getEnabledInterruptStatus();
+    RTC_C_clearInterruptFlag(status);
+    if(status & RTC_C_PRESCALE_TIMER1_INTERRUPT){
+        uptime_overflow();
+    }
+    if(status & RTC_C_CLOCK_ALARM_INTERRUPT){
+        calendar_schedule();
+    }
+}
+
+#endif
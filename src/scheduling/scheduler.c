@@ -7,6 +7,7 @@
 
 #include "scheduling/scheduler.h"
 #include "scheduling/timer.h"
+#include "scheduling/uptime.h"
 
 void init_task_list() { task_list.curr = 0; }
 
@@ -48,6 +49,20 @@ int disable_task_at(uint32_t index){
     return 0;
 }
 
+int set_task_period(uint32_t index, int32_t max_time){
+    if(task_list.curr <=index){
+        return -1;
+    }
+    disable_timer_interrupt();
+    STask *t = &(task_list.task_array[index]);
+    t->max_time = max_time;
+    if(t->elapsed_time > max_time){
+        t->elapsed_time = max_time;
+    }
+    enable_timer_interrupt();
+    return 0;
+}
+
 void init_task_queue() {
 
     task_queue.write_index = 0;
@@ -117,3 +132,23 @@ void scheduler_init() {
     init_task_queue();
     scheduler_state = SLEEPING;
 }
+
+uint32_t scheduler_get_uptime() {
+    // the tick is not a timebase, it stops in LPM3
+    return (uint32_t)uptime_now_ms();
+}
+
+int32_t scheduler_ms_to_next_task() {
+    int32_t next = INT32_MAX;
+    int i;
+    if (task_queue.read_index != task_queue.write_index) {
+        return 0;
+    }
+    for (i = 0; i < task_list.curr; i++) {
+        STask *t = &(task_list.task_array[i]);
+        if (t->is_active && t->elapsed_time < next) {
+            next = t->elapsed_time;
+        }
+    }
+    return next;
+}
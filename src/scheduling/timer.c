@@ -7,9 +7,26 @@
 
 #include "msp.h"
 #include "scheduling/timer.h"
+#include "clock/clock_profile.h"
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 
-inline int compute_countdown(int32_t period, int32_t divider) {
-    return (3000000 / divider) / (1000 / period);
+inline int compute_countdown(int32_t clock, int32_t period, int32_t divider) {
+    return (clock / divider) / (1000 / period);
+}
+
+// keeps the tick at TIMER_PERIOD when SMCLK changes
+static void timer_clock_changed(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz) {
+    if (change != CLOCK_CHANGE_AFTER) {
+        return;
+    }
+    uint16_t old_countdown = TIMER_A0->CCR[0];
+    uint16_t new_countdown = compute_countdown(smclk_hz, TIMER_PERIOD, 8);
+
+    // the count is scaled instead of cleared, so the current tick is not lost
+    TIMER_A0->CTL &= ~TIMER_A_CTL_MC_MASK;
+    TIMER_A0->R = (uint32_t)TIMER_A0->R * new_countdown / old_countdown;
+    TIMER_A0->CCR[0] = new_countdown;
+    TIMER_A0->CTL |= TIMER_A_CTL_MC__UP;
 }
 
 void timer_init() {
@@ -17,15 +34,40 @@ void timer_init() {
     TIMER_A0->CTL = TIMER_A_CTL_SSEL__SMCLK;
     TIMER_A0->CTL |= TIMER_A_CTL_MC__UP;
     TIMER_A0->CTL |= TIMER_A_CTL_ID_3;
-    TIMER_A0->CCR[0] = compute_countdown(TIMER_PERIOD,8);
+    TIMER_A0->CCR[0] = compute_countdown(CS_getSMCLK(),TIMER_PERIOD,8);
     TIMER_A0 -> CCTL[0] = TIMER_A_CCTLN_CCIE;
+    clock_profile_register(timer_clock_changed);
 
     // enable irq9 line for the timer interrupt to catch overflow
     // NVIC->ISER[0] = 1 << ((TA0_0_IRQn) & 31);
     enable_timer_interrupt();
 }
-void enable_timer_interrupt() { NVIC->ISER[0] = 1 << ((TA0_0_IRQn) & 31); }
-void disable_timer_interrupt() { NVIC->ISER[0] = 0 << ((TA0_0_IRQn) & 31); }
+// number of disable_timer_interrupt calls not matched by an enable yet
+static volatile uint8_t timer_interrupt_locks = 0;
+
+// the count and the NVIC mask are changed together with every interrupt masked, an interrupt
+// nesting its own disable/enable between the two would otherwise unmask the tick of the outer section
+void enable_timer_interrupt() {
+    bool was_disabled = Interrupt_disableMaster();
+    if (timer_interrupt_locks == 0 || --timer_interrupt_locks == 0) {
+        NVIC->ISER[0] = 1 << ((TA0_0_IRQn) & 31);
+    }
+    // otherwise an outer section still needs the interrupt masked
+    if (!was_disabled) {
+        Interrupt_enableMaster();
+    }
+}
+void disable_timer_interrupt() {
+    bool was_disabled = Interrupt_disableMaster();
+    timer_interrupt_locks++;
+    // writing 0 to ISER has no effect, the interrupt is masked through ICER
+    NVIC->ICER[0] = 1 << ((TA0_0_IRQn) & 31);
+    __DSB();
+    __ISB();
+    if (!was_disabled) {
+        Interrupt_enableMaster();
+    }
+}
 void TA0_0_IRQHandler() {
 
     TIMER_A0->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
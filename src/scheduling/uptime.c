@@ -0,0 +1,105 @@
+/*
+ * uptime.c
+ *
+ * Monotonic uptime clock, see uptime.h
+ */
+
+#include "scheduling/uptime.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
+
+uint64_t uptime_extend(uint32_t overflows, uint16_t count, bool pending){
+    // a pending overflow happened before the count was read only if the count is small
+    if(pending && count < 0x8000){
+        overflows++;
+    }
+    return ((uint64_t)overflows << 16) | count;
+}
+
+uint64_t uptime_ticks_to_ms(uint64_t ticks){
+    // 1000 / 32768 = 125 / 4096
+    return ticks / 4096 * 125 + ticks % 4096 * 125 / 4096;
+}
+
+uint64_t uptime_ticks_to_us(uint64_t ticks){
+    // 1000000 / 32768 = 15625 / 512
+    return ticks / 512 * 15625 + ticks % 512 * 15625 / 512;
+}
+
+uint64_t uptime_now_ms(){
+    return uptime_ticks_to_ms(uptime_now_ticks());
+}
+
+uint64_t uptime_now_us(){
+    return uptime_ticks_to_us(uptime_now_ticks());
+}
+
+#ifdef SOFTWARE_DEBUG
+
+static uint64_t uptime_ticks = 0;
+
+void uptime_set_ticks(uint64_t ticks){
+    uptime_ticks = ticks;
+}
+
+uint64_t uptime_now_ticks(){
+    return uptime_ticks;
+}
+
+#else
+
+// wraps of the RTC prescalers, only written by uptime_overflow from the RTC interrupt
+static volatile uint32_t uptime_overflows = 0;
+static volatile bool uptime_started = false;
+// prescaler count at uptime_init, the clock starts from 0 there
+static uint16_t uptime_origin;
+
+// RT1PS:RT0PS count BCLK, asynchronous to MCLK: read until two reads agree
+static uint16_t uptime_count(){
+    uint16_t first;
+    uint16_t second;
+    do{
+        first = RTC_C->PS;
+        second = RTC_C->PS;
+    }while(first != second);
+    return first;
+}
+
+void uptime_init(){
+    uptime_overflows = 0;
+    uptime_origin = uptime_count();
+    // RT1PS divides the 128 Hz output of RT0PS by 256: one event every 2 s, when the 16 bit count wraps
+    RTC_C_definePrescaleEvent(RTC_C_PRESCALE_1, RTC_C_PSEVENTDIVIDER_256);
+    RTC_C_clearInterruptFlag(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+    RTC_C_enableInterrupt(RTC_C_PRESCALE_TIMER1_INTERRUPT);
+    uptime_started = true;
+    Interrupt_enableInterrupt(INT_RTC_C);
+}
+
+uint64_t uptime_now_ticks(){
+    uint32_t overflows;
+    uint16_t count;
+    bool pending;
+    bool was_disabled;
+    if(!uptime_started){
+        return 0;
+    }
+    was_disabled = Interrupt_disableMaster();
+    overflows = uptime_overflows;
+    count = uptime_count();
+    pending = (RTC_C->PS1CTL & RTC_C_PS1CTL_RT1PSIFG) != 0;
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    return uptime_extend(overflows, count, pending) - uptime_origin;
+}
+
+void uptime_overflow(){
+    uptime_overflows++;
+}
+
+#endif
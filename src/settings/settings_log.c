@@ -0,0 +1,268 @@
+/*
+ * settings_log.c
+ *
+ * Settings log in flash, see settings_log.h
+ */
+
+#include "settings/settings_log.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef SOFTWARE_DEBUG
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#endif
+
+#define KEY_NONE 0xFFFF
+
+uint16_t settings_log_crc16(const uint8_t * data, uint16_t len){
+    return settings_log_crc16_update(0xFFFF, data, len);
+}
+
+uint16_t settings_log_crc16_update(uint16_t crc, const uint8_t * data, uint16_t len){
+    uint16_t i;
+    uint8_t bit;
+    for(i = 0; i < len; i++){
+        crc ^= (uint16_t)data[i] << 8;
+        for(bit = 0; bit < 8; bit++){
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint32_t record_header(uint16_t key, int32_t value){
+    uint32_t bits = value;
+    uint8_t bytes[6] = {
+        key & 0xFF, key >> 8,
+        bits & 0xFF, (bits >> 8) & 0xFF, (bits >> 16) & 0xFF, bits >> 24
+    };
+    return ((uint32_t)key << 16) | settings_log_crc16(bytes, 6);
+}
+
+static volatile uint32_t * slot_address(const SettingsLog * log, uint8_t sector, uint16_t slot){
+    return log->sectors[sector] + slot * SETTINGS_LOG_RECORD_WORDS;
+}
+
+static bool slot_erased(const SettingsLog * log, uint8_t sector, uint16_t slot){
+    volatile uint32_t * record = slot_address(log, sector, slot);
+    return record[0] == SETTINGS_LOG_ERASED && record[1] == SETTINGS_LOG_ERASED;
+}
+
+// reads a record, false if the slot is erased or the record is damaged
+static bool slot_read(const SettingsLog * log, uint8_t sector, uint16_t slot, uint16_t * key, int32_t * value){
+    volatile uint32_t * record = slot_address(log, sector, slot);
+    uint32_t header = record[0];
+    int32_t stored = (int32_t)record[1];
+    uint16_t stored_key = header >> 16;
+    if(stored_key == KEY_NONE || record_header(stored_key, stored) != header){
+        return false;
+    }
+    *key = stored_key;
+    *value = stored;
+    return true;
+}
+
+static bool slot_write(const SettingsLog * log, uint8_t sector, uint16_t slot, uint16_t key, int32_t value){
+    uint32_t record[SETTINGS_LOG_RECORD_WORDS] = {record_header(key, value), (uint32_t)value};
+    return log->program(slot_address(log, sector, slot), record, SETTINGS_LOG_RECORD_WORDS);
+}
+
+static bool sector_format(SettingsLog * log, uint8_t sector, uint32_t generation){
+    uint32_t header[SETTINGS_LOG_RECORD_WORDS] = {SETTINGS_LOG_MAGIC, generation};
+    if(!log->erase(log->sectors[sector]) ||
+       !log->program(log->sectors[sector], header, SETTINGS_LOG_RECORD_WORDS)){
+        return false;
+    }
+    log->active = sector;
+    log->generation = generation;
+    log->next = 1;
+    return true;
+}
+
+void settings_log_state_init(SettingsLog * log, volatile uint32_t * const * sectors, uint8_t sector_count,
+                             uint32_t sector_size, SettingsProgramFP program, SettingsEraseFP erase){
+    uint8_t i;
+    if(sector_count > SETTINGS_LOG_MAX_SECTORS){
+        sector_count = SETTINGS_LOG_MAX_SECTORS;
+    }
+    for(i = 0; i < sector_count; i++){
+        log->sectors[i] = sectors[i];
+    }
+    log->sector_count = sector_count;
+    log->sector_slots = sector_size / (SETTINGS_LOG_RECORD_WORDS * sizeof(uint32_t));
+    log->program = program;
+    log->erase = erase;
+    log->keep = NULL;
+    log->active = 0;
+    log->next = log->sector_slots;
+    log->generation = 0;
+}
+
+void settings_log_set_filter(SettingsLog * log, SettingsKeepFP keep){
+    log->keep = keep;
+}
+
+bool settings_log_mount(SettingsLog * log){
+    bool found = false;
+    uint8_t i;
+    for(i = 0; i < log->sector_count; i++){
+        volatile uint32_t * header = log->sectors[i];
+        // a sector whose compaction was interrupted has no magic number yet
+        if(header[0] == SETTINGS_LOG_MAGIC && header[1] != SETTINGS_LOG_ERASED &&
+           (!found || header[1] > log->generation)){
+            log->active = i;
+            log->generation = header[1];
+            found = true;
+        }
+    }
+    if(!found){
+        return sector_format(log, 0, 0);
+    }
+    // after the last programmed slot, damaged records included
+    log->next = log->sector_slots;
+    while(log->next > 1 && slot_erased(log, log->active, log->next - 1)){
+        log->next--;
+    }
+    return true;
+}
+
+uint16_t settings_log_replay(const SettingsLog * log, SettingsApplyFP apply){
+    uint16_t count = 0;
+    uint16_t slot;
+    uint16_t key;
+    int32_t value;
+    for(slot = 1; slot < log->next; slot++){
+        if(slot_read(log, log->active, slot, &key, &value)){
+            apply(key, value);
+            count++;
+        }
+    }
+    return count;
+}
+
+bool settings_log_find(const SettingsLog * log, uint16_t key, int32_t * value){
+    uint16_t slot;
+    uint16_t stored_key;
+    int32_t stored;
+    for(slot = log->next - 1; slot > 0; slot--){
+        if(slot_read(log, log->active, slot, &stored_key, &stored) && stored_key == key){
+            *value = stored;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool settings_log_append(SettingsLog * log, uint16_t key, int32_t value){
+    int32_t stored;
+    if(key == KEY_NONE){
+        return false;
+    }
+    if(settings_log_find(log, key, &stored) && stored == value){
+        return true;
+    }
+    if(log->next == log->sector_slots && !settings_log_compact(log)){
+        return false;
+    }
+    if(log->next == log->sector_slots){
+        // every slot holds a different setting
+        return false;
+    }
+    // the slot is used even if programming failed, it may be partially written
+    return slot_write(log, log->active, log->next++, key, value);
+}
+
+bool settings_log_compact(SettingsLog * log){
+    // off the stack, a compaction runs under option_change_confirm and the flash routines;
+    // it is only called from the main loop, never from an interrupt
+    static uint16_t keys[SETTINGS_LOG_MAX_KEYS];
+    uint8_t key_count = 0;
+    uint8_t target = (log->active + 1) % log->sector_count;
+    uint16_t out = 1;
+    uint16_t slot;
+    uint16_t key;
+    int32_t value;
+    uint8_t i;
+    uint32_t header[SETTINGS_LOG_RECORD_WORDS] = {SETTINGS_LOG_MAGIC, log->generation + 1};
+
+    if(!log->erase(log->sectors[target])){
+        return false;
+    }
+    // newest first, only the latest record of each key is copied
+    for(slot = log->next - 1; slot > 0; slot--){
+        if(!slot_read(log, log->active, slot, &key, &value)){
+            continue;
+        }
+        // a setting no longer used is dropped with all its records
+        if(log->keep != NULL && !log->keep(key)){
+            continue;
+        }
+        for(i = 0; i < key_count && keys[i] != key; i++);
+        if(i < key_count){
+            continue;
+        }
+        if(key_count == SETTINGS_LOG_MAX_KEYS || out == log->sector_slots ||
+           !slot_write(log, target, out, key, value)){
+            return false;
+        }
+        keys[key_count++] = key;
+        out++;
+    }
+    // the new sector becomes valid only once everything has been copied
+    if(!log->program(log->sectors[target], header, SETTINGS_LOG_RECORD_WORDS)){
+        return false;
+    }
+    log->active = target;
+    log->generation++;
+    log->next = out;
+    return true;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+// sectors 30 and 31 of bank 1, the firmware runs from bank 0 and keeps running while they are programmed
+#define SETTINGS_FLASH_SECTOR_MASK (FLASH_SECTOR30 | FLASH_SECTOR31)
+
+static SettingsLog settings;
+
+static bool settings_flash_program(volatile uint32_t * address, const uint32_t * words, uint16_t count){
+    bool ok;
+    FlashCtl_unprotectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, SETTINGS_FLASH_SECTOR_MASK);
+    ok = FlashCtl_programMemory((void *)words, (void *)address, count * sizeof(uint32_t));
+    FlashCtl_protectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, SETTINGS_FLASH_SECTOR_MASK);
+    return ok;
+}
+
+static bool settings_flash_erase(volatile uint32_t * sector){
+    bool ok;
+    FlashCtl_unprotectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, SETTINGS_FLASH_SECTOR_MASK);
+    ok = FlashCtl_eraseSector((uint32_t)sector);
+    FlashCtl_protectSector(FLASH_MAIN_MEMORY_SPACE_BANK1, SETTINGS_FLASH_SECTOR_MASK);
+    return ok;
+}
+
+void settings_init(){
+    volatile uint32_t * const sectors[2] = {
+        (volatile uint32_t *)SETTINGS_FLASH_START,
+        (volatile uint32_t *)(SETTINGS_FLASH_START + SETTINGS_FLASH_SECTOR_SIZE)
+    };
+    settings_log_state_init(&settings, sectors, 2, SETTINGS_FLASH_SECTOR_SIZE,
+                            settings_flash_program, settings_flash_erase);
+    // if the flash cannot be formatted the log looks full, the next save formats it through a compaction
+    settings_log_mount(&settings);
+}
+
+uint16_t settings_replay(SettingsApplyFP apply){
+    return settings_log_replay(&settings, apply);
+}
+
+bool settings_save(uint16_t key, int32_t value){
+    return settings_log_append(&settings, key, value);
+}
+
+void settings_set_filter(SettingsKeepFP keep){
+    settings_log_set_filter(&settings, keep);
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * telemetry.c
+ *
+ * Periodic snapshot of the greenhouse state sent as a single UART frame.
+ */
+
+#include "telemetry/telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SOFTWARE_DEBUG
+#include "scheduling/scheduler.h"
+#include "uart_communication/uart_comm.h"
+#include "option_menu/option_menu.h"
+#include "light_system/growing_light.h"
+#include "environment_systems/temperature.h"
+#include "environment_systems/air_quality.h"
+#include "environment_systems/buzzer.h"
+#include "water_management/water_init.h"
+#include "water_management/water_reading.h"
+#include "water_management/pump_management.h"
+
+static TelemetryState telemetry_state;
+static task_list_index telemetry_task_index;
+#endif
+
+bool telemetry_snapshot_equal(const TelemetrySnapshot * a, const TelemetrySnapshot * b){
+    return a->lux == b->lux &&
+           a->brightness == b->brightness &&
+           a->air_ppm == b->air_ppm &&
+           a->tank_level == b->tank_level &&
+           a->reservoir_level == b->reservoir_level &&
+           a->temperature == b->temperature &&
+           a->flags == b->flags;
+}
+
+uint16_t telemetry_format_frame(const TelemetrySnapshot * snapshot, char * buffer, uint16_t len){
+    int written = snprintf(buffer, len, "%s%lu,%lu,%lu,%u,%lu,%lu,%lu,%u%c",
+                           TELEMETRY_FRAME_HEADER,
+                           (unsigned long)snapshot->timestamp,
+                           (unsigned long)snapshot->lux,
+                           (unsigned long)snapshot->brightness,
+                           (unsigned)snapshot->temperature,
+                           (unsigned long)snapshot->air_ppm,
+                           (unsigned long)snapshot->tank_level,
+                           (unsigned long)snapshot->reservoir_level,
+                           (unsigned)snapshot->flags,
+                           TELEMETRY_FRAME_SEP);
+    if(written < 0 || written >= len){
+        return 0;
+    }
+    return (uint16_t)written;
+}
+
+void telemetry_state_init(TelemetryState * state){
+    memset(state, 0, sizeof(TelemetryState));
+}
+
+bool telemetry_should_send(TelemetryState * state, const TelemetrySnapshot * snapshot){
+    if(!state->has_sent){
+        return true;
+    }
+    if(!telemetry_snapshot_equal(&state->last_sent, snapshot)){
+        return true;
+    }
+    if(state->skipped + 1 >= TELEMETRY_HEARTBEAT_INTERVALS){
+        return true;
+    }
+    state->skipped++;
+    state->suppressed++;
+    return false;
+}
+
+void telemetry_mark_sent(TelemetryState * state, const TelemetrySnapshot * snapshot, bool ok){
+    if(!ok){
+        // keep last_sent untouched so the same values are retried next interval
+        state->dropped++;
+        return;
+    }
+    state->last_sent = *snapshot;
+    state->has_sent = true;
+    state->skipped = 0;
+    state->sent++;
+}
+
+#ifndef SOFTWARE_DEBUG
+
+void telemetry_collect(TelemetrySnapshot * snapshot){
+    snapshot->timestamp = scheduler_get_uptime();
+    snapshot->lux = grow_light_get_lux();
+    snapshot->brightness = grow_light_get_brightness();
+    snapshot->temperature = temp_get_current_temperature();
+    snapshot->air_ppm = air_get_level();
+    // same mapping used by read_tank and read_reservoire
+    snapshot->tank_level = water_arr[1];
+    snapshot->reservoir_level = water_arr[0];
+
+    uint8_t flags = 0;
+    if(is_grow_light_on())      flags |= TELEMETRY_FLAG_LIGHT_ON;
+    if(grow_light_get_mode())   flags |= TELEMETRY_FLAG_LIGHT_MAN;
+    if(act_1)                   flags |= TELEMETRY_FLAG_PUMP1;
+    if(act_2)                   flags |= TELEMETRY_FLAG_PUMP2;
+    if(block)                   flags |= TELEMETRY_FLAG_PUMPS_BLK;
+    if(is_buzzer_on())          flags |= TELEMETRY_FLAG_BUZZER;
+    if(exceeding_threshold())   flags |= TELEMETRY_FLAG_AIR_ALARM;
+    snapshot->flags = flags;
+}
+
+void telemetry_task(){
+    TelemetrySnapshot snapshot;
+    telemetry_collect(&snapshot);
+    if(!telemetry_should_send(&telemetry_state, &snapshot)){
+        return;
+    }
+    char frame[TELEMETRY_FRAME_LEN];
+    uint16_t len = telemetry_format_frame(&snapshot, frame, TELEMETRY_FRAME_LEN);
+    bool ok = len > 0 && uart_send(UART_TX_TELEMETRY, 0, (const uint8_t *)frame, len, NULL);
+    telemetry_mark_sent(&telemetry_state, &snapshot, ok);
+}
+
+void telemetry_init(){
+    telemetry_state_init(&telemetry_state);
+
+    STask task = {
+        .fpointer = telemetry_task,
+        .max_time = TELEMETRY_INTERVAL_DEFAULT,
+        .elapsed_time = TELEMETRY_INTERVAL_DEFAULT,
+        .is_active = true
+    };
+    telemetry_task_index = push_task(task);
+}
+
+void update_telemetry_timer(int32_t new_timer){
+    if(new_timer > 0){
+        set_task_period(telemetry_task_index, new_timer);
+    }
+}
+
+static const OptionDesc telemetry_options[] = {
+    OPTION_TIMER(OPTION_ID_TELEMETRY_TIMER, "telemetry timer",
+                 TELEMETRY_INTERVAL_DEFAULT,
+                 update_telemetry_timer,
+                 to_string_timer_default)
+};
+
+void add_telemetry_options(){
+    option_menu_push_options(telemetry_options, sizeof(telemetry_options) / sizeof(telemetry_options[0]));
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * uart_baud.c
+ *
+ * Computation of the eUSCI_A divider values for an arbitrary clock and baud rate.
+ */
+
+#include "uart_communication/uart_baud.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// fractional parts are handled in 1/10000 to avoid floating point
+#define FRAC_SCALE 10000
+
+/*
+    UCBRSx lookup table from the technical reference manual:
+    the entry to use is the last one whose fraction is <= the fractional part of N
+*/
+typedef struct {
+    uint16_t fraction;
+    uint8_t ucbrs;
+} UcbrsEntry;
+
+static const UcbrsEntry ucbrs_table[] = {
+    {0,    0x00}, {529,  0x01}, {715,  0x02}, {835,  0x04},
+    {1001, 0x08}, {1252, 0x10}, {1430, 0x20}, {1670, 0x11},
+    {2147, 0x21}, {2224, 0x22}, {2503, 0x44}, {3000, 0x25},
+    {3335, 0x49}, {3575, 0x4A}, {3753, 0x52}, {4003, 0x92},
+    {4286, 0x53}, {4378, 0x55}, {5002, 0xAA}, {5715, 0x6B},
+    {6003, 0xAD}, {6254, 0xB5}, {6432, 0xB6}, {6667, 0xD6},
+    {7001, 0xB7}, {7147, 0xBB}, {7503, 0xDD}, {7861, 0xED},
+    {8004, 0xEE}, {8333, 0xBF}, {8464, 0xDF}, {8572, 0xEF},
+    {8751, 0xF7}, {9004, 0xFB}, {9170, 0xFD}, {9288, 0xFE}
+};
+#define UCBRS_TABLE_LEN (sizeof(ucbrs_table) / sizeof(ucbrs_table[0]))
+
+static uint8_t ucbrs_from_fraction(uint32_t fraction){
+    uint8_t ret = 0;
+    uint32_t i;
+    for(i = 0; i < UCBRS_TABLE_LEN; i++){
+        if(ucbrs_table[i].fraction > fraction){
+            break;
+        }
+        ret = ucbrs_table[i].ucbrs;
+    }
+    return ret;
+}
+
+static uint32_t count_ones(uint8_t pattern){
+    uint32_t n = 0;
+    while(pattern){
+        n += pattern & 1;
+        pattern >>= 1;
+    }
+    return n;
+}
+
+uint32_t uart_baud_effective(uint32_t clock_hz, const UART_BaudConfig * config){
+    // divider in eighths of a clock cycle: every bit set in UCBRSx stretches one bit by a cycle
+    uint64_t divider_x8;
+    if(config->oversampling){
+        divider_x8 = ((uint64_t)config->clock_prescalar * 16 + config->first_mod_reg) * 8;
+    }else{
+        divider_x8 = (uint64_t)config->clock_prescalar * 8;
+    }
+    divider_x8 += count_ones(config->second_mod_reg);
+    if(divider_x8 == 0){
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)clock_hz * 8 + divider_x8 / 2) / divider_x8);
+}
+
+bool uart_baud_compute(uint32_t clock_hz, uint32_t baud, UART_BaudConfig * config){
+    config->clock_prescalar = 0;
+    config->first_mod_reg = 0;
+    config->second_mod_reg = 0;
+    config->oversampling = false;
+    config->error = FRAC_SCALE;
+
+    if(baud == 0 || clock_hz == 0){
+        return false;
+    }
+    // N = clock / baud, kept with four decimal digits
+    uint64_t n_scaled = ((uint64_t)clock_hz * FRAC_SCALE) / baud;
+    uint32_t n_int = (uint32_t)(n_scaled / FRAC_SCALE);
+    uint32_t n_frac = (uint32_t)(n_scaled % FRAC_SCALE);
+
+    if(n_int < UART_BAUD_MIN_DIVISOR){
+        return false;
+    }
+
+    if(n_int >= 16){
+        // oversampling mode: UCBRx = INT(N/16), UCBRFx = INT(FRAC(N/16) * 16)
+        uint64_t n16_scaled = n_scaled / 16;
+        config->oversampling = true;
+        config->clock_prescalar = (uint16_t)(n16_scaled / FRAC_SCALE);
+        config->first_mod_reg = (uint8_t)(((n16_scaled % FRAC_SCALE) * 16) / FRAC_SCALE);
+    }else{
+        // low frequency mode: UCBRx = INT(N)
+        config->clock_prescalar = (uint16_t)n_int;
+    }
+    config->second_mod_reg = ucbrs_from_fraction(n_frac);
+
+    int64_t effective = uart_baud_effective(clock_hz, config);
+    config->error = (int32_t)(((effective - (int64_t)baud) * FRAC_SCALE) / (int64_t)baud);
+
+    if(config->error > UART_BAUD_MAX_ERROR || config->error < -UART_BAUD_MAX_ERROR){
+        return false;
+    }
+    return true;
+}
@@ -1,16 +1,35 @@
 #include <msp.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include "uart_communication/uart_comm.h"
+#include "uart_communication/uart_baud.h"
+#include "uart_communication/uart_tx_queue.h"
 #include "option_menu/option_menu_input.h"
 #include "environment_systems/air_quality.h"
 #include "scheduling/scheduler.h"
 #include "scheduling/timer.h"
+#include "clock/clock_profile.h"
+#include "scheduling/calendar.h"
+#include "option_menu/option_remote.h"
+#include "history/history.h"
+#include "datalog/datalog.h"
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #define SEP '$'
+
+// messages waiting for the line, only touched with interrupts disabled or from the ISR
+static UART_TxQueue uart_tx_queue;
+// slot of the message currently in the tx buffer, -1 if none
+static volatile int8_t uart_tx_current = -1;
+// uptime of the last received byte
+static volatile uint32_t uart_last_rx_ms = 0;
+
+static void uart_tx_finish_current();
+static void uart_tx_start_next();
+static void uart_clock_changed(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz);
+
 void uart_init(){
     //setting up uart context
     uart_ctx.tx_buff.write_index = 0;
@@ -20,8 +39,10 @@ void uart_init(){
     uart_ctx.rx_buff.write_index = 0;
     uart_ctx.rx_buff.read_index = 0;
     uart_ctx.rx_overflow = false;
+    uart_ctx.rx_discarding = false;
 
-
+    uart_tx_queue_init(&uart_tx_queue);
+    uart_tx_current = -1;
 
 
     //GPIO CONFIGURATION(P1.2,P1.3)
@@ -31,29 +52,58 @@ void uart_init(){
           GPIO_PRIMARY_MODULE_FUNCTION
     );
 
+    uart_set_baud(UART_DEFAULT_BAUD);
+    clock_profile_register(uart_clock_changed);
+    Interrupt_enableInterrupt(INT_EUSCIA0);
+    Interrupt_enableMaster();
+
+}
+
+bool uart_set_baud(uint32_t baud){
+    UART_BaudConfig baud_config;
+    // the dividers depend on the current SMCLK, so they are recomputed on every change
+    uint32_t clock_hz = CS_getSMCLK();
+    if(!uart_baud_compute(clock_hz, baud, &baud_config)){
+        return false;
+    }
+
     eUSCI_UART_ConfigV1 uart_config = {
          EUSCI_A_UART_CLOCKSOURCE_SMCLK,
-         19,
-         8,
-         85,
+         baud_config.clock_prescalar,
+         baud_config.first_mod_reg,
+         baud_config.second_mod_reg,
          EUSCI_A_UART_NO_PARITY,
          EUSCI_A_UART_LSB_FIRST,
          EUSCI_A_UART_ONE_STOP_BIT,
          EUSCI_A_UART_MODE,
-         EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION,
+         baud_config.oversampling ? EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION
+                                  : EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION,
          EUSCI_A_UART_8_BIT_LEN
     };
-    //initialize and enable uart
+    // wait for the last byte to leave the shift register before touching the dividers
+    while(UART_queryStatusFlags(EUSCI_A0_BASE, EUSCI_A_UART_BUSY));
+
+    //initialize and enable uart (initModule puts the module in reset, clearing the interrupt enables)
     UART_initModule(EUSCI_A0_BASE, &uart_config);
     UART_enableModule(EUSCI_A0_BASE);
 
     // enable TX and RX interrupts
     UART_enableInterrupt(EUSCI_A0_BASE,
                              EUSCI_A_UART_TRANSMIT_INTERRUPT | EUSCI_A_UART_RECEIVE_INTERRUPT);
+    uart_ctx.baud = baud;
+    return true;
+}
 
-    Interrupt_enableInterrupt(INT_EUSCIA0);
-    Interrupt_enableMaster();
-
+static void uart_clock_changed(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz){
+    if(change == CLOCK_CHANGE_BEFORE){
+        // a byte shifted out while the clock changes would be garbled
+        while(UART_queryStatusFlags(EUSCI_A0_BASE, EUSCI_A_UART_BUSY));
+        return;
+    }
+    // the baud rate may not be reachable from the new clock
+    if(!uart_set_baud(uart_ctx.baud)){
+        uart_set_baud(UART_DEFAULT_BAUD);
+    }
 }
 
 
@@ -125,15 +175,9 @@ void EUSCIA0_IRQHandler(void) {
             UART_transmitData(EUSCI_A0_BASE, next_ch);
            // printf("transmitted %c\n",next_ch);
         }else{
-            //buffer empty: disable tx interrupt
-            UART_disableInterrupt(EUSCI_A0_BASE,EUSCI_A_UART_TRANSMIT_INTERRUPT);
-            uart_ctx.tx_busy = false;
-
-            //invoke tx completion callback
-            if(uart_ctx.tx_complete_callback){
-                uart_ctx.tx_complete_callback();
-
-            }
+            //buffer empty: the current message is done, load the next one
+            uart_tx_finish_current();
+            uart_tx_start_next();
         }
     }
     // rx
@@ -141,6 +185,7 @@ void EUSCIA0_IRQHandler(void) {
     if(status & EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG){
 
         uint8_t rx_data = UART_receiveData(EUSCI_A0_BASE);
+        uart_last_rx_ms = scheduler_get_uptime();
 
         if(uart_buff_enqueue(&uart_ctx.rx_buff,rx_data)){
 
@@ -178,36 +223,77 @@ void rx_data_callback(uint8_t ch){
 
 }
 
-bool UART_write(const uint8_t *data, uint16_t length, void (*callback)(void)){
-    // disable interrupts for atomic access
-    uint32_t int_status = Interrupt_disableMaster();
-    //check buffer space
-    uint16_t free_space = buff_available_space(&uart_ctx.tx_buff);
-    if(free_space < length){
-        Interrupt_enableMaster();
-        return false;
+// must be called with interrupts disabled or from the ISR
+static void uart_tx_finish_current(){
+    if(uart_tx_current < 0){
+        return;
     }
-    uint16_t i = 0;
-    for(i = 0;i < length;i++){
+    fp_tx_msg_callback callback = uart_tx_queue_message(&uart_tx_queue, uart_tx_current)->callback;
+    uart_tx_queue_release(&uart_tx_queue, uart_tx_current);
+    uart_tx_current = -1;
+    //invoke tx completion callback of this message
+    if(callback){
+        callback();
+    }
+}
 
-        uart_buff_enqueue(&uart_ctx.tx_buff,data[i]);
-        if(data[i]==0){
-                    break;
-        }
+// must be called with interrupts disabled or from the ISR, when the tx buffer is empty
+static void uart_tx_start_next(){
+    int8_t slot = uart_tx_queue_pop(&uart_tx_queue);
+    if(slot < 0){
+        //nothing left: disable tx interrupt
+        UART_disableInterrupt(EUSCI_A0_BASE,EUSCI_A_UART_TRANSMIT_INTERRUPT);
+        uart_ctx.tx_busy = false;
+        return;
+    }
+    UART_TxMessage * msg = uart_tx_queue_message(&uart_tx_queue, slot);
+    uart_tx_current = slot;
+    // the first byte goes straight to the hardware, the rest through the buffer
+    uint16_t i;
+    for(i = 1; i < msg->len; i++){
+        uart_buff_enqueue(&uart_ctx.tx_buff, msg->data[i]);
     }
-    uart_ctx.tx_complete_callback = callback;
+    uart_ctx.tx_busy = true;
+    UART_enableInterrupt(EUSCI_A0_BASE,EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    UART_transmitData(EUSCI_A0_BASE, msg->data[0]);
+}
+
+bool uart_send(UART_TxClass msg_class, uint16_t key, const uint8_t *data, uint16_t length, void (*callback)(void)){
+    // disable interrupts for atomic access
+    bool was_disabled = Interrupt_disableMaster();
+    bool ret = uart_tx_queue_push(&uart_tx_queue, msg_class, key, data, length, callback);
 
     //start transmission
-    if(!uart_ctx.tx_busy){
-        uart_ctx.tx_busy = true;
-        UART_enableInterrupt(EUSCI_A0_BASE,EUSCI_A_UART_TRANSMIT_INTERRUPT);
-        // Trigger first transmission
-        int32_t first_ch = uart_buff_dequeue(&uart_ctx.tx_buff,NULL);
+    if(ret && !uart_ctx.tx_busy){
+        uart_tx_start_next();
+    }
+    if(!was_disabled){
+        Interrupt_enableMaster();
+    }
+    return ret;
+}
+
+bool uart_is_active(uint32_t hold_ms){
+    if(uart_ctx.tx_busy || !uart_buff_is_empty(&uart_ctx.rx_buff)){
+        return true;
+    }
+    return scheduler_get_uptime() - uart_last_rx_ms < hold_ms;
+}
 
-        UART_transmitData(EUSCI_A0_BASE, first_ch);
+bool UART_write(const uint8_t *data, uint16_t length, void (*callback)(void)){
+    return uart_send(UART_TX_REPLY, 0, data, length, callback);
+}
 
+bool uart_get_tx_stats(UART_TxClass msg_class, UART_TxStats * stats){
+    const UART_TxStats * src = uart_tx_queue_stats(&uart_tx_queue, msg_class);
+    if(!src){
+        return false;
+    }
+    bool was_disabled = Interrupt_disableMaster();
+    *stats = *src;
+    if(!was_disabled){
+        Interrupt_enableMaster();
     }
-    Interrupt_enableMaster();
     return true;
 }
 
@@ -244,6 +330,27 @@ void RMT_to_string(uint8_t * buffer, RxMessageType type){
     case AIR:
         strcpy(buffer,"AIR");
         break;
+    case TIME:
+        strcpy(buffer,"TIME");
+        break;
+    case GET:
+        strcpy(buffer,"GET");
+        break;
+    case SET:
+        strcpy(buffer,"SET");
+        break;
+    case LIST:
+        strcpy(buffer,"LIST");
+        break;
+    case HIST:
+        strcpy(buffer,"HIST");
+        break;
+    case LOGINFO:
+        strcpy(buffer,"LOGINFO");
+        break;
+    case LOGGET:
+        strcpy(buffer,"LOGGET");
+        break;
     }
 }
 
@@ -260,6 +367,27 @@ RxMessageType RMT_from_string(const uint8_t * str,uint16_t len){
     if(strncmp(str,"AIR",3)==0){
             return AIR;
         }
+    if(strncmp(str,"TIME",4)==0){
+            return TIME;
+        }
+    if(strncmp(str,"GET",3)==0){
+            return GET;
+        }
+    if(strncmp(str,"SET",3)==0){
+            return SET;
+        }
+    if(strncmp(str,"LIST",4)==0){
+            return LIST;
+        }
+    if(strncmp(str,"HIST",4)==0){
+            return HIST;
+        }
+    if(strncmp(str,"LOGINFO",7)==0){
+            return LOGINFO;
+        }
+    if(strncmp(str,"LOGGET",6)==0){
+            return LOGGET;
+        }
     return AIR;
 }
 
@@ -267,6 +395,19 @@ void handle_msg(){
 
     uint16_t len = UART_read(uart_ctx.read_buf,READ_BUF_LEN);
 
+    //too long, the rest of the message is dropped up to its separator, which
+    //may only arrive for a later call
+    while(uart_ctx.rx_discarding || (len == READ_BUF_LEN && uart_ctx.read_buf[len-1] != '\0')){
+        uart_ctx.rx_discarding = true;
+        if(len > 0 && uart_ctx.read_buf[len-1] == '\0'){
+            uart_ctx.rx_discarding = false;
+            return;
+        }
+        if(len < READ_BUF_LEN){
+            return;
+        }
+        len = UART_read(uart_ctx.read_buf,READ_BUF_LEN);
+    }
     parse_msg(uart_ctx.read_buf,len);
 
 
@@ -296,6 +437,12 @@ void handle_air_msg(const char * buff, uint16_t len){
     uint32_t val = (uint32_t) atoi(buff);
     air_set_level(val);
 }
+void handle_time_msg(const char * buff, uint16_t len){
+    CalendarTime time;
+    if(calendar_parse_time(buff, &time)){
+        calendar_set_time(&time);
+    }
+}
 void parse_msg(const uint8_t * buffer,uint16_t len){
 
     printf("%s\n",buffer);
@@ -320,6 +467,27 @@ void parse_msg(const uint8_t * buffer,uint16_t len){
         case AIR:
             handle_air_msg(value_str,len-index);
             break;
+        case TIME:
+            handle_time_msg(value_str,len-index);
+            break;
+        case GET:
+            option_remote_get(value_str);
+            break;
+        case SET:
+            option_remote_set(value_str);
+            break;
+        case LIST:
+            option_remote_list(value_str);
+            break;
+        case HIST:
+            history_query(value_str);
+            break;
+        case LOGINFO:
+            datalog_info(value_str);
+            break;
+        case LOGGET:
+            datalog_get(value_str);
+            break;
     }
     return;
 
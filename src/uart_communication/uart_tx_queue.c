@@ -0,0 +1,188 @@
+/*
+ * uart_tx_queue.c
+ *
+ * Priority queue of the messages waiting to be sent through UART.
+ */
+
+#include "uart_communication/uart_tx_queue.h"
+#include <string.h>
+
+#define NO_SLOT -1
+
+static const uint8_t default_limit[UART_TX_N_CLASSES] = {6, 4, 2, 1};
+static const UART_TxPolicy default_policy[UART_TX_N_CLASSES] = {
+    UART_TX_COALESCE,
+    UART_TX_DROP_NEWEST,
+    UART_TX_COALESCE,
+    UART_TX_COALESCE
+};
+
+void uart_tx_queue_init(UART_TxQueue * queue){
+    int i;
+    memset(queue, 0, sizeof(UART_TxQueue));
+    // every slot starts in the free list
+    for(i = 0; i < UART_TX_QUEUE_SLOTS; i++){
+        queue->next[i] = (i + 1 < UART_TX_QUEUE_SLOTS) ? i + 1 : NO_SLOT;
+    }
+    queue->free_head = 0;
+    for(i = 0; i < UART_TX_N_CLASSES; i++){
+        queue->head[i] = NO_SLOT;
+        queue->tail[i] = NO_SLOT;
+        queue->limit[i] = default_limit[i];
+        queue->policy[i] = default_policy[i];
+    }
+}
+
+void uart_tx_queue_set_policy(UART_TxQueue * queue, UART_TxClass msg_class, UART_TxPolicy policy, uint8_t limit){
+    if(msg_class >= UART_TX_N_CLASSES){
+        return;
+    }
+    if(limit < 1){
+        limit = 1;
+    }else if(limit > UART_TX_QUEUE_SLOTS){
+        limit = UART_TX_QUEUE_SLOTS;
+    }
+    queue->policy[msg_class] = policy;
+    queue->limit[msg_class] = limit;
+}
+
+// removes the oldest message of a class and puts its slot back in the free list
+static void drop_oldest(UART_TxQueue * queue, UART_TxClass msg_class){
+    int8_t slot = queue->head[msg_class];
+    if(slot == NO_SLOT){
+        return;
+    }
+    queue->head[msg_class] = queue->next[slot];
+    if(queue->head[msg_class] == NO_SLOT){
+        queue->tail[msg_class] = NO_SLOT;
+    }
+    queue->next[slot] = queue->free_head;
+    queue->free_head = slot;
+    queue->stats[msg_class].pending--;
+    queue->stats[msg_class].dropped++;
+}
+
+static int8_t find_key(UART_TxQueue * queue, UART_TxClass msg_class, uint16_t key){
+    int8_t slot = queue->head[msg_class];
+    while(slot != NO_SLOT){
+        if(queue->slots[slot].key == key){
+            return slot;
+        }
+        slot = queue->next[slot];
+    }
+    return NO_SLOT;
+}
+
+static void fill_slot(UART_TxMessage * msg, UART_TxClass msg_class, uint16_t key,
+                      const uint8_t * data, uint16_t len, fp_tx_msg_callback callback){
+    memcpy(msg->data, data, len);
+    msg->len = len;
+    msg->key = key;
+    msg->msg_class = msg_class;
+    msg->callback = callback;
+}
+
+bool uart_tx_queue_push(UART_TxQueue * queue, UART_TxClass msg_class, uint16_t key,
+                        const uint8_t * data, uint16_t len, fp_tx_msg_callback callback){
+    if(msg_class >= UART_TX_N_CLASSES){
+        return false;
+    }
+    UART_TxStats * stats = &queue->stats[msg_class];
+    if(len == 0 || len > UART_TX_MSG_LEN){
+        stats->dropped++;
+        return false;
+    }
+
+    if(queue->policy[msg_class] == UART_TX_COALESCE){
+        int8_t slot = find_key(queue, msg_class, key);
+        if(slot != NO_SLOT){
+            // keeps its place in the list, only the content is newer
+            fill_slot(&queue->slots[slot], msg_class, key, data, len, callback);
+            stats->coalesced++;
+            stats->enqueued++;
+            return true;
+        }
+    }
+
+    if(stats->pending >= queue->limit[msg_class]){
+        if(queue->policy[msg_class] == UART_TX_DROP_NEWEST){
+            stats->dropped++;
+            return false;
+        }
+        drop_oldest(queue, msg_class);
+    }
+
+    if(queue->free_head == NO_SLOT){
+        // pool full: take the place of the oldest message of the least important class below this one
+        int lower;
+        for(lower = UART_TX_N_CLASSES - 1; lower > (int)msg_class; lower--){
+            if(queue->head[lower] != NO_SLOT){
+                drop_oldest(queue, (UART_TxClass)lower);
+                break;
+            }
+        }
+        if(queue->free_head == NO_SLOT){
+            stats->dropped++;
+            return false;
+        }
+    }
+
+    int8_t slot = queue->free_head;
+    queue->free_head = queue->next[slot];
+    fill_slot(&queue->slots[slot], msg_class, key, data, len, callback);
+    queue->next[slot] = NO_SLOT;
+    if(queue->tail[msg_class] == NO_SLOT){
+        queue->head[msg_class] = slot;
+    }else{
+        queue->next[queue->tail[msg_class]] = slot;
+    }
+    queue->tail[msg_class] = slot;
+
+    stats->enqueued++;
+    stats->pending++;
+    if(stats->pending > stats->max_pending){
+        stats->max_pending = stats->pending;
+    }
+    return true;
+}
+
+int8_t uart_tx_queue_pop(UART_TxQueue * queue){
+    int i;
+    for(i = 0; i < UART_TX_N_CLASSES; i++){
+        int8_t slot = queue->head[i];
+        if(slot == NO_SLOT){
+            continue;
+        }
+        queue->head[i] = queue->next[slot];
+        if(queue->head[i] == NO_SLOT){
+            queue->tail[i] = NO_SLOT;
+        }
+        queue->next[slot] = NO_SLOT;
+        queue->stats[i].pending--;
+        return slot;
+    }
+    return NO_SLOT;
+}
+
+void uart_tx_queue_release(UART_TxQueue * queue, int8_t slot){
+    if(slot < 0 || slot >= UART_TX_QUEUE_SLOTS){
+        return;
+    }
+    queue->stats[queue->slots[slot].msg_class].sent++;
+    queue->next[slot] = queue->free_head;
+    queue->free_head = slot;
+}
+
+UART_TxMessage * uart_tx_queue_message(UART_TxQueue * queue, int8_t slot){
+    if(slot < 0 || slot >= UART_TX_QUEUE_SLOTS){
+        return 0;
+    }
+    return &queue->slots[slot];
+}
+
+const UART_TxStats * uart_tx_queue_stats(const UART_TxQueue * queue, UART_TxClass msg_class){
+    if(msg_class >= UART_TX_N_CLASSES){
+        return 0;
+    }
+    return &queue->stats[msg_class];
+}
@@ -10,6 +10,8 @@
 #include "water_management/water_init.h"
 #include "option_menu/options.h"
 #include "option_menu/option_menu.h"
+#include "observer/observer.h"
+#include "IOT/iot_publish.h"
 
 #include <stdio.h>
 #include <stdbool.h>
@@ -58,7 +60,7 @@ void activate_pump1() {
         #endif
         
         // Send pump activation status to communication interface
-        send_data(6, 1, 0);
+        iot_publish(6, 1, 0, 1);
         
         // Turn on pump 1 (set pin HIGH)
         PUMP1_PORT->OUT |= PUMP1_PIN;
@@ -69,6 +71,7 @@ void activate_pump1() {
         
         // Update pump status flag
         act_1 = true;
+        observer_notify(OBSERVED_PUMP1, true);
     } else {
         #ifndef DEBUG
         printf("Blocked pump 1 activation\n");
@@ -77,6 +80,20 @@ void activate_pump1() {
 }
 
 
+/**
+ * water_pump1_daily() - Daily watering run of pump 1
+ * 
+ * Calendar callback: activates pump 1 like its periodic task, unless the pumps
+ * are in manual mode, where only the user switches them.
+ */
+void water_pump1_daily() {
+    if (water_option_values.manual_mode) {
+        return;
+    }
+    activate_pump1();
+}
+
+
 /**
  * turn_off_pump1() - Turn off water pump 1
  * 
@@ -91,7 +108,7 @@ void turn_off_pump1() {
         #endif
         
         // Send pump deactivation status to communication interface
-        send_data(6, 0, 0);
+        iot_publish(6, 0, 0, 0);
 
         // Turn off pump 1 (set pin LOW)
         PUMP1_PORT->OUT &= ~PUMP1_PIN;
@@ -102,6 +119,7 @@ void turn_off_pump1() {
         
         // Update pump status flag
         act_1 = false;
+        observer_notify(OBSERVED_PUMP1, false);
     } else {
         #ifndef DEBUG
         printf("Blocked pump 1 deactivation\n");
@@ -121,7 +139,7 @@ void activate_pump2() {
     #endif
     
     // Send pump activation status to communication interface
-    send_data(7, 1, 0);
+    iot_publish(7, 1, 0, 1);
     
     // Turn on pump 2 (set pin HIGH)
     PUMP2_PORT->OUT |= PUMP2_PIN;
@@ -132,6 +150,7 @@ void activate_pump2() {
     
     // Update pump status flag
     act_2 = true;
+    observer_notify(OBSERVED_PUMP2, true);
 }
 
 /**
@@ -148,7 +167,7 @@ void turn_off_pump2() {
         #endif
         
         // Send pump deactivation status to communication interface
-        send_data(7, 0, 0);
+        iot_publish(7, 0, 0, 0);
         
         // Turn off pump 2 (set pin LOW)
         PUMP2_PORT->OUT &= ~PUMP2_PIN;
@@ -159,6 +178,7 @@ void turn_off_pump2() {
         
         // Update pump status flag
         act_2 = false;
+        observer_notify(OBSERVED_PUMP2, false);
     } else {
         #ifndef DEBUG
         printf("Blocked pump 2 deactivation\n");
@@ -166,6 +186,28 @@ void turn_off_pump2() {
     }
 }
 
+static const OptionDesc pump_options[] = {
+    // Manual/Automatic mode toggle
+    OPTION_SWITCH(OPTION_ID_PUMPS_MANUAL_MODE, "Pumps Manual Mode", false,
+                  upd_manual_mode, to_string_manual_auto),
+
+    // Manual control switches for individual pumps
+    OPTION_SWITCH(OPTION_ID_PUMP1_STATUS, "Pump 1 Status", false,
+                  upd_manual_pump1_status, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_PUMP2_STATUS, "Pump 2 Status", false,
+                  upd_manual_pump2_status, to_string_switch_default),
+
+    // Timing configuration options
+    OPTION_TIMER(OPTION_ID_PUMP1_ENABLE_TIME, "Pump 1 Enable Time", PUMP1_ENABLE_TIME_DEFAULT,
+                 upd_pump1_enable_time, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP2_ENABLE_TIME, "Pump 2 Enable Time", PUMP2_ENABLE_TIME_DEFAULT,
+                 upd_pump2_enable_time, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP1_DISABLE_TIME, "Pump 1 Disable Time", PUMP1_DISABLE_TIME_DEFAULT,
+                 upd_pump1_disable_time, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP2_DISABLE_TIME, "Pump 2 Disable Time", PUMP2_DISABLE_TIME_DEFAULT,
+                 upd_pump2_disable_time, to_string_timer_default)
+};
+
 /**
  * add_pump_options() - Initialize pump configuration options for the menu system
  * 
@@ -173,42 +215,7 @@ void turn_off_pump2() {
  * Allows users to control pump behavior through the interface.
  */
 void add_pump_options() {
-    int error;
-    
-    // Manual/Automatic mode toggle
-    OptionUnion manual_mode = option_u_new_switch(false);
-    option_menu_push_option(option_new("Pumps Manual Mode", SWITCH, manual_mode, 
-                                      upd_manual_mode, to_string_manual_auto));
-
-    // Manual control switches for individual pumps
-    OptionUnion pump1_toggled = option_u_new_switch(false);
-    option_menu_push_option(option_new("Pump 1 Status", SWITCH, pump1_toggled, 
-                                      upd_manual_pump1_status, to_string_switch_default));
-
-    OptionUnion pump2_toggled = option_u_new_switch(false);
-    option_menu_push_option(option_new("Pump 2 Status", SWITCH, pump2_toggled, 
-                                      upd_manual_pump2_status, to_string_switch_default));
-
-    // Timing configuration options
-    OptionUnion enable_pump1_time = option_u_new_timer(
-        timer_option_get_name_by_value(PUMP1_ENABLE_TIME_DEFAULT), &error);
-    option_menu_push_option(option_new("Pump 1 Enable Time", TIMER, enable_pump1_time, 
-                                      upd_pump1_enable_time, to_string_timer_default));
-
-    OptionUnion enable_pump2_time = option_u_new_timer(
-        timer_option_get_name_by_value(PUMP2_ENABLE_TIME_DEFAULT), &error);
-    option_menu_push_option(option_new("Pump 2 Enable Time", TIMER, enable_pump2_time, 
-                                      upd_pump2_enable_time, to_string_timer_default));
-
-    OptionUnion disable_pump1_time = option_u_new_timer(
-        timer_option_get_name_by_value(PUMP1_DISABLE_TIME_DEFAULT), &error);
-    option_menu_push_option(option_new("Pump 1 Disable Time", TIMER, disable_pump1_time, 
-                                      upd_pump1_disable_time, to_string_timer_default));
-
-    OptionUnion disable_pump2_time = option_u_new_timer(
-        timer_option_get_name_by_value(PUMP2_DISABLE_TIME_DEFAULT), &error);
-    option_menu_push_option(option_new("Pump 2 Disable Time", TIMER, disable_pump2_time, 
-                                      upd_pump2_disable_time, to_string_timer_default));
+    option_menu_push_options(pump_options, sizeof(pump_options) / sizeof(pump_options[0]));
 }
 
 /**
@@ -218,22 +225,22 @@ void add_pump_options() {
 
 void upd_pump1_enable_time(int32_t val) {
     water_option_values.enable_pump1_time = val;
-    task_list.task_array[activate_pump1_index].max_time = val;
+    set_task_period(activate_pump1_index, val);
 }
 
 void upd_pump2_enable_time(int32_t val) {
     water_option_values.enable_pump2_time = val;
-    task_list.task_array[activate_pump2_index].max_time = val;
+    set_task_period(activate_pump2_index, val);
 }
 
 void upd_pump1_disable_time(int32_t val) {
     water_option_values.disable_pump1_time = val;
-    task_list.task_array[deactivate_pump1_index].max_time = val;
+    set_task_period(deactivate_pump1_index, val);
 }
 
 void upd_pump2_disable_time(int32_t val) {
     water_option_values.disable_pump2_time = val;
-    task_list.task_array[deactivate_pump2_index].max_time = val;
+    set_task_period(deactivate_pump2_index, val);
 }
 
 /**
@@ -9,6 +9,7 @@
 #include "water_management/pump_management.h"
 #include "water_management/water_reading.h"
 #include "scheduling/scheduler.h"
+#include "scheduling/calendar.h"
 
 void water_option_values_init(){
     water_option_values.manual_mode = false;
@@ -84,6 +85,9 @@ void water_init(){
       deactivate_pump2_index=push_task(task4);
       index_tank=push_task(task5);
       index_reservoire=push_task(task6);
+
+      // pump 1 also waters every morning, its deactivation task stops it
+      calendar_add(CALENDAR_EVERY_DAY, PUMP1_WATERING_HOUR, PUMP1_WATERING_MINUTE, water_pump1_daily);
 }
 
 void add_water_options(){
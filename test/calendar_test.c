@@ -0,0 +1,204 @@
+#include "calendar_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "scheduling/calendar.h"
+#include "light_system/growing_light.h"
+
+static Calendar calendar;
+static uint16_t lights_runs;
+static uint16_t pump_runs;
+static uint16_t weekly_runs;
+// minute of the week of the simulated RTC, read by the routines
+static uint16_t sim_now;
+static uint16_t last_weekly_at;
+
+static void lights(){
+    lights_runs++;
+}
+static void pump(){
+    pump_runs++;
+}
+static void weekly(){
+    weekly_runs++;
+    last_weekly_at = sim_now;
+}
+
+static uint16_t at(uint8_t day, uint8_t hour, uint8_t minute){
+    CalendarTime time = {day, hour, minute, 0};
+    return calendar_minute_of_week(&time);
+}
+
+static void run_due(uint16_t now){
+    CalendarFP due[CALENDAR_MAX_RULES];
+    uint8_t count = calendar_due(&calendar, now, due);
+    uint8_t i;
+    for(i = 0; i < count; i++){
+        due[i]();
+    }
+}
+
+void calendar_test_rules(){
+    CalendarTime bad = {7, 0, 0, 0};
+    uint8_t i;
+    calendar_state_init(&calendar);
+    assert(calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 6, 0, lights) == 0);
+    assert(calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 24, 0, lights) == -1);
+    assert(calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 6, 60, lights) == -1);
+    assert(calendar_add_rule(&calendar, 0, 6, 0, lights) == -1);
+    assert(calendar_add_rule(&calendar, 0x80, 6, 0, lights) == -1);
+    assert(calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 6, 0, NULL) == -1);
+    for(i = 1; i < CALENDAR_MAX_RULES; i++){
+        assert(calendar_add_rule(&calendar, CALENDAR_DAY(1), 0, i, pump) == i);
+    }
+    assert(calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 6, 0, lights) == -1);
+
+    assert(at(0, 0, 0) == 0);
+    assert(at(6, 23, 59) == CALENDAR_MINUTES_PER_WEEK - 1);
+    assert(calendar_minute_of_week(&bad) == CALENDAR_MINUTES_PER_WEEK);
+}
+
+void calendar_test_next(){
+    uint16_t next;
+    calendar_state_init(&calendar);
+    assert(!calendar_next(&calendar, 0, &next));
+
+    calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, PHOTOPERIOD_START_HOUR, 0, lights);
+    calendar_add_rule(&calendar, CALENDAR_DAY(3), 12, 30, weekly);
+    assert(calendar_next(&calendar, at(1, 0, 0), &next) && next == at(1, PHOTOPERIOD_START_HOUR, 0));
+    // strictly after now
+    assert(calendar_next(&calendar, at(1, PHOTOPERIOD_START_HOUR, 0), &next) && next == at(2, PHOTOPERIOD_START_HOUR, 0));
+    assert(calendar_next(&calendar, at(3, 7, 0), &next) && next == at(3, 12, 30));
+    // wraps around the end of the week
+    assert(calendar_next(&calendar, at(6, 23, 0), &next) && next == at(0, PHOTOPERIOD_START_HOUR, 0));
+
+    // a single weekly rule is a week away from itself
+    calendar_state_init(&calendar);
+    calendar_add_rule(&calendar, CALENDAR_DAY(3), 12, 30, weekly);
+    assert(calendar_next(&calendar, at(3, 12, 30), &next) && next == at(3, 12, 30));
+}
+
+void calendar_test_due(){
+    calendar_state_init(&calendar);
+    lights_runs = 0;
+    pump_runs = 0;
+    calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, 6, 0, lights);
+    calendar_add_rule(&calendar, CALENDAR_WEEKDAYS, 7, 0, pump);
+
+    // nothing runs before the clock is set, the RTC only counts from boot
+    assert(!calendar.synced);
+    run_due(at(0, 0, 0));
+    run_due(at(1, 8, 0));
+    assert(lights_runs == 0);
+    assert(pump_runs == 0);
+
+    // the rules at the minute the clock is set to still run
+    calendar_sync(&calendar, at(1, 6, 0));
+    run_due(at(1, 6, 0));
+    assert(lights_runs == 1);
+    // but only once
+    run_due(at(1, 6, 0));
+    assert(lights_runs == 1);
+
+    run_due(at(1, 7, 0));
+    assert(pump_runs == 1);
+    // saturday: no pump
+    calendar_sync(&calendar, at(6, 5, 0));
+    run_due(at(6, 8, 0));
+    assert(lights_runs == 2);
+    assert(pump_runs == 1);
+
+    // an alarm handled late: the missed rules run once each
+    calendar_sync(&calendar, at(1, 5, 0));
+    run_due(at(3, 8, 0));
+    assert(lights_runs == 3);
+    assert(pump_runs == 2);
+}
+
+void calendar_test_window(){
+    uint16_t start = PHOTOPERIOD_START_HOUR * 60;
+    uint16_t end = PHOTOPERIOD_END_HOUR * 60;
+    assert(!calendar_in_window(start - 1, start, end));
+    assert(calendar_in_window(start, start, end));
+    assert(calendar_in_window(end - 1, start, end));
+    assert(!calendar_in_window(end, start, end));
+    // 16 hours on, 8 off
+    assert(end - start == 16 * 60);
+    // across midnight
+    assert(calendar_in_window(23 * 60, end, start));
+    assert(calendar_in_window(0, end, start));
+    assert(!calendar_in_window(12 * 60, end, start));
+}
+
+void calendar_test_parse_time(){
+    CalendarTime time;
+    assert(calendar_parse_time("3,14,05,59", &time));
+    assert(time.day_of_week == 3 && time.hour == 14 && time.minute == 5 && time.second == 59);
+    assert(!calendar_parse_time("7,14,05,59", &time));
+    assert(!calendar_parse_time("3,24,05,59", &time));
+    assert(!calendar_parse_time("3,14,60,00", &time));
+    assert(!calendar_parse_time("3,14,05", &time));
+    assert(!calendar_parse_time("3,14,05,00,", &time));
+    assert(!calendar_parse_time("3,,05,00", &time));
+    assert(!calendar_parse_time("", &time));
+    // a failed parse leaves the time untouched
+    assert(time.day_of_week == 3 && time.hour == 14);
+}
+
+/*
+    simulated RTC: the clock advances one minute at a time and the CPU only wakes
+    up when it reaches the programmed alarm, like with RTC_C in LPM3
+*/
+void calendar_test_simulated_week(){
+    uint16_t alarm;
+    bool armed;
+    uint16_t wakeups = 0;
+    uint32_t minute;
+
+    calendar_state_init(&calendar);
+    lights_runs = 0;
+    pump_runs = 0;
+    weekly_runs = 0;
+    calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, PHOTOPERIOD_START_HOUR, 0, lights);
+    calendar_add_rule(&calendar, CALENDAR_EVERY_DAY, PHOTOPERIOD_END_HOUR, 0, lights);
+    calendar_add_rule(&calendar, CALENDAR_WEEKDAYS, 7, 0, pump);
+    calendar_add_rule(&calendar, CALENDAR_DAY(3), 12, 30, weekly);
+
+    // clock set on wednesday at 12:00
+    sim_now = at(3, 12, 0);
+    calendar_sync(&calendar, sim_now);
+    run_due(sim_now);
+    armed = calendar_next(&calendar, sim_now, &alarm);
+
+    for(minute = 1; minute <= CALENDAR_MINUTES_PER_WEEK; minute++){
+        sim_now = (at(3, 12, 0) + minute) % CALENDAR_MINUTES_PER_WEEK;
+        if(!armed || sim_now != alarm){
+            continue;
+        }
+        wakeups++;
+        run_due(sim_now);
+        armed = calendar_next(&calendar, sim_now, &alarm);
+    }
+
+    printf("calendar: %u wakeups in a simulated week\n", wakeups);
+    assert(lights_runs == 14);
+    assert(pump_runs == 5);
+    assert(weekly_runs == 1);
+    assert(last_weekly_at == at(3, 12, 30));
+    // one wakeup per rule run, nothing else
+    assert(wakeups == lights_runs + pump_runs + weekly_runs);
+}
+
+int calendar_test_main(){
+
+    calendar_test_rules();
+    calendar_test_next();
+    calendar_test_due();
+    calendar_test_window();
+    calendar_test_parse_time();
+    calendar_test_simulated_week();
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef TEST_CALENDAR_TEST_H_
+#define TEST_CALENDAR_TEST_H_
+
+void calendar_test_rules();
+void calendar_test_next();
+void calendar_test_due();
+void calendar_test_window();
+void calendar_test_parse_time();
+void calendar_test_simulated_week();
+int calendar_test_main();
+
+#endif
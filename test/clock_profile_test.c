@@ -0,0 +1,115 @@
+#include "clock_profile_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "clock/clock_profile.h"
+
+void clock_profile_test_desc(){
+    const ClockProfileDesc * desc = clock_profile_desc(CLOCK_PROFILE_LOW_POWER);
+    assert(desc->mclk_hz == 3000000 && desc->smclk_hz == 3000000);
+    assert(desc->vcore == 0 && desc->wait_states == 0);
+
+    desc = clock_profile_desc(CLOCK_PROFILE_NOMINAL);
+    assert(desc->mclk_hz == 12000000 && desc->smclk_hz == 12000000);
+    assert(desc->vcore == 0 && desc->wait_states == 0);
+
+    // 48 MHz needs VCORE1 and a wait state, SMCLK stays within its 24 MHz limit
+    desc = clock_profile_desc(CLOCK_PROFILE_PERFORMANCE);
+    assert(desc->mclk_hz == 48000000 && desc->smclk_hz == 24000000);
+    assert(desc->mclk_hz / desc->smclk_divider == desc->smclk_hz);
+    assert(desc->vcore == 1 && desc->wait_states == 1);
+
+    assert(clock_profile_desc(CLOCK_PROFILE_COUNT) == NULL);
+}
+
+void clock_profile_test_plan(){
+    ClockStep steps[CLOCK_PROFILE_MAX_STEPS];
+
+    assert(clock_profile_plan(CLOCK_PROFILE_NOMINAL, CLOCK_PROFILE_NOMINAL, steps) == 0);
+
+    // same voltage and wait states: only the clocks change
+    assert(clock_profile_plan(CLOCK_PROFILE_LOW_POWER, CLOCK_PROFILE_NOMINAL, steps) == 1);
+    assert(steps[0] == CLOCK_STEP_CLOCKS);
+
+    // going up: voltage and wait states first
+    assert(clock_profile_plan(CLOCK_PROFILE_LOW_POWER, CLOCK_PROFILE_PERFORMANCE, steps) == 3);
+    assert(steps[0] == CLOCK_STEP_VCORE);
+    assert(steps[1] == CLOCK_STEP_WAIT_STATES);
+    assert(steps[2] == CLOCK_STEP_CLOCKS);
+
+    // going down: clocks first
+    assert(clock_profile_plan(CLOCK_PROFILE_PERFORMANCE, CLOCK_PROFILE_NOMINAL, steps) == 3);
+    assert(steps[0] == CLOCK_STEP_CLOCKS);
+    assert(steps[1] == CLOCK_STEP_WAIT_STATES);
+    assert(steps[2] == CLOCK_STEP_VCORE);
+}
+
+void clock_profile_test_timer_divider(){
+    uint8_t profile;
+    for(profile = 0; profile < CLOCK_PROFILE_COUNT; profile++){
+        const ClockProfileDesc * desc = clock_profile_desc((ClockProfile)profile);
+        uint8_t divider = clock_profile_timer_divider(desc->smclk_hz);
+        // the PWM periods are computed for this tick
+        assert(desc->smclk_hz / divider == CLOCK_PROFILE_TIMER_TICK_HZ);
+    }
+    assert(clock_profile_timer_divider(6000000) == 2);
+    // never below the tick, never above the largest Timer_A input divider
+    assert(clock_profile_timer_divider(1000000) == 1);
+    assert(clock_profile_timer_divider(48000000) == 8);
+}
+
+static uint8_t calls = 0;
+static ClockChange last_change;
+static uint32_t last_mclk = 0;
+static uint32_t last_smclk = 0;
+
+static void test_listener(ClockChange change, uint32_t mclk_hz, uint32_t smclk_hz){
+    // the current profile only changes between the two calls
+    if(change == CLOCK_CHANGE_BEFORE){
+        assert(clock_profile_desc(clock_profile_get())->mclk_hz != mclk_hz);
+    }else{
+        assert(clock_profile_desc(clock_profile_get())->mclk_hz == mclk_hz);
+    }
+    calls++;
+    last_change = change;
+    last_mclk = mclk_hz;
+    last_smclk = smclk_hz;
+}
+
+void clock_profile_test_listeners(){
+    uint8_t i;
+    clock_profile_state_init();
+    assert(clock_profile_get() == CLOCK_PROFILE_LOW_POWER);
+    assert(clock_profile_register(test_listener));
+
+    // burst and back
+    assert(clock_profile_set(CLOCK_PROFILE_PERFORMANCE) == CLOCK_PROFILE_LOW_POWER);
+    assert(calls == 2);
+    assert(last_change == CLOCK_CHANGE_AFTER);
+    assert(last_mclk == 48000000 && last_smclk == 24000000);
+    assert(clock_profile_set(CLOCK_PROFILE_LOW_POWER) == CLOCK_PROFILE_PERFORMANCE);
+    assert(calls == 4);
+    assert(last_mclk == 3000000 && last_smclk == 3000000);
+
+    // nothing to do
+    assert(clock_profile_set(CLOCK_PROFILE_LOW_POWER) == CLOCK_PROFILE_LOW_POWER);
+    assert(clock_profile_set(CLOCK_PROFILE_COUNT) == CLOCK_PROFILE_LOW_POWER);
+    assert(calls == 4);
+
+    for(i = 1; i < CLOCK_PROFILE_MAX_LISTENERS; i++){
+        assert(clock_profile_register(test_listener));
+    }
+    assert(!clock_profile_register(test_listener));
+    clock_profile_state_init();
+}
+
+int clock_profile_test_main(){
+
+    clock_profile_test_desc();
+    clock_profile_test_plan();
+    clock_profile_test_timer_divider();
+    clock_profile_test_listeners();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_CLOCK_PROFILE_TEST_H_
+#define TEST_CLOCK_PROFILE_TEST_H_
+
+void clock_profile_test_desc();
+void clock_profile_test_plan();
+void clock_profile_test_timer_divider();
+void clock_profile_test_listeners();
+int clock_profile_test_main();
+
+#endif
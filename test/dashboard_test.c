@@ -0,0 +1,123 @@
+#include "dashboard_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include "observer/observer.h"
+#include "dashboard/dashboard.h"
+#include "environment_systems/temperature.h"
+#include "environment_systems/air_quality.h"
+
+static uint32_t calls;
+static ObservedValue last_id;
+static int32_t last_value;
+
+static void count_changes(ObservedValue id, int32_t value, uint64_t time){
+    (void)time;
+    calls++;
+    last_id = id;
+    last_value = value;
+}
+
+void dashboard_test_observer_changes(){
+    observer_init();
+    calls = 0;
+    assert(observer_register(count_changes));
+
+    // the first notification always counts, even if the value is 0
+    assert(!observer_has_value(OBSERVED_TEMPERATURE));
+    observer_notify(OBSERVED_TEMPERATURE, 0);
+    assert(calls == 1 && last_id == OBSERVED_TEMPERATURE && last_value == 0);
+    assert(observer_has_value(OBSERVED_TEMPERATURE));
+
+    // same value again: nothing to redraw
+    observer_notify(OBSERVED_TEMPERATURE, 0);
+    assert(calls == 1);
+
+    observer_notify(OBSERVED_TEMPERATURE, 23);
+    assert(calls == 2 && last_value == 23);
+    assert(observer_get(OBSERVED_TEMPERATURE) == 23);
+
+    // values are tracked separately
+    observer_notify(OBSERVED_AIR_LEVEL, 23);
+    assert(calls == 3 && last_id == OBSERVED_AIR_LEVEL);
+
+    // out of range ids are ignored
+    observer_notify(OBSERVED_VALUE_COUNT, 1);
+    assert(calls == 3);
+}
+
+void dashboard_test_pending(){
+    observer_init();
+    dashboard_state_init();
+    assert(observer_register(dashboard_on_change));
+
+    observer_notify(OBSERVED_PUMP1, 1);
+    observer_notify(OBSERVED_BUZZER, 0);
+    observer_notify(OBSERVED_PUMP1, 1);
+    assert(dashboard_take_pending() == ((1UL << OBSERVED_PUMP1) | (1UL << OBSERVED_BUZZER)));
+    // taking the pending widgets clears them
+    assert(dashboard_take_pending() == 0);
+
+    observer_notify(OBSERVED_BUZZER, 0);
+    assert(dashboard_take_pending() == 0);
+    observer_notify(OBSERVED_BUZZER, 1);
+    assert(dashboard_take_pending() == (1UL << OBSERVED_BUZZER));
+}
+
+void dashboard_test_format(){
+    char buf[DASHBOARD_FIELD_LEN + 1];
+
+    assert(dashboard_format_value(OBSERVED_LIGHT_LUX, 960, buf, sizeof(buf)) == DASHBOARD_FIELD_LEN);
+    assert(strcmp(buf, "960 lx      ") == 0);
+    dashboard_format_value(OBSERVED_TEMPERATURE, 21, buf, sizeof(buf));
+    assert(strcmp(buf, "21 C        ") == 0);
+    dashboard_format_value(OBSERVED_AIR_LEVEL, 42, buf, sizeof(buf));
+    assert(strcmp(buf, "42 ppm      ") == 0);
+    dashboard_format_value(OBSERVED_TANK_LEVEL, 5000, buf, sizeof(buf));
+    assert(strcmp(buf, "5000        ") == 0);
+    dashboard_format_value(OBSERVED_PUMP2, 1, buf, sizeof(buf));
+    assert(strcmp(buf, "ON          ") == 0);
+    dashboard_format_value(OBSERVED_BUZZER, 0, buf, sizeof(buf));
+    assert(strcmp(buf, "OFF         ") == 0);
+
+    // values longer than the field are cut
+    dashboard_format_value(OBSERVED_LIGHT_LUX, 2147483647, buf, sizeof(buf));
+    assert(strlen(buf) == DASHBOARD_FIELD_LEN);
+
+    char small[4];
+    assert(dashboard_format_value(OBSERVED_PUMP1, 1, small, sizeof(small)) == 0);
+
+    // every label ends where the value field starts
+    uint8_t id;
+    for(id = 0; id < OBSERVED_VALUE_COUNT; id++){
+        assert(strlen(dashboard_label((ObservedValue)id)) == DASHBOARD_FIELD_COL);
+    }
+}
+
+void dashboard_test_setters(){
+    observer_init();
+    dashboard_state_init();
+    assert(observer_register(dashboard_on_change));
+
+    temp_set_current_temperature(30);
+    air_set_level(120);
+    assert(dashboard_take_pending() == ((1UL << OBSERVED_TEMPERATURE) | (1UL << OBSERVED_AIR_LEVEL)));
+    assert(observer_get(OBSERVED_TEMPERATURE) == 30);
+    assert(observer_get(OBSERVED_AIR_LEVEL) == 120);
+
+    // setting the same value does not mark the widget again
+    temp_set_current_temperature(30);
+    assert(dashboard_take_pending() == 0);
+}
+
+int dashboard_test_main(){
+    dashboard_test_observer_changes();
+    dashboard_test_pending();
+    dashboard_test_format();
+    dashboard_test_setters();
+    // leave no callback behind for the other tests
+    observer_init();
+    return 0;
+}
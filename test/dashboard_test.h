@@ -0,0 +1,10 @@
+#ifndef TEST_DASHBOARD_TEST_H_
+#define TEST_DASHBOARD_TEST_H_
+
+void dashboard_test_observer_changes();
+void dashboard_test_pending();
+void dashboard_test_format();
+void dashboard_test_setters();
+int dashboard_test_main();
+
+#endif
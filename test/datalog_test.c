@@ -0,0 +1,256 @@
+#include "datalog_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "datalog/datalog.h"
+
+// simulated flash: 4 sectors of 4 blocks
+#define SECTOR_SIZE 4096
+#define FLASH_SIZE (4 * SECTOR_SIZE)
+
+static uint8_t flash[FLASH_SIZE];
+static Datalog datalog;
+static uint32_t words_programmed;
+static uint32_t sectors_erased;
+
+// like the flash controller: bits can only be cleared, every word is programmed once after an erase
+static bool flash_program(uint8_t * address, const void * data, uint16_t len){
+    uint16_t i;
+    assert(address >= flash && address + len <= flash + FLASH_SIZE);
+    assert((address - flash) % DATALOG_WORD_SIZE == 0 && len % DATALOG_WORD_SIZE == 0);
+    for(i = 0; i < len; i++){
+        assert(address[i] == 0xFF);
+        address[i] &= ((const uint8_t *)data)[i];
+    }
+    words_programmed += len / DATALOG_WORD_SIZE;
+    return true;
+}
+
+static bool flash_erase(uint8_t * sector){
+    assert(sector >= flash && (sector - flash) % SECTOR_SIZE == 0);
+    memset(sector, 0xFF, SECTOR_SIZE);
+    sectors_erased++;
+    return true;
+}
+
+// the board resets: the RAM state is lost, the flash is kept
+static void reset(){
+    datalog_state_init(&datalog, flash, FLASH_SIZE, SECTOR_SIZE, flash_program, flash_erase);
+    assert(datalog_mount(&datalog));
+}
+
+// every sample appended, the time is the index in seconds
+#define SAMPLES 6000
+static struct {
+    uint8_t id;
+    int32_t value;
+} samples[SAMPLES];
+
+typedef struct {
+    uint32_t next;
+    uint16_t records;
+} DecodeCheck;
+
+// checks that the records of a block are the samples appended, in order
+static void check_sample(void * context, uint8_t id, uint32_t time, int32_t value){
+    DecodeCheck * check = context;
+    uint32_t index = time / 1000;
+    assert(time % 1000 == 0 && index < SAMPLES);
+    if(check->records > 0){
+        assert(index == check->next);
+    }
+    assert(samples[index].id == id && samples[index].value == value);
+    check->next = index + 1;
+    check->records++;
+}
+
+static void append_samples(uint32_t from, uint32_t to, uint32_t seed){
+    static int32_t values[4];
+    uint32_t i;
+    for(i = from; i < to; i++){
+        seed = seed * 1103515245 + 12345;
+        uint8_t id = (seed >> 16) % 4;
+        // mostly small steps, sometimes large jumps
+        values[id] += ((seed >> 20) % 16 == 0) ? (int32_t)(seed % 100000) - 50000 : (int32_t)((seed >> 4) % 9) - 4;
+        samples[i].id = id;
+        samples[i].value = values[id];
+        assert(datalog_append(&datalog, id, i * 1000, values[id]));
+    }
+}
+
+void datalog_test_append(){
+    const uint8_t * block;
+    const DatalogHeader * header;
+    DecodeCheck check = {0, 0};
+    uint32_t first;
+    uint32_t last;
+
+    memset(flash, 0, sizeof(flash));
+    reset();
+    assert(datalog.boot == 0);
+    assert(!datalog_range(&datalog, &first, &last));
+    assert(!datalog_append(&datalog, DATALOG_MAX_IDS, 0, 1));
+
+    append_samples(0, 100, 1);
+    // the open block is not downloaded yet
+    assert(!datalog_range(&datalog, &first, &last));
+    assert(datalog_find(&datalog, 1) == NULL);
+    assert(datalog_seal(&datalog));
+    assert(datalog_range(&datalog, &first, &last) && first == 1 && last == 1);
+
+    block = datalog_find(&datalog, 1);
+    header = (const DatalogHeader *)block;
+    assert(block == flash);
+    assert(datalog_block_check(block, datalog_block_bytes(block)));
+    assert(header->magic == DATALOG_MAGIC && header->sequence == 1 && header->boot == 0);
+    assert(header->count == 100 && header->first_time == 0 && header->last_time == 99000);
+    assert(header->mask == 0x0F);
+    assert(datalog_block_bytes(block) == DATALOG_HEADER_SIZE + header->length);
+    assert(datalog_block_decode(block, check_sample, &check) == 100);
+    assert(check.next == 100);
+
+    // a block does not span more than DATALOG_BLOCK_SPAN_MS
+    append_samples(100, 101, 1);
+    assert(datalog_append(&datalog, 0, 100000 + DATALOG_BLOCK_SPAN_MS, 5));
+    assert(datalog_range(&datalog, &first, &last) && last == 2);
+    assert(((const DatalogHeader *)datalog_find(&datalog, 2))->count == 1);
+}
+
+void datalog_test_recovery(){
+    DecodeCheck check = {0, 0};
+    const uint8_t * block;
+    uint32_t first;
+    uint32_t last;
+    uint16_t count;
+
+    memset(flash, 0xFF, sizeof(flash));
+    reset();
+    append_samples(0, 150, 2);
+    // reset with the block open, the records of the unfinished word are lost
+    reset();
+    assert(datalog.boot == 1);
+    assert(datalog_range(&datalog, &first, &last) && first == 1 && last == 1);
+    block = datalog_find(&datalog, 1);
+    assert(datalog_block_check(block, datalog_block_bytes(block)));
+    count = datalog_block_decode(block, check_sample, &check);
+    assert(count == ((const DatalogHeader *)block)->count);
+    assert(count > 140 && count <= 150 && check.next == count);
+    assert(((const DatalogHeader *)block)->last_time == (count - 1) * 1000UL);
+
+    // the next boot goes on in a new block
+    append_samples(0, 10, 3);
+    assert(datalog_seal(&datalog));
+    block = datalog_find(&datalog, 2);
+    assert(block == flash + DATALOG_BLOCK_SIZE);
+    assert(((const DatalogHeader *)block)->boot == 1);
+    reset();
+    assert(datalog.boot == 2);
+    assert(datalog_range(&datalog, &first, &last) && first == 1 && last == 2);
+}
+
+void datalog_test_wrap(){
+    uint32_t first;
+    uint32_t last;
+    uint32_t sequence;
+    uint32_t next = 0;
+
+    memset(flash, 0xFF, sizeof(flash));
+    sectors_erased = 0;
+    reset();
+    append_samples(0, SAMPLES, 4);
+    assert(datalog_seal(&datalog));
+    assert(datalog_range(&datalog, &first, &last));
+    // the ring wrapped: a sector is erased before reuse, so one to four sectors of blocks are kept
+    assert(last > FLASH_SIZE / DATALOG_BLOCK_SIZE);
+    assert(sectors_erased > FLASH_SIZE / SECTOR_SIZE);
+    assert(last - first + 1 > FLASH_SIZE / DATALOG_BLOCK_SIZE - SECTOR_SIZE / DATALOG_BLOCK_SIZE);
+    assert(last - first + 1 <= FLASH_SIZE / DATALOG_BLOCK_SIZE);
+    assert(datalog_find(&datalog, first - 1) == NULL && datalog_find(&datalog, last + 1) == NULL);
+    // the blocks kept hold consecutive samples up to the last one
+    for(sequence = first; sequence <= last; sequence++){
+        DecodeCheck check = {0, 0};
+        const uint8_t * block = datalog_find(&datalog, sequence);
+        assert(block != NULL && datalog_block_check(block, datalog_block_bytes(block)));
+        datalog_block_decode(block, check_sample, &check);
+        assert(sequence == first || check.next - check.records == next);
+        next = check.next;
+    }
+    assert(next == SAMPLES);
+
+    // still there after a reset
+    reset();
+    assert(datalog_range(&datalog, &sequence, &next) && sequence == first && next == last);
+}
+
+void datalog_test_corruption(){
+    static uint8_t copy[DATALOG_BLOCK_SIZE];
+    uint32_t first;
+    uint32_t last;
+    const uint8_t * block;
+    uint16_t bytes;
+
+    datalog_range(&datalog, &first, &last);
+    block = datalog_find(&datalog, last);
+    bytes = datalog_block_bytes(block);
+    memcpy(copy, block, bytes);
+    assert(datalog_block_check(copy, bytes));
+    // a download cut short
+    assert(!datalog_block_check(copy, bytes - 1));
+    assert(!datalog_block_check(copy, DATALOG_HEADER_SIZE - 1));
+    // a byte of the payload, of the open word, of the seal word
+    copy[bytes - 1] ^= 0x01;
+    assert(!datalog_block_check(copy, bytes));
+    copy[bytes - 1] ^= 0x01;
+    copy[20] ^= 0x80;
+    assert(!datalog_block_check(copy, bytes));
+    copy[20] ^= 0x80;
+    copy[0] ^= 0x04;
+    assert(!datalog_block_check(copy, bytes));
+    copy[0] ^= 0x04;
+    assert(datalog_block_check(copy, bytes));
+    // an open block is not sealed
+    memset(copy, 0xFF, 16);
+    assert(!datalog_block_check(copy, bytes));
+}
+
+void datalog_test_cost(){
+    uint32_t first;
+    uint32_t last;
+    uint32_t records = 0;
+    uint32_t bytes = 0;
+    uint32_t sequence;
+
+    memset(flash, 0xFF, sizeof(flash));
+    words_programmed = 0;
+    sectors_erased = 0;
+    reset();
+    append_samples(0, 2000, 5);
+    assert(datalog_seal(&datalog));
+    datalog_range(&datalog, &first, &last);
+    for(sequence = first; sequence <= last; sequence++){
+        const DatalogHeader * header = (const DatalogHeader *)datalog_find(&datalog, sequence);
+        records += header->count;
+        bytes += DATALOG_HEADER_SIZE + header->length;
+    }
+    assert(records == 2000);
+    // each append programs at most a payload word, plus the two header words when a block changes
+    printf("datalog: %lu records in %lu blocks, %lu.%lu bytes per record, %lu flash words and %lu erases per 1000 records\n",
+           (unsigned long)records, (unsigned long)(last - first + 1),
+           (unsigned long)(bytes / records), (unsigned long)(bytes * 10 / records % 10),
+           (unsigned long)(words_programmed * 1000 / records), (unsigned long)(sectors_erased * 1000 / records));
+    assert(words_programmed * DATALOG_WORD_SIZE < bytes + (last - first + 1) * DATALOG_WORD_SIZE);
+}
+
+int datalog_test_main(){
+
+    datalog_test_append();
+    datalog_test_recovery();
+    datalog_test_wrap();
+    datalog_test_corruption();
+    datalog_test_cost();
+
+    return 0;
+}
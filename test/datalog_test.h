@@ -0,0 +1,11 @@
+#ifndef TEST_DATALOG_TEST_H_
+#define TEST_DATALOG_TEST_H_
+
+void datalog_test_append();
+void datalog_test_recovery();
+void datalog_test_wrap();
+void datalog_test_corruption();
+void datalog_test_cost();
+int datalog_test_main();
+
+#endif
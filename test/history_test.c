@@ -0,0 +1,226 @@
+#include "history_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "history/history.h"
+
+static uint8_t buf[HISTORY_BUF_LEN];
+static History history;
+
+void history_test_encoding(){
+    history_state_init(&history, buf, HISTORY_BUF_LEN, 0);
+    // first record: delta from 0 escaped, 10000 ms in two bytes
+    assert(history_record(&history, OBSERVED_TEMPERATURE, 10000, 21));
+    assert(history.used == 4);
+    assert(buf[0] == ((OBSERVED_TEMPERATURE << 4) | HISTORY_DELTA_ESCAPE));
+    // one degree more, 10 s later: 3 bytes
+    assert(history_record(&history, OBSERVED_TEMPERATURE, 20000, 22));
+    assert(history.used == 7);
+    assert(buf[4] == ((OBSERVED_TEMPERATURE << 4) | 2));
+    // one degree less, zigzag 1, 100 ms later: 2 bytes
+    assert(history_record(&history, OBSERVED_TEMPERATURE, 20100, 21));
+    assert(history.used == 9);
+    assert(buf[7] == ((OBSERVED_TEMPERATURE << 4) | 1));
+    // large jumps, both ways
+    assert(history_record(&history, OBSERVED_AIR_LEVEL, 20100, INT32_MAX));
+    assert(history_record(&history, OBSERVED_AIR_LEVEL, 20100, INT32_MIN));
+    assert(history.last.values[OBSERVED_AIR_LEVEL] == INT32_MIN);
+    assert(history.records == 5);
+    assert(!history_record(&history, HISTORY_MAX_IDS, 20100, 1));
+}
+
+void history_test_aggregate(){
+    HistoryAggregate out[4];
+    history_state_init(&history, buf, HISTORY_BUF_LEN, 0);
+    history_record(&history, OBSERVED_TANK_LEVEL, 1000, 10);
+    history_record(&history, OBSERVED_PUMP1, 1200, 1);
+    history_record(&history, OBSERVED_TANK_LEVEL, 1500, 20);
+    history_record(&history, OBSERVED_TANK_LEVEL, 2500, -10);
+    // replaced at the same time, the 40 is never held
+    history_record(&history, OBSERVED_TANK_LEVEL, 2750, 40);
+    history_record(&history, OBSERVED_TANK_LEVEL, 2750, 0);
+
+    history_aggregate(&history, OBSERVED_TANK_LEVEL, 0, 1000, 4, 3500, out);
+    // not known yet
+    assert(out[0].covered == 0 && out[0].records == 0);
+    // 10 for 500 ms, 20 for 500 ms
+    assert(out[1].min == 10 && out[1].max == 20 && out[1].avg == 15);
+    assert(out[1].covered == 1000 && out[1].records == 2);
+    // 20 for 500 ms, -10 for 250 ms, 0 for 250 ms
+    assert(out[2].min == -10 && out[2].max == 20 && out[2].avg == (20 * 500 - 10 * 250) / 1000);
+    assert(out[2].records == 3);
+    // held up to now, then nothing
+    assert(out[3].min == 0 && out[3].max == 0 && out[3].covered == 500 && out[3].records == 0);
+
+    // a window without records still has the value held through it
+    history_aggregate(&history, OBSERVED_PUMP1, 100000, 1000, 1, 200000, out);
+    assert(out[0].min == 1 && out[0].max == 1 && out[0].avg == 1 && out[0].covered == 1000 && out[0].records == 0);
+
+    // a value recorded now counts, even if it was held for no time
+    history_record(&history, OBSERVED_BUZZER, 5000, 1);
+    history_aggregate(&history, OBSERVED_BUZZER, 4000, 1000, 2, 5000, out);
+    assert(out[0].covered == 0 && out[0].records == 0);
+    assert(out[1].min == 1 && out[1].max == 1 && out[1].avg == 1 && out[1].records == 1);
+}
+
+// every sample recorded, to check the aggregates of a small ring that dropped most of them
+#define SAMPLES 3000
+static struct {
+    uint8_t id;
+    uint32_t time;
+    int32_t value;
+} samples[SAMPLES];
+
+static bool reference_value(uint8_t id, uint32_t t, int32_t * value){
+    bool known = false;
+    int i;
+    for(i = 0; i < SAMPLES && samples[i].time <= t; i++){
+        if(samples[i].id == id){
+            *value = samples[i].value;
+            known = true;
+        }
+    }
+    return known;
+}
+
+void history_test_wrap(){
+    static uint8_t small[200];
+    HistoryAggregate out[HISTORY_MAX_WINDOWS];
+    uint32_t seed = 12345;
+    uint32_t time = 0;
+    int32_t values[3] = {0, 0, 0};
+    int i;
+    history_state_init(&history, small, sizeof(small), 0);
+    for(i = 0; i < SAMPLES; i++){
+        seed = seed * 1103515245 + 12345;
+        uint8_t id = (seed >> 16) % 3;
+        time += (seed >> 8) % 90;
+        // mostly small steps, sometimes large jumps
+        values[id] += ((seed >> 20) % 16 == 0) ? (int32_t)(seed % 100000) - 50000 : (int32_t)((seed >> 4) % 9) - 4;
+        samples[i].id = id;
+        samples[i].time = time;
+        samples[i].value = values[id];
+        assert(history_record(&history, id, time, values[id]));
+    }
+    assert(history.dropped > 0 && history.used <= sizeof(small));
+    assert(history.dropped + history.records == SAMPLES);
+    assert(history.last.time == time);
+    for(i = 0; i < 3; i++){
+        assert(history.last.values[i] == values[i]);
+    }
+
+    // the windows after the base, where the ring knows every value
+    uint32_t from = history.base.time + 1;
+    uint32_t now = time + 50;
+    uint32_t window = (now - from) / 8 + 1;
+    uint8_t id;
+    for(id = 0; id < 3; id++){
+        uint8_t w;
+        history_aggregate(&history, id, from, window, 8, now, out);
+        for(w = 0; w < 8; w++){
+            int64_t sum = 0;
+            uint32_t covered = 0;
+            int32_t min = INT32_MAX;
+            int32_t max = INT32_MIN;
+            uint16_t records = 0;
+            uint32_t t;
+            int32_t value;
+            for(t = from + w * window; t < from + (w + 1) * window && t < now; t++){
+                if(reference_value(id, t, &value)){
+                    sum += value;
+                    covered++;
+                    min = value < min ? value : min;
+                    max = value > max ? value : max;
+                }
+            }
+            for(i = 0; i < SAMPLES; i++){
+                if(samples[i].id == id && samples[i].time >= from + w * window && samples[i].time < from + (w + 1) * window){
+                    records++;
+                }
+            }
+            assert(out[w].covered == covered);
+            assert(out[w].records == records);
+            if(covered > 0){
+                assert(out[w].min == min && out[w].max == max && out[w].avg == sum / (int64_t)covered);
+            }
+        }
+    }
+}
+
+void history_test_capacity(){
+    uint32_t seed = 777;
+    uint32_t time = 0;
+    uint32_t records = 0;
+    int32_t temperature = 22;
+    int32_t air = 400;
+    int32_t lux = 300;
+    history_state_init(&history, buf, HISTORY_BUF_LEN, 0);
+    // a greenhouse day: light read every 10 s, temperature every 5 s, air every 20 s, only the changes are recorded
+    while(history.dropped == 0){
+        time += 5000;
+        seed = seed * 1103515245 + 12345;
+        if((seed >> 16) % 12 == 0){
+            temperature += ((seed >> 8) & 1) ? 1 : -1;
+            history_record(&history, OBSERVED_TEMPERATURE, time, temperature);
+            records++;
+        }
+        if(time % 10000 == 0 && (seed >> 12) % 3 == 0){
+            lux += (int32_t)((seed >> 4) % 11) - 5;
+            history_record(&history, OBSERVED_LIGHT_LUX, time, lux);
+            records++;
+        }
+        if(time % 20000 == 0 && (seed >> 20) % 4 == 0){
+            air += (int32_t)((seed >> 6) % 21) - 10;
+            history_record(&history, OBSERVED_AIR_LEVEL, time, air);
+            records++;
+        }
+    }
+    printf("history: %lu changes (%lu minutes) in %u bytes, %lu.%lu bytes per change\n",
+           (unsigned long)records, (unsigned long)(time / 60000), HISTORY_BUF_LEN,
+           (unsigned long)(HISTORY_BUF_LEN / records), (unsigned long)(HISTORY_BUF_LEN * 10 / records % 10));
+    // hours of data in the ring
+    assert(time > 3 * 3600000UL);
+}
+
+void history_test_query(){
+    HistoryQuery query;
+    HistoryAggregate aggregate = {-3, 12, 4, 1000, 2, 4000};
+    char line[64];
+
+    assert(history_parse_query("2,60000,120000,10000", &query));
+    assert(query.id == 2 && query.from == 60000 && query.to == 120000 && query.window == 10000);
+    assert(history_query_windows(&query) == 6);
+    query.to = 120001;
+    assert(history_query_windows(&query) == 7);
+    query.window = 1;
+    assert(history_query_windows(&query) == HISTORY_MAX_WINDOWS);
+
+    assert(!history_parse_query("2,60000,120000", &query));
+    assert(!history_parse_query("2,60000,120000,0", &query));
+    assert(!history_parse_query("2,60000,60000,10", &query));
+    assert(!history_parse_query("99,0,10,1", &query));
+    assert(!history_parse_query("2,0,10,1,", &query));
+    assert(!history_parse_query("2,0,99999999999,1", &query));
+
+    assert(history_format_window(line, sizeof(line), 3, &aggregate) == strlen("HST:3,-3,12,4,2$"));
+    assert(strcmp(line, "HST:3,-3,12,4,2$") == 0);
+    aggregate.covered = 0;
+    aggregate.records = 0;
+    history_format_window(line, sizeof(line), 0, &aggregate);
+    assert(strcmp(line, "HST:0,,,,0$") == 0);
+    assert(history_format_window(line, 8, 3, &aggregate) == 0);
+}
+
+int history_test_main(){
+
+    history_test_encoding();
+    history_test_aggregate();
+    history_test_wrap();
+    history_test_capacity();
+    history_test_query();
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef TEST_HISTORY_TEST_H_
+#define TEST_HISTORY_TEST_H_
+
+void history_test_encoding();
+void history_test_aggregate();
+void history_test_wrap();
+void history_test_capacity();
+void history_test_query();
+int history_test_main();
+
+#endif
@@ -0,0 +1,71 @@
+#include "idle_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "power/idle.h"
+
+static IdleStats stats;
+
+void idle_test_choose_state(){
+    assert(idle_choose_state(0, 1000) == IDLE_LPM3);
+    assert(idle_choose_state(0, IDLE_LPM3_MIN_MS) == IDLE_LPM3);
+    // the next task is too close
+    assert(idle_choose_state(0, IDLE_LPM3_MIN_MS - 1) == IDLE_LPM0);
+    // any active peripheral keeps the fast clocks running
+    assert(idle_choose_state(1UL << IDLE_BUSY_UART, 1000) == IDLE_LPM0);
+    assert(idle_choose_state(1UL << IDLE_BUSY_ADC, INT32_MAX) == IDLE_LPM0);
+    assert(idle_choose_state((1UL << IDLE_BUSY_BUZZER) | (1UL << IDLE_BUSY_GROW_LIGHT), 1000) == IDLE_LPM0);
+}
+
+void idle_test_wake_ticks(){
+    // the watchdog must fire before the next task is due
+    assert(idle_wake_ticks(IDLE_LPM3_MIN_MS) == IDLE_WAKE_SHORT_TICKS);
+    assert((int64_t)IDLE_WAKE_SHORT_TICKS * 1000 <= (int64_t)IDLE_LPM3_MIN_MS * IDLE_TICKS_PER_SECOND);
+    assert(idle_wake_ticks(249) == IDLE_WAKE_SHORT_TICKS);
+    assert(idle_wake_ticks(250) == IDLE_WAKE_LONG_TICKS);
+    assert(idle_wake_ticks(INT32_MAX) == IDLE_WAKE_LONG_TICKS);
+}
+
+void idle_test_stats(){
+    idle_stats_init(&stats);
+    assert(idle_residency_permille(&stats, IDLE_LPM0, 1000) == 0);
+
+    // 250 ms in LPM3, 500 ms in LPM0 blocked by the UART
+    idle_stats_record(&stats, IDLE_LPM3, 0, IDLE_WAKE_LONG_TICKS);
+    idle_stats_record(&stats, IDLE_LPM0, 1UL << IDLE_BUSY_UART, IDLE_TICKS_PER_SECOND / 4);
+    idle_stats_record(&stats, IDLE_LPM0, 1UL << IDLE_BUSY_UART, IDLE_TICKS_PER_SECOND / 4);
+    assert(stats.entries[IDLE_LPM3] == 1);
+    assert(stats.entries[IDLE_LPM0] == 2);
+    assert(stats.blocked[IDLE_BUSY_UART] == 2);
+    assert(stats.blocked[IDLE_BUSY_ADC] == 0);
+
+    assert(idle_residency_permille(&stats, IDLE_LPM3, 1000) == 250);
+    assert(idle_residency_permille(&stats, IDLE_LPM0, 1000) == 500);
+    assert(idle_residency_permille(&stats, IDLE_LPM0, 0) == 0);
+    // never more than the whole uptime
+    assert(idle_residency_permille(&stats, IDLE_LPM0, 100) == 1000);
+}
+
+void idle_test_credit(){
+    uint32_t total = 0;
+    uint16_t i;
+    idle_stats_init(&stats);
+    assert(idle_credit_ms(&stats, IDLE_WAKE_LONG_TICKS) == 250);
+
+    // 15.625 ms per short sleep: the fractions add up instead of being lost
+    for(i = 0; i < 64; i++){
+        total += idle_credit_ms(&stats, IDLE_WAKE_SHORT_TICKS);
+    }
+    assert(total == 1000);
+    assert(stats.credit_carry == 0);
+}
+
+int idle_test_main(){
+
+    idle_test_choose_state();
+    idle_test_wake_ticks();
+    idle_test_stats();
+    idle_test_credit();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_IDLE_TEST_H_
+#define TEST_IDLE_TEST_H_
+
+void idle_test_choose_state();
+void idle_test_wake_ticks();
+void idle_test_stats();
+void idle_test_credit();
+int idle_test_main();
+
+#endif
@@ -0,0 +1,123 @@
+#include "iot_frame_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "IOT/iot_frame.h"
+
+static IotDecoder decoder;
+
+// plays the sender side of the link: every byte as two nibbles, high first
+static bool transmit(const IotFrame * frame, IotFrame * received){
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    uint8_t len = iot_frame_encode(frame, buf);
+    uint8_t i;
+    iot_decoder_reset(&decoder);
+    for(i = 0; i < len; i++){
+        iot_decoder_push(&decoder, buf[i] >> 4);
+        iot_decoder_push(&decoder, buf[i] & 0x0F);
+    }
+    return iot_decoder_end(&decoder, received);
+}
+
+static void assert_same(const IotFrame * a, const IotFrame * b){
+    assert(a->code == b->code);
+    assert(a->active == b->active);
+    assert(a->category == b->category);
+    assert(a->reading == b->reading);
+    assert(a->timestamp == b->timestamp);
+}
+
+void iot_frame_test_round_trip(){
+    IotFrame sent = {2, false, 3, 37, 123456};
+    IotFrame received;
+    assert(transmit(&sent, &received));
+    assert_same(&sent, &received);
+
+    IotFrame pump = {7, true, 4, 1, 0xFFFFFFFF};
+    assert(transmit(&pump, &received));
+    assert_same(&pump, &received);
+
+    // category 0 (used by the pumps) goes out as 4, like on the v1 link
+    IotFrame no_category = {6, true, 0, 0, 10};
+    assert(transmit(&no_category, &received));
+    assert(received.category == 4);
+}
+
+void iot_frame_test_width(){
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    IotFrame frame = {1, false, 1, 32767, 0};
+    IotFrame received;
+
+    assert(iot_frame_encode(&frame, buf) == 8);
+    frame.reading = -32768;
+    assert(iot_frame_encode(&frame, buf) == 8);
+    assert(transmit(&frame, &received));
+    assert(received.reading == -32768);
+
+    frame.reading = 32768;
+    assert(iot_frame_encode(&frame, buf) == 10);
+    assert(transmit(&frame, &received));
+    assert(received.reading == 32768);
+
+    frame.reading = INT32_MIN;
+    assert(transmit(&frame, &received));
+    assert(received.reading == INT32_MIN);
+}
+
+void iot_frame_test_corrupted(){
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    IotFrame frame = {5, false, 2, 1500, 99};
+    IotFrame received;
+    uint8_t len = iot_frame_encode(&frame, buf);
+    uint8_t i, bit;
+
+    assert(iot_frame_decode(buf, len, &received));
+    // every single bit error is detected
+    for(i = 0; i < len; i++){
+        for(bit = 0; bit < 8; bit++){
+            buf[i] ^= 1 << bit;
+            assert(!iot_frame_decode(buf, len, &received));
+            buf[i] ^= 1 << bit;
+        }
+    }
+    // truncated frame
+    assert(!iot_frame_decode(buf, len - 1, &received));
+    assert(!iot_frame_decode(buf, 0, &received));
+}
+
+void iot_frame_test_decoder(){
+    uint8_t buf[IOT_FRAME_MAX_LEN];
+    IotFrame frame = {3, true, 1, 4000, 7};
+    IotFrame received;
+    uint8_t len = iot_frame_encode(&frame, buf);
+    uint8_t i;
+
+    // frame cut in the middle of a byte
+    iot_decoder_reset(&decoder);
+    for(i = 0; i < len - 1; i++){
+        iot_decoder_push(&decoder, buf[i] >> 4);
+        iot_decoder_push(&decoder, buf[i] & 0x0F);
+    }
+    iot_decoder_push(&decoder, buf[len - 1] >> 4);
+    assert(!iot_decoder_end(&decoder, &received));
+
+    // too many nibbles
+    for(i = 0; i < 2 * IOT_FRAME_MAX_LEN + 2; i++){
+        iot_decoder_push(&decoder, 0);
+    }
+    assert(!iot_decoder_end(&decoder, &received));
+
+    // the decoder is ready for the next frame after an error
+    assert(transmit(&frame, &received));
+    assert_same(&frame, &received);
+}
+
+int iot_frame_test_main(){
+
+    iot_frame_test_round_trip();
+    iot_frame_test_width();
+    iot_frame_test_corrupted();
+    iot_frame_test_decoder();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_IOT_FRAME_TEST_H_
+#define TEST_IOT_FRAME_TEST_H_
+
+void iot_frame_test_round_trip();
+void iot_frame_test_width();
+void iot_frame_test_corrupted();
+void iot_frame_test_decoder();
+int iot_frame_test_main();
+
+#endif
@@ -0,0 +1,103 @@
+#include "iot_publish_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "IOT/iot_publish.h"
+
+static IotPublishState state;
+
+// what the firmware does on each sensor update
+static bool publish(uint8_t code, bool active, uint8_t value, int32_t reading, uint32_t now){
+    if(iot_publish_update(&state, code, active, value, reading, now)){
+        iot_publish_mark_sent(&state, code, now);
+        return true;
+    }
+    return false;
+}
+
+void iot_publish_test_change_only(){
+    iot_publish_state_init(&state);
+    state.heartbeat = 0;
+
+    // first message of a code always goes out
+    assert(publish(6, true, 0, 1, 0));
+    // same state, even with another reading
+    assert(!publish(6, true, 0, 1, 10));
+    assert(publish(2, false, 2, 21, 10));
+    assert(!publish(2, false, 2, 22, 5000));
+    assert(!publish(2, false, 2, 23, 9000));
+    // category change
+    assert(publish(2, false, 3, 36, 10000));
+    // active change
+    assert(publish(6, false, 0, 0, 10000));
+    assert(state.sent == 4);
+    assert(state.suppressed == 3);
+    assert(iot_publish_next_due(&state, 100000) == 0);
+}
+
+void iot_publish_test_rate_limit(){
+    iot_publish_state_init(&state);
+    state.heartbeat = 0;
+    iot_publish_set_rate_limit(&state, 1, 1000);
+
+    assert(publish(1, false, 1, 100, 0));
+    // a change within the limit stays pending
+    assert(!publish(1, false, 2, 400, 200));
+    assert(state.codes[1].pending);
+    assert(iot_publish_next_due(&state, 500) == 0);
+
+    // back to the sent state before the limit: nothing left to send
+    assert(!publish(1, false, 1, 120, 600));
+    assert(!state.codes[1].pending);
+    assert(iot_publish_next_due(&state, 1500) == 0);
+
+    // the latest state goes out from the task once the limit expires
+    assert(!publish(1, false, 2, 400, 700));
+    assert(!publish(1, false, 3, 50, 800));
+    assert(iot_publish_next_due(&state, 999) == 0);
+    assert(iot_publish_next_due(&state, 1000) == 1);
+    assert(state.codes[1].value == 3 && state.codes[1].reading == 50);
+    iot_publish_mark_sent(&state, 1, 1000);
+    assert(iot_publish_next_due(&state, 1000) == 0);
+
+    // a later change after the limit goes out directly
+    assert(publish(1, false, 1, 100, 2000));
+}
+
+void iot_publish_test_heartbeat(){
+    iot_publish_state_init(&state);
+    state.heartbeat = 30000;
+
+    assert(publish(3, true, 0, 900, 1000));
+    assert(publish(6, true, 0, 1, 5000));
+    assert(iot_publish_next_due(&state, 30999) == 0);
+    assert(iot_publish_next_due(&state, 31000) == 3);
+    iot_publish_mark_sent(&state, 3, 31000);
+    assert(iot_publish_next_due(&state, 31000) == 0);
+    assert(iot_publish_next_due(&state, 35000) == 6);
+    iot_publish_mark_sent(&state, 6, 35000);
+
+    // uptime wrap around
+    iot_publish_state_init(&state);
+    assert(publish(4, false, 2, 300, UINT32_MAX - 100));
+    assert(iot_publish_next_due(&state, 1000) == 0);
+    assert(iot_publish_next_due(&state, IOT_PUBLISH_HEARTBEAT_DEFAULT) == 4);
+}
+
+void iot_publish_test_invalid(){
+    iot_publish_state_init(&state);
+    assert(!publish(0, true, 1, 0, 0));
+    assert(!publish(IOT_PUBLISH_CODES, true, 1, 0, 0));
+    assert(state.sent == 0);
+    assert(iot_publish_next_due(&state, 100000) == 0);
+}
+
+int iot_publish_test_main(){
+
+    iot_publish_test_change_only();
+    iot_publish_test_rate_limit();
+    iot_publish_test_heartbeat();
+    iot_publish_test_invalid();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_IOT_PUBLISH_TEST_H_
+#define TEST_IOT_PUBLISH_TEST_H_
+
+void iot_publish_test_change_only();
+void iot_publish_test_rate_limit();
+void iot_publish_test_heartbeat();
+void iot_publish_test_invalid();
+int iot_publish_test_main();
+
+#endif
@@ -0,0 +1,104 @@
+#include "iot_tx_queue_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "IOT/iot_tx_queue.h"
+
+static IotTxQueue queue;
+
+void iot_tx_queue_test_order(){
+    IotTxMessage msg;
+    iot_tx_queue_init(&queue);
+    assert(!iot_tx_queue_pop(&queue, &msg));
+
+    assert(iot_tx_queue_push(&queue, 1, false, 2, 800, 0));
+    assert(iot_tx_queue_push(&queue, 6, true, 0, 1, 0));
+    assert(iot_tx_queue_push(&queue, 2, false, 3, 36, 0));
+
+    assert(iot_tx_queue_pop(&queue, &msg));
+    assert(msg.code == 1 && msg.value == 2 && msg.reading == 800 && !msg.active);
+    assert(iot_tx_queue_pop(&queue, &msg));
+    assert(msg.code == 6 && msg.active);
+    assert(iot_tx_queue_pop(&queue, &msg));
+    assert(msg.code == 2 && msg.reading == 36);
+    assert(!iot_tx_queue_pop(&queue, &msg));
+
+    // wrap around of the circular buffer
+    uint8_t i;
+    for(i = 0; i < 3 * IOT_TX_QUEUE_LEN; i++){
+        assert(iot_tx_queue_push(&queue, 1 + i % 7, false, 1, i, i));
+        assert(iot_tx_queue_pop(&queue, &msg));
+        assert(msg.reading == i);
+    }
+}
+
+void iot_tx_queue_test_coalesce(){
+    IotTxMessage msg;
+    iot_tx_queue_init(&queue);
+
+    assert(iot_tx_queue_push(&queue, 6, true, 0, 1, 100));
+    assert(iot_tx_queue_push(&queue, 3, true, 0, 900, 150));
+    // pump 1 turned off before the first message was sent: only the latest state goes out
+    assert(iot_tx_queue_push(&queue, 6, false, 0, 0, 200));
+    assert(queue.count == 2);
+    assert(queue.stats.coalesced == 1);
+    assert(queue.stats.enqueued == 2);
+
+    assert(iot_tx_queue_pop(&queue, &msg));
+    assert(msg.code == 6 && !msg.active && msg.reading == 0);
+    // the wait counts from the first push
+    assert(msg.enqueued_at == 100);
+}
+
+void iot_tx_queue_test_overflow(){
+    IotTxMessage msg;
+    uint8_t i;
+    iot_tx_queue_init(&queue);
+
+    for(i = 0; i < IOT_TX_QUEUE_LEN; i++){
+        assert(iot_tx_queue_push(&queue, 10 + i, false, 1, i, 0));
+    }
+    assert(queue.stats.max_pending == IOT_TX_QUEUE_LEN);
+    assert(!iot_tx_queue_push(&queue, 50, false, 1, 0, 0));
+    assert(queue.stats.overflows == 1);
+    // a code already waiting is still accepted
+    assert(iot_tx_queue_push(&queue, 10, true, 1, 0, 0));
+    assert(queue.stats.overflows == 1);
+
+    assert(iot_tx_queue_pop(&queue, &msg));
+    assert(iot_tx_queue_push(&queue, 50, false, 1, 0, 0));
+}
+
+void iot_tx_queue_test_latency(){
+    IotTxMessage msg;
+    iot_tx_queue_init(&queue);
+    assert(iot_tx_queue_average_latency(&queue) == 0);
+
+    assert(iot_tx_queue_push(&queue, 1, false, 1, 0, 1000));
+    assert(iot_tx_queue_push(&queue, 2, false, 1, 0, 1000));
+    assert(iot_tx_queue_pop(&queue, &msg));
+    iot_tx_queue_mark_sent(&queue, &msg, 1100);
+    assert(iot_tx_queue_pop(&queue, &msg));
+    iot_tx_queue_mark_sent(&queue, &msg, 1300);
+
+    assert(queue.stats.sent == 2);
+    assert(queue.stats.max_latency == 300);
+    assert(iot_tx_queue_average_latency(&queue) == 200);
+
+    // uptime wrap around
+    assert(iot_tx_queue_push(&queue, 3, false, 1, 0, UINT32_MAX - 9));
+    assert(iot_tx_queue_pop(&queue, &msg));
+    iot_tx_queue_mark_sent(&queue, &msg, 10);
+    assert(queue.stats.max_latency == 300);
+    assert(queue.stats.total_latency == 420);
+}
+
+int iot_tx_queue_test_main(){
+
+    iot_tx_queue_test_order();
+    iot_tx_queue_test_coalesce();
+    iot_tx_queue_test_overflow();
+    iot_tx_queue_test_latency();
+
+    return 0;
+}
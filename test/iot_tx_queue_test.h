@@ -0,0 +1,10 @@
+#ifndef TEST_IOT_TX_QUEUE_TEST_H_
+#define TEST_IOT_TX_QUEUE_TEST_H_
+
+void iot_tx_queue_test_order();
+void iot_tx_queue_test_coalesce();
+void iot_tx_queue_test_overflow();
+void iot_tx_queue_test_latency();
+int iot_tx_queue_test_main();
+
+#endif
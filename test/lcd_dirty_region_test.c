@@ -0,0 +1,123 @@
+#include "lcd_dirty_region_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "LcdDriver/lcd_dirty_region.h"
+
+static LcdDirtyRegion region;
+
+static bool rects_overlap(const LcdRect * a, const LcdRect * b){
+    return !(a->x1 < b->x0 || b->x1 < a->x0 || a->y1 < b->y0 || b->y1 < a->y0);
+}
+
+// checks the tracker invariant: no pixel is sent twice
+static void assert_disjoint(){
+    uint8_t i, j;
+    for(i = 0; i < region.count; i++){
+        for(j = i + 1; j < region.count; j++){
+            assert(!rects_overlap(&region.rects[i], &region.rects[j]));
+        }
+    }
+}
+
+void lcd_dirty_test_clipping(){
+    lcd_dirty_init(&region, 128, 128);
+
+    lcd_dirty_add(&region, -10, -10, 5, 5);
+    assert(region.count == 1);
+    assert(region.rects[0].x0 == 0 && region.rects[0].y0 == 0);
+    assert(region.rects[0].x1 == 5 && region.rects[0].y1 == 5);
+
+    // completely outside
+    lcd_dirty_add(&region, 200, 200, 300, 300);
+    assert(region.count == 1);
+
+    lcd_dirty_clear(&region);
+    // corners given in the wrong order
+    lcd_dirty_add(&region, 130, 20, 120, 10);
+    assert(region.rects[0].x0 == 120 && region.rects[0].x1 == 127);
+    assert(region.rects[0].y0 == 10 && region.rects[0].y1 == 20);
+}
+
+void lcd_dirty_test_contained(){
+    lcd_dirty_init(&region, 128, 128);
+
+    lcd_dirty_add(&region, 10, 10, 50, 20);
+    lcd_dirty_add(&region, 12, 12, 12, 12);
+    lcd_dirty_add(&region, 30, 15, 40, 20);
+    assert(region.count == 1);
+    assert(lcd_dirty_area(&region) == 41 * 11);
+}
+
+void lcd_dirty_test_merge(){
+    lcd_dirty_init(&region, 128, 128);
+
+    // adjacent pixels of a text line become a single rectangle
+    int16_t x;
+    for(x = 20; x < 80; x++){
+        lcd_dirty_add(&region, x, 60, x, 67);
+    }
+    assert(region.count == 1);
+    assert(lcd_dirty_area(&region) == 60 * 8);
+
+    // overlapping rectangles are always merged
+    lcd_dirty_add(&region, 70, 62, 100, 90);
+    assert(region.count == 1);
+    assert(region.rects[0].x0 == 20 && region.rects[0].x1 == 100);
+    assert(region.rects[0].y0 == 60 && region.rects[0].y1 == 90);
+}
+
+void lcd_dirty_test_separate(){
+    lcd_dirty_init(&region, 128, 128);
+
+    // far apart: merging would send a lot of unchanged pixels
+    lcd_dirty_add(&region, 0, 0, 9, 9);
+    lcd_dirty_add(&region, 100, 100, 109, 109);
+    assert(region.count == 2);
+    assert(lcd_dirty_area(&region) == 200);
+
+    // a rectangle bridging both makes them overlap and collapse into one
+    lcd_dirty_add(&region, 5, 5, 105, 105);
+    assert(region.count == 1);
+    assert_disjoint();
+}
+
+void lcd_dirty_test_full(){
+    lcd_dirty_init(&region, 128, 128);
+
+    // more isolated areas than slots: the tracker keeps working and stays disjoint
+    int16_t i;
+    for(i = 0; i < 20; i++){
+        int16_t x = (i * 37) % 120;
+        int16_t y = (i * 53) % 120;
+        lcd_dirty_add(&region, x, y, x + 2, y + 2);
+        assert(region.count <= LCD_DIRTY_MAX_RECTS);
+        assert_disjoint();
+    }
+    // every added area is still covered
+    for(i = 0; i < 20; i++){
+        int16_t x = (i * 37) % 120;
+        int16_t y = (i * 53) % 120;
+        LcdRect added = {x, y, x + 2, y + 2};
+        bool covered = false;
+        uint8_t j;
+        for(j = 0; j < region.count; j++){
+            LcdRect * r = &region.rects[j];
+            if(r->x0 <= added.x0 && r->y0 <= added.y0 && r->x1 >= added.x1 && r->y1 >= added.y1){
+                covered = true;
+            }
+        }
+        assert(covered);
+    }
+}
+
+int lcd_dirty_test_main(){
+
+    lcd_dirty_test_clipping();
+    lcd_dirty_test_contained();
+    lcd_dirty_test_merge();
+    lcd_dirty_test_separate();
+    lcd_dirty_test_full();
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef TEST_LCD_DIRTY_REGION_TEST_H_
+#define TEST_LCD_DIRTY_REGION_TEST_H_
+
+void lcd_dirty_test_clipping();
+void lcd_dirty_test_contained();
+void lcd_dirty_test_merge();
+void lcd_dirty_test_separate();
+void lcd_dirty_test_full();
+int lcd_dirty_test_main();
+
+#endif
@@ -0,0 +1,153 @@
+#include "lcd_scene_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "LcdDriver/lcd_scene.h"
+
+static LcdScene scene;
+static LcdScene shown;
+
+void lcd_scene_test_fill(){
+    lcd_scene_init(&scene, 0);
+    assert(lcd_scene_row_spans(&scene, 10) == 1);
+
+    lcd_scene_fill(&scene, 10, 20, 29, 3);
+    assert(lcd_scene_row_spans(&scene, 10) == 3);
+    assert(lcd_scene_get(&scene, 10, 19) == 0);
+    assert(lcd_scene_get(&scene, 10, 20) == 3);
+    assert(lcd_scene_get(&scene, 10, 29) == 3);
+    assert(lcd_scene_get(&scene, 10, 30) == 0);
+    // other rows are untouched
+    assert(lcd_scene_get(&scene, 11, 25) == 0);
+
+    // adjacent spans of the same color are merged
+    lcd_scene_fill(&scene, 10, 30, 39, 3);
+    assert(lcd_scene_row_spans(&scene, 10) == 3);
+    assert(lcd_scene_get(&scene, 10, 39) == 3);
+
+    // overwriting the middle splits the span
+    lcd_scene_fill(&scene, 10, 25, 26, 5);
+    assert(lcd_scene_row_spans(&scene, 10) == 5);
+    assert(lcd_scene_get(&scene, 10, 24) == 3);
+    assert(lcd_scene_get(&scene, 10, 25) == 5);
+    assert(lcd_scene_get(&scene, 10, 27) == 3);
+
+    // back to the background color: a single span again
+    lcd_scene_fill(&scene, 10, 20, 39, 0);
+    assert(lcd_scene_row_spans(&scene, 10) == 1);
+
+    // edges of the row
+    lcd_scene_fill(&scene, 10, 0, 0, 1);
+    lcd_scene_fill(&scene, 10, 127, 127, 2);
+    assert(lcd_scene_get(&scene, 10, 0) == 1);
+    assert(lcd_scene_get(&scene, 10, 1) == 0);
+    assert(lcd_scene_get(&scene, 10, 127) == 2);
+    assert(lcd_scene_row_spans(&scene, 10) == 3);
+}
+
+void lcd_scene_test_packed(){
+    uint8_t indices[LCD_SCENE_WIDTH];
+    uint16_t x;
+    lcd_scene_init(&scene, 0);
+
+    // a text-like row: more color changes than spans
+    for(x = 0; x < LCD_SCENE_WIDTH; x += 2){
+        lcd_scene_fill(&scene, 5, x, x, (x / 2) % 16);
+    }
+    assert(lcd_scene_row_spans(&scene, 5) == 0);
+    lcd_scene_row_indices(&scene, 5, indices);
+    for(x = 0; x < LCD_SCENE_WIDTH; x++){
+        assert(indices[x] == ((x & 1) ? 0 : (x / 2) % 16));
+        assert(lcd_scene_get(&scene, 5, x) == indices[x]);
+    }
+
+    // partial fills keep the row packed
+    lcd_scene_fill(&scene, 5, 10, 20, 7);
+    assert(lcd_scene_row_spans(&scene, 5) == 0);
+    assert(lcd_scene_get(&scene, 5, 9) == 0);
+    assert(lcd_scene_get(&scene, 5, 10) == 7);
+    assert(lcd_scene_get(&scene, 5, 20) == 7);
+
+    // a full row fill turns it back into spans
+    lcd_scene_fill(&scene, 5, 0, LCD_SCENE_WIDTH - 1, 4);
+    assert(lcd_scene_row_spans(&scene, 5) == 1);
+    assert(lcd_scene_get(&scene, 5, 64) == 4);
+}
+
+void lcd_scene_test_diff(){
+    uint8_t first, last;
+    uint16_t x;
+    lcd_scene_init(&scene, 1);
+    lcd_scene_init(&shown, 1);
+    assert(!lcd_scene_row_diff(&scene, &shown, 0, &first, &last));
+
+    lcd_scene_fill(&scene, 0, 40, 50, 2);
+    lcd_scene_fill(&scene, 0, 60, 61, 3);
+    assert(lcd_scene_row_diff(&scene, &shown, 0, &first, &last));
+    assert(first == 40 && last == 61);
+
+    // drawing the same content again: no difference once copied
+    lcd_scene_copy_row(&shown, &scene, 0);
+    assert(!lcd_scene_row_diff(&scene, &shown, 0, &first, &last));
+    lcd_scene_fill(&scene, 0, 40, 50, 2);
+    assert(!lcd_scene_row_diff(&scene, &shown, 0, &first, &last));
+
+    // same pixels stored differently (packed against spans)
+    for(x = 0; x < LCD_SCENE_WIDTH; x += 2){
+        lcd_scene_fill(&scene, 1, x, x, 2);
+    }
+    for(x = 0; x < LCD_SCENE_WIDTH; x += 2){
+        lcd_scene_fill(&scene, 1, x, x, 1);
+    }
+    assert(lcd_scene_row_spans(&scene, 1) == 0);
+    assert(!lcd_scene_row_diff(&scene, &shown, 1, &first, &last));
+    lcd_scene_fill(&scene, 1, 127, 127, 5);
+    assert(lcd_scene_row_diff(&scene, &shown, 1, &first, &last));
+    assert(first == 127 && last == 127);
+
+    lcd_scene_copy_row(&shown, &scene, 1);
+    assert(lcd_scene_row_spans(&shown, 1) == 0);
+    assert(lcd_scene_get(&shown, 1, 127) == 5);
+}
+
+void lcd_scene_test_palette(){
+    LcdPalette palette;
+    const LcdScene * scenes[2] = {&scene, &shown};
+    uint8_t i;
+    lcd_palette_init(&palette);
+    lcd_scene_init(&scene, 0);
+    lcd_scene_init(&shown, 0);
+
+    assert(lcd_palette_index(&palette, 0xFFFF, scenes, 2) == 0);
+    assert(lcd_palette_index(&palette, 0x0000, scenes, 2) == 1);
+    assert(lcd_palette_index(&palette, 0xFFFF, scenes, 2) == 0);
+
+    for(i = 2; i < LCD_SCENE_PALETTE_SIZE; i++){
+        assert(lcd_palette_index(&palette, 0x0800 * i, scenes, 2) == i);
+    }
+    assert(palette.count == LCD_SCENE_PALETTE_SIZE);
+
+    // palette full: index 3 is used by no scene and is given to the new color
+    for(i = 0; i < LCD_SCENE_PALETTE_SIZE; i++){
+        if(i != 3){
+            lcd_scene_fill(&shown, i, 0, 0, i);
+        }
+    }
+    assert(lcd_palette_index(&palette, 0x001F, scenes, 2) == 3);
+    assert(palette.colors[3] == 0x001F);
+
+    // every index on the screen: the closest color is used
+    lcd_scene_fill(&scene, 3, 0, 0, 3);
+    assert(lcd_palette_index(&palette, 0xFFDF, scenes, 2) == 0);
+    assert(lcd_palette_index(&palette, 0x001E, scenes, 2) == 3);
+}
+
+int lcd_scene_test_main(){
+
+    lcd_scene_test_fill();
+    lcd_scene_test_packed();
+    lcd_scene_test_diff();
+    lcd_scene_test_palette();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_LCD_SCENE_TEST_H_
+#define TEST_LCD_SCENE_TEST_H_
+
+void lcd_scene_test_fill();
+void lcd_scene_test_packed();
+void lcd_scene_test_diff();
+void lcd_scene_test_palette();
+int lcd_scene_test_main();
+
+#endif
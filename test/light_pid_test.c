@@ -0,0 +1,134 @@
+#include "light_pid_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "light_system/light_pid.h"
+#include "light_system/growing_light.h"
+
+/*
+    plant model used to tune LIGHT_PID_*: the sensor sees the ambient light plus
+    PLANT_GAIN_NUM / PLANT_GAIN_DEN lux per brightness level, and moves half way
+    towards it between two readings (the fade and the 800 ms conversion)
+*/
+#define PLANT_GAIN_NUM 2
+#define PLANT_GAIN_DEN 5
+#define PLANT_SETTLE_BAND 30
+#define PLANT_MAX_STEPS 40
+
+typedef struct {
+    int32_t ambient;
+    int32_t lux;
+} Plant;
+
+static LightPid pid;
+
+static void plant_step(Plant * plant, int32_t brightness){
+    int32_t target = plant->ambient + brightness * PLANT_GAIN_NUM / PLANT_GAIN_DEN;
+    plant->lux += (target - plant->lux) / 2;
+}
+
+/*
+    runs the loop for PLANT_MAX_STEPS readings
+    returns the number of readings before the light level stays within PLANT_SETTLE_BAND
+    of the setpoint (PLANT_MAX_STEPS if it never does), overshoot gets the largest
+    excursion past the setpoint, in the direction of the step
+*/
+static int32_t plant_run(Plant * plant, int32_t setpoint, int32_t * overshoot){
+    int32_t settled = 0;
+    int32_t step;
+    bool rising = plant->lux < setpoint;
+    *overshoot = 0;
+    for(step = 0; step < PLANT_MAX_STEPS; step++){
+        plant_step(plant, light_pid_update(&pid, setpoint, plant->lux));
+        int32_t past = rising ? plant->lux - setpoint : setpoint - plant->lux;
+        if(past > *overshoot){
+            *overshoot = past;
+        }
+        if(abs(plant->lux - setpoint) > PLANT_SETTLE_BAND){
+            settled = step + 1;
+        }
+    }
+    return settled;
+}
+
+void light_pid_test_terms(){
+    // proportional only: 0.5 brightness per lux
+    light_pid_init(&pid, LIGHT_PID_ONE / 2, 0, 0, 0, MAX_BRIGHTNESS);
+    assert(light_pid_update(&pid, 1000, 400) == 300);
+    assert(light_pid_update(&pid, 1000, 1200) == 0);
+
+    // integral only: accumulates the error
+    light_pid_init(&pid, 0, LIGHT_PID_ONE, 0, 0, MAX_BRIGHTNESS);
+    assert(light_pid_update(&pid, 1000, 900) == 100);
+    assert(light_pid_update(&pid, 1000, 900) == 200);
+    assert(light_pid_update(&pid, 1000, 1100) == 100);
+
+    // derivative on the measurement: a setpoint change alone does not move it
+    light_pid_init(&pid, 0, 0, LIGHT_PID_ONE, -MAX_BRIGHTNESS, MAX_BRIGHTNESS);
+    light_pid_reset(&pid, 0);
+    assert(light_pid_update(&pid, 1000, 500) == 0);
+    assert(light_pid_update(&pid, 2000, 500) == 0);
+    assert(light_pid_update(&pid, 2000, 400) == 100);
+}
+
+void light_pid_test_reset(){
+    light_pid_init(&pid, 0, LIGHT_PID_ONE, 0, 0, MAX_BRIGHTNESS);
+    // no error: the output stays where the reset put it
+    light_pid_reset(&pid, 1234);
+    assert(light_pid_update(&pid, 1000, 1000) == 1234);
+    light_pid_reset(&pid, MAX_BRIGHTNESS + 1);
+    assert(light_pid_update(&pid, 1000, 1000) == MAX_BRIGHTNESS);
+}
+
+void light_pid_test_setpoint_step(){
+    Plant plant = {600, 600};
+    int32_t overshoot;
+    light_pid_init(&pid, LIGHT_PID_KP, LIGHT_PID_KI, LIGHT_PID_KD, 0, MAX_BRIGHTNESS);
+
+    int32_t settled = plant_run(&plant, DEFAULT_THRESHOLD, &overshoot);
+    printf("light pid: setpoint step settled in %d readings, overshoot %d lux\n", settled, overshoot);
+    assert(settled <= 8);
+    assert(overshoot <= PLANT_SETTLE_BAND);
+    assert(abs(plant.lux - DEFAULT_THRESHOLD) <= 2);
+}
+
+void light_pid_test_disturbance(){
+    Plant plant = {600, 600};
+    int32_t overshoot;
+    light_pid_init(&pid, LIGHT_PID_KP, LIGHT_PID_KI, LIGHT_PID_KD, 0, MAX_BRIGHTNESS);
+    plant_run(&plant, DEFAULT_THRESHOLD, &overshoot);
+
+    // the sun comes out: the lights must dim
+    plant.ambient = 1000;
+    int32_t settled = plant_run(&plant, DEFAULT_THRESHOLD, &overshoot);
+    printf("light pid: ambient step settled in %d readings\n", settled);
+    assert(settled <= 10);
+    assert(abs(plant.lux - DEFAULT_THRESHOLD) <= 2);
+}
+
+void light_pid_test_saturation(){
+    // too dark for the lights to reach the setpoint
+    Plant plant = {0, 0};
+    int32_t overshoot;
+    light_pid_init(&pid, LIGHT_PID_KP, LIGHT_PID_KI, LIGHT_PID_KD, 0, MAX_BRIGHTNESS);
+    plant_run(&plant, DEFAULT_THRESHOLD, &overshoot);
+    assert(light_pid_update(&pid, DEFAULT_THRESHOLD, plant.lux) == MAX_BRIGHTNESS);
+
+    // the integral did not wind up: the recovery is as fast as a normal step
+    plant.ambient = 1000;
+    int32_t settled = plant_run(&plant, DEFAULT_THRESHOLD, &overshoot);
+    assert(settled <= 10);
+}
+
+int light_pid_test_main(){
+
+    light_pid_test_terms();
+    light_pid_test_reset();
+    light_pid_test_setpoint_step();
+    light_pid_test_disturbance();
+    light_pid_test_saturation();
+
+    return 0;
+}
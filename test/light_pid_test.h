@@ -0,0 +1,11 @@
+#ifndef TEST_LIGHT_PID_TEST_H_
+#define TEST_LIGHT_PID_TEST_H_
+
+void light_pid_test_terms();
+void light_pid_test_reset();
+void light_pid_test_setpoint_step();
+void light_pid_test_disturbance();
+void light_pid_test_saturation();
+int light_pid_test_main();
+
+#endif
@@ -113,6 +113,33 @@ void light_test_update(){
     assert(is_grow_light_on() == 0);
 
 }
+void light_test_closed_loop(){
+
+    grow_light_set_threshold(1500);
+    update_light_hal(0x60F0); // 240
+    assert(grow_light_get_brightness() == 2520);
+    assert(grow_light_get_closed_loop() == false);
+
+    grow_light_set_closed_loop(true);
+    assert(grow_light_get_closed_loop() == true);
+
+    // darker than the setpoint: brighter than the proportional law
+    update_light_hal(0x60F0); // 240
+    assert(grow_light_get_brightness() == MAX_BRIGHTNESS);
+    update_light_hal(0x65DC); // 1500, on the setpoint
+    assert(grow_light_get_brightness() == MAX_BRIGHTNESS);
+
+    // too bright: the lights dim, then turn off
+    update_light_hal(0x90F0); // 1920
+    assert(is_grow_light_on() == 1);
+    assert(grow_light_get_brightness() == 2265);
+    update_light_hal(0xA0F0); // 3840
+    assert(is_grow_light_on() == 0);
+    assert(grow_light_get_brightness() == 0);
+
+    grow_light_set_closed_loop(false);
+    assert(grow_light_get_closed_loop() == false);
+}
 int light_test_main(){
 
     light_test_initialization();
@@ -121,6 +148,7 @@ int light_test_main(){
     light_test_mode_operations();
     light_test_power_operations();
     light_test_update();
+    light_test_closed_loop();
 
     return 0;
 }
@@ -9,6 +9,7 @@ void light_test_threshold_operations();
 void light_test_mode_operations();
 void light_test_power_operations();
 void light_test_update();
+void light_test_closed_loop();
 int light_test_main();
 
 
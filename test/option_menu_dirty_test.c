@@ -0,0 +1,81 @@
+#include "option_menu_dirty_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "option_menu/option_menu_dirty.h"
+
+static OptionMenuDirty dirty;
+
+void option_dirty_test_redraw(){
+    option_dirty_init(&dirty);
+    // the first draw is always done
+    assert(option_dirty_needs_redraw(&dirty));
+    option_dirty_drawn(&dirty);
+    assert(!option_dirty_needs_redraw(&dirty));
+
+    // moving to another option
+    option_dirty_mark_redraw(&dirty);
+    assert(option_dirty_needs_redraw(&dirty));
+    // marking twice still needs a single draw
+    option_dirty_mark_redraw(&dirty);
+    option_dirty_drawn(&dirty);
+    assert(!option_dirty_needs_redraw(&dirty));
+
+    // a changed value is drawn again
+    option_dirty_mark_changed(&dirty, 3);
+    assert(option_dirty_needs_redraw(&dirty));
+    option_dirty_drawn(&dirty);
+    // drawing does not confirm the value
+    assert(!option_dirty_needs_redraw(&dirty) && option_dirty_is_changed(&dirty, 3));
+}
+
+void option_dirty_test_changed(){
+    uint32_t pending[OPTION_DIRTY_WORDS];
+    int32_t i;
+    option_dirty_init(&dirty);
+    for(i = 0; i < OPTION_DIRTY_MAX_OPTIONS; i++){
+        assert(!option_dirty_is_changed(&dirty, i));
+    }
+
+    // both words
+    option_dirty_mark_changed(&dirty, 0);
+    option_dirty_mark_changed(&dirty, 31);
+    option_dirty_mark_changed(&dirty, 32);
+    option_dirty_mark_changed(&dirty, OPTION_DIRTY_MAX_OPTIONS - 1);
+    option_dirty_mark_changed(&dirty, 32);
+    // out of range indexes are ignored
+    option_dirty_mark_changed(&dirty, -1);
+    option_dirty_mark_changed(&dirty, OPTION_DIRTY_MAX_OPTIONS);
+    assert(!option_dirty_is_changed(&dirty, -1) && !option_dirty_is_changed(&dirty, OPTION_DIRTY_MAX_OPTIONS));
+    for(i = 0; i < OPTION_DIRTY_MAX_OPTIONS; i++){
+        assert(option_dirty_is_changed(&dirty, i) == (i == 0 || i == 31 || i == 32 || i == OPTION_DIRTY_MAX_OPTIONS - 1));
+    }
+
+    // a removed option is not confirmed
+    option_dirty_forget(&dirty, 31);
+    assert(!option_dirty_is_changed(&dirty, 31));
+
+    // the confirm takes the changed options and clears them
+    option_dirty_take_changed(&dirty, pending);
+    assert(pending[0] == 1UL);
+    assert(pending[1] == ((1UL << 0) | (1UL << 31)));
+    for(i = 0; i < OPTION_DIRTY_MAX_OPTIONS; i++){
+        assert(!option_dirty_is_changed(&dirty, i));
+    }
+    option_dirty_take_changed(&dirty, pending);
+    assert(pending[0] == 0 && pending[1] == 0);
+
+    // init forgets the changes
+    option_dirty_mark_changed(&dirty, 5);
+    option_dirty_init(&dirty);
+    assert(!option_dirty_is_changed(&dirty, 5));
+}
+
+int option_dirty_test_main(){
+
+    option_dirty_test_redraw();
+    option_dirty_test_changed();
+
+    return 0;
+}
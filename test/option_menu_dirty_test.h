@@ -0,0 +1,8 @@
+#ifndef TEST_OPTION_MENU_DIRTY_TEST_H_
+#define TEST_OPTION_MENU_DIRTY_TEST_H_
+
+void option_dirty_test_redraw();
+void option_dirty_test_changed();
+int option_dirty_test_main();
+
+#endif
@@ -19,6 +19,17 @@ void blink_routine_a_on_change(int32_t value){
 void blink_routine_b_on_change(int32_t value){
     task_list.task_array[b].max_time = value;
 }
+static const OptionDesc blink_options[] = {
+    OPTION_TIMER(OPTION_ID_TEST_BLINK_A, "blink a timer",
+                 1000,
+                 blink_routine_a_on_change,
+                 to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_TEST_BLINK_B, "blink b timer",
+                 30000,
+                 blink_routine_b_on_change,
+                 to_string_timer_default)
+};
+
 void option_menu_test_main(){
     //REQUIRED: scheduling_test
 
@@ -39,28 +50,9 @@ void option_menu_test_main(){
     };
     a = push_task(task);
     b = push_task(task2);
-    int err_a,err_b;
-
-    //OptionList * option_menu = &option_list;
-    //creating two new timer options, with 1s and 2s respectively
-    OptionUnion option_u_a = option_u_new_timer("1s",&err_a),option_u_b = option_u_new_timer("30s",&err_b);
-
-
-    option_menu_push_option(
-            option_new("blink a timer",
-                       TIMER,
-                       option_u_a,
-                       blink_routine_a_on_change,
-                       to_string_timer_default)
-                           );
 
-    option_menu_push_option(
-               option_new("blink b timer",
-                          TIMER,
-                          option_u_b,
-                          blink_routine_b_on_change,
-                          to_string_timer_default)
-                              );
+    //creating two new timer options, with 1s and 30s respectively
+    option_menu_push_options(blink_options, 2);
 
 }
 
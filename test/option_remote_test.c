@@ -0,0 +1,222 @@
+#include "option_remote_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "option_menu/options.h"
+#include "option_menu/option_remote.h"
+#include "option_menu/option_ids.h"
+#include "light_system/growing_light.h"
+
+static int32_t last_action_value;
+
+static void action(int32_t value){
+    last_action_value = value;
+}
+
+static const OptionDesc remote_options[] = {
+    OPTION_THRESHOLD(5, "light threshold", 100, 20, 210, 20, action, to_string_threshold_default),
+    OPTION_TIMER(24, "tank timer", 10000, action, to_string_timer_default),
+    OPTION_SWITCH(30, "manual mode", false, action, to_string_switch_default)
+};
+
+static Option options[3];
+
+static void options_reset(){
+    int i;
+    for(i = 0; i < 3; i++){
+        options[i] = option_from_desc(&remote_options[i]);
+    }
+}
+
+/*
+    types and ranges of every option of the firmware (main.c, water_reading.c,
+    pump_management.c, telemetry.c, iot_publish.c), to be kept in sync with them
+*/
+static const OptionDesc firmware_options[] = {
+    OPTION_SWITCH(OPTION_ID_POWER_LEDS, "power leds", false, action, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_LIGHT_MODE, "light mode", false, action, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_LIGHT_CLOSED_LOOP, "light closed loop", false, action, to_string_switch_default),
+    OPTION_TIMER(OPTION_ID_LIGHT_TIMER, "light timer", 10000, action, to_string_timer_default),
+    OPTION_THRESHOLD(OPTION_ID_LIGHT_THRESHOLD, "change light threshold", DEFAULT_THRESHOLD,
+                     MIN_BRIGHTNESS, MAX_BRIGHTNESS, 20, action, to_string_threshold_default),
+    OPTION_TIMER(OPTION_ID_TEMP_TIMER, "temp sensor timer", 5000, action, to_string_timer_default),
+    OPTION_THRESHOLD(OPTION_ID_TEMP_HIGHER_THRESHOLD, "change temp higher threshold", 30, 0, 42, 5,
+                     action, to_string_threshold_default),
+    OPTION_THRESHOLD(OPTION_ID_TEMP_LOWER_THRESHOLD, "change temp lower threshold", 20, 0, 40, 5,
+                     action, to_string_threshold_default),
+    OPTION_TIMER(OPTION_ID_AIR_TIMER, "air system timer", 20000, action, to_string_timer_default),
+    OPTION_THRESHOLD(OPTION_ID_AIR_THRESHOLD, "change air threshold", 50, 0, 50, 5,
+                     action, to_string_threshold_default),
+    OPTION_SWITCH(OPTION_ID_POWER_BUZZER, "power buzzer", false, action, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_BUZZER_MODE, "buzzer mode", false, action, to_string_switch_default),
+    OPTION_THRESHOLD(OPTION_ID_RESERVOIRE_EMPTY_THRESHOLD, "Empty Reservoire Threshold", 20, 0, 20, 1,
+                     action, to_string_threshold_default),
+    OPTION_THRESHOLD(OPTION_ID_RESERVOIRE_LOW_THRESHOLD, "Low Reservoire Threshold", 500, 0, 500, 2,
+                     action, to_string_threshold_default),
+    OPTION_THRESHOLD(OPTION_ID_RESERVOIRE_MODERATE_THRESHOLD, "Moderate Reservoire Threshold", 500, 0, 500, 2,
+                     action, to_string_threshold_default),
+    OPTION_THRESHOLD(OPTION_ID_TANK_EMPTY_THRESHOLD, "Empty Tank Threshold", 500, 0, 500, 2,
+                     action, to_string_threshold_default),
+    OPTION_TIMER(OPTION_ID_TANK_READING_TIME, "Tank Reading Time", 10000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_RESERVOIRE_READING_TIME, "Reservoire Reading Time", 10000, action, to_string_timer_default),
+    OPTION_SWITCH(OPTION_ID_PUMPS_MANUAL_MODE, "Pumps Manual Mode", false, action, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_PUMP1_STATUS, "Pump 1 Status", false, action, to_string_switch_default),
+    OPTION_SWITCH(OPTION_ID_PUMP2_STATUS, "Pump 2 Status", false, action, to_string_switch_default),
+    OPTION_TIMER(OPTION_ID_PUMP1_ENABLE_TIME, "Pump 1 Enable Time", 10000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP2_ENABLE_TIME, "Pump 2 Enable Time", 10000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP1_DISABLE_TIME, "Pump 1 Disable Time", 20000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_PUMP2_DISABLE_TIME, "Pump 2 Disable Time", 20000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_TELEMETRY_TIMER, "telemetry timer", 10000, action, to_string_timer_default),
+    OPTION_TIMER(OPTION_ID_IOT_HEARTBEAT, "iot heartbeat", 10000, action, to_string_timer_default)
+};
+
+#define FIRMWARE_OPTION_COUNT (sizeof(firmware_options) / sizeof(firmware_options[0]))
+
+// the valid value of an option with the most characters
+static int32_t longest_value(const OptionDesc * desc){
+    char min[12];
+    char max[12];
+    int32_t longest = 0;
+    int i;
+    switch(desc->type){
+        case SWITCH:
+            return 1;
+        case THRESHOLD:
+            snprintf(min, sizeof(min), "%ld", (long)desc->min_value);
+            snprintf(max, sizeof(max), "%ld", (long)desc->max_value);
+            return strlen(min) > strlen(max) ? desc->min_value : desc->max_value;
+        case TIMER:
+            for(i = 0; i < TIMER_OPTION_ARR_LEN; i++){
+                if(timer_option_arr[i].value > longest){
+                    longest = timer_option_arr[i].value;
+                }
+            }
+            return longest;
+    }
+    return 0;
+}
+
+void option_remote_test_parse(){
+    OptionAssignment a[4];
+    uint8_t id;
+
+    assert(option_remote_parse_id("24", &id) && id == 24);
+    assert(option_remote_parse_id("0", &id) && id == 0);
+    assert(!option_remote_parse_id("256", &id));
+    assert(!option_remote_parse_id("", &id));
+    assert(!option_remote_parse_id("2x", &id));
+
+    assert(option_remote_parse_assignments("5=140", a, 4) == 1);
+    assert(a[0].id == 5 && a[0].value == 140);
+    assert(option_remote_parse_assignments("5=-20,24=3600000,30=1", a, 4) == 3);
+    assert(a[0].value == -20 && a[1].id == 24 && a[1].value == 3600000 && a[2].id == 30 && a[2].value == 1);
+    assert(option_remote_parse_assignments("1=2147483647,2=-2147483648", a, 4) == 2);
+    assert(a[0].value == INT32_MAX && a[1].value == INT32_MIN);
+
+    // format errors
+    assert(option_remote_parse_assignments("", a, 4) == -1);
+    assert(option_remote_parse_assignments("5", a, 4) == -1);
+    assert(option_remote_parse_assignments("5=", a, 4) == -1);
+    assert(option_remote_parse_assignments("5=1,", a, 4) == -1);
+    assert(option_remote_parse_assignments("5=1;6=2", a, 4) == -1);
+    assert(option_remote_parse_assignments("300=1", a, 4) == -1);
+    assert(option_remote_parse_assignments("5=2147483648", a, 4) == -1);
+    // more assignments than the array holds
+    assert(option_remote_parse_assignments("1=1,2=2,3=3,4=4,5=5", a, 4) == -1);
+    assert(option_remote_parse_assignments("1=1,2=2,3=3,4=4", a, 4) == 4);
+}
+
+void option_remote_test_check(){
+    OptionAssignment a[4];
+    int32_t indexes[4];
+    int8_t count;
+    options_reset();
+
+    count = option_remote_parse_assignments("30=1,5=140,24=3600000", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == -1);
+    assert(indexes[0] == 2 && indexes[1] == 0 && indexes[2] == 1);
+
+    // threshold: range and step from the minimum, the maximum is reachable too
+    count = option_remote_parse_assignments("5=20,5=200,5=210", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == -1);
+    count = option_remote_parse_assignments("5=20,5=150", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 1);
+    count = option_remote_parse_assignments("5=0", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 0);
+    count = option_remote_parse_assignments("5=220", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 0);
+
+    // timer: only the amounts of the timer array
+    count = option_remote_parse_assignments("24=1000,24=1500", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 1);
+
+    // switch: 0 or 1
+    count = option_remote_parse_assignments("30=0,30=2", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 1);
+
+    // unknown id, after a valid assignment
+    count = option_remote_parse_assignments("30=1,6=1", a, 4);
+    assert(option_remote_check(options, 3, a, count, indexes) == 1);
+
+    // checking changes nothing
+    assert(option_get_value(&options[0]) == 100);
+    assert(option_get_value(&options[2]) == 0);
+    assert(option_find_by_id(options, 3, 24) == 1);
+    assert(option_find_by_id(options, 3, 25) == -1);
+}
+
+void option_remote_test_format(){
+    char buf[OPTION_REMOTE_LINE_LEN];
+    uint16_t len;
+    options_reset();
+
+    len = option_remote_format_option(buf, sizeof(buf), &options[0]);
+    assert(strcmp(buf, "OPT:5,0,100,20,210,20,light threshold$") == 0);
+    assert(len == strlen(buf));
+    option_remote_format_option(buf, sizeof(buf), &options[1]);
+    assert(strcmp(buf, "OPT:24,1,10000,2,7200000,0,tank timer$") == 0);
+    assert(option_set_value(&options[2], 1) == 1);
+    option_remote_format_option(buf, sizeof(buf), &options[2]);
+    assert(strcmp(buf, "OPT:30,2,1,0,1,1,manual mode$") == 0);
+
+    // a line that does not fit is not sent truncated
+    assert(option_remote_format_option(buf, 10, &options[0]) == 0);
+}
+
+// a board is provisioned with one SET of every option, it must fit in a UART frame
+void option_remote_test_longest_set(){
+    static Option options[FIRMWARE_OPTION_COUNT];
+    static OptionAssignment a[OPTION_REMOTE_MAX_ASSIGNMENTS];
+    static int32_t indexes[OPTION_REMOTE_MAX_ASSIGNMENTS];
+    char frame[2 * OPTION_REMOTE_FRAME_LEN];
+    size_t len = 0;
+    size_t i;
+
+    assert(FIRMWARE_OPTION_COUNT <= OPTION_REMOTE_MAX_ASSIGNMENTS);
+    len += snprintf(frame + len, sizeof(frame) - len, "SET:");
+    for(i = 0; i < FIRMWARE_OPTION_COUNT; i++){
+        options[i] = option_from_desc(&firmware_options[i]);
+        len += snprintf(frame + len, sizeof(frame) - len, "%s%u=%ld", i ? "," : "",
+                        firmware_options[i].id, (long)longest_value(&firmware_options[i]));
+    }
+    // the frame without its separator, as handed to option_remote_set
+    assert(option_remote_parse_assignments(frame + 4, a, OPTION_REMOTE_MAX_ASSIGNMENTS) == (int8_t)FIRMWARE_OPTION_COUNT);
+    assert(option_remote_check(options, FIRMWARE_OPTION_COUNT, a, FIRMWARE_OPTION_COUNT, indexes) == -1);
+    len += snprintf(frame + len, sizeof(frame) - len, "$");
+    printf("option remote: longest SET of the %u options is %u characters\n",
+           (unsigned)FIRMWARE_OPTION_COUNT, (unsigned)len);
+    assert(len <= OPTION_REMOTE_FRAME_LEN);
+}
+
+int option_remote_test_main(){
+
+    option_remote_test_parse();
+    option_remote_test_check();
+    option_remote_test_format();
+    option_remote_test_longest_set();
+
+    return 0;
+}
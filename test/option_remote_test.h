@@ -0,0 +1,9 @@
+#ifndef TEST_OPTION_REMOTE_TEST_H_
+#define TEST_OPTION_REMOTE_TEST_H_
+
+void option_remote_test_parse();
+void option_remote_test_check();
+void option_remote_test_format();
+int option_remote_test_main();
+
+#endif
@@ -0,0 +1,56 @@
+#include "pwm_test.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include "pwm/pwm.h"
+#include "light_system/growing_light.h"
+#include "environment_systems/buzzer.h"
+
+void pwm_test_duty_counts(){
+    assert(pwm_duty_counts(0, MAX_BRIGHTNESS, PWM_PERIOD) == 0);
+    assert(pwm_duty_counts(MAX_BRIGHTNESS / 2, MAX_BRIGHTNESS, PWM_PERIOD) == PWM_PERIOD / 2);
+    assert(pwm_duty_counts(MAX_BRIGHTNESS, MAX_BRIGHTNESS, PWM_PERIOD) == PWM_PERIOD);
+    // brighter than the maximum is still 100%
+    assert(pwm_duty_counts(MAX_BRIGHTNESS + 1, MAX_BRIGHTNESS, PWM_PERIOD) == PWM_PERIOD);
+    assert(pwm_duty_counts(5, 0, PWM_PERIOD) == PWM_PERIOD);
+    // no overflow with large levels
+    assert(pwm_duty_counts(UINT32_MAX - 1, UINT32_MAX, BUZZER_PERIOD) == BUZZER_PERIOD - 1);
+}
+
+void pwm_test_compare_value(){
+    assert(pwm_compare_value(0, PWM_PERIOD) == 0);
+    assert(pwm_compare_value(1, PWM_PERIOD) == 1);
+    assert(pwm_compare_value(PWM_PERIOD - 1, PWM_PERIOD) == PWM_PERIOD - 1);
+    // past CCR0 the reset never happens and the pin stays high
+    assert(pwm_compare_value(PWM_PERIOD, PWM_PERIOD) == PWM_PERIOD + 1);
+    assert(pwm_compare_value(BUZZER_PERIOD / 2, BUZZER_PERIOD) == 1500);
+}
+
+void pwm_test_fade_step(){
+    uint16_t duty = 0;
+    uint16_t periods = 0;
+    // no step: straight to the target
+    assert(pwm_fade_step(100, 2000, 0) == 2000);
+    assert(pwm_fade_step(100, 103, 2) == 102);
+    assert(pwm_fade_step(102, 103, 2) == 103);
+    assert(pwm_fade_step(103, 103, 2) == 103);
+    assert(pwm_fade_step(103, 0, 2) == 101);
+    assert(pwm_fade_step(1, 0, 2) == 0);
+
+    // off to full brightness in about a second
+    while(duty != PWM_PERIOD){
+        duty = pwm_fade_step(duty, PWM_PERIOD, GROW_LIGHT_FADE_STEP);
+        periods++;
+    }
+    assert(periods == (PWM_PERIOD + GROW_LIGHT_FADE_STEP - 1) / GROW_LIGHT_FADE_STEP);
+    assert(periods <= PWM_FREQUENCY_HZ + PWM_FREQUENCY_HZ / 10);
+}
+
+int pwm_test_main(){
+
+    pwm_test_duty_counts();
+    pwm_test_compare_value();
+    pwm_test_fade_step();
+
+    return 0;
+}
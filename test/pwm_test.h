@@ -0,0 +1,9 @@
+#ifndef TEST_PWM_TEST_H_
+#define TEST_PWM_TEST_H_
+
+void pwm_test_duty_counts();
+void pwm_test_compare_value();
+void pwm_test_fade_step();
+int pwm_test_main();
+
+#endif
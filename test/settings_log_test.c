@@ -0,0 +1,214 @@
+#include "settings_log_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "settings/settings_log.h"
+
+// simulated flash: small sectors, so the log is compacted often
+#define SIM_SECTOR_SIZE 256
+#define SIM_SECTOR_WORDS (SIM_SECTOR_SIZE / 4)
+#define SIM_SLOTS (SIM_SECTOR_SIZE / 8)
+
+static uint32_t sim_flash[2][SIM_SECTOR_WORDS];
+static volatile uint32_t * const sim_sectors[2] = {sim_flash[0], sim_flash[1]};
+static uint16_t sim_erases[2];
+static uint32_t sim_programmed_words;
+// programming stops after this many words, to simulate a reset (-1: never)
+static int32_t sim_words_before_reset;
+
+static bool sim_program(volatile uint32_t * address, const uint32_t * words, uint16_t count){
+    uint16_t i;
+    for(i = 0; i < count; i++){
+        if(sim_words_before_reset == 0){
+            return false;
+        }
+        if(sim_words_before_reset > 0){
+            sim_words_before_reset--;
+        }
+        // programming can only clear bits
+        address[i] &= words[i];
+        sim_programmed_words++;
+    }
+    return true;
+}
+
+static bool sim_erase(volatile uint32_t * sector){
+    uint8_t s = sector == sim_sectors[0] ? 0 : 1;
+    if(sim_words_before_reset == 0){
+        return false;
+    }
+    memset(sim_flash[s], 0xFF, SIM_SECTOR_SIZE);
+    sim_erases[s]++;
+    return true;
+}
+
+static SettingsLog settings;
+
+// values seen by the last replay, indexed by key (the tests use small keys)
+static int32_t replayed[16];
+static uint16_t replayed_mask;
+
+static void apply(uint16_t key, int32_t value){
+    assert(key < 16);
+    replayed[key] = value;
+    replayed_mask |= 1U << key;
+}
+
+// a reset: the log is mounted again on the same flash and replayed
+static uint16_t reboot(){
+    settings_log_state_init(&settings, sim_sectors, 2, SIM_SECTOR_SIZE, sim_program, sim_erase);
+    assert(settings_log_mount(&settings));
+    replayed_mask = 0;
+    return settings_log_replay(&settings, apply);
+}
+
+static void sim_reset(){
+    memset(sim_flash, 0x5A, sizeof(sim_flash));
+    sim_erases[0] = 0;
+    sim_erases[1] = 0;
+    sim_programmed_words = 0;
+    sim_words_before_reset = -1;
+}
+
+void settings_log_test_crc(){
+    uint8_t bytes[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    // check value of CRC-16/CCITT-FALSE
+    assert(settings_log_crc16(bytes, 9) == 0x29B1);
+}
+
+void settings_log_test_append_replay(){
+    int32_t value;
+    sim_reset();
+    // first boot, the flash holds garbage
+    assert(reboot() == 0);
+    assert(sim_erases[0] == 1);
+
+    assert(settings_log_append(&settings, 1, 100));
+    assert(settings_log_append(&settings, 2, -5));
+    assert(settings_log_append(&settings, 1, 120));
+    assert(settings_log_find(&settings, 1, &value) && value == 120);
+    assert(!settings_log_find(&settings, 3, &value));
+    assert(!settings_log_append(&settings, 0xFFFF, 0));
+
+    // the same value is not written again
+    uint32_t programmed = sim_programmed_words;
+    assert(settings_log_append(&settings, 1, 120));
+    assert(sim_programmed_words == programmed);
+
+    assert(reboot() == 3);
+    assert(replayed_mask == ((1U << 1) | (1U << 2)));
+    assert(replayed[1] == 120);
+    assert(replayed[2] == -5);
+    // nothing erased by the reboot
+    assert(sim_erases[0] == 1 && sim_erases[1] == 0);
+
+    // appended after the records found at boot
+    assert(settings_log_append(&settings, 3, 7));
+    assert(reboot() == 4);
+    assert(replayed[3] == 7);
+}
+
+void settings_log_test_compaction(){
+    uint32_t i;
+    sim_reset();
+    reboot();
+    // far more changes than a sector holds
+    for(i = 0; i < 20 * SIM_SLOTS; i++){
+        assert(settings_log_append(&settings, i % 4, i));
+    }
+    reboot();
+    assert(replayed_mask == 0x0F);
+    for(i = 0; i < 4; i++){
+        assert(replayed[i] == (int32_t)(20 * SIM_SLOTS - 4 + i));
+    }
+    printf("settings log: %u erases for %u changes (%u and %u per sector)\n",
+           sim_erases[0] + sim_erases[1], 20 * SIM_SLOTS, sim_erases[0], sim_erases[1]);
+    // the erases alternate between the two sectors
+    assert(sim_erases[0] <= sim_erases[1] + 1 && sim_erases[1] <= sim_erases[0] + 1);
+    assert(sim_erases[0] > 1 && sim_erases[1] > 1);
+
+    // a sector full of different settings cannot be compacted
+    sim_reset();
+    reboot();
+    for(i = 0; i < SIM_SLOTS - 1; i++){
+        assert(settings_log_append(&settings, 0x100 + i, 1));
+    }
+    assert(!settings_log_append(&settings, 0x200, 1));
+}
+
+// the test keeps the small keys, as the firmware keeps the ids of its options
+static bool keep_small_keys(uint16_t key){
+    return key < 16;
+}
+
+void settings_log_test_filter(){
+    uint32_t i;
+    sim_reset();
+    reboot();
+    // stale keys, like the hashed keys of an older format, fill most of the sector
+    for(i = 0; i < SIM_SLOTS - 3; i++){
+        assert(settings_log_append(&settings, 0x100 + i, 1));
+    }
+    assert(settings_log_append(&settings, 1, 10));
+    assert(settings_log_append(&settings, 2, 20));
+    // without a filter they are all carried forward and the new sector is full too
+    assert(!settings_log_append(&settings, 3, 30));
+    assert(settings.active == 1 && settings.next == SIM_SLOTS);
+
+    settings_log_set_filter(&settings, keep_small_keys);
+    assert(settings_log_append(&settings, 3, 30));
+    assert(settings.active == 0);
+    // header, the two kept settings and the new one
+    assert(settings.next == 4);
+    assert(reboot() == 3);
+    assert(replayed_mask == ((1U << 1) | (1U << 2) | (1U << 3)));
+    assert(replayed[1] == 10 && replayed[2] == 20 && replayed[3] == 30);
+    assert(!settings_log_find(&settings, 0x100, (int32_t *)&i));
+}
+
+void settings_log_test_reset(){
+    sim_reset();
+    reboot();
+    assert(settings_log_append(&settings, 1, 10));
+
+    // reset in the middle of a record: it is skipped, the next one goes after it
+    sim_words_before_reset = 1;
+    assert(!settings_log_append(&settings, 2, 20));
+    sim_words_before_reset = -1;
+    assert(reboot() == 1);
+    assert(replayed_mask == (1U << 1));
+    assert(settings_log_append(&settings, 2, 30));
+    assert(reboot() == 2);
+    assert(replayed[2] == 30);
+
+    // reset during a compaction, before the new header: the old sector stays active
+    while(settings.next < settings.sector_slots){
+        assert(settings_log_append(&settings, 3, settings.next));
+    }
+    sim_words_before_reset = 4;
+    assert(!settings_log_append(&settings, 1, 11));
+    sim_words_before_reset = -1;
+    reboot();
+    assert(settings.active == 0);
+    assert(replayed[1] == 10 && replayed[2] == 30 && replayed[3] == SIM_SLOTS - 1);
+
+    // the next change compacts again and is kept
+    assert(settings_log_append(&settings, 1, 11));
+    reboot();
+    assert(settings.active == 1);
+    assert(replayed[1] == 11 && replayed[2] == 30 && replayed[3] == SIM_SLOTS - 1);
+}
+
+int settings_log_test_main(){
+
+    settings_log_test_crc();
+    settings_log_test_append_replay();
+    settings_log_test_compaction();
+    settings_log_test_filter();
+    settings_log_test_reset();
+
+    return 0;
+}
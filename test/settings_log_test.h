@@ -0,0 +1,11 @@
+#ifndef TEST_SETTINGS_LOG_TEST_H_
+#define TEST_SETTINGS_LOG_TEST_H_
+
+void settings_log_test_crc();
+void settings_log_test_append_replay();
+void settings_log_test_compaction();
+void settings_log_test_filter();
+void settings_log_test_reset();
+int settings_log_test_main();
+
+#endif
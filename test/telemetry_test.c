@@ -0,0 +1,105 @@
+#include "telemetry_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include "telemetry/telemetry.h"
+
+static TelemetrySnapshot make_snapshot(){
+    TelemetrySnapshot s = {
+        .timestamp = 123456,
+        .lux = 960,
+        .brightness = 1560,
+        .air_ppm = 42,
+        .tank_level = 5000,
+        .reservoir_level = 3200,
+        .temperature = 21,
+        .flags = TELEMETRY_FLAG_LIGHT_ON | TELEMETRY_FLAG_PUMP1
+    };
+    return s;
+}
+
+void telemetry_test_format(){
+    TelemetrySnapshot s = make_snapshot();
+    char buf[TELEMETRY_FRAME_LEN];
+
+    uint16_t len = telemetry_format_frame(&s, buf, TELEMETRY_FRAME_LEN);
+    assert(strcmp(buf, "TLM:123456,960,1560,21,42,5000,3200,5$") == 0);
+    assert(len == strlen(buf));
+
+    // worst case must fit in TELEMETRY_FRAME_LEN
+    memset(&s, 0xFF, sizeof(s));
+    assert(telemetry_format_frame(&s, buf, TELEMETRY_FRAME_LEN) > 0);
+}
+
+void telemetry_test_small_buffer(){
+    TelemetrySnapshot s = make_snapshot();
+    char buf[16];
+
+    assert(telemetry_format_frame(&s, buf, sizeof(buf)) == 0);
+}
+
+void telemetry_test_suppression(){
+    TelemetryState state;
+    TelemetrySnapshot s = make_snapshot();
+    telemetry_state_init(&state);
+
+    // first frame always goes out
+    assert(telemetry_should_send(&state, &s));
+    telemetry_mark_sent(&state, &s, true);
+
+    // only the timestamp changed
+    s.timestamp += 5000;
+    assert(!telemetry_should_send(&state, &s));
+    assert(state.suppressed == 1);
+
+    s.temperature = 22;
+    assert(telemetry_should_send(&state, &s));
+    telemetry_mark_sent(&state, &s, true);
+    assert(state.sent == 2);
+
+    s.flags |= TELEMETRY_FLAG_BUZZER;
+    assert(telemetry_should_send(&state, &s));
+}
+
+void telemetry_test_heartbeat(){
+    TelemetryState state;
+    TelemetrySnapshot s = make_snapshot();
+    telemetry_state_init(&state);
+
+    assert(telemetry_should_send(&state, &s));
+    telemetry_mark_sent(&state, &s, true);
+
+    int i;
+    for(i = 0; i < TELEMETRY_HEARTBEAT_INTERVALS - 1; i++){
+        assert(!telemetry_should_send(&state, &s));
+    }
+    assert(telemetry_should_send(&state, &s));
+    telemetry_mark_sent(&state, &s, true);
+    assert(state.skipped == 0);
+    assert(!telemetry_should_send(&state, &s));
+}
+
+void telemetry_test_dropped(){
+    TelemetryState state;
+    TelemetrySnapshot s = make_snapshot();
+    telemetry_state_init(&state);
+
+    // tx buffer full: nothing recorded as sent, retried next time
+    assert(telemetry_should_send(&state, &s));
+    telemetry_mark_sent(&state, &s, false);
+    assert(state.dropped == 1);
+    assert(telemetry_should_send(&state, &s));
+}
+
+int telemetry_test_main(){
+
+    telemetry_test_format();
+    telemetry_test_small_buffer();
+    telemetry_test_suppression();
+    telemetry_test_heartbeat();
+    telemetry_test_dropped();
+
+    return 0;
+}
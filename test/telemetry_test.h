@@ -0,0 +1,11 @@
+#ifndef TEST_TELEMETRY_TEST_H_
+#define TEST_TELEMETRY_TEST_H_
+
+void telemetry_test_format();
+void telemetry_test_small_buffer();
+void telemetry_test_suppression();
+void telemetry_test_heartbeat();
+void telemetry_test_dropped();
+int telemetry_test_main();
+
+#endif
@@ -2,15 +2,56 @@
 #include "air_qual_test.h"
 #include "temp_test.h"
 #include "buzzer_test.h"
-/*
+#include "uart_baud_test.h"
+#include "telemetry_test.h"
+#include "uart_tx_queue_test.h"
+#include "lcd_dirty_region_test.h"
+#include "dashboard_test.h"
+#include "lcd_scene_test.h"
+#include "iot_frame_test.h"
+#include "iot_publish_test.h"
+#include "iot_tx_queue_test.h"
+#include "clock_profile_test.h"
+#include "idle_test.h"
+#include "pwm_test.h"
+#include "light_pid_test.h"
+#include "calendar_test.h"
+#include "settings_log_test.h"
+#include "option_remote_test.h"
+#include "option_menu_dirty_test.h"
+#include "history_test.h"
+#include "datalog_test.h"
+#include "uptime_test.h"
+
+#ifdef SOFTWARE_DEBUG
 int main(){
   // no harware inits should be found here
   light_test_main();
   air_test_main();
   temp_test_main();
   buzzer_test_main();
+  uart_baud_test_main();
+  telemetry_test_main();
+  uart_tx_queue_test_main();
+  lcd_dirty_test_main();
+  dashboard_test_main();
+  lcd_scene_test_main();
+  iot_frame_test_main();
+  iot_publish_test_main();
+  iot_tx_queue_test_main();
+  clock_profile_test_main();
+  idle_test_main();
+  pwm_test_main();
+  light_pid_test_main();
+  calendar_test_main();
+  settings_log_test_main();
+  option_remote_test_main();
+  option_dirty_test_main();
+  history_test_main();
+  datalog_test_main();
+  uptime_test_main();
   //    blink_test_init();
 //        option_menu_test_main();
   return 0;
 }
-*/
\ No newline at end of file
+#endif
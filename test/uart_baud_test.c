@@ -0,0 +1,156 @@
+#ifdef SOFTWARE_DEBUG
+// needed for the pseudo terminal functions used by the loopback test
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#endif
+#include "uart_baud_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart_communication/uart_baud.h"
+
+#ifdef SOFTWARE_DEBUG
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#endif
+
+void uart_baud_test_default_rate(){
+    UART_BaudConfig config;
+
+    // must match the values that were hard coded in uart_init
+    assert(uart_baud_compute(3000000, UART_DEFAULT_BAUD, &config));
+    assert(config.oversampling == true);
+    assert(config.clock_prescalar == 19);
+    assert(config.first_mod_reg == 8);
+    assert(config.second_mod_reg == 0x55);
+    assert(uart_baud_effective(3000000, &config) == 9600);
+}
+
+void uart_baud_test_high_speed_rates(){
+    UART_BaudConfig config;
+
+    // values from the technical reference manual table
+    assert(uart_baud_compute(3000000, 115200, &config));
+    assert(config.oversampling == true);
+    assert(config.clock_prescalar == 1);
+    assert(config.first_mod_reg == 10);
+    assert(config.second_mod_reg == 0x00);
+
+    // below 16 clock cycles per bit the low frequency mode is used
+    assert(uart_baud_compute(3000000, 230400, &config));
+    assert(config.oversampling == false);
+    assert(config.clock_prescalar == 13);
+
+    // values from the technical reference manual table
+    assert(uart_baud_compute(12000000, 115200, &config));
+    assert(config.oversampling == true);
+    assert(config.clock_prescalar == 6);
+    assert(config.first_mod_reg == 8);
+    assert(config.second_mod_reg == 0x20);
+
+    assert(uart_baud_compute(48000000, 115200, &config));
+    assert(config.oversampling == true);
+    assert(config.clock_prescalar == 26);
+    assert(config.first_mod_reg == 0);
+    assert(config.second_mod_reg == 0xB6);
+
+    assert(uart_baud_compute(48000000, 921600, &config));
+    assert(config.oversampling == true);
+    assert(config.clock_prescalar == 3);
+    assert(config.first_mod_reg == 4);
+    assert(config.second_mod_reg == 0x02);
+
+    uint32_t rates[] = {115200, 230400, 460800, 921600};
+    uint32_t i;
+    for(i = 0; i < 4; i++){
+        assert(uart_baud_compute(48000000, rates[i], &config));
+        assert(config.error <= UART_BAUD_MAX_ERROR && config.error >= -UART_BAUD_MAX_ERROR);
+    }
+}
+
+void uart_baud_test_invalid_rates(){
+    UART_BaudConfig config;
+
+    assert(uart_baud_compute(3000000, 0, &config) == false);
+    assert(uart_baud_compute(0, 9600, &config) == false);
+    // less than UART_BAUD_MIN_DIVISOR clock cycles per bit
+    assert(uart_baud_compute(3000000, 1500000, &config) == false);
+    assert(uart_baud_compute(3000000, 921600, &config) == false);
+}
+
+#ifdef SOFTWARE_DEBUG
+/*
+    sends a block of data through a pseudo terminal standing in for the host side
+    of the uart link and checks that it comes back unchanged.
+    the pty itself has no baud rate, the transfer time printed here is the one
+    the configured divider would need on the wire (10 bits per byte: start + 8 data + stop)
+*/
+static void loopback_at(uint32_t clock_hz, uint32_t baud){
+    UART_BaudConfig config;
+    assert(uart_baud_compute(clock_hz, baud, &config));
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    assert(master >= 0);
+    assert(grantpt(master) == 0);
+    assert(unlockpt(master) == 0);
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    assert(slave >= 0);
+
+    struct termios tio;
+    assert(tcgetattr(slave, &tio) == 0);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    uint8_t tx[1024];
+    uint8_t rx[1024];
+    uint32_t i;
+    for(i = 0; i < sizeof(tx); i++){
+        tx[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    assert(write(slave, tx, sizeof(tx)) == (ssize_t)sizeof(tx));
+    size_t received = 0;
+    while(received < sizeof(rx)){
+        ssize_t n = read(master, rx + received, sizeof(rx) - received);
+        assert(n > 0);
+        received += (size_t)n;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    assert(memcmp(tx, rx, sizeof(tx)) == 0);
+
+    uint32_t wire_bytes_per_s = uart_baud_effective(clock_hz, &config) / 10;
+    double pty_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    printf("uart loopback %lu baud @ %lu Hz: %lu B/s on the wire, %u bytes in %.0f us on the pty\n",
+           (unsigned long)baud, (unsigned long)clock_hz, (unsigned long)wire_bytes_per_s,
+           (unsigned)sizeof(tx), pty_us);
+
+    close(slave);
+    close(master);
+}
+#endif
+
+void uart_baud_test_loopback(){
+#ifdef SOFTWARE_DEBUG
+    loopback_at(3000000, UART_DEFAULT_BAUD);
+    loopback_at(3000000, UART_HIGH_SPEED_BAUD);
+    loopback_at(48000000, 921600);
+#endif
+}
+
+int uart_baud_test_main(){
+
+    uart_baud_test_default_rate();
+    uart_baud_test_high_speed_rates();
+    uart_baud_test_invalid_rates();
+    uart_baud_test_loopback();
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef TEST_UART_BAUD_TEST_H_
+#define TEST_UART_BAUD_TEST_H_
+
+void uart_baud_test_default_rate();
+void uart_baud_test_high_speed_rates();
+void uart_baud_test_invalid_rates();
+void uart_baud_test_loopback();
+int uart_baud_test_main();
+
+#endif
@@ -0,0 +1,147 @@
+#include "uart_tx_queue_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include "uart_communication/uart_tx_queue.h"
+
+static UART_TxQueue queue;
+static int callback_calls;
+
+static void count_callback(){
+    callback_calls++;
+}
+
+static bool push_str(UART_TxClass msg_class, uint16_t key, const char * str){
+    return uart_tx_queue_push(&queue, msg_class, key, (const uint8_t *)str, strlen(str), NULL);
+}
+
+// pops the next message, checks its content and releases it
+static void expect_next(const char * str){
+    int8_t slot = uart_tx_queue_pop(&queue);
+    assert(slot >= 0);
+    UART_TxMessage * msg = uart_tx_queue_message(&queue, slot);
+    assert(msg->len == strlen(str));
+    assert(memcmp(msg->data, str, msg->len) == 0);
+    uart_tx_queue_release(&queue, slot);
+}
+
+void uart_tx_queue_test_priority(){
+    uart_tx_queue_init(&queue);
+
+    assert(push_str(UART_TX_MENU, 0, "menu"));
+    assert(push_str(UART_TX_TELEMETRY, 0, "tlm"));
+    assert(push_str(UART_TX_REPLY, 0, "reply"));
+    assert(push_str(UART_TX_ALERT, 1, "alert"));
+
+    expect_next("alert");
+    expect_next("reply");
+    expect_next("tlm");
+    expect_next("menu");
+    assert(uart_tx_queue_pop(&queue) == -1);
+
+    assert(uart_tx_queue_stats(&queue, UART_TX_ALERT)->sent == 1);
+    assert(uart_tx_queue_stats(&queue, UART_TX_MENU)->pending == 0);
+}
+
+void uart_tx_queue_test_drop_newest(){
+    uart_tx_queue_init(&queue);
+
+    // replies default to 4 messages, newest refused
+    assert(push_str(UART_TX_REPLY, 0, "r1"));
+    assert(push_str(UART_TX_REPLY, 0, "r2"));
+    assert(push_str(UART_TX_REPLY, 0, "r3"));
+    assert(push_str(UART_TX_REPLY, 0, "r4"));
+    assert(!push_str(UART_TX_REPLY, 0, "r5"));
+    assert(uart_tx_queue_stats(&queue, UART_TX_REPLY)->dropped == 1);
+    assert(uart_tx_queue_stats(&queue, UART_TX_REPLY)->max_pending == 4);
+
+    expect_next("r1");
+
+    // too long
+    uint8_t big[UART_TX_MSG_LEN + 1];
+    memset(big, 'x', sizeof(big));
+    assert(!uart_tx_queue_push(&queue, UART_TX_REPLY, 0, big, sizeof(big), NULL));
+}
+
+void uart_tx_queue_test_drop_oldest(){
+    uart_tx_queue_init(&queue);
+    uart_tx_queue_set_policy(&queue, UART_TX_TELEMETRY, UART_TX_DROP_OLDEST, 2);
+
+    assert(push_str(UART_TX_TELEMETRY, 0, "t1"));
+    assert(push_str(UART_TX_TELEMETRY, 0, "t2"));
+    assert(push_str(UART_TX_TELEMETRY, 0, "t3"));
+    assert(uart_tx_queue_stats(&queue, UART_TX_TELEMETRY)->dropped == 1);
+
+    expect_next("t2");
+    expect_next("t3");
+}
+
+void uart_tx_queue_test_coalesce(){
+    uart_tx_queue_init(&queue);
+
+    assert(push_str(UART_TX_ALERT, 1, "temp high"));
+    assert(push_str(UART_TX_ALERT, 2, "air bad"));
+    // same key: replaces the content but keeps its turn
+    assert(push_str(UART_TX_ALERT, 1, "temp very high"));
+    assert(uart_tx_queue_stats(&queue, UART_TX_ALERT)->coalesced == 1);
+    assert(uart_tx_queue_stats(&queue, UART_TX_ALERT)->pending == 2);
+
+    assert(push_str(UART_TX_MENU, 0, "line 1"));
+    assert(push_str(UART_TX_MENU, 0, "line 2"));
+
+    expect_next("temp very high");
+    expect_next("air bad");
+    expect_next("line 2");
+    assert(uart_tx_queue_pop(&queue) == -1);
+}
+
+void uart_tx_queue_test_eviction(){
+    uart_tx_queue_init(&queue);
+    uart_tx_queue_set_policy(&queue, UART_TX_TELEMETRY, UART_TX_DROP_OLDEST, UART_TX_QUEUE_SLOTS);
+
+    // telemetry fills the whole pool
+    int i;
+    char buf[8];
+    for(i = 0; i < UART_TX_QUEUE_SLOTS; i++){
+        snprintf(buf, sizeof(buf), "t%d", i);
+        assert(push_str(UART_TX_TELEMETRY, i, buf));
+    }
+    // menu is less important, it can't take a slot
+    assert(!push_str(UART_TX_MENU, 0, "menu"));
+    // an alert takes the slot of the oldest telemetry frame
+    assert(push_str(UART_TX_ALERT, 0, "alert"));
+    assert(uart_tx_queue_stats(&queue, UART_TX_TELEMETRY)->dropped == 1);
+
+    expect_next("alert");
+    expect_next("t1");
+}
+
+void uart_tx_queue_test_callbacks(){
+    uart_tx_queue_init(&queue);
+    callback_calls = 0;
+
+    const uint8_t data[] = "abc";
+    assert(uart_tx_queue_push(&queue, UART_TX_REPLY, 0, data, 3, count_callback));
+    assert(uart_tx_queue_push(&queue, UART_TX_REPLY, 0, data, 3, NULL));
+
+    int8_t slot = uart_tx_queue_pop(&queue);
+    assert(uart_tx_queue_message(&queue, slot)->callback == count_callback);
+    uart_tx_queue_release(&queue, slot);
+    slot = uart_tx_queue_pop(&queue);
+    assert(uart_tx_queue_message(&queue, slot)->callback == NULL);
+    uart_tx_queue_release(&queue, slot);
+}
+
+int uart_tx_queue_test_main(){
+
+    uart_tx_queue_test_priority();
+    uart_tx_queue_test_drop_newest();
+    uart_tx_queue_test_drop_oldest();
+    uart_tx_queue_test_coalesce();
+    uart_tx_queue_test_eviction();
+    uart_tx_queue_test_callbacks();
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef TEST_UART_TX_QUEUE_TEST_H_
+#define TEST_UART_TX_QUEUE_TEST_H_
+
+void uart_tx_queue_test_priority();
+void uart_tx_queue_test_drop_newest();
+void uart_tx_queue_test_drop_oldest();
+void uart_tx_queue_test_coalesce();
+void uart_tx_queue_test_eviction();
+void uart_tx_queue_test_callbacks();
+int uart_tx_queue_test_main();
+
+#endif
@@ -0,0 +1,95 @@
+#include "uptime_test.h"
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "scheduling/uptime.h"
+#include "observer/observer.h"
+#include "environment_systems/temperature.h"
+#include "environment_systems/air_quality.h"
+
+void uptime_test_extend(){
+    assert(uptime_extend(0, 0, false) == 0);
+    assert(uptime_extend(3, 0x1234, false) == 3 * 65536UL + 0x1234);
+    // the count wrapped and the interrupt is pending: the overflow is counted here
+    assert(uptime_extend(3, 0x0002, true) == 4 * 65536UL + 2);
+    // the count was read just before the wrap, the pending flag is for the next overflow
+    assert(uptime_extend(3, 0xFFFE, true) == 3 * 65536UL + 0xFFFE);
+    // 48 bits of ticks
+    assert(uptime_extend(UINT32_MAX, 0xFFFF, false) == 0xFFFFFFFFFFFFULL);
+
+    // a read across an overflow never goes back
+    uint32_t overflows;
+    uint64_t last = 0;
+    for(overflows = 0; overflows < 4; overflows++){
+        uint32_t count;
+        for(count = 0; count < 65536; count += 7){
+            // the interrupt is served a bit after the wrap: the count is small and the flag still set
+            bool pending = count < 40 && overflows > 0;
+            uint64_t now = uptime_extend(pending ? overflows - 1 : overflows, count, pending);
+            assert(now >= last);
+            last = now;
+        }
+    }
+}
+
+void uptime_test_conversions(){
+    assert(uptime_ticks_to_ms(0) == 0);
+    assert(uptime_ticks_to_ms(UPTIME_TICKS_PER_SECOND) == 1000);
+    assert(uptime_ticks_to_ms(32) == 0 && uptime_ticks_to_ms(33) == 1);
+    assert(uptime_ticks_to_us(1) == 30);
+    assert(uptime_ticks_to_us(UPTIME_TICKS_PER_SECOND) == 1000000);
+    // a year of ticks, no overflow in the conversions
+    uint64_t year = 365ULL * 24 * 3600 * UPTIME_TICKS_PER_SECOND;
+    assert(uptime_ticks_to_ms(year) == 365ULL * 24 * 3600 * 1000);
+    assert(uptime_ticks_to_us(year + 1) == 365ULL * 24 * 3600 * 1000000 + 30);
+    // the whole range of the clock
+    assert(uptime_ticks_to_ms(0xFFFFFFFFFFFFULL) == 0xFFFFFFFFFFFFULL * 1000 / UPTIME_TICKS_PER_SECOND);
+    assert(uptime_ticks_to_us(0xFFFFFFFFFFFFULL) == 0xFFFFFFFFFFFFULL / 512 * 15625 + 511 * 15625 / 512);
+
+    uptime_set_ticks(5 * UPTIME_TICKS_PER_SECOND);
+    assert(uptime_now_ms() == 5000 && uptime_now_us() == 5000000);
+    uptime_set_ticks(0);
+}
+
+static uint64_t callback_time;
+
+static void save_time(ObservedValue id, int32_t value, uint64_t time){
+    (void)id;
+    (void)value;
+    callback_time = time;
+}
+
+void uptime_test_samples(){
+    observer_init();
+    assert(observer_register(save_time));
+    assert(observer_get_time(OBSERVED_TEMPERATURE) == 0);
+
+    // the setters date every sample
+    uptime_set_ticks(10 * UPTIME_TICKS_PER_SECOND);
+    temp_set_current_temperature(21);
+    assert(observer_get_time(OBSERVED_TEMPERATURE) == 10000 && callback_time == 10000);
+
+    // the same value later: the callbacks are not called but the sample is dated, the value is not stale
+    uptime_set_ticks(70 * UPTIME_TICKS_PER_SECOND);
+    temp_set_current_temperature(21);
+    assert(observer_get_time(OBSERVED_TEMPERATURE) == 70000 && callback_time == 10000);
+
+    air_set_level(400);
+    assert(observer_get_time(OBSERVED_AIR_LEVEL) == 70000 && callback_time == 70000);
+    assert(observer_get_time(OBSERVED_VALUE_COUNT) == 0);
+
+    observer_init();
+    assert(observer_get_time(OBSERVED_TEMPERATURE) == 0);
+    uptime_set_ticks(0);
+}
+
+int uptime_test_main(){
+
+    uptime_test_extend();
+    uptime_test_conversions();
+    uptime_test_samples();
+
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_UPTIME_TEST_H_
+#define TEST_UPTIME_TEST_H_
+
+void uptime_test_extend();
+void uptime_test_conversions();
+void uptime_test_samples();
+int uptime_test_main();
+
+#endif
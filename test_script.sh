@@ -11,10 +11,52 @@ SRC_FILES=(
     src/environment_systems/air_quality.c
     src/environment_systems/temperature.c
     src/light_system/growing_light.c
+    src/light_system/light_pid.c
+    src/uart_communication/uart_baud.c
+    src/telemetry/telemetry.c
+    src/uart_communication/uart_tx_queue.c
+    include/LcdDriver/lcd_dirty_region.c
+    include/LcdDriver/lcd_scene.c
+    src/observer/observer.c
+    src/dashboard/dashboard.c
+    src/IOT/iot_frame.c
+    src/IOT/iot_publish.c
+    src/IOT/iot_tx_queue.c
+    src/clock/clock_profile.c
+    src/power/idle.c
+    src/pwm/pwm.c
+    src/scheduling/calendar.c
+    src/settings/settings_log.c
+    src/option_menu/options.c
+    src/option_menu/option_remote.c
+    src/option_menu/option_menu_dirty.c
+    src/history/history.c
+    src/datalog/datalog.c
+    src/scheduling/uptime.c
     $TEST_DIR/buzzer_test.c
     $TEST_DIR/air_qual_test.c
     $TEST_DIR/light_test.c
     $TEST_DIR/temp_test.c
+    $TEST_DIR/uart_baud_test.c
+    $TEST_DIR/telemetry_test.c
+    $TEST_DIR/uart_tx_queue_test.c
+    $TEST_DIR/lcd_dirty_region_test.c
+    $TEST_DIR/dashboard_test.c
+    $TEST_DIR/lcd_scene_test.c
+    $TEST_DIR/iot_frame_test.c
+    $TEST_DIR/iot_publish_test.c
+    $TEST_DIR/iot_tx_queue_test.c
+    $TEST_DIR/clock_profile_test.c
+    $TEST_DIR/idle_test.c
+    $TEST_DIR/pwm_test.c
+    $TEST_DIR/light_pid_test.c
+    $TEST_DIR/calendar_test.c
+    $TEST_DIR/settings_log_test.c
+    $TEST_DIR/option_remote_test.c
+    $TEST_DIR/option_menu_dirty_test.c
+    $TEST_DIR/history_test.c
+    $TEST_DIR/datalog_test.c
+    $TEST_DIR/uptime_test.c
 )
 
 for src in "${SRC_FILES[@]}"; do
@@ -26,7 +68,27 @@ gcc -DSOFTWARE_DEBUG -DDEBUG "$TEST_DIR/test_all.c" -o "$BUILD_DIR/tests" \
     "$BUILD_DIR/air_qual_test.o" "$BUILD_DIR/growing_light.o" \
     "$BUILD_DIR/light_test.o" "$BUILD_DIR/temp_test.o" \
     "$BUILD_DIR/buzzer_test.o" "$BUILD_DIR/buzzer.o" \
-    "$BUILD_DIR/temperature.o" "$BUILD_DIR/air_quality.o"
+    "$BUILD_DIR/temperature.o" "$BUILD_DIR/air_quality.o" \
+    "$BUILD_DIR/uart_baud_test.o" "$BUILD_DIR/uart_baud.o" \
+    "$BUILD_DIR/telemetry_test.o" "$BUILD_DIR/telemetry.o" \
+    "$BUILD_DIR/uart_tx_queue_test.o" "$BUILD_DIR/uart_tx_queue.o" \
+    "$BUILD_DIR/lcd_dirty_region_test.o" "$BUILD_DIR/lcd_dirty_region.o" \
+    "$BUILD_DIR/dashboard_test.o" "$BUILD_DIR/dashboard.o" "$BUILD_DIR/observer.o" \
+    "$BUILD_DIR/lcd_scene_test.o" "$BUILD_DIR/lcd_scene.o" \
+    "$BUILD_DIR/iot_frame_test.o" "$BUILD_DIR/iot_frame.o" \
+    "$BUILD_DIR/iot_publish_test.o" "$BUILD_DIR/iot_publish.o" \
+    "$BUILD_DIR/iot_tx_queue_test.o" "$BUILD_DIR/iot_tx_queue.o" \
+    "$BUILD_DIR/clock_profile_test.o" "$BUILD_DIR/clock_profile.o" \
+    "$BUILD_DIR/idle_test.o" "$BUILD_DIR/idle.o" \
+    "$BUILD_DIR/pwm_test.o" "$BUILD_DIR/pwm.o" \
+    "$BUILD_DIR/light_pid_test.o" "$BUILD_DIR/light_pid.o" \
+    "$BUILD_DIR/calendar_test.o" "$BUILD_DIR/calendar.o" \
+    "$BUILD_DIR/settings_log_test.o" "$BUILD_DIR/settings_log.o" \
+    "$BUILD_DIR/option_remote_test.o" "$BUILD_DIR/option_remote.o" "$BUILD_DIR/options.o" \
+    "$BUILD_DIR/option_menu_dirty_test.o" "$BUILD_DIR/option_menu_dirty.o" \
+    "$BUILD_DIR/history_test.o" "$BUILD_DIR/history.o" \
+    "$BUILD_DIR/datalog_test.o" "$BUILD_DIR/datalog.o" \
+    "$BUILD_DIR/uptime_test.o" "$BUILD_DIR/uptime.o"
 
 "$BUILD_DIR/tests"
 
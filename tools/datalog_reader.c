@@ -0,0 +1,323 @@
+/*
+ * datalog_reader.c
+ *
+ * Host side of the data log (see datalog/datalog.h), for Linux.
+ *
+ *     datalog_reader [-b <baud>] <serial device> <directory>
+ *         downloads the sealed blocks missing from the directory, one file per
+ *         block named after its sequence number (<directory>/<sequence>.blk),
+ *         checks their CRC and prints the download throughput
+ *     datalog_reader --decode <block file>...
+ *         prints the records of downloaded blocks as CSV: sequence,boot,id,time ms,value
+ *
+ * Build from the root of the repository:
+ *
+ *     gcc -DSOFTWARE_DEBUG -I include -o datalog_reader tools/datalog_reader.c \
+ *         src/datalog/datalog.c src/settings/settings_log.c src/history/history.c
+ *
+ * The sequence numbers restart from 1 if the data log region is erased (a new
+ * firmware flashed with the region erased): use a new directory then.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include "datalog/datalog.h"
+
+// a reply line not received within this time ends the download
+#define READER_TIMEOUT_MS 3000
+#define READER_LINE_LEN 256
+
+static speed_t baud_to_speed(long baud){
+    switch(baud){
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+    }
+}
+
+static int serial_open(const char * device, long baud){
+    struct termios tty;
+    speed_t speed = baud_to_speed(baud);
+    int fd;
+    if(speed == 0){
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+    fd = open(device, O_RDWR | O_NOCTTY);
+    if(fd < 0){
+        fprintf(stderr, "%s: %s\n", device, strerror(errno));
+        return -1;
+    }
+    if(tcgetattr(fd, &tty) != 0){
+        fprintf(stderr, "%s: %s\n", device, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+static bool serial_send(int fd, const char * message){
+    size_t len = strlen(message);
+    return write(fd, message, len) == (ssize_t)len;
+}
+
+/*
+    reads the next message from the board, up to its '$'; the NUL terminators
+    and line breaks between messages are skipped
+    returns:
+    - false on timeout or error
+*/
+static bool serial_read_line(int fd, char * line, size_t len){
+    size_t pos = 0;
+    char c;
+    while(true){
+        fd_set set;
+        struct timeval timeout = {READER_TIMEOUT_MS / 1000, (READER_TIMEOUT_MS % 1000) * 1000};
+        FD_ZERO(&set);
+        FD_SET(fd, &set);
+        if(select(fd + 1, &set, NULL, NULL, &timeout) <= 0 || read(fd, &c, 1) != 1){
+            return false;
+        }
+        if(c == '\0' || c == '\r' || c == '\n'){
+            continue;
+        }
+        if(c == '$'){
+            line[pos] = '\0';
+            return true;
+        }
+        // too long, not a reply of the data log
+        if(pos == len - 1){
+            pos = 0;
+        }
+        line[pos++] = c;
+    }
+}
+
+// reads lines up to one starting with one of the prefixes, the telemetry frames and other replies are skipped
+static bool serial_expect(int fd, char * line, size_t len, const char * prefix, const char * other){
+    while(serial_read_line(fd, line, len)){
+        if(strncmp(line, prefix, strlen(prefix)) == 0 || (other != NULL && strncmp(line, other, strlen(other)) == 0)){
+            return true;
+        }
+    }
+    return false;
+}
+
+static double now_seconds(){
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1e6;
+}
+
+static void block_path(char * path, size_t len, const char * directory, unsigned long sequence){
+    snprintf(path, len, "%s/%08lu.blk", directory, sequence);
+}
+
+// size of the file if it holds a checked block, 0 otherwise
+static long block_load(const char * path, uint8_t * block){
+    FILE * file = fopen(path, "rb");
+    long len;
+    if(file == NULL){
+        return 0;
+    }
+    len = fread(block, 1, DATALOG_BLOCK_SIZE, file);
+    fclose(file);
+    return datalog_block_check(block, len) ? len : 0;
+}
+
+static int hex_value(char c){
+    if(c >= '0' && c <= '9'){
+        return c - '0';
+    }
+    if(c >= 'A' && c <= 'F'){
+        return c - 'A' + 10;
+    }
+    if(c >= 'a' && c <= 'f'){
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/*
+    downloads a block with LOGGET
+    returns:
+    - the bytes of the block, 0 if it could not be downloaded or its CRC does not match
+*/
+static uint16_t block_download(int fd, unsigned long sequence, uint8_t * block){
+    char line[READER_LINE_LEN];
+    char message[32];
+    unsigned long reply_sequence;
+    unsigned bytes;
+    unsigned offset;
+    unsigned received = 0;
+    int consumed;
+
+    snprintf(message, sizeof(message), "LOGGET:%lu$", sequence);
+    if(!serial_send(fd, message) || !serial_expect(fd, line, sizeof(line), "LOGB:", "LOG:ERR")){
+        return 0;
+    }
+    if(sscanf(line, "LOGB:%lu,%u", &reply_sequence, &bytes) != 2 || reply_sequence != sequence ||
+       bytes < DATALOG_HEADER_SIZE || bytes > DATALOG_BLOCK_SIZE){
+        return 0;
+    }
+    while(received < bytes){
+        const char * hex;
+        if(!serial_expect(fd, line, sizeof(line), "LOGD:", "LOG:ERR") ||
+           sscanf(line, "LOGD:%lu,%u,%n", &reply_sequence, &offset, &consumed) != 2 ||
+           reply_sequence != sequence || offset != received){
+            return 0;
+        }
+        for(hex = line + consumed; hex[0] != '\0' && hex[1] != '\0' && received < bytes; hex += 2){
+            int high = hex_value(hex[0]);
+            int low = hex_value(hex[1]);
+            if(high < 0 || low < 0){
+                return 0;
+            }
+            block[received++] = high << 4 | low;
+        }
+    }
+    return datalog_block_check(block, bytes) ? bytes : 0;
+}
+
+static int download(const char * device, long baud, const char * directory){
+    uint8_t block[DATALOG_BLOCK_SIZE];
+    char line[READER_LINE_LEN];
+    char path[512];
+    unsigned long first;
+    unsigned long last;
+    unsigned long sequence;
+    unsigned boot;
+    unsigned long dropped;
+    unsigned long blocks = 0;
+    unsigned long bytes = 0;
+    unsigned long failed = 0;
+    double start;
+    double elapsed;
+    int fd = serial_open(device, baud);
+
+    if(fd < 0){
+        return 1;
+    }
+    if(!serial_send(fd, "LOGINFO:$") || !serial_expect(fd, line, sizeof(line), "LOG:", NULL) ||
+       sscanf(line, "LOG:%lu,%lu,%u,%lu", &first, &last, &boot, &dropped) != 4){
+        fprintf(stderr, "no reply to LOGINFO\n");
+        close(fd);
+        return 1;
+    }
+    printf("board: blocks %lu to %lu, boot %u, %lu changes lost before reaching the log\n",
+           first, last, boot, dropped);
+
+    start = now_seconds();
+    for(sequence = first; first != 0 && sequence <= last; sequence++){
+        uint16_t len;
+        FILE * file;
+        block_path(path, sizeof(path), directory, sequence);
+        if(block_load(path, block) > 0){
+            continue;
+        }
+        len = block_download(fd, sequence, block);
+        if(len == 0){
+            fprintf(stderr, "block %lu: download failed\n", sequence);
+            failed++;
+            continue;
+        }
+        file = fopen(path, "wb");
+        if(file == NULL || fwrite(block, 1, len, file) != len){
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            if(file != NULL){
+                fclose(file);
+            }
+            close(fd);
+            return 1;
+        }
+        fclose(file);
+        blocks++;
+        bytes += len;
+    }
+    elapsed = now_seconds() - start;
+    close(fd);
+
+    printf("downloaded %lu blocks, %lu bytes in %.1f s", blocks, bytes, elapsed);
+    if(blocks > 0 && elapsed > 0){
+        // the hex lines take a bit more than twice the bytes on the wire
+        printf(", %.0f bytes/s (%.0f%% of the %ld baud line)", bytes / elapsed,
+               100.0 * bytes / elapsed / (baud / 10.0), baud);
+    }
+    printf("\n");
+    if(failed > 0){
+        printf("%lu blocks failed, run again to retry them\n", failed);
+    }
+    return failed > 0;
+}
+
+typedef struct {
+    uint32_t sequence;
+    uint16_t boot;
+} DecodeContext;
+
+static void print_sample(void * context, uint8_t id, uint32_t time, int32_t value){
+    const DecodeContext * block = context;
+    printf("%lu,%u,%u,%lu,%ld\n", (unsigned long)block->sequence, block->boot, id, (unsigned long)time, (long)value);
+}
+
+static int decode(int count, char ** paths){
+    uint8_t block[DATALOG_BLOCK_SIZE];
+    int errors = 0;
+    int i;
+    printf("sequence,boot,id,time_ms,value\n");
+    for(i = 0; i < count; i++){
+        const DatalogHeader * header = (const DatalogHeader *)block;
+        DecodeContext context;
+        if(block_load(paths[i], block) == 0){
+            fprintf(stderr, "%s: not a valid block\n", paths[i]);
+            errors++;
+            continue;
+        }
+        context.sequence = header->sequence;
+        context.boot = header->boot;
+        datalog_block_decode(block, print_sample, &context);
+    }
+    return errors > 0;
+}
+
+static void usage(){
+    fprintf(stderr, "usage: datalog_reader [-b <baud>] <serial device> <directory>\n"
+                    "       datalog_reader --decode <block file>...\n");
+}
+
+int main(int argc, char ** argv){
+    long baud = 9600;
+    int arg = 1;
+    if(argc >= 2 && strcmp(argv[1], "--decode") == 0){
+        return decode(argc - 2, argv + 2);
+    }
+    if(argc >= 3 && strcmp(argv[1], "-b") == 0){
+        baud = strtol(argv[2], NULL, 10);
+        arg = 3;
+    }
+    if(argc - arg != 2){
+        usage();
+        return 2;
+    }
+    return download(argv[arg], baud, argv[arg + 1]);
+}